@@ -1,6 +1,5 @@
 #include "bios_software_manager.hpp"
 
-#include "common/include/dbus_helper.hpp"
 #include "common/include/software_manager.hpp"
 #include "spi_device.hpp"
 
@@ -20,15 +19,14 @@ BIOSSoftwareManager::BIOSSoftwareManager(sdbusplus::async::context& ctx,
 {}
 
 sdbusplus::async::task<bool> BIOSSoftwareManager::initDevice(
-    const std::string& service, const sdbusplus::object_path& path,
-    SoftwareConfig& config)
+    const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
+    SoftwareConfig& config, const ConfigSnapshot& snapshot)
 {
     std::string configIface =
         "xyz.openbmc_project.Configuration." + config.configType;
 
     std::optional<uint64_t> spiControllerIndex =
-        co_await dbusGetRequiredProperty<uint64_t>(
-            ctx, service, path, configIface, "SPIControllerIndex");
+        snapshot.getRequired<uint64_t>(configIface, "SPIControllerIndex");
 
     if (!spiControllerIndex.has_value())
     {
@@ -37,8 +35,7 @@ sdbusplus::async::task<bool> BIOSSoftwareManager::initDevice(
     }
 
     std::optional<uint64_t> spiDeviceIndex =
-        co_await dbusGetRequiredProperty<uint64_t>(
-            ctx, service, path, configIface, "SPIDeviceIndex");
+        snapshot.getRequired<uint64_t>(configIface, "SPIDeviceIndex");
 
     if (!spiDeviceIndex.has_value())
     {
@@ -59,31 +56,10 @@ sdbusplus::async::task<bool> BIOSSoftwareManager::initDevice(
         tool = flashToolFlashcp;
     }
 
-    const std::string configIfaceMux = configIface + ".MuxOutputs";
-
     std::vector<std::string> names;
     std::vector<bool> values;
 
-    for (size_t i = 0; true; i++)
-    {
-        const std::string iface = configIfaceMux + std::to_string(i);
-
-        std::optional<std::string> name =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Name");
-
-        std::optional<std::string> polarity =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Polarity");
-
-        if (!name.has_value() || !polarity.has_value())
-        {
-            break;
-        }
-
-        names.push_back(name.value());
-        values.push_back((polarity == "High") ? 1 : 0);
-    }
+    snapshot.getMuxOutputs(configIface, names, values);
 
     enum FlashLayout layout = flashLayoutFlat;
 
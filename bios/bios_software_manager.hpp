@@ -14,9 +14,9 @@ class BIOSSoftwareManager : public SoftwareManager
   public:
     BIOSSoftwareManager(sdbusplus::async::context& ctx, bool isDryRun);
 
-    sdbusplus::async::task<bool> initDevice(const std::string& service,
-                                            const sdbusplus::object_path& path,
-                                            SoftwareConfig& config) final;
+    sdbusplus::async::task<bool> initDevice(
+        const std::string& service, const sdbusplus::object_path& path,
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) final;
 
   private:
     bool dryRun;
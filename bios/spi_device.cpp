@@ -123,6 +123,8 @@ sdbusplus::async::task<bool> SPIDevice::updateDevice(const uint8_t* image,
     }
 
     // restore the previous powerstate
+    beginUpdatePhase(update::UpdatePhase::Reset);
+
     const bool powerstate_restore =
         co_await HostPower::setState(ctx, prevPowerstate);
     if (!powerstate_restore)
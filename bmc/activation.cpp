@@ -90,7 +90,14 @@ auto Activation::activation(Activations value) -> Activations
     {
 #ifdef WANT_SIGNATURE_VERIFY
         fs::path uploadDir(IMG_UPLOAD_DIR);
-        if (!verifySignature(uploadDir / versionId, SIGNED_IMAGE_CONF_PATH))
+#ifdef BMC_STATIC_DUAL_IMAGE
+        // An image written to the alt chip was verified while it was written
+        const bool verified = parent.streamedImages.contains(versionId);
+#else
+        const bool verified = false;
+#endif
+        if (!verified &&
+            !verifySignature(uploadDir / versionId, SIGNED_IMAGE_CONF_PATH))
         {
             using InvalidSignatureErr = sdbusplus::error::xyz::openbmc_project::
                 software::version::InvalidSignature;
@@ -148,7 +155,16 @@ auto Activation::activation(Activations value) -> Activations
         // Enable systemd signals
         Activation::subscribeToSystemdSignals();
 
-        flashWrite();
+        // A volume may be rewritten with an os-release of the same stamp
+        ReleaseCache::invalidate();
+
+        if (!flashWrite())
+        {
+            error("Failed to write the image {ID}", "ID", versionId);
+            Activation::unsubscribeFromSystemdSignals();
+            return Activation::activation(
+                softwareServer::Activation::Activations::Failed);
+        }
 
 #if defined UBIFS_LAYOUT || defined MMC_LAYOUT
 
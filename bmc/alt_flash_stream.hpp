@@ -0,0 +1,103 @@
+#pragma once
+
+#include "flash_delta.hpp"
+#include "image_verify.hpp"
+#include "tar_extract.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+namespace fs = std::filesystem;
+
+/** @class AltFlashStream
+ *  @brief Writes the full BMC image of an upload to the alt chip while the
+ *         upload is extracted, instead of extracting it first.
+ *  @details The image is only streamed once the MANIFEST, the image public
+ *           key and the signatures which precede it in the archive were
+ *           verified, otherwise it is extracted as usual. It is hashed while
+ *           it is written, and its signature is verified over that digest
+ *           once the partition was read back and matched it. An image which
+ *           fails is erased. The alt chip is only selected to boot by the
+ *           activation, with the obmc-flash-bmc-alt-select unit.
+ *           The alt filesystems are unmounted and the Sync service stopped
+ *           while the chip is written.
+ */
+class AltFlashStream : public utils::TarObserver
+{
+  public:
+    AltFlashStream(const AltFlashStream&) = delete;
+    AltFlashStream& operator=(const AltFlashStream&) = delete;
+    AltFlashStream(AltFlashStream&&) = delete;
+    AltFlashStream& operator=(AltFlashStream&&) = delete;
+    ~AltFlashStream() override;
+
+    /** @brief Constructs AltFlashStream
+     *  @param[in] extractDir - The directory the upload is extracted to.
+     *  @param[in] next - Optionally sees the files which are extracted.
+     */
+    AltFlashStream(const fs::path& extractDir, utils::TarObserver* next) :
+        extractDir(extractDir), next(next)
+    {}
+
+    bool extract(const fs::path& path) override;
+    void begin(const fs::path& path) override;
+    bool update(std::span<const uint8_t> data) override;
+    bool end() override;
+
+    /** @brief Give the alt chip back once the extraction is over. A part of
+     *         an image is erased, then the alt filesystems are mounted again
+     *         and the Sync service is started.
+     *  @return true if the image was written and verified.
+     */
+    bool release();
+
+  private:
+    /** @brief What is done with the file being extracted */
+    enum class Target
+    {
+        extracted,
+        streamed,
+        rejected,
+    };
+
+    /** @brief Check that the image can be streamed and take the alt chip
+     *  @return true if the image is to be streamed.
+     */
+    bool start();
+
+    /** @brief Whether the upload is a BMC image for this machine */
+    bool isForThisBMC() const;
+
+    /** @brief Unmount the alt filesystems and open the alt chip */
+    bool takeAltChip();
+
+    const fs::path extractDir;
+    utils::TarObserver* const next;
+
+    Target target = Target::extracted;
+    bool imageSeen = false;
+
+    /** @brief Verifies the metadata, then the digest of the image */
+    std::unique_ptr<image::Signature> signature;
+
+    /** @brief The alt chip, once it was taken */
+    int deviceFd = -1;
+    bool altTaken = false;
+    std::unique_ptr<utils::DeltaWriter> writer;
+
+    /** @brief Set once the image was written and verified */
+    bool streamed = false;
+};
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
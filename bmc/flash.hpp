@@ -29,8 +29,11 @@ class Flash
 
     /**
      * @brief Writes the image file(s) to flash
+     *
+     * @return false if the write failed to start, a write which completes
+     *         asynchronously reports its result through onStateChanges
      */
-    virtual void flashWrite() = 0;
+    virtual bool flashWrite() = 0;
 
     /**
      * @brief Takes action when the state of the activation service file changes
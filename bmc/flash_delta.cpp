@@ -0,0 +1,371 @@
+#include "flash_delta.hpp"
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <mtd/mtd-user.h>
+#include <openssl/evp.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::software::utils
+{
+
+namespace // anonymous
+{
+
+// The unit compared on block devices, where nothing needs to be erased
+constexpr uint32_t blockDeviceBlockSize = 64 * 1024;
+
+using EVP_MD_CTX_Ptr =
+    std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+using Digest = std::array<uint8_t, EVP_MAX_MD_SIZE>;
+
+/** @brief Read until size bytes were read or the end of the file */
+ssize_t readFull(int fd, uint8_t* data, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+/** @brief Read at offset until size bytes were read or the end of the file */
+ssize_t preadFull(int fd, uint8_t* data, size_t size, uint64_t offset)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = pread(fd, data + done, size - done,
+                          static_cast<off_t>(offset + done));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+bool pwriteFull(int fd, const uint8_t* data, size_t size, uint64_t offset)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = pwrite(fd, data + done, size - done,
+                           static_cast<off_t>(offset + done));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool eraseBlock(int fd, uint64_t offset, uint32_t size)
+{
+    erase_info_user erase{};
+    erase.start = static_cast<uint32_t>(offset);
+    erase.length = size;
+    return ioctl(fd, MEMERASE, &erase) == 0;
+}
+
+/** @brief Drop the cached pages of the partition, so that it is read back
+ *         from the device rather than from what was written to the cache.
+ *         MTD character devices are not cached. */
+void dropCache(int fd)
+{
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISBLK(st.st_mode) &&
+        ioctl(fd, BLKFLSBUF, 0) != 0)
+    {
+        warning("Failed to flush the buffers of the partition: {ERRNO}",
+                "ERRNO", errno);
+    }
+
+    // The pages are clean after the sync, so they can all be dropped
+    if (int rc = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); rc != 0)
+    {
+        warning("Failed to drop the cache of the partition: {ERRNO}", "ERRNO",
+                rc);
+    }
+}
+
+/** @brief Hash the first size bytes of the partition */
+bool hashDevice(int fd, uint64_t size, const EVP_MD* md, Digest& digest,
+                unsigned int& digestSize)
+{
+    EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free);
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), md, nullptr) <= 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(blockDeviceBlockSize);
+    for (uint64_t offset = 0; offset < size;)
+    {
+        const auto chunk = static_cast<size_t>(
+            std::min<uint64_t>(size - offset, buffer.size()));
+        if (preadFull(fd, buffer.data(), chunk, offset) !=
+            static_cast<ssize_t>(chunk))
+        {
+            return false;
+        }
+        EVP_DigestUpdate(ctx.get(), buffer.data(), chunk);
+        offset += chunk;
+    }
+    return EVP_DigestFinal_ex(ctx.get(), digest.data(), &digestSize) > 0;
+}
+
+} // namespace
+
+std::optional<FlashDevice> probeFlashDevice(int fd)
+{
+    struct stat st{};
+    if (fstat(fd, &st) != 0)
+    {
+        return std::nullopt;
+    }
+
+    FlashDevice device;
+    if (S_ISCHR(st.st_mode))
+    {
+        mtd_info_user info{};
+        if (ioctl(fd, MEMGETINFO, &info) != 0 || info.erasesize == 0)
+        {
+            return std::nullopt;
+        }
+        device.size = info.size;
+        device.blockSize = info.erasesize;
+        device.writeSize = std::max<uint32_t>(info.writesize, 1);
+        device.erase = true;
+        return device;
+    }
+
+    device.blockSize = blockDeviceBlockSize;
+    if (S_ISBLK(st.st_mode))
+    {
+        uint64_t size = 0;
+        if (ioctl(fd, BLKGETSIZE64, &size) != 0)
+        {
+            return std::nullopt;
+        }
+        device.size = size;
+        return device;
+    }
+
+    if (S_ISREG(st.st_mode))
+    {
+        // An image of a partition, which may grow
+        device.size = std::numeric_limits<uint64_t>::max();
+        return device;
+    }
+    return std::nullopt;
+}
+
+DeltaWriter::DeltaWriter(int deviceFd, const FlashDevice& device,
+                         const EVP_MD* md) :
+    deviceFd(deviceFd), device(device), md(md),
+    ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free), image(device.blockSize),
+    current(device.blockSize)
+{
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), md, nullptr) <= 0)
+    {
+        error("Failed to create a digest context");
+        failed = true;
+    }
+}
+
+bool DeltaWriter::write(std::span<const uint8_t> data)
+{
+    while (!failed && !data.empty())
+    {
+        const size_t chunk = std::min(data.size(), image.size() - buffered);
+        std::copy_n(data.begin(), chunk, image.begin() + buffered);
+        buffered += chunk;
+        data = data.subspan(chunk);
+
+        if (buffered == image.size() && !writeBlock())
+        {
+            failed = true;
+        }
+    }
+    return !failed;
+}
+
+bool DeltaWriter::writeBlock()
+{
+    const size_t size = buffered;
+    buffered = 0;
+
+    if (size > device.size || offset > device.size - size)
+    {
+        error("The image is larger than the partition ({SIZE})", "SIZE",
+              device.size);
+        return false;
+    }
+
+    EVP_DigestUpdate(ctx.get(), image.data(), size);
+    stats.imageSize += size;
+    stats.blocks++;
+
+    const ssize_t existing = preadFull(deviceFd, current.data(), size, offset);
+    if (existing < 0)
+    {
+        error("Failed to read the partition at {OFFSET}: {ERRNO}", "OFFSET",
+              offset, "ERRNO", errno);
+        return false;
+    }
+
+    if (static_cast<size_t>(existing) != size ||
+        std::memcmp(image.data(), current.data(), size) != 0)
+    {
+        // The last block is padded to the write unit with the erased value
+        size_t writeSize = size;
+        if (device.erase)
+        {
+            writeSize = (size + device.writeSize - 1) / device.writeSize *
+                        device.writeSize;
+            std::fill(image.begin() + size, image.begin() + writeSize, 0xff);
+
+            if (!eraseBlock(deviceFd, offset, device.blockSize))
+            {
+                error("Failed to erase the block at {OFFSET}: {ERRNO}",
+                      "OFFSET", offset, "ERRNO", errno);
+                return false;
+            }
+        }
+
+        if (!pwriteFull(deviceFd, image.data(), writeSize, offset))
+        {
+            error("Failed to write the block at {OFFSET}: {ERRNO}", "OFFSET",
+                  offset, "ERRNO", errno);
+            return false;
+        }
+        stats.written++;
+    }
+
+    offset += size;
+    return true;
+}
+
+bool DeltaWriter::finish()
+{
+    if (failed || (buffered > 0 && !writeBlock()))
+    {
+        failed = true;
+        return false;
+    }
+    failed = true;
+
+    if (fsync(deviceFd) != 0 && errno != EINVAL)
+    {
+        error("Failed to sync the partition: {ERRNO}", "ERRNO", errno);
+        return false;
+    }
+
+    // Read everything back from the device, including the blocks which were
+    // skipped
+    dropCache(deviceFd);
+    Digest expected{};
+    Digest actual{};
+    unsigned int expectedSize = 0;
+    unsigned int actualSize = 0;
+    if (EVP_DigestFinal_ex(ctx.get(), expected.data(), &expectedSize) <= 0 ||
+        !hashDevice(deviceFd, stats.imageSize, md, actual, actualSize) ||
+        expectedSize != actualSize ||
+        std::memcmp(expected.data(), actual.data(), expectedSize) != 0)
+    {
+        error("The partition does not match the image after the write");
+        return false;
+    }
+
+    digest.assign(expected.begin(), expected.begin() + expectedSize);
+    return true;
+}
+
+bool DeltaWriter::invalidate()
+{
+    failed = true;
+    digest.clear();
+
+    if (device.erase)
+    {
+        return eraseBlock(deviceFd, 0, device.blockSize);
+    }
+
+    std::vector<uint8_t> erased(
+        std::min<uint64_t>(device.size, device.blockSize), 0xff);
+    return pwriteFull(deviceFd, erased.data(), erased.size(), 0) &&
+           (fsync(deviceFd) == 0 || errno == EINVAL);
+}
+
+bool writeDelta(int imageFd, int deviceFd, const FlashDevice& device,
+                DeltaStats& stats)
+{
+    DeltaWriter writer(deviceFd, device);
+
+    std::vector<uint8_t> buffer(device.blockSize);
+    bool written = true;
+    while (written)
+    {
+        const ssize_t n = readFull(imageFd, buffer.data(), buffer.size());
+        if (n < 0)
+        {
+            error("Failed to read the image: {ERRNO}", "ERRNO", errno);
+            written = false;
+            break;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        written = writer.write({buffer.data(), static_cast<size_t>(n)});
+    }
+
+    written = written && writer.finish();
+    stats = writer.getStats();
+    return written;
+}
+
+} // namespace phosphor::software::utils
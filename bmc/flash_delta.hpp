@@ -0,0 +1,146 @@
+#pragma once
+
+#include <openssl/evp.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace phosphor::software::utils
+{
+
+/** @struct FlashDevice
+ *  @brief The geometry of a partition to write an image to.
+ */
+struct FlashDevice
+{
+    /** @brief The size of the partition */
+    uint64_t size = 0;
+
+    /** @brief The unit which is compared, and erased on MTD devices */
+    uint32_t blockSize = 0;
+
+    /** @brief The unit of the MTD writes, 1 for block devices */
+    uint32_t writeSize = 1;
+
+    /** @brief Whether blocks must be erased before they are written */
+    bool erase = false;
+};
+
+/** @struct DeltaStats
+ *  @brief What a delta write did.
+ */
+struct DeltaStats
+{
+    /** @brief The size of the image */
+    uint64_t imageSize = 0;
+
+    /** @brief The number of blocks of the image */
+    uint64_t blocks = 0;
+
+    /** @brief The number of blocks which differed and were written */
+    uint64_t written = 0;
+};
+
+/** @brief Get the geometry of an MTD partition, a block device or a file.
+ *  @param[in] fd - The open partition.
+ *  @return The geometry, nullopt if it can't be queried.
+ */
+std::optional<FlashDevice> probeFlashDevice(int fd);
+
+/** @class DeltaWriter
+ *  @brief Writes an image to a partition while it is received, one block at
+ *         a time. Blocks whose contents already match the image are neither
+ *         erased nor written, so the wear and the time scale with the size
+ *         of the change.
+ *  @details The image is hashed as it is written, and once it is finished
+ *           the partition is read back and its digest compared to the one
+ *           of the image.
+ */
+class DeltaWriter
+{
+  public:
+    DeltaWriter(const DeltaWriter&) = delete;
+    DeltaWriter& operator=(const DeltaWriter&) = delete;
+    DeltaWriter(DeltaWriter&&) = delete;
+    DeltaWriter& operator=(DeltaWriter&&) = delete;
+    ~DeltaWriter() = default;
+
+    /** @brief Constructs DeltaWriter
+     *  @param[in] deviceFd - The partition, open for reading and writing.
+     *  @param[in] device - The geometry of the partition.
+     *  @param[in] md - The hash function of the digests.
+     */
+    DeltaWriter(int deviceFd, const FlashDevice& device,
+                const EVP_MD* md = EVP_sha256());
+
+    /** @brief Write the next bytes of the image
+     *  @param[in] data - The bytes following the ones already written.
+     *  @return false if they can't be written, the partition then holds a
+     *          part of the image.
+     */
+    bool write(std::span<const uint8_t> data);
+
+    /** @brief Write the rest of the image and check the partition
+     *  @return true if the partition holds the image.
+     */
+    bool finish();
+
+    /** @brief Erase the start of the partition, so that what it holds
+     *         can't be booted.
+     *  @return true if it was erased.
+     */
+    bool invalidate();
+
+    /** @brief Get the digest of the image, once it is finished */
+    const std::vector<uint8_t>& getDigest() const
+    {
+        return digest;
+    }
+
+    /** @brief Get what was written */
+    const DeltaStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    using EVP_MD_CTX_Ptr =
+        std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+
+    /** @brief Write the buffered block at the current offset */
+    bool writeBlock();
+
+    const int deviceFd;
+    const FlashDevice device;
+    const EVP_MD* const md;
+    EVP_MD_CTX_Ptr ctx;
+
+    /** @brief The block being received, and the one on the partition */
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> current;
+    size_t buffered = 0;
+    uint64_t offset = 0;
+
+    /** @brief Set once a write failed or the image was finished, nothing
+     *         is written after */
+    bool failed = false;
+
+    DeltaStats stats;
+    std::vector<uint8_t> digest;
+};
+
+/** @brief Write an image to a partition with a DeltaWriter.
+ *  @details The image is read sequentially, so it may be a pipe.
+ *  @param[in] imageFd - The image to write.
+ *  @param[in] deviceFd - The partition, open for reading and writing.
+ *  @param[in] device - The geometry of the partition.
+ *  @param[out] stats - What was written.
+ *  @return true if the partition holds the image.
+ */
+bool writeDelta(int imageFd, int deviceFd, const FlashDevice& device,
+                DeltaStats& stats);
+
+} // namespace phosphor::software::utils
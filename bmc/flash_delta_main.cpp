@@ -0,0 +1,71 @@
+#include "flash_delta.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    using namespace phosphor::software::utils;
+
+    if (argc != 3)
+    {
+        lg2::error("Usage: {NAME} <image|-> <partition>", "NAME", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::string imagePath = argv[1];
+    const std::string devicePath = argv[2];
+
+    // The image may be streamed in, e.g. by a decompressor
+    int imageFd = STDIN_FILENO;
+    if (imagePath != "-")
+    {
+        imageFd = open(imagePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (imageFd < 0)
+        {
+            lg2::error("Failed to open {PATH}: {ERRNO}", "PATH", imagePath,
+                       "ERRNO", errno);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int deviceFd = open(devicePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (deviceFd < 0)
+    {
+        lg2::error("Failed to open {PATH}: {ERRNO}", "PATH", devicePath,
+                   "ERRNO", errno);
+        return EXIT_FAILURE;
+    }
+
+    auto device = probeFlashDevice(deviceFd);
+    if (!device)
+    {
+        lg2::error("Failed to get the geometry of {PATH}", "PATH", devicePath);
+        return EXIT_FAILURE;
+    }
+
+    DeltaStats stats;
+    if (!writeDelta(imageFd, deviceFd, *device, stats))
+    {
+        lg2::error("Failed to write {IMAGE} to {PATH}", "IMAGE", imagePath,
+                   "PATH", devicePath);
+        return EXIT_FAILURE;
+    }
+
+    lg2::info("Wrote {WRITTEN} of {BLOCKS} blocks of {IMAGE} to {PATH}",
+              "WRITTEN", stats.written, "BLOCKS", stats.blocks, "IMAGE",
+              imagePath, "PATH", devicePath);
+
+    close(deviceFd);
+    if (imageFd != STDIN_FILENO)
+    {
+        close(imageFd);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+#include "config.h"
+
+#include "image_digests.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace phosphor
+{
+namespace software
+{
+namespace image
+{
+
+PHOSPHOR_LOG2_USING;
+
+namespace
+{
+
+constexpr auto hashFunctionTag = "HashType";
+constexpr auto hashTagSuffix = "_Hash_Type";
+
+// The MANIFEST is kept in memory to find the hash types, it is only a few
+// lines long
+constexpr size_t maxManifestSize = 64 * 1024;
+
+/** @brief The key of an image directory in the store */
+fs::path getKey(const fs::path& imageDir)
+{
+    auto key = imageDir.lexically_normal();
+    return key.has_filename() ? key : key.parent_path();
+}
+
+} // namespace
+
+void ImageDigests::add(const std::string& file, const std::string& hashType,
+                       Digest digest)
+{
+    digests[{file, hashType}] = std::move(digest);
+}
+
+void ImageDigests::setStamp(const std::string& file, const FileStamp& stamp)
+{
+    stamps[file] = stamp;
+}
+
+void ImageDigests::erase(const std::string& file)
+{
+    std::erase_if(digests, [&file](const auto& entry) {
+        return entry.first.first == file;
+    });
+    stamps.erase(file);
+}
+
+const ImageDigests::Digest* ImageDigests::find(
+    const fs::path& imageDir, const std::string& file,
+    const std::string& hashType) const
+{
+    auto it = digests.find({file, hashType});
+    auto stamp = stamps.find(file);
+    if (it == digests.end() || stamp == stamps.end())
+    {
+        return nullptr;
+    }
+
+    // A file written or replaced since the extraction is read again
+    struct stat st{};
+    if (stat((imageDir / file).c_str(), &st) != 0 ||
+        FileStamp::of(st) != stamp->second)
+    {
+        warning("{FILE} changed after the extraction", "FILE", file);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void DigestCollector::begin(const fs::path& path)
+{
+    file = path.generic_string();
+
+    // A file may be replaced by a later entry of the same name
+    digests.erase(file);
+    contexts.clear();
+
+    inManifest = (file == MANIFEST_FILE_NAME);
+    manifest.clear();
+    if (inManifest)
+    {
+        return;
+    }
+
+    for (const auto& [name, md] : hashTypes)
+    {
+        EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), ::EVP_MD_CTX_free);
+        if (!ctx || EVP_DigestInit_ex(ctx.get(), md, nullptr) <= 0)
+        {
+            warning("Unable to hash {FILE} with {HASH}", "FILE", file, "HASH",
+                    name);
+            continue;
+        }
+        contexts.emplace_back(name, std::move(ctx));
+    }
+}
+
+bool DigestCollector::update(std::span<const uint8_t> data)
+{
+    if (inManifest)
+    {
+        if (manifest.size() + data.size() > maxManifestSize)
+        {
+            inManifest = false;
+            manifest.clear();
+            return true;
+        }
+        manifest.append(reinterpret_cast<const char*>(data.data()),
+                        data.size());
+        return true;
+    }
+
+    for (auto& [name, ctx] : contexts)
+    {
+        EVP_DigestUpdate(ctx.get(), data.data(), data.size());
+    }
+    return true;
+}
+
+bool DigestCollector::end()
+{
+    if (inManifest)
+    {
+        parseManifest();
+
+        // It is in memory already, hash it as a whole
+        for (const auto& [name, md] : hashTypes)
+        {
+            ImageDigests::Digest digest(EVP_MAX_MD_SIZE);
+            unsigned int size = 0;
+            if (EVP_Digest(manifest.data(), manifest.size(), digest.data(),
+                           &size, md, nullptr) > 0)
+            {
+                digest.resize(size);
+                digests.add(file, name, std::move(digest));
+            }
+        }
+
+        inManifest = false;
+        manifest.clear();
+    }
+    else
+    {
+        for (auto& [name, ctx] : contexts)
+        {
+            ImageDigests::Digest digest(EVP_MAX_MD_SIZE);
+            unsigned int size = 0;
+            if (EVP_DigestFinal_ex(ctx.get(), digest.data(), &size) > 0)
+            {
+                digest.resize(size);
+                digests.add(file, name, std::move(digest));
+            }
+        }
+        contexts.clear();
+    }
+
+    // The file is closed, later changes to it show in its stamp
+    struct stat st{};
+    if (stat((extractDir / file).c_str(), &st) != 0)
+    {
+        digests.erase(file);
+        return true;
+    }
+    digests.setStamp(file, FileStamp::of(st));
+    return true;
+}
+
+void DigestCollector::parseManifest()
+{
+    hashTypes.clear();
+
+    auto addHashType = [this](const std::string& name) {
+        auto md = EVP_get_digestbyname(name.c_str());
+        if (!md || std::ranges::any_of(hashTypes, [&name](const auto& h) {
+                return h.first == name;
+            }))
+        {
+            return;
+        }
+        hashTypes.emplace_back(name, md);
+    };
+
+    // Matches the lookups of the Signature class
+    std::istringstream lines(manifest);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        auto delimPos = line.find('=');
+        if (delimPos == std::string::npos)
+        {
+            continue;
+        }
+        std::string key = line.substr(0, delimPos);
+        std::string value = line.substr(delimPos + 1);
+
+        if (key == hashFunctionTag)
+        {
+            addHashType(value);
+        }
+        else if (key.find(hashTagSuffix) != std::string::npos)
+        {
+            // <hash type>,<algorithm>
+            addHashType(value.substr(0, value.find(',')));
+        }
+    }
+}
+
+DigestStore& DigestStore::instance()
+{
+    static DigestStore store;
+    return store;
+}
+
+void DigestStore::add(const fs::path& imageDir, ImageDigests digests)
+{
+    auto key = getKey(imageDir);
+    auto shared = std::make_shared<const ImageDigests>(std::move(digests));
+
+    std::lock_guard lock(mutex);
+    std::erase_if(images,
+                  [&key](const auto& entry) { return entry.first == key; });
+    if (images.size() >= maxImages)
+    {
+        images.erase(images.begin());
+    }
+    images.emplace_back(std::move(key), std::move(shared));
+}
+
+std::shared_ptr<const ImageDigests> DigestStore::find(const fs::path& imageDir)
+{
+    auto key = getKey(imageDir);
+
+    std::lock_guard lock(mutex);
+    auto it = std::ranges::find_if(
+        images, [&key](const auto& entry) { return entry.first == key; });
+    if (it == images.end())
+    {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void DigestStore::erase(const fs::path& imageDir)
+{
+    auto key = getKey(imageDir);
+
+    std::lock_guard lock(mutex);
+    std::erase_if(images,
+                  [&key](const auto& entry) { return entry.first == key; });
+}
+
+} // namespace image
+} // namespace software
+} // namespace phosphor
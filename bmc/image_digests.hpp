@@ -0,0 +1,202 @@
+#pragma once
+
+#include "tar_extract.hpp"
+
+#include <openssl/evp.h>
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace software
+{
+namespace image
+{
+
+namespace fs = std::filesystem;
+
+/** @struct FileStamp
+ *  @brief Identifies a version of a file. Writing to the file or replacing
+ *         it changes the stamp, the ctime can't be set back by anyone.
+ */
+struct FileStamp
+{
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    int64_t size = 0;
+    int64_t mtimeSec = 0;
+    int64_t mtimeNsec = 0;
+    int64_t ctimeSec = 0;
+    int64_t ctimeNsec = 0;
+
+    /** @brief Get the stamp of the file status st */
+    static FileStamp of(const struct stat& st)
+    {
+        return FileStamp{.dev = st.st_dev,
+                         .ino = st.st_ino,
+                         .size = st.st_size,
+                         .mtimeSec = st.st_mtim.tv_sec,
+                         .mtimeNsec = st.st_mtim.tv_nsec,
+                         .ctimeSec = st.st_ctim.tv_sec,
+                         .ctimeNsec = st.st_ctim.tv_nsec};
+    }
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+/** @class ImageDigests
+ *  @brief The digests of the files of an image, by file and hash type,
+ *         with the stamp each file had when it was hashed.
+ */
+class ImageDigests
+{
+  public:
+    using Digest = std::vector<uint8_t>;
+
+    /**
+     * @brief Add the digest of a file
+     * @param[in] file - The path of the file relative to the image directory
+     * @param[in] hashType - The hash function name, as in the MANIFEST
+     * @param[in] digest - The digest
+     */
+    void add(const std::string& file, const std::string& hashType,
+             Digest digest);
+
+    /**
+     * @brief Set the stamp of a file, once all its digests were added
+     * @param[in] file - The path of the file relative to the image directory
+     * @param[in] stamp - The stamp of the hashed file
+     */
+    void setStamp(const std::string& file, const FileStamp& stamp);
+
+    /**
+     * @brief Remove all the digests of a file
+     * @param[in] file - The path of the file relative to the image directory
+     */
+    void erase(const std::string& file);
+
+    /**
+     * @brief Find the digest of a file, if the file wasn't changed since
+     * @param[in] imageDir - The image directory
+     * @param[in] file - The path of the file relative to the image directory
+     * @param[in] hashType - The hash function name
+     * @return The digest, or nullptr if it wasn't computed or is outdated
+     */
+    const Digest* find(const fs::path& imageDir, const std::string& file,
+                       const std::string& hashType) const;
+
+  private:
+    /** @brief The digests by file and hash type */
+    std::map<std::pair<std::string, std::string>, Digest> digests;
+
+    /** @brief The stamps of the hashed files */
+    std::map<std::string, FileStamp> stamps;
+};
+
+/** @class DigestCollector
+ *  @brief Computes the digests of the files of an image while it is
+ *         extracted, using the hash types named in its MANIFEST.
+ *  @details Files preceding the MANIFEST in the archive are not hashed, the
+ *           signature verification reads them again instead.
+ */
+class DigestCollector : public phosphor::software::utils::TarObserver
+{
+  public:
+    /** @brief Constructs DigestCollector
+     *  @param[in] extractDir - The directory the image is extracted to
+     */
+    explicit DigestCollector(const fs::path& extractDir) :
+        extractDir(extractDir)
+    {}
+
+    void begin(const fs::path& path) override;
+    bool update(std::span<const uint8_t> data) override;
+    bool end() override;
+
+    /** @brief Take the digests of the extracted files */
+    ImageDigests takeDigests()
+    {
+        return std::move(digests);
+    }
+
+  private:
+    using EVP_MD_CTX_Ptr =
+        std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+
+    /** @brief Get the hash types from the contents of the MANIFEST */
+    void parseManifest();
+
+    const fs::path extractDir;
+
+    /** @brief Hash types named in the MANIFEST, with their digest */
+    std::vector<std::pair<std::string, const EVP_MD*>> hashTypes;
+
+    /** @brief The contexts of the file being extracted, by hash type */
+    std::vector<std::pair<std::string, EVP_MD_CTX_Ptr>> contexts;
+
+    /** @brief The file being extracted */
+    std::string file;
+
+    /** @brief The contents of the MANIFEST, while it is extracted */
+    std::string manifest;
+    bool inManifest = false;
+
+    ImageDigests digests;
+};
+
+/** @class DigestStore
+ *  @brief Keeps the digests of the images extracted by this process in
+ *         memory, until their signature is verified.
+ *  @details Nothing is written to disk: the digests can only be trusted as
+ *           long as nobody else could have written them. The store may be
+ *           used from several threads.
+ */
+class DigestStore
+{
+  public:
+    /** @brief The store shared by the extraction and the verification */
+    static DigestStore& instance();
+
+    /**
+     * @brief Keep the digests of an extracted image
+     * @param[in] imageDir - The image directory
+     * @param[in] digests - The digests of its files
+     */
+    void add(const fs::path& imageDir, ImageDigests digests);
+
+    /**
+     * @brief Get the digests of an image
+     * @param[in] imageDir - The image directory
+     * @return The digests, or null if none are kept
+     */
+    std::shared_ptr<const ImageDigests> find(const fs::path& imageDir);
+
+    /**
+     * @brief Drop the digests of an image
+     * @param[in] imageDir - The image directory
+     */
+    void erase(const fs::path& imageDir);
+
+  private:
+    /** @brief The number of images kept, the oldest is dropped first */
+    static constexpr size_t maxImages = 4;
+
+    std::mutex mutex;
+
+    /** @brief The digests by image directory, in the order they were added */
+    std::vector<std::pair<fs::path, std::shared_ptr<const ImageDigests>>>
+        images;
+};
+
+} // namespace image
+} // namespace software
+} // namespace phosphor
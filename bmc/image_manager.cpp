@@ -2,13 +2,16 @@
 
 #include "image_manager.hpp"
 
+#include "software_utils.hpp"
 #include "version.hpp"
 #include "watch.hpp"
 
+#include <fcntl.h>
+#include <openssl/evp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/eventfd.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <unistd.h>
 
 #include <phosphor-logging/elog-errors.hpp>
@@ -17,12 +20,19 @@
 #include <xyz/openbmc_project/Software/Image/error.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstring>
 #include <ctime>
+#include <exception>
 #include <filesystem>
+#include <memory>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <system_error>
+#include <tuple>
+#include <vector>
 
 namespace phosphor
 {
@@ -39,7 +49,9 @@ using ManifestFail = Software::image::ManifestFileFailure;
 using UnTarFail = Software::image::UnTarFailure;
 using InternalFail = Software::image::InternalFailure;
 using ImageFail = Software::image::ImageFailure;
+using namespace std::string_literals;
 namespace fs = std::filesystem;
+namespace softwareUtils = phosphor::software::utils;
 
 struct RemovablePath
 {
@@ -77,21 +89,436 @@ std::vector<std::string> getSoftwareObjects(sdbusplus::bus_t& bus)
     return paths;
 }
 
+/** @brief Hash the contents of a tarball
+ *  @return The SHA-256 digest in hex, empty if the tarball can't be read.
+ */
+std::string hashTarball(const std::string& tarFilePath)
+{
+    int fd = open(tarFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return {};
+    }
+
+    using EVP_MD_CTX_Ptr =
+        std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+    EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free);
+    bool result = ctx && EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr);
+
+    std::vector<uint8_t> buffer(64 * 1024);
+    while (result)
+    {
+        auto n = read(fd, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            result = n == 0;
+            break;
+        }
+        result = EVP_DigestUpdate(ctx.get(), buffer.data(), n);
+    }
+    close(fd);
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    unsigned int size = 0;
+    if (!result || !EVP_DigestFinal_ex(ctx.get(), digest.data(), &size))
+    {
+        return {};
+    }
+
+    std::string hex;
+    for (unsigned int i = 0; i < size; i++)
+    {
+        constexpr auto digits = "0123456789abcdef";
+        hex += digits[digest[i] >> 4];
+        hex += digits[digest[i] & 0xf];
+    }
+    return hex;
+}
+
 } // namespace
 
+Manager::Manager(sdbusplus::bus_t& bus, sd_event* loop) :
+    Manager(bus, loop,
+            {IMG_UPLOAD_DIR, OS_RELEASE_FILE,
+             []() {
+                 // The default bus is per thread, so this doesn't share the
+                 // connection of the event loop
+                 auto workerBus = sdbusplus::bus::new_default();
+                 return getSoftwareObjects(workerBus);
+             }})
+{}
+
+Manager::Manager(sdbusplus::bus_t& bus, sd_event* loop,
+                 Environment environment) :
+    bus(bus), environment(std::move(environment))
+{
+    updateFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (updateFd < 0)
+    {
+        auto error = errno;
+        throw std::runtime_error(
+            "eventfd failed, errno="s + std::strerror(error));
+    }
+
+    auto rc = sd_event_add_io(loop, &updateSource, updateFd, EPOLLIN,
+                              updateCallback, this);
+    if (0 > rc)
+    {
+        close(updateFd);
+        throw std::runtime_error(
+            "failed to add to event loop, rc="s + std::strerror(-rc));
+    }
+
+    for (size_t i = 0; i < maxWorkers; i++)
+    {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+Manager::~Manager()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    workers.clear();
+
+    // Nothing processes them after a restart, they would fill the upload
+    // dir
+    for (const auto& job : jobs)
+    {
+        std::error_code ec;
+        fs::remove(job.tarballFilePath, ec);
+    }
+
+    sd_event_source_unref(updateSource);
+    close(updateFd);
+}
+
 int Manager::processImage(const std::string& tarFilePath)
 {
+    auto upload = nextUpload++;
+    auto path = std::string{SOFTWARE_OBJPATH} + "/upload/" +
+                std::to_string(upload);
+    auto progress = std::make_unique<UploadProgress>(
+        bus, path.c_str(), UploadProgress::action::defer_emit);
+    progress->startTime(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count(),
+        true);
+    progress->status(UploadProgress::OperationStatus::InProgress, true);
+    progress->emit_object_added();
+    uploads.emplace(upload, std::move(progress));
+
+    if (pendingUploads >= maxQueued)
+    {
+        error("Too many images are being processed, rejecting {PATH}",
+              "PATH", tarFilePath);
+        report<ImageFailure>(
+            ImageFail::FAIL("Too many images are being processed"),
+            ImageFail::PATH(tarFilePath.c_str()));
+        std::error_code ec;
+        fs::remove(tarFilePath, ec);
+        finishUpload(upload, false);
+        return -1;
+    }
+
+    pendingUploads++;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back({upload, tarFilePath, std::to_string(randomGen())});
+    }
+    wakeWorkers.notify_one();
+    return 0;
+}
+
+const UploadProgress* Manager::getUploadProgress(uint64_t upload) const
+{
+    auto it = uploads.find(upload);
+    return it != uploads.end() ? it->second.get() : nullptr;
+}
+
+void Manager::work()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wakeWorkers.wait(guard, [this]() {
+                return stopping || !jobs.empty();
+            });
+            if (stopping)
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        post({job.upload, false, std::nullopt});
+
+        // An exception would terminate the process from a worker
+        std::optional<Image> image;
+        try
+        {
+            image = prepareImage(job);
+        }
+        catch (const std::exception& e)
+        {
+            error("Failed to process {PATH}: {ERROR}", "PATH",
+                  job.tarballFilePath, "ERROR", e);
+        }
+        post({job.upload, true, std::move(image)});
+    }
+}
+
+void Manager::post(Update&& update)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        updates.push_back(std::move(update));
+    }
+
+    // an eventfd write only fails on counter overflow
+    const uint64_t one = 1;
+    std::ignore = write(updateFd, &one, sizeof(one));
+}
+
+int Manager::updateCallback(sd_event_source* /* s */, int fd,
+                            uint32_t revents, void* userdata)
+{
+    if (!(revents & EPOLLIN))
+    {
+        return 0;
+    }
+
+    uint64_t count = 0;
+    std::ignore = read(fd, &count, sizeof(count));
+
+    auto manager = static_cast<Manager*>(userdata);
+    std::deque<Update> updates;
+    {
+        std::lock_guard<std::mutex> guard(manager->lock);
+        updates.swap(manager->updates);
+    }
+
+    for (auto& update : updates)
+    {
+        if (!update.done)
+        {
+            // Being extracted, InProgress at 0 means queued
+            auto it = manager->uploads.find(update.upload);
+            if (it != manager->uploads.end())
+            {
+                it->second->progress(10);
+            }
+            continue;
+        }
+
+        manager->pendingUploads--;
+        if (update.image && update.image->exists)
+        {
+            // Finishes along with the upload which extracts the image
+            manager->duplicates.emplace(update.upload, update.image->id);
+            continue;
+        }
+        if (update.image)
+        {
+            manager->createVersion(*update.image);
+        }
+        manager->finishUpload(update.upload, update.image.has_value());
+    }
+    manager->finishDuplicates();
+    return 0;
+}
+
+void Manager::finishDuplicates()
+{
+    for (auto it = duplicates.begin(); it != duplicates.end();)
+    {
+        auto& [upload, id] = *it;
+        bool created = versions.find(id) != versions.end();
+        if (!created)
+        {
+            // Still reserved while the image is extracted, released if that
+            // fails
+            std::lock_guard<std::mutex> guard(lock);
+            if (contentHashes.find(id) != contentHashes.end())
+            {
+                ++it;
+                continue;
+            }
+        }
+        finishUpload(upload, created);
+        it = duplicates.erase(it);
+    }
+}
+
+void Manager::finishUpload(uint64_t upload, bool success)
+{
+    auto it = uploads.find(upload);
+    if (it != uploads.end())
+    {
+        auto& progress = *it->second;
+        progress.completedTime(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+        if (success)
+        {
+            progress.progress(100);
+        }
+        progress.status(success ? UploadProgress::OperationStatus::Completed
+                                : UploadProgress::OperationStatus::Failed);
+    }
+
+    finishedUploads.push_back(upload);
+    while (finishedUploads.size() > maxFinished)
+    {
+        uploads.erase(finishedUploads.front());
+        finishedUploads.pop_front();
+    }
+}
+
+std::optional<Manager::Image> Manager::prepareImage(const Job& job)
+{
+    const auto& tarFilePath = job.tarballFilePath;
+
     std::error_code ec;
     if (!fs::is_regular_file(tarFilePath, ec))
     {
         error("Tarball {PATH} does not exist: {ERROR_MSG}", "PATH", tarFilePath,
               "ERROR_MSG", ec.message());
         report<ManifestFileFailure>(ManifestFail::PATH(tarFilePath.c_str()));
-        return -1;
+        return std::nullopt;
     }
     RemovablePath tarPathRemove(tarFilePath);
-    fs::path tmpDirPath(std::string{IMG_UPLOAD_DIR});
-    tmpDirPath /= "imageXXXXXX";
+
+    Image image;
+
+    // Identify the image by its contents, so that an image uploaded again
+    // isn't extracted and stored again
+    image.contentHash = hashTarball(tarFilePath);
+    if (image.contentHash.empty())
+    {
+        error("Failed to read {PATH}", "PATH", tarFilePath);
+        report<UnTarFailure>(UnTarFail::PATH(tarFilePath.c_str()));
+        return std::nullopt;
+    }
+    if (!reserveId(job, image))
+    {
+        return std::nullopt;
+    }
+    if (image.exists)
+    {
+        return image;
+    }
+
+    bool extracted = false;
+    try
+    {
+        extracted = extractImage(job, image);
+    }
+    catch (...)
+    {
+        releaseId(image.id);
+        throw;
+    }
+    if (!extracted)
+    {
+        releaseId(image.id);
+        return std::nullopt;
+    }
+    return image;
+}
+
+bool Manager::reserveId(const Job& job, Image& image)
+{
+    const auto& tarFilePath = job.tarballFilePath;
+
+    image.id = Version::getId(image.contentHash);
+    for (size_t attempt = 0; attempt < maxIdAttempts; attempt++)
+    {
+        if (attempt > 0)
+        {
+            // The ids are short, salt the one of a different image
+            image.id = Version::getId(image.contentHash + job.salt +
+                                      std::to_string(attempt));
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto same = std::find_if(
+                contentHashes.begin(), contentHashes.end(),
+                [&image](const auto& entry) {
+                    return entry.second == image.contentHash;
+                });
+            if (same != contentHashes.end())
+            {
+                info("Image {PATH} was already uploaded as {ID}", "PATH",
+                     tarFilePath, "ID", same->first);
+                image.id = same->first;
+                image.exists = true;
+                return true;
+            }
+            if (!contentHashes.emplace(image.id, image.contentHash).second)
+            {
+                continue;
+            }
+        }
+
+        // The id isn't used by this service, but another one may have a
+        // version with it, e.g. the item updater once an image is activated.
+        // It may be a different image, only the full hash tells.
+        auto objPath = std::string{SOFTWARE_OBJPATH} + '/' + image.id;
+        std::vector<std::string> allSoftwareObjs;
+        try
+        {
+            allSoftwareObjs = environment.softwareObjects();
+        }
+        catch (const sdbusplus::exception_t& e)
+        {
+            error("Failed to get the software objects: {ERROR}", "ERROR", e);
+            releaseId(image.id);
+            return false;
+        }
+
+        // A directory left behind by a previous run isn't overwritten either
+        std::error_code ec;
+        if (std::find(allSoftwareObjs.begin(), allSoftwareObjs.end(),
+                      objPath) == allSoftwareObjs.end() &&
+            !fs::exists(environment.uploadDir / image.id, ec) && !ec)
+        {
+            return true;
+        }
+        releaseId(image.id);
+    }
+
+    error("No free version id for {PATH}", "PATH", tarFilePath);
+    report<ImageFailure>(ImageFail::FAIL("No free version id"),
+                         ImageFail::PATH(tarFilePath.c_str()));
+    return false;
+}
+
+void Manager::releaseId(const std::string& id)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    contentHashes.erase(id);
+}
+
+bool Manager::extractImage(const Job& job, Image& image)
+{
+    const auto& tarFilePath = job.tarballFilePath;
+    std::error_code ec;
+
+    fs::path tmpDirPath = environment.uploadDir / "imageXXXXXX";
     auto tmpDir = tmpDirPath.string();
 
     // Create a tmp dir to extract tarball.
@@ -99,7 +526,7 @@ int Manager::processImage(const std::string& tarFilePath)
     {
         error("Error ({ERRNO}) occurred during mkdtemp", "ERRNO", errno);
         report<InternalFailure>(InternalFail::FAIL("mkdtemp"));
-        return -1;
+        return false;
     }
 
     tmpDirPath = tmpDir;
@@ -112,7 +539,7 @@ int Manager::processImage(const std::string& tarFilePath)
     if (rc < 0)
     {
         error("Error ({RC}) occurred during untar", "RC", rc);
-        return -1;
+        return false;
     }
 
     // Verify the manifest file
@@ -121,34 +548,37 @@ int Manager::processImage(const std::string& tarFilePath)
         error("No manifest file {PATH}: {ERROR_MSG}", "PATH", tarFilePath,
               "ERROR_MSG", ec.message());
         report<ManifestFileFailure>(ManifestFail::PATH(tarFilePath.c_str()));
-        return -1;
+        return false;
     }
 
+    // Parse the manifest once for all the keys below
+    auto manifest = Manifest::read(manifestPath);
+
     // Get version
-    auto version = Version::getValue(manifestPath.string(), "version");
-    if (version.empty())
+    image.version = manifest.getValue("version");
+    if (image.version.empty())
     {
         error("Unable to read version from manifest file {PATH}", "PATH",
               tarFilePath);
         report<ManifestFileFailure>(ManifestFail::PATH(tarFilePath.c_str()));
-        return -1;
+        return false;
     }
 
     // Get running machine name
-    std::string currMachine = Version::getBMCMachine(OS_RELEASE_FILE);
+    std::string currMachine =
+        Version::getBMCMachine(environment.osReleaseFile.string());
     if (currMachine.empty())
     {
-        auto path = OS_RELEASE_FILE;
+        auto path = environment.osReleaseFile.c_str();
         error("Failed to read machine name from osRelease: {PATH}", "PATH",
               path);
         report<ImageFailure>(ImageFail::FAIL("Failed to read machine name"),
                              ImageFail::PATH(path));
-        return -1;
+        return false;
     }
 
     // Get machine name for image to be upgraded
-    std::string machineStr =
-        Version::getValue(manifestPath.string(), "MachineName");
+    std::string machineStr = manifest.getValue("MachineName");
     if (!machineStr.empty())
     {
         if (machineStr != currMachine)
@@ -159,7 +589,7 @@ int Manager::processImage(const std::string& tarFilePath)
             report<ImageFailure>(
                 ImageFail::FAIL("Machine name does not match"),
                 ImageFail::PATH(manifestPath.string().c_str()));
-            return -1;
+            return false;
         }
     }
     else
@@ -171,13 +601,13 @@ int Manager::processImage(const std::string& tarFilePath)
     }
 
     // Get purpose
-    auto purposeString = Version::getValue(manifestPath.string(), "purpose");
+    auto purposeString = manifest.getValue("purpose");
     if (purposeString.empty())
     {
         error("Unable to read purpose from manifest file {PATH}", "PATH",
               tarFilePath);
         report<ManifestFileFailure>(ManifestFail::PATH(tarFilePath.c_str()));
-        return -1;
+        return false;
     }
 
     auto convertedPurpose =
@@ -190,54 +620,42 @@ int Manager::processImage(const std::string& tarFilePath)
             "Failed to convert manifest purpose ({PURPOSE}) to enum; setting to Unknown.",
             "PURPOSE", purposeString);
     }
-    auto purpose = convertedPurpose.value_or(Version::VersionPurpose::Unknown);
+    image.purpose =
+        convertedPurpose.value_or(Version::VersionPurpose::Unknown);
 
     // Get ExtendedVersion
-    std::string extendedVersion =
-        Version::getValue(manifestPath.string(), "ExtendedVersion");
+    image.extendedVersion = manifest.getValue("ExtendedVersion");
 
     // Get CompatibleNames
-    std::vector<std::string> compatibleNames =
-        Version::getRepeatedValues(manifestPath.string(), "CompatibleName");
-
-    // Compute id
-    auto salt = std::to_string(randomGen());
-    auto id = Version::getId(version + salt);
-
-    fs::path imageDirPath = std::string{IMG_UPLOAD_DIR};
-    imageDirPath /= id;
-
-    auto objPath = std::string{SOFTWARE_OBJPATH} + '/' + id;
-
-    // This service only manages the uploaded versions, and there could be
-    // active versions on D-Bus that is not managed by this service.
-    // So check D-Bus if there is an existing version.
-    auto allSoftwareObjs = getSoftwareObjects(bus);
-    auto it =
-        std::find(allSoftwareObjs.begin(), allSoftwareObjs.end(), objPath);
-    if (versions.find(id) == versions.end() && it == allSoftwareObjs.end())
-    {
-        // Rename the temp dir to image dir
-        fs::rename(tmpDirPath, imageDirPath, ec);
-        // Clear the path, so it does not attempt to remove a non-existing path
-        tmpDirToRemove.path.clear();
-
-        // Create Version object
-        auto versionPtr = std::make_unique<Version>(
-            bus, objPath, version, purpose, extendedVersion,
-            imageDirPath.string(), compatibleNames,
-            std::bind(&Manager::erase, this, std::placeholders::_1), id);
-        versionPtr->deleteObject =
-            std::make_unique<phosphor::software::manager::Delete>(
-                bus, objPath, *versionPtr);
-        versions.insert(std::make_pair(id, std::move(versionPtr)));
-    }
-    else
+    image.compatibleNames = manifest.getRepeatedValues("CompatibleName");
+
+    // Rename the temp dir to image dir
+    auto imageDirPath = environment.uploadDir / image.id;
+    fs::rename(tmpDirPath, imageDirPath, ec);
+    if (ec)
     {
-        info("Software Object with the same version ({VERSION}) already exists",
-             "VERSION", id);
+        error("Failed to move the image to {PATH}: {ERROR_MSG}", "PATH",
+              imageDirPath, "ERROR_MSG", ec.message());
+        return false;
     }
-    return 0;
+    // Clear the path, so it does not attempt to remove a non-existing path
+    tmpDirToRemove.path.clear();
+    image.dirPath = imageDirPath;
+    return true;
+}
+
+void Manager::createVersion(Image& image)
+{
+    // Create Version object
+    auto objPath = std::string{SOFTWARE_OBJPATH} + '/' + image.id;
+    auto versionPtr = std::make_unique<Version>(
+        bus, objPath, image.version, image.purpose, image.extendedVersion,
+        image.dirPath.string(), image.compatibleNames,
+        std::bind(&Manager::erase, this, std::placeholders::_1), image.id);
+    versionPtr->deleteObject =
+        std::make_unique<phosphor::software::manager::Delete>(
+            bus, objPath, *versionPtr);
+    versions.insert(std::make_pair(image.id, std::move(versionPtr)));
 }
 
 void Manager::erase(const std::string& entryId)
@@ -256,6 +674,9 @@ void Manager::erase(const std::string& entryId)
         fs::remove_all(imageDirPath, ec);
     }
     this->versions.erase(entryId);
+
+    std::lock_guard<std::mutex> guard(lock);
+    contentHashes.erase(entryId);
 }
 
 int Manager::unTar(const std::string& tarFilePath,
@@ -274,35 +695,23 @@ int Manager::unTar(const std::string& tarFilePath,
         return -1;
     }
 
-    info("Untaring {PATH} to {EXTRACTIONDIR}", "PATH", tarFilePath,
-         "EXTRACTIONDIR", extractDirPath);
-    int status = 0;
-    pid_t pid = fork();
+    info("Untaring {PATH}", "PATH", tarFilePath);
 
-    if (pid == 0)
+    // Writable to free the tarball while it is extracted, it is removed after
+    int fd = open(tarFilePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
     {
-        // child process
-        execl("/bin/tar", "tar", "-xf", tarFilePath.c_str(), "-C",
-              extractDirPath.c_str(), (char*)0);
-        // execl only returns on fail
-        error("Failed to execute untar on {PATH}", "PATH", tarFilePath);
+        error("Failed ({ERRNO}) to open {PATH}", "ERRNO", errno, "PATH",
+              tarFilePath);
         report<UnTarFailure>(UnTarFail::PATH(tarFilePath.c_str()));
         return -1;
     }
-    else if (pid > 0)
-    {
-        waitpid(pid, &status, 0);
-        if (WEXITSTATUS(status))
-        {
-            error("Failed ({STATUS}) to untar file {PATH}", "STATUS", status,
-                  "PATH", tarFilePath);
-            report<UnTarFailure>(UnTarFail::PATH(tarFilePath.c_str()));
-            return -1;
-        }
-    }
-    else
+
+    auto extracted = softwareUtils::unTar(fd, extractDirPath, true);
+    close(fd);
+    if (!extracted)
     {
-        error("fork() failed: {ERRNO}", "ERRNO", errno);
+        error("Failed to untar file {PATH}", "PATH", tarFilePath);
         report<UnTarFailure>(UnTarFail::PATH(tarFilePath.c_str()));
         return -1;
     }
@@ -1,11 +1,23 @@
 #pragma once
 #include "version.hpp"
 
+#include <systemd/sd-event.h>
+
 #include <sdbusplus/server.hpp>
+#include <xyz/openbmc_project/Common/Progress/server.hpp>
 
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace phosphor
 {
@@ -14,29 +26,89 @@ namespace software
 namespace manager
 {
 
+using UploadProgress = sdbusplus::server::object_t<
+    sdbusplus::server::xyz::openbmc_project::common::Progress>;
+
 /** @class Manager
  *  @brief Contains a map of Version dbus objects.
  *  @details The software image manager class that contains the Version dbus
- *           objects and their version ids.
+ *           objects and their version ids. The uploaded tarballs are queued
+ *           and extracted by a pool of worker threads, the Version objects
+ *           are created back on the event loop.
  */
 class Manager
 {
   public:
+    /** @brief The number of tarballs extracted at the same time */
+    static constexpr size_t maxWorkers = 2;
+
+    /** @brief The number of tarballs queued or being extracted, after which
+     *         uploads are rejected rather than filling the upload dir */
+    static constexpr size_t maxQueued = 8;
+
+    /** @brief The number of processed uploads kept on D-Bus */
+    static constexpr size_t maxFinished = 8;
+
+    /** @brief The number of ids tried for an image, the first is unsalted */
+    static constexpr size_t maxIdAttempts = 8;
+
+    /** @brief What the manager uses besides its own D-Bus objects */
+    struct Environment
+    {
+        /** @brief Where the images are extracted to */
+        fs::path uploadDir;
+
+        /** @brief The os-release file of the running BMC */
+        fs::path osReleaseFile;
+
+        /** @brief Get the paths of the software objects on D-Bus. Called
+         *         from the workers. */
+        std::function<std::vector<std::string>()> softwareObjects;
+    };
+
     /** @brief Constructs Manager Class
      *
      * @param[in] bus - The Dbus bus object
+     * @param[in] loop - The event loop the results are handled on
      */
-    explicit Manager(sdbusplus::bus_t& bus) : bus(bus) {};
+    Manager(sdbusplus::bus_t& bus, sd_event* loop);
+
+    /** @brief Constructs Manager Class
+     *
+     * @param[in] bus - The Dbus bus object
+     * @param[in] loop - The event loop the results are handled on
+     * @param[in] environment - Replaces the configured paths and the
+     *                          object mapper
+     */
+    Manager(sdbusplus::bus_t& bus, sd_event* loop, Environment environment);
+
+    Manager(const Manager&) = delete;
+    Manager& operator=(const Manager&) = delete;
+    Manager(Manager&&) = delete;
+    Manager& operator=(Manager&&) = delete;
+
+    /** @brief Stops the workers, the queued tarballs are removed */
+    ~Manager();
 
     /**
-     * @brief Verify and untar the tarball. Verify the manifest file.
-     *        Create and populate the version and filepath interfaces.
+     * @brief Queue a tarball to be verified and extracted. Its state is
+     *        published as a Progress object under the upload path, and
+     *        the version and filepath interfaces are created once it is
+     *        processed. The uploads are numbered in order, from 0.
      *
      * @param[in]  tarballFilePath - Tarball path.
-     * @param[out] result          - 0 if successful.
+     * @param[out] result          - 0 if queued.
      */
     int processImage(const std::string& tarballFilePath);
 
+    /**
+     * @brief Get the progress of an upload
+     *
+     * @param[in] upload - The number of the upload
+     * @return The progress, nullptr if the upload is unknown or was pruned
+     */
+    const UploadProgress* getUploadProgress(uint64_t upload) const;
+
     /**
      * @brief Erase specified entry d-bus object
      *        and deletes the image file.
@@ -46,19 +118,127 @@ class Manager
     void erase(const std::string& entryId);
 
   private:
+    /** @brief An extracted image, ready for its Version object */
+    struct Image
+    {
+        fs::path dirPath;
+        std::string id;
+        std::string contentHash;
+        std::string version;
+        Version::VersionPurpose purpose = Version::VersionPurpose::Unknown;
+        std::string extendedVersion;
+        std::vector<std::string> compatibleNames;
+
+        /** @brief Whether this service already has the image, under id */
+        bool exists = false;
+    };
+
+    /** @brief A tarball for the workers */
+    struct Job
+    {
+        uint64_t upload;
+        std::string tarballFilePath;
+
+        /** @brief Salts the id when it collides with another image's */
+        std::string salt;
+    };
+
+    /** @brief A change of the state of an upload, from the workers */
+    struct Update
+    {
+        uint64_t upload;
+        bool done;
+        std::optional<Image> image;
+    };
+
+    /**
+     * @brief Verify and untar the tarball, and verify the manifest file.
+     *        Runs on the workers, the tarball is removed.
+     * @details The id is derived from the hash of the tarball. An image
+     *          which was already uploaded isn't extracted, exists is set.
+     *
+     * @param[in] job - The tarball.
+     * @return The image, nullopt if it is invalid.
+     */
+    std::optional<Image> prepareImage(const Job& job);
+
+    /**
+     * @brief Reserve the id of an image in contentHashes.
+     * @details Only an image with the same hash is a duplicate, exists is
+     *          set and id is the one of the first upload. The id is salted
+     *          while it is used by another image of this service, by a
+     *          software object on D-Bus or by a directory in the upload dir.
+     *
+     * @param[in] job - The tarball.
+     * @param[in,out] image - The image, with its contentHash.
+     * @return false if no id could be reserved.
+     */
+    bool reserveId(const Job& job, Image& image);
+
+    /** @brief Release the id of an image which wasn't extracted */
+    void releaseId(const std::string& id);
+
+    /**
+     * @brief Extract the tarball to the upload dir under the reserved id,
+     *        and read the manifest of the image.
+     *
+     * @param[in] job - The tarball.
+     * @param[in,out] image - The image, with its id.
+     * @return false if the image is invalid.
+     */
+    bool extractImage(const Job& job, Image& image);
+
+    /** @brief Create the version and filepath interfaces of an image */
+    void createVersion(Image& image);
+
+    /** @brief The loop of the worker threads */
+    void work();
+
+    /** @brief Queue an update for the event loop */
+    void post(Update&& update);
+
+    /** @brief sd-event callback, applies the updates of the workers */
+    static int updateCallback(sd_event_source* s, int fd, uint32_t revents,
+                              void* userdata);
+
+    /** @brief Publish an upload which finished, pruning old ones */
+    void finishUpload(uint64_t upload, bool success);
+
+    /** @brief Finish the duplicate uploads once their image was processed */
+    void finishDuplicates();
+
     /** @brief Persistent map of Version dbus objects and their
      * version id */
     std::map<std::string, std::unique_ptr<Version>> versions;
 
+    /** @brief The progress of the uploads, by number */
+    std::map<uint64_t, std::unique_ptr<UploadProgress>> uploads;
+
+    /** @brief The finished uploads, oldest first */
+    std::deque<uint64_t> finishedUploads;
+
+    /** @brief The uploads of an image which was already uploaded, with the
+     *         id of its version */
+    std::map<uint64_t, std::string> duplicates;
+
+    /** @brief The number of the next upload */
+    uint64_t nextUpload = 0;
+
+    /** @brief The number of uploads queued or being extracted */
+    size_t pendingUploads = 0;
+
     /** @brief Persistent sdbusplus DBus bus connection. */
     sdbusplus::bus_t& bus;
 
-    /** @brief The random generator to get the version salt */
+    /** @brief What the manager uses besides its own D-Bus objects */
+    const Environment environment;
+
+    /** @brief The random generator to get the id salt */
     std::mt19937 randomGen{static_cast<unsigned>(
         std::chrono::system_clock::now().time_since_epoch().count())};
 
     /**
-     * @brief Untar the tarball.
+     * @brief Untar the tarball, which is consumed by the extraction.
      *
      * @param[in]  tarballFilePath - Tarball path.
      * @param[in]  extractDirPath  - Dir path to extract tarball ball to.
@@ -66,6 +246,34 @@ class Manager
      */
     static int unTar(const std::string& tarballFilePath,
                      const std::string& extractDirPath);
+
+    /** @brief The eventfd the workers signal updates with */
+    int updateFd = -1;
+
+    /** @brief The event source of updateFd */
+    sd_event_source* updateSource = nullptr;
+
+    /** @brief Guards the members below, shared with the workers */
+    std::mutex lock;
+
+    /** @brief Wakes the workers up */
+    std::condition_variable wakeWorkers;
+
+    /** @brief The tarballs to extract */
+    std::deque<Job> jobs;
+
+    /** @brief The updates for the event loop */
+    std::deque<Update> updates;
+
+    /** @brief The content hashes of the versions, and of the images being
+     *         extracted, by id */
+    std::map<std::string, std::string> contentHashes;
+
+    /** @brief Set when the workers must exit */
+    bool stopping = false;
+
+    /** @brief The worker threads, joined before the rest is destroyed */
+    std::vector<std::jthread> workers;
 };
 
 } // namespace manager
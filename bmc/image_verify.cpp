@@ -15,10 +15,15 @@
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <fstream>
+#include <cerrno>
+#include <exception>
+#include <mutex>
 #include <set>
 #include <system_error>
+#include <thread>
 
 namespace phosphor
 {
@@ -41,17 +46,18 @@ Signature::Signature(const fs::path& imageDirPath,
                      const fs::path& signedConfPath) :
     imageDirPath(imageDirPath), signedConfPath(signedConfPath)
 {
-    fs::path file(imageDirPath / MANIFEST_FILE_NAME);
+    auto manifest = Manifest::read(imageDirPath / MANIFEST_FILE_NAME);
 
-    keyType = Version::getValue(file, keyTypeTag);
-    hashType = Version::getValue(file, hashFunctionTag);
+    keyType = manifest.getValue(keyTypeTag);
+    hashType = manifest.getValue(hashFunctionTag);
 
     // Get purpose
-    auto purposeString = Version::getValue(file, "purpose");
+    auto purposeString = manifest.getValue("purpose");
     auto convertedPurpose =
         sdbusplus::message::convert_from_string<VersionPurpose>(purposeString);
     purpose = convertedPurpose.value_or(Version::VersionPurpose::Unknown);
-    pqAlgorithm = getPQAlgorithmFromManifest();
+    pqAlgorithm = getPQAlgorithmFromManifest(manifest);
+    digests = DigestStore::instance().find(imageDirPath);
 }
 
 AvailableKeyTypes Signature::getAvailableKeyTypesFromSystem() const
@@ -98,30 +104,12 @@ inline KeyHashPathPair Signature::getKeyHashFileNames(const Key_t& key) const
     return std::make_pair(std::move(hashpath), std::move(keyPath));
 }
 
-std::optional<Signature::PQAlgorithm> Signature::getPQAlgorithmFromManifest()
-    const
+std::optional<Signature::PQAlgorithm> Signature::getPQAlgorithmFromManifest(
+    const Manifest& manifest)
 {
-    fs::path manifestFile(imageDirPath / MANIFEST_FILE_NAME);
-
-    std::ifstream efile(manifestFile);
-    if (!efile.good())
-    {
-        return std::nullopt;
-    }
-
-    std::string line;
-    while (std::getline(efile, line))
+    for (const auto& [key, value] : manifest.getEntries())
     {
-        // Look for lines ending with "_Hash_Type"
-        auto delimPos = line.find('=');
-        if (delimPos == std::string::npos)
-        {
-            continue;
-        }
-
-        std::string key = line.substr(0, delimPos);
-        std::string value = line.substr(delimPos + 1);
-
+        // Look for keys containing "_Hash_Type"
         if (key.find(hashTagSuffix) == std::string::npos)
         {
             continue;
@@ -153,7 +141,8 @@ bool Signature::verifyFullImage()
         return ret;
     }
 
-    std::vector<std::string> fullImages = {
+    // The full image is the concatenation of these, as far as they exist
+    std::vector<fs::path> fullImages = {
         fs::path(imageDirPath) / "image-bmc.sig",
         fs::path(imageDirPath) / "image-hostfw.sig",
         fs::path(imageDirPath) / "image-kernel.sig",
@@ -163,13 +152,6 @@ bool Signature::verifyFullImage()
         fs::path(imageDirPath) / "MANIFEST.sig",
         fs::path(imageDirPath) / "publickey.sig"};
 
-    // Merge files
-    std::string tmpFullFile = "/tmp/image-full";
-    utils::mergeFiles(fullImages, tmpFullFile);
-
-    // Validate the full image files
-    fs::path pkeyFullFile(tmpFullFile);
-
     std::string imageFullSig = "image-full.sig";
     fs::path pkeyFullFileSig(imageDirPath / imageFullSig);
     pkeyFullFileSig.replace_extension(SIGNATURE_FILE_EXT);
@@ -177,7 +159,8 @@ bool Signature::verifyFullImage()
     // image specific publickey file name.
     fs::path publicKeyFile(imageDirPath / PUBLICKEY_FILE_NAME);
 
-    ret = verifyFile(pkeyFullFile, pkeyFullFileSig, publicKeyFile, hashType);
+    ret = verifyConcatenation(fullImages, pkeyFullFileSig, publicKeyFile,
+                              hashType);
 
     if (ret)
     {
@@ -191,11 +174,11 @@ bool Signature::verifyFullImage()
                 fs::path algoFullImageSig = algoDir / imageFullSig;
                 fs::path algoPublicKeyFile = algoDir / PUBLICKEY_FILE_NAME;
 
-                if (fs::exists(algoFullImageSig, ec2) &&
-                    fs::exists(tmpFullFile, ec2))
+                if (fs::exists(algoFullImageSig, ec2))
                 {
-                    ret = verifyFile(tmpFullFile, algoFullImageSig,
-                                     algoPublicKeyFile, pqAlgorithm->hashType);
+                    ret = verifyConcatenation(fullImages, algoFullImageSig,
+                                              algoPublicKeyFile,
+                                              pqAlgorithm->hashType);
                     if (!ret)
                     {
                         error(
@@ -206,9 +189,6 @@ bool Signature::verifyFullImage()
             }
         }
     }
-
-    std::error_code ec;
-    fs::remove(tmpFullFile, ec);
 #endif
 
     return ret;
@@ -244,27 +224,31 @@ bool Signature::verify()
 
         if (!valid)
         {
-            // Validate bmcImages
+            // Validate bmcImages, along with their post-quantum signatures
             imageUpdateList.clear();
             imageUpdateList.assign(bmcImages.begin(), bmcImages.end());
-            valid =
-                checkAndVerifyImage(imageDirPath, publicKeyFile,
-                                    imageUpdateList, bmcFilesFound, hashType);
 
-            if (bmcFilesFound && valid)
+            std::vector<VerifyJob> jobs;
+            valid = addImageJobs(imageDirPath, publicKeyFile, imageUpdateList,
+                                 bmcFilesFound, jobs, hashType);
+
+            if (bmcFilesFound && valid && !addPQJobs(bmcImages, jobs))
             {
-                if (!verifyPQSignatures(bmcImages))
-                {
-                    error("PQ image signature verification failed");
-                    return false;
-                }
+                error("PQ image signature verification failed");
+                return false;
+            }
+
+            valid = verifyFiles(jobs) && valid;
+            if (bmcFilesFound && !valid)
+            {
+                return false;
             }
         }
 
         // Validate the optional image files.
         auto optionalImages = getOptionalImages();
         bool optionalFilesFound = false;
-        bool optionalImagesValid = false;
+        std::vector<VerifyJob> optionalJobs;
         for (const auto& optionalImage : optionalImages)
         {
             // Build Image File name
@@ -272,53 +256,39 @@ bool Signature::verify()
             file /= optionalImage;
 
             std::error_code ec;
-            if (fs::exists(file, ec))
+            if (!fs::exists(file, ec))
             {
-                optionalFilesFound = true;
-                // Build Signature File name
-                fs::path sigFile(file);
-                sigFile += SIGNATURE_FILE_EXT;
-
-                // Verify the signature.
-                optionalImagesValid =
-                    verifyFile(file, sigFile, publicKeyFile, hashType);
-                if (!optionalImagesValid)
-                {
-                    error("Image file Signature Validation failed on {IMAGE}",
-                          "IMAGE", optionalImage);
-                    return false;
-                }
+                continue;
+            }
+            optionalFilesFound = true;
 
-                if (pqAlgorithm.has_value())
-                {
-                    fs::path algoDir(imageDirPath / pqAlgorithm->name);
+            // Build Signature File name
+            fs::path sigFile(file);
+            sigFile += SIGNATURE_FILE_EXT;
+            optionalJobs.push_back({file, sigFile, publicKeyFile, hashType});
 
-                    if (fs::exists(algoDir, ec))
-                    {
-                        fs::path algoPublicKeyFile =
-                            algoDir / PUBLICKEY_FILE_NAME;
-                        fs::path algoSigFile =
-                            algoDir / (optionalImage + ".sig");
+            if (pqAlgorithm.has_value())
+            {
+                fs::path algoDir(imageDirPath / pqAlgorithm->name);
+                fs::path algoSigFile = algoDir / (optionalImage + ".sig");
 
-                        if (fs::exists(algoSigFile, ec))
-                        {
-                            bool algoValid =
-                                verifyFile(file, algoSigFile, algoPublicKeyFile,
-                                           pqAlgorithm->hashType);
-                            if (!algoValid)
-                            {
-                                error(
-                                    "Signature validation failed for optional image {IMAGE} with {ALGO}",
-                                    "IMAGE", optionalImage, "ALGO",
-                                    pqAlgorithm->name);
-                                return false;
-                            }
-                        }
-                    }
+                if (fs::exists(algoDir, ec) && fs::exists(algoSigFile, ec))
+                {
+                    optionalJobs.push_back({file, algoSigFile,
+                                            algoDir / PUBLICKEY_FILE_NAME,
+                                            pqAlgorithm->hashType});
                 }
             }
         }
 
+        // Verify the signatures.
+        bool optionalImagesValid =
+            optionalFilesFound && verifyFiles(optionalJobs);
+        if (optionalFilesFound && !optionalImagesValid)
+        {
+            return false;
+        }
+
         if (!verifyFullImage())
         {
             error("Image full file Signature Validation failed");
@@ -348,6 +318,99 @@ bool Signature::verify()
     }
 }
 
+bool Signature::verifyMetadata()
+{
+    // The post-quantum signatures are verified over the data itself
+    if (pqAlgorithm.has_value())
+    {
+        info("The {ALGO} signatures need the image files", "ALGO",
+             pqAlgorithm->name);
+        return false;
+    }
+
+    try
+    {
+        if (!systemLevelVerify())
+        {
+            error("System level Signature Validation failed");
+            return false;
+        }
+
+        // RSA and ECDSA sign the digest, other algorithms need the data
+        auto publicKey = createPublicKey(imageDirPath / PUBLICKEY_FILE_NAME);
+        const auto keyId =
+            publicKey ? EVP_PKEY_get_base_id(publicKey.get()) : EVP_PKEY_NONE;
+        if (keyId != EVP_PKEY_RSA && keyId != EVP_PKEY_RSA_PSS &&
+            keyId != EVP_PKEY_EC)
+        {
+            info("The image public key can't verify a digest");
+            return false;
+        }
+
+        if (!verifyFullImage())
+        {
+            error("Image full file Signature Validation failed");
+            return false;
+        }
+        return true;
+    }
+    catch (const InternalFailure& e)
+    {
+        return false;
+    }
+    catch (const std::exception& e)
+    {
+        error("Error during processing: {ERROR}", "ERROR", e);
+        return false;
+    }
+}
+
+bool Signature::verifyFileDigest(const std::string& file,
+                                 const ImageDigests::Digest& digest) const
+{
+    fs::path sigFile(imageDirPath / file);
+    sigFile += SIGNATURE_FILE_EXT;
+
+    try
+    {
+        std::error_code ec;
+        if (!fs::exists(sigFile, ec))
+        {
+            error("Failed to find the signature file {PATH}", "PATH",
+                  sigFile);
+            return false;
+        }
+
+        auto publicKey = createPublicKey(imageDirPath / PUBLICKEY_FILE_NAME);
+        auto hashStruct = CryptoCache::instance().getDigest(hashType);
+        if (!publicKey || !hashStruct)
+        {
+            error("Unable to verify {PATH} with {HASH}", "PATH", sigFile,
+                  "HASH", hashType);
+            return false;
+        }
+
+        auto result =
+            verifyDigest(publicKey.get(), hashStruct, digest, sigFile);
+        if (result <= 0)
+        {
+            error("EVP_PKEY_verify:Signature validation failed on {PATH}",
+                  "PATH", sigFile);
+            return false;
+        }
+        return true;
+    }
+    catch (const InternalFailure& e)
+    {
+        return false;
+    }
+    catch (const std::exception& e)
+    {
+        error("Error during processing: {ERROR}", "ERROR", e);
+        return false;
+    }
+}
+
 bool Signature::systemLevelVerify()
 {
     // Get available key types from the system.
@@ -458,7 +521,7 @@ bool Signature::systemLevelVerify()
 
 bool Signature::verifyFile(const fs::path& file, const fs::path& sigFile,
                            const fs::path& publicKey,
-                           const std::string& hashFunc)
+                           const std::string& hashFunc) const
 {
     // Check existence of the files in the system.
     std::error_code ec;
@@ -472,6 +535,95 @@ bool Signature::verifyFile(const fs::path& file, const fs::path& sigFile,
         elog<InternalFailure>();
     }
 
+    // RSA and ECDSA sign the digest, so the one computed while extracting
+    // the image can be verified directly. Other algorithms need the data.
+    const ImageDigests::Digest* digest = nullptr;
+    if (digests)
+    {
+        digest = digests->find(
+            imageDirPath, file.lexically_relative(imageDirPath).generic_string(),
+            hashFunc);
+    }
+    if (!digest)
+    {
+        return verifyConcatenation({file}, sigFile, publicKey, hashFunc);
+    }
+
+    auto publicKeyPtr = createPublicKey(publicKey);
+    if (!publicKeyPtr)
+    {
+        error("Failed to create public key from {PATH}", "PATH", publicKey);
+        elog<InternalFailure>();
+    }
+
+    const auto keyId = EVP_PKEY_get_base_id(publicKeyPtr.get());
+    if (keyId != EVP_PKEY_RSA && keyId != EVP_PKEY_RSA_PSS &&
+        keyId != EVP_PKEY_EC)
+    {
+        return verifyConcatenation({file}, sigFile, publicKey, hashFunc);
+    }
+
+    auto hashStruct = CryptoCache::instance().getDigest(hashFunc);
+    if (!hashStruct)
+    {
+        error("EVP_get_digestbynam: Unknown message digest: {HASH}", "HASH",
+              hashFunc);
+        elog<InternalFailure>();
+    }
+
+    auto result = verifyDigest(publicKeyPtr.get(), hashStruct, *digest,
+                               sigFile);
+    if (result < 0)
+    {
+        error("Error ({RC}) occurred during EVP_PKEY_verify", "RC",
+              ERR_get_error());
+        elog<InternalFailure>();
+    }
+
+    if (result == 0)
+    {
+        error("EVP_PKEY_verify:Signature validation failed on {PATH}", "PATH",
+              sigFile);
+        return false;
+    }
+    return true;
+}
+
+int Signature::verifyDigest(EVP_PKEY* publicKey, const EVP_MD* hash,
+                            const ImageDigests::Digest& digest,
+                            const fs::path& sigFile)
+{
+    EVP_PKEY_CTX_Ptr ctx(EVP_PKEY_CTX_new(publicKey, nullptr),
+                         ::EVP_PKEY_CTX_free);
+    if (!ctx || EVP_PKEY_verify_init(ctx.get()) <= 0 ||
+        EVP_PKEY_CTX_set_signature_md(ctx.get(), hash) <= 0)
+    {
+        error("Error ({RC}) occurred during EVP_PKEY_verify_init", "RC",
+              ERR_get_error());
+        elog<InternalFailure>();
+    }
+
+    std::error_code ec;
+    auto size = fs::file_size(sigFile, ec);
+    auto signature = mapFile(sigFile, size);
+
+    return EVP_PKEY_verify(ctx.get(),
+                           reinterpret_cast<unsigned char*>(signature()), size,
+                           digest.data(), digest.size());
+}
+
+bool Signature::verifyConcatenation(const std::vector<fs::path>& files,
+                                    const fs::path& sigFile,
+                                    const fs::path& publicKey,
+                                    const std::string& hashFunc)
+{
+    std::error_code ec;
+    if (!fs::exists(sigFile, ec))
+    {
+        error("Failed to find the signature file {PATH}", "PATH", sigFile);
+        elog<InternalFailure>();
+    }
+
     auto publicKeyPtr = createPublicKey(publicKey);
     if (!publicKeyPtr)
     {
@@ -482,11 +634,8 @@ bool Signature::verifyFile(const fs::path& file, const fs::path& sigFile,
     // Initializes a digest context.
     EVP_MD_CTX_Ptr verifyCtx(EVP_MD_CTX_new(), ::EVP_MD_CTX_free);
 
-    // Adds all digest algorithms to the internal table
-    OpenSSL_add_all_digests();
-
     // Create Hash structure.
-    auto hashStruct = EVP_get_digestbyname(hashFunc.c_str());
+    auto hashStruct = CryptoCache::instance().getDigest(hashFunc);
     if (!hashStruct)
     {
         error("EVP_get_digestbynam: Unknown message digest: {HASH}", "HASH",
@@ -504,20 +653,27 @@ bool Signature::verifyFile(const fs::path& file, const fs::path& sigFile,
         elog<InternalFailure>();
     }
 
-    // Hash the data file and update the verification context
-    auto size = fs::file_size(file, ec);
-    auto dataPtr = mapFile(file, size);
-
-    result = EVP_DigestVerifyUpdate(verifyCtx.get(), dataPtr(), size);
-    if (result <= 0)
+    // Hash the data files one after the other, as if they were merged
+    for (const auto& file : files)
     {
-        error("Error ({RC}) occurred during EVP_DigestVerifyUpdate", "RC",
-              ERR_get_error());
-        elog<InternalFailure>();
+        auto size = fs::file_size(file, ec);
+        if (ec || size == 0)
+        {
+            continue;
+        }
+        auto dataPtr = mapFile(file, size);
+
+        result = EVP_DigestVerifyUpdate(verifyCtx.get(), dataPtr(), size);
+        if (result <= 0)
+        {
+            error("Error ({RC}) occurred during EVP_DigestVerifyUpdate", "RC",
+                  ERR_get_error());
+            elog<InternalFailure>();
+        }
     }
 
     // Verify the data with signature.
-    size = fs::file_size(sigFile, ec);
+    auto size = fs::file_size(sigFile, ec);
     auto signature = mapFile(sigFile, size);
 
     result = EVP_DigestVerifyFinal(
@@ -542,38 +698,118 @@ bool Signature::verifyFile(const fs::path& file, const fs::path& sigFile,
 
 inline EVP_PKEY_Ptr Signature::createPublicKey(const fs::path& publicKey)
 {
-    std::error_code ec;
-    auto size = fs::file_size(publicKey, ec);
+    return CryptoCache::instance().getPublicKey(publicKey);
+}
+
+CustomMap Signature::mapFile(const fs::path& path, size_t size)
+{
+    CustomFd fd(open(path.c_str(), O_RDONLY));
+
+    return CustomMap(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd(), 0),
+                     size);
+}
+
+CryptoCache& CryptoCache::instance()
+{
+    static CryptoCache cache;
+    return cache;
+}
+
+EVP_PKEY_Ptr CryptoCache::getPublicKey(const fs::path& path)
+{
+    auto share = [](EVP_PKEY* key) {
+        EVP_PKEY_up_ref(key);
+        return EVP_PKEY_Ptr(key, &::EVP_PKEY_free);
+    };
+
+    std::lock_guard lock(mutex);
+
+    struct stat st{};
+    auto it = keys.find(path);
+    if (it != keys.end() && stat(path.c_str(), &st) == 0 &&
+        it->second.stamp == FileStamp::of(st))
+    {
+        it->second.lastUse = ++useCount;
+        return share(it->second.key.get());
+    }
 
-    // Read public key file
-    auto data = mapFile(publicKey, size);
+    // The stamp comes from the descriptor the key is read from, so a file
+    // replaced in between is parsed again on the next lookup
+    CustomFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd() < 0 || fstat(fd(), &st) != 0 || !S_ISREG(st.st_mode) ||
+        st.st_size > maxKeySize)
+    {
+        return {nullptr, &::EVP_PKEY_free};
+    }
+
+    std::string data(st.st_size, '\0');
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        auto rc = read(fd(), data.data() + offset, data.size() - offset);
+        if (rc < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            return {nullptr, &::EVP_PKEY_free};
+        }
+        offset += rc;
+    }
 
-    BIO_MEM_Ptr keyBio(BIO_new_mem_buf(data(), -1), &::BIO_free);
+    BIO_MEM_Ptr keyBio(BIO_new_mem_buf(data.data(), data.size()), &::BIO_free);
     if (keyBio.get() == nullptr)
     {
         error("Failed to create new BIO Memory buffer");
         elog<InternalFailure>();
     }
 
-    return {PEM_read_bio_PUBKEY(keyBio.get(), nullptr, nullptr, nullptr),
-            &::EVP_PKEY_free};
+    EVP_PKEY_Ptr key(
+        PEM_read_bio_PUBKEY(keyBio.get(), nullptr, nullptr, nullptr),
+        &::EVP_PKEY_free);
+    if (!key)
+    {
+        keys.erase(path);
+        return key;
+    }
+
+    if (it == keys.end() && keys.size() >= maxKeys)
+    {
+        keys.erase(std::ranges::min_element(
+            keys, {}, [](const auto& entry) { return entry.second.lastUse; }));
+    }
+    auto entry = keys.insert_or_assign(
+        path, KeyEntry{FileStamp::of(st), std::move(key), ++useCount});
+    return share(entry.first->second.key.get());
 }
 
-CustomMap Signature::mapFile(const fs::path& path, size_t size)
+const EVP_MD* CryptoCache::getDigest(const std::string& name)
 {
-    CustomFd fd(open(path.c_str(), O_RDONLY));
+    std::lock_guard lock(mutex);
 
-    return CustomMap(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd(), 0),
-                     size);
+    auto it = digests.find(name);
+    if (it != digests.end())
+    {
+        return it->second.get();
+    }
+
+    // An explicitly fetched digest saves the implicit fetch of every
+    // EVP_DigestVerifyInit
+    EVP_MD_Ptr md(EVP_MD_fetch(nullptr, name.c_str(), nullptr), &::EVP_MD_free);
+    if (!md)
+    {
+        return EVP_get_digestbyname(name.c_str());
+    }
+    return digests.emplace(name, std::move(md)).first->second.get();
 }
 
-bool Signature::checkAndVerifyImage(
+bool Signature::addImageJobs(
     const std::string& filePath, const std::string& publicKeyPath,
     const std::vector<std::string>& imageList, bool& fileFound,
-    const std::string& hashType, const std::string& sigSubDir)
+    std::vector<VerifyJob>& jobs, const std::string& hashType,
+    const std::string& sigSubDir) const
 {
-    bool valid = true;
-
     fileFound = false;
     for (auto& bmcImage : imageList)
     {
@@ -583,8 +819,7 @@ bool Signature::checkAndVerifyImage(
         std::error_code ec;
         if (!fs::exists(file, ec))
         {
-            valid = false;
-            break;
+            return false;
         }
         fileFound = true;
 
@@ -602,20 +837,87 @@ bool Signature::checkAndVerifyImage(
                       (bmcImage + SIGNATURE_FILE_EXT);
         }
 
-        // Verify the signature.
-        valid = verifyFile(file, sigFile, publicKeyPath, hashType);
-        if (!valid)
+        jobs.push_back({file, sigFile, publicKeyPath, hashType});
+    }
+
+    return true;
+}
+
+bool Signature::checkAndVerifyImage(
+    const std::string& filePath, const std::string& publicKeyPath,
+    const std::vector<std::string>& imageList, bool& fileFound,
+    const std::string& hashType, const std::string& sigSubDir) const
+{
+    std::vector<VerifyJob> jobs;
+    bool allFound = addImageJobs(filePath, publicKeyPath, imageList, fileFound,
+                                 jobs, hashType, sigSubDir);
+
+    // The files found are verified even if one is missing, as before
+    return verifyFiles(jobs) && allFound;
+}
+
+bool Signature::verifyFiles(const std::vector<VerifyJob>& jobs) const
+{
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    std::mutex exceptionLock;
+    std::exception_ptr exception;
+
+    auto worker = [&]() {
+        // No new verification is started once one failed
+        while (!failed)
         {
-            error("Image file Signature Validation failed on {PATH}", "PATH",
-                  bmcImage);
-            return false;
+            const size_t i = next++;
+            if (i >= jobs.size())
+            {
+                return;
+            }
+
+            const auto& job = jobs[i];
+            try
+            {
+                if (!verifyFile(job.file, job.sigFile, job.publicKey,
+                                job.hashFunc))
+                {
+                    error("Image file Signature Validation failed on {PATH}",
+                          "PATH", job.file, "SIGNATURE", job.sigFile);
+                    failed = true;
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(exceptionLock);
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+                failed = true;
+            }
         }
+    };
+
+    const size_t threads = std::min<size_t>(
+        jobs.size(), std::max(1U, std::thread::hardware_concurrency()));
+    {
+        // The calling thread verifies as well
+        std::vector<std::jthread> pool;
+        for (size_t i = 1; i < threads; i++)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
     }
 
-    return valid;
+    // Errors are reported as if the verification ran sequentially
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+    return !failed;
 }
 
-bool Signature::verifyPQSignatures(const std::vector<std::string>& imageList)
+bool Signature::addPQJobs(const std::vector<std::string>& imageList,
+                          std::vector<VerifyJob>& jobs) const
 {
     if (!pqAlgorithm.has_value())
     {
@@ -639,9 +941,9 @@ bool Signature::verifyPQSignatures(const std::vector<std::string>& imageList)
     }
 
     bool algoFileFound = false;
-    return checkAndVerifyImage(imageDirPath, algoPublicKeyFile.string(),
-                               imageList, algoFileFound, pqAlgorithm->hashType,
-                               pqAlgorithm->name);
+    return addImageJobs(imageDirPath, algoPublicKeyFile.string(), imageList,
+                        algoFileFound, jobs, pqAlgorithm->hashType,
+                        pqAlgorithm->name);
 }
 
 } // namespace image
@@ -1,4 +1,5 @@
 #pragma once
+#include "image_digests.hpp"
 #include "openssl_alloc.hpp"
 #include "version.hpp"
 
@@ -8,7 +9,11 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
@@ -34,6 +39,8 @@ using VersionPurpose =
 // RAII support for openSSL functions.
 using BIO_MEM_Ptr = std::unique_ptr<BIO, decltype(&::BIO_free)>;
 using EVP_PKEY_Ptr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
+using EVP_PKEY_CTX_Ptr =
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&::EVP_PKEY_CTX_free)>;
 using EVP_MD_CTX_Ptr =
     std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
 
@@ -111,6 +118,58 @@ struct CustomMap
     }
 };
 
+/** @class CryptoCache
+ *  @brief Keeps the parsed public keys and the digests used to verify the
+ *         images for the lifetime of the process.
+ *  @details A key file is parsed again once it is replaced or modified.
+ *           The cache may be used from several threads.
+ */
+class CryptoCache
+{
+  public:
+    /** @brief The cache shared by all the signature verifications */
+    static CryptoCache& instance();
+
+    /**
+     * @brief Get the public key of a PEM file
+     * @param[in] path - The public key file
+     * @return The key, null if the file can't be read or parsed
+     */
+    EVP_PKEY_Ptr getPublicKey(const fs::path& path);
+
+    /**
+     * @brief Get a digest by name
+     * @param[in] name - The hash function name, as in the MANIFEST
+     * @return The digest, or nullptr if it is unknown
+     */
+    const EVP_MD* getDigest(const std::string& name);
+
+  private:
+    using EVP_MD_Ptr = std::unique_ptr<EVP_MD, decltype(&::EVP_MD_free)>;
+
+    struct KeyEntry
+    {
+        FileStamp stamp;
+        EVP_PKEY_Ptr key;
+        uint64_t lastUse;
+    };
+
+    /** @brief The number of keys kept, uploaded images come with their own */
+    static constexpr size_t maxKeys = 16;
+
+    /** @brief Larger files are not read, they can't be a PEM public key */
+    static constexpr int64_t maxKeySize = 64 * 1024;
+
+    std::mutex mutex;
+
+    /** @brief The parsed public keys by path */
+    std::map<fs::path, KeyEntry> keys;
+    uint64_t useCount = 0;
+
+    /** @brief The fetched digests by name */
+    std::map<std::string, EVP_MD_Ptr, std::less<>> digests;
+};
+
 /** @class Signature
  *  @brief Contains signature verification functions.
  *  @details The software image class that contains the signature
@@ -147,6 +206,34 @@ class Signature
      */
     bool verify();
 
+    /**
+     * @brief Verify the Manifest and public key file signature, and the full
+     *        image signature, before the image files are available. The
+     *        image files are then verified from their digest, with
+     *        verifyFileDigest.
+     *
+     *        @return true if signature verification was successful and the
+     *                     image public key can verify a digest, false if not
+     */
+    bool verifyMetadata();
+
+    /**
+     * @brief Verify the signature of an image file which was not extracted,
+     *        from its digest, using the image specific public key.
+     *
+     * @param[in] file - The path of the file relative to the image directory
+     * @param[in] digest - The digest of the file, with getHashType()
+     * @return true if signature verification was successful, false if not
+     */
+    bool verifyFileDigest(const std::string& file,
+                          const ImageDigests::Digest& digest) const;
+
+    /** @brief Get the hash function of the image files */
+    const Hash_t& getHashType() const
+    {
+        return hashType;
+    }
+
   private:
     /**
      * @brief Function used for system level file signature validation
@@ -185,12 +272,16 @@ class Signature
 
     /**
      * @brief Get post-quantum algorithm from MANIFEST file
+     * @param[in]  - The parsed MANIFEST
      * @return Optional containing PQ algorithm, or nullopt if none found
      */
-    std::optional<PQAlgorithm> getPQAlgorithmFromManifest() const;
+    static std::optional<PQAlgorithm> getPQAlgorithmFromManifest(
+        const manager::Manifest& manifest);
 
     /**
-     * @brief Verify the file signature using public key and hash function
+     * @brief Verify the file signature using public key and hash function.
+     *        The digest of the file computed while the image was extracted
+     *        is used instead of reading the file, where the key type allows.
      *
      * @param[in]  - Image file path
      * @param[in]  - Signature file path
@@ -198,9 +289,37 @@ class Signature
      * @param[in]  - Hash function name
      * @return true if signature verification was successful, false if not
      */
-    static bool verifyFile(const fs::path& file, const fs::path& signature,
-                           const fs::path& publicKey,
-                           const std::string& hashFunc);
+    bool verifyFile(const fs::path& file, const fs::path& signature,
+                    const fs::path& publicKey,
+                    const std::string& hashFunc) const;
+
+    /**
+     * @brief Verify the signature of a precomputed digest
+     *
+     * @param[in]  - Public key
+     * @param[in]  - Hash function
+     * @param[in]  - Digest of the signed file
+     * @param[in]  - Signature file path
+     * @return The result of EVP_PKEY_verify
+     */
+    static int verifyDigest(EVP_PKEY* publicKey, const EVP_MD* hash,
+                            const ImageDigests::Digest& digest,
+                            const fs::path& sigFile);
+
+    /**
+     * @brief Verify the signature of the concatenation of files, without
+     *        writing it out. Missing and empty files are skipped.
+     *
+     * @param[in]  - Image file paths, in order
+     * @param[in]  - Signature file path
+     * @param[in]  - Public key
+     * @param[in]  - Hash function name
+     * @return true if signature verification was successful, false if not
+     */
+    static bool verifyConcatenation(const std::vector<fs::path>& files,
+                                    const fs::path& signature,
+                                    const fs::path& publicKey,
+                                    const std::string& hashFunc);
 
     /**
      * @brief Create EVP_PKEY object from the public key
@@ -242,6 +361,21 @@ class Signature
     /** @brief Cached post-quantum algorithm info from MANIFEST */
     std::optional<PQAlgorithm> pqAlgorithm;
 
+    /** @brief Digests of the image files computed during the extraction,
+     *         null if the image wasn't extracted by this process */
+    std::shared_ptr<const ImageDigests> digests;
+
+    /** @struct VerifyJob
+     *  @brief A file signature to verify.
+     */
+    struct VerifyJob
+    {
+        fs::path file;
+        fs::path sigFile;
+        fs::path publicKey;
+        std::string hashFunc;
+    };
+
     /** @brief Check and Verify the required image files
      *
      * @param[in] filePath - BMC tarball file path
@@ -254,19 +388,52 @@ class Signature
      * @return true if all image files are found in BMC tarball and
      * Verify Success false if one of image files is missing
      */
-    static bool checkAndVerifyImage(
-        const std::string& filePath, const std::string& publicKeyPath,
-        const std::vector<std::string>& imageList, bool& fileFound,
-        const std::string& hashType = "", const std::string& sigSubDir = "");
+    bool checkAndVerifyImage(const std::string& filePath,
+                             const std::string& publicKeyPath,
+                             const std::vector<std::string>& imageList,
+                             bool& fileFound, const std::string& hashType = "",
+                             const std::string& sigSubDir = "") const;
+
+    /** @brief Add the signatures of the image files to verify, up to the
+     *         first missing file
+     *
+     * @param[in] filePath - BMC tarball file path
+     * @param[in] publicKeyPath - publicKey file Path
+     * @param[in] imageList - Image filenames included in the BMC tarball
+     * @param[out] fileFound - Indicate if the file to verify is found or not
+     * @param[out] jobs - The signatures to verify
+     * @param[in] hashType - Hash function to use for verification
+     * @param[in] sigSubDir - Subdirectory containing signatures
+     *
+     * @return true if all image files are found in BMC tarball
+     */
+    bool addImageJobs(const std::string& filePath,
+                      const std::string& publicKeyPath,
+                      const std::vector<std::string>& imageList,
+                      bool& fileFound, std::vector<VerifyJob>& jobs,
+                      const std::string& hashType = "",
+                      const std::string& sigSubDir = "") const;
 
     /**
-     * @brief Verify post-quantum algorithm signatures for image files
+     * @brief Add the post-quantum algorithm signatures of image files
      *
      * @param[in] imageList - List of image filenames to verify
-     * @return true if PQ verification succeeds or is not required, false on
-     * failure
+     * @param[out] jobs - The signatures to verify
+     * @return true if the PQ signatures were added or are not required,
+     * false if they can't be verified
+     */
+    bool addPQJobs(const std::vector<std::string>& imageList,
+                   std::vector<VerifyJob>& jobs) const;
+
+    /**
+     * @brief Verify signatures concurrently on up to one thread per core.
+     *        No new verification is started after one failed.
+     *
+     * @param[in] jobs - The signatures to verify
+     * @return true if all the signatures are valid
+     * @throw The exception of the first verification which threw one
      */
-    bool verifyPQSignatures(const std::vector<std::string>& imageList);
+    bool verifyFiles(const std::vector<VerifyJob>& jobs) const;
 };
 
 } // namespace image
@@ -2,6 +2,9 @@
 
 #include "item_updater.hpp"
 
+#ifdef WANT_SIGNATURE_VERIFY
+#include "image_digests.hpp"
+#endif
 #include "images.hpp"
 #include "serialize.hpp"
 #include "version.hpp"
@@ -165,7 +168,18 @@ ActivationIntf::Activations ItemUpdater::verifyAndCreateObjects(
     ItemUpdater::ActivationStatus result;
     if (purpose == VersionPurpose::BMC || purpose == VersionPurpose::System)
     {
-        result = ItemUpdater::validateSquashFSImage(filePath);
+#ifdef BMC_STATIC_DUAL_IMAGE
+        // Only the metadata of an image written to the alt chip was extracted
+        if (streamedImages.contains(id))
+        {
+            imageUpdateList.assign(1, bmcFullImages);
+            result = ItemUpdater::ActivationStatus::ready;
+        }
+        else
+#endif
+        {
+            result = ItemUpdater::validateSquashFSImage(filePath);
+        }
     }
     else
     {
@@ -265,6 +279,10 @@ void ItemUpdater::processBMCImage()
     constexpr auto functionalSuffix = "-functional";
     bool functionalFound = false;
 
+    // The versions read from the os-release files on a previous start, which
+    // remain valid until the volumes change
+    ReleaseCache releaseCache;
+
     // Read os-release from folders under /media/ to get
     // BMC Software Versions.
     std::error_code ec;
@@ -302,7 +320,9 @@ void ItemUpdater::processBMCImage()
 
                 continue;
             }
-            auto version = VersionClass::getBMCVersion(osRelease);
+            auto release =
+                releaseCache.get(iter.path().filename().native(), osRelease);
+            const auto& version = release.version;
             if (version.empty())
             {
                 error("Failed to read version from osRelease: {PATH}", "PATH",
@@ -342,9 +362,8 @@ void ItemUpdater::processBMCImage()
             auto purpose = server::Version::VersionPurpose::BMC;
             restorePurpose(flashId, purpose);
 
-            // Read os-release from /etc/ to get the BMC extended version
-            std::string extendedVersion =
-                VersionClass::getBMCExtendedVersion(osRelease);
+            // The BMC extended version, also from os-release
+            const auto& extendedVersion = release.extendedVersion;
 
             auto path = fs::path(SOFTWARE_OBJPATH) / id;
 
@@ -442,6 +461,8 @@ void ItemUpdater::processBMCImage()
         }
     }
 
+    releaseCache.store();
+
     for (const auto& version : versions)
     {
         if ((versions.size() == 1) || (!version.second->isFunctional()))
@@ -557,6 +578,15 @@ void ItemUpdater::erase(std::string entryId)
         updateManagers.erase(entryId);
     }
 
+#ifdef WANT_SIGNATURE_VERIFY
+    // The digests computed while the image was extracted, if it was
+    image::DigestStore::instance().erase(fs::path(IMG_UPLOAD_DIR) / entryId);
+#endif
+
+#ifdef BMC_STATIC_DUAL_IMAGE
+    streamedImages.erase(entryId);
+#endif
+
     return;
 }
 
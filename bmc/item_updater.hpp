@@ -14,6 +14,7 @@
 #include <xyz/openbmc_project/Control/FieldMode/server.hpp>
 #include <xyz/openbmc_project/Software/MinimumVersion/server.hpp>
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -273,6 +274,12 @@ class ItemUpdater : public ItemUpdaterInherit
     /** @brief The slot of running BMC image */
     uint32_t runningImageSlot = 0;
 
+#ifdef BMC_STATIC_DUAL_IMAGE
+    /** @brief The ids of the images which were written to the alt chip and
+     *         verified while they were uploaded */
+    std::set<std::string> streamedImages;
+#endif
+
     /** @brief The type of updater. */
     UpdaterType type;
 
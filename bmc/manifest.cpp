@@ -0,0 +1,111 @@
+#include "manifest.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <fstream>
+#include <iterator>
+
+namespace phosphor
+{
+namespace software
+{
+namespace manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+Manifest::Manifest(std::string_view contents)
+{
+    while (!contents.empty())
+    {
+        auto lineEnd = contents.find('\n');
+        auto line = contents.substr(0, lineEnd);
+        contents.remove_prefix(
+            lineEnd == std::string_view::npos ? contents.size() : lineEnd + 1);
+
+        if (!line.empty() && line.back() == '\r')
+        {
+            // If the manifest has CRLF line terminators, e.g. is created on
+            // Windows, the line will contain \r at the end, remove it.
+            line.remove_suffix(1);
+        }
+
+        auto delimPos = line.find('=');
+        if (delimPos == std::string_view::npos)
+        {
+            continue;
+        }
+
+        auto key = line.substr(0, delimPos);
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            it = index.emplace(std::string(key), std::vector<size_t>{}).first;
+        }
+        it->second.push_back(entries.size());
+        entries.emplace_back(key, line.substr(delimPos + 1));
+    }
+}
+
+Manifest Manifest::read(const fs::path& manifestFilePath)
+{
+    std::ifstream efile(manifestFilePath);
+    if (!efile.is_open())
+    {
+        error("Error occurred when reading MANIFEST file {PATH}", "PATH",
+              manifestFilePath);
+        return {};
+    }
+
+    std::string contents{std::istreambuf_iterator<char>(efile),
+                         std::istreambuf_iterator<char>()};
+    if (efile.bad())
+    {
+        error("Error occurred when reading MANIFEST file {PATH}", "PATH",
+              manifestFilePath);
+        return {};
+    }
+
+    return Manifest(contents);
+}
+
+std::string Manifest::getValue(std::string_view key) const
+{
+    auto values = getRepeatedValues(key);
+    if (values.empty())
+    {
+        return std::string{};
+    }
+    if (values.size() > 1)
+    {
+        error("Multiple values found in MANIFEST file for key: {KEY}", "KEY",
+              std::string(key));
+    }
+    return values.at(0);
+}
+
+std::vector<std::string> Manifest::getRepeatedValues(std::string_view key) const
+{
+    std::vector<std::string> values{};
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        for (auto i : it->second)
+        {
+            values.push_back(entries[i].second);
+        }
+    }
+
+    if (values.empty())
+    {
+        info("No values found in MANIFEST file for key: {KEY}", "KEY",
+             std::string(key));
+    }
+
+    return values;
+}
+
+} // namespace manager
+} // namespace software
+} // namespace phosphor
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace software
+{
+namespace manager
+{
+
+namespace fs = std::filesystem;
+
+/** @class Manifest
+ *  @brief The key=value lines of an image MANIFEST, parsed once.
+ *  @details Keys may be repeated, and lines may end with CRLF. Lines without
+ *           a '=' are ignored.
+ */
+class Manifest
+{
+  public:
+    using Entry = std::pair<std::string, std::string>;
+
+    Manifest() = default;
+
+    /**
+     * @brief Parse the contents of a MANIFEST
+     * @param[in] contents - The MANIFEST text
+     */
+    explicit Manifest(std::string_view contents);
+
+    /**
+     * @brief Read and parse a MANIFEST file
+     * @param[in] manifestFilePath - The MANIFEST file
+     * @return The manifest, empty if the file can't be read
+     */
+    static Manifest read(const fs::path& manifestFilePath);
+
+    /**
+     * @brief Get the value of a key
+     * @param[in] key - The key
+     * @return The first value of the key, empty if it is missing
+     */
+    std::string getValue(std::string_view key) const;
+
+    /**
+     * @brief Get all the values of a repeated key
+     * @param[in] key - The key
+     * @return The values of the key, in the order of the file
+     */
+    std::vector<std::string> getRepeatedValues(std::string_view key) const;
+
+    /** @brief All the entries, in the order of the file */
+    const std::vector<Entry>& getEntries() const
+    {
+        return entries;
+    }
+
+  private:
+    /** @brief The entries in the order of the file */
+    std::vector<Entry> entries;
+
+    /** @brief The indexes of the entries of each key */
+    std::map<std::string, std::vector<size_t>, std::less<>> index;
+};
+
+} // namespace manager
+} // namespace software
+} // namespace phosphor
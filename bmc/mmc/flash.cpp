@@ -14,13 +14,16 @@ namespace updater
 
 namespace softwareServer = sdbusplus::server::xyz::openbmc_project::software;
 
-void Activation::flashWrite()
+bool Activation::flashWrite()
 {
     auto method = bus.new_method_call(SYSTEMD_BUSNAME, SYSTEMD_PATH,
                                       SYSTEMD_INTERFACE, "StartUnit");
     auto serviceFile = "obmc-flash-mmc@" + versionId + ".service";
     method.append(serviceFile, "replace");
     bus.call_noreply(method);
+
+    // The service reports its result through onStateChanges
+    return true;
 }
 
 void Activation::onStateChanges(sdbusplus::message_t& msg)
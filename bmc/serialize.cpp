@@ -2,13 +2,18 @@
 
 #include "serialize.hpp"
 
+#include <sys/stat.h>
+
 #include <cereal/archives/json.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/server.hpp>
 
 #include <filesystem>
 #include <fstream>
 #include <system_error>
+#include <utility>
 
 namespace phosphor
 {
@@ -22,6 +27,10 @@ namespace fs = std::filesystem;
 
 const std::string priorityName = "priority";
 const std::string purposeName = "purpose";
+const std::string releasesName = "releases";
+
+// Bump when the entries change, older files are then ignored
+constexpr uint32_t releaseCacheVersion = 1;
 
 void storePriority(const std::string& flashId, uint8_t priority)
 {
@@ -159,6 +168,125 @@ void removePersistDataDirectory(const std::string& flashId)
     }
 }
 
+template <class Archive>
+void ReleaseCache::Entry::serialize(Archive& archive)
+{
+    archive(cereal::make_nvp("dev", dev), cereal::make_nvp("ino", ino),
+            cereal::make_nvp("size", size), cereal::make_nvp("mtime", mtime),
+            cereal::make_nvp("ctime", ctime),
+            cereal::make_nvp("version", release.version),
+            cereal::make_nvp("extendedVersion", release.extendedVersion));
+}
+
+fs::path ReleaseCache::defaultPath()
+{
+    return fs::path(PERSIST_DIR) / releasesName;
+}
+
+ReleaseCache::ReleaseCache(fs::path path) : path(std::move(path))
+{
+    std::error_code ec;
+    if (!fs::exists(this->path, ec))
+    {
+        return;
+    }
+
+    std::ifstream is(this->path.c_str(), std::ios::in);
+    try
+    {
+        uint32_t version = 0;
+        cereal::JSONInputArchive iarchive(is);
+        iarchive(cereal::make_nvp("version", version));
+        if (version == releaseCacheVersion)
+        {
+            iarchive(cereal::make_nvp(releasesName, cached));
+        }
+    }
+    // A file which isn't JSON at all fails in rapidjson, which doesn't
+    // throw a cereal::Exception
+    catch (const std::exception& e)
+    {
+        cached.clear();
+        fs::remove_all(this->path, ec);
+    }
+}
+
+ReleaseCache::Release ReleaseCache::get(const std::string& volume,
+                                        const fs::path& osRelease)
+{
+    using VersionClass = phosphor::software::manager::Version;
+
+    // Taken before reading, so a file changed meanwhile is read again later
+    struct stat st{};
+    if (stat(osRelease.c_str(), &st) != 0)
+    {
+        return {VersionClass::getBMCVersion(osRelease),
+                VersionClass::getBMCExtendedVersion(osRelease)};
+    }
+
+    Entry entry;
+    entry.dev = st.st_dev;
+    entry.ino = st.st_ino;
+    entry.size = st.st_size;
+    entry.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    entry.ctime = st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec;
+
+    auto it = cached.find(volume);
+    if (it != cached.end() && it->second.sameFile(entry))
+    {
+        current.insert_or_assign(volume, it->second);
+        return it->second.release;
+    }
+
+    entry.release.version = VersionClass::getBMCVersion(osRelease);
+    entry.release.extendedVersion =
+        VersionClass::getBMCExtendedVersion(osRelease);
+    if (!entry.release.version.empty())
+    {
+        current.insert_or_assign(volume, entry);
+        changed = true;
+    }
+    return entry.release;
+}
+
+void ReleaseCache::store()
+{
+    if (!changed && current.size() == cached.size())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    auto tmpPath = fs::path(path).concat(".tmp");
+    fs::create_directories(path.parent_path(), ec);
+
+    {
+        std::ofstream os(tmpPath.c_str());
+        cereal::JSONOutputArchive oarchive(os);
+        oarchive(cereal::make_nvp("version", releaseCacheVersion),
+                 cereal::make_nvp(releasesName, current));
+    }
+
+    // Replace the previous entries as a whole
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        warning("Failed to store the BMC releases: {ERROR}", "ERROR",
+                ec.message());
+        fs::remove(tmpPath, ec);
+        return;
+    }
+
+    cached = current;
+    changed = false;
+}
+
+void ReleaseCache::invalidate(const fs::path& path)
+{
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
 } // namespace updater
 } // namespace software
 } // namespace phosphor
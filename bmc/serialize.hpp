@@ -4,6 +4,9 @@
 
 #include "version.hpp"
 
+#include <cstdint>
+#include <filesystem>
+#include <map>
 #include <string>
 
 namespace phosphor
@@ -52,6 +55,81 @@ bool restorePurpose(const std::string& flashId, VersionPurpose& purpose);
  **/
 void removePersistDataDirectory(const std::string& flashId);
 
+/** @class ReleaseCache
+ *  @brief The os-release values of the mounted BMC volumes, persisted so that
+ *         a restart does not have to read them again.
+ *  @details An entry is used only while the os-release file of the volume is
+ *           the same file with the same size and times, anything else reads
+ *           the file again. Volumes not looked up are dropped on store.
+ */
+class ReleaseCache
+{
+  public:
+    /** @brief The values read from an os-release file */
+    struct Release
+    {
+        std::string version;
+        std::string extendedVersion;
+    };
+
+    /** @brief Loads the persisted entries, if they can be read
+     *  @param[in] path - The file the entries are persisted in.
+     **/
+    explicit ReleaseCache(std::filesystem::path path = defaultPath());
+
+    /** @brief The file the entries are persisted in, in PERSIST_DIR */
+    static std::filesystem::path defaultPath();
+
+    /** @brief Get the release of a volume, from the cache if it is valid
+     *  @param[in] volume - The mount directory name of the volume.
+     *  @param[in] osRelease - The os-release file of the volume.
+     *  @return The release, with an empty version if it can't be read.
+     **/
+    Release get(const std::string& volume,
+                const std::filesystem::path& osRelease);
+
+    /** @brief Persist the entries of the volumes looked up, if they changed */
+    void store();
+
+    /** @brief Remove the persisted entries, before a volume is rewritten
+     *  @param[in] path - The file the entries are persisted in.
+     **/
+    static void invalidate(const std::filesystem::path& path = defaultPath());
+
+  private:
+    struct Entry
+    {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+        int64_t size = 0;
+        int64_t mtime = 0;
+        int64_t ctime = 0;
+        Release release;
+
+        template <class Archive>
+        void serialize(Archive& archive);
+
+        bool sameFile(const Entry& other) const
+        {
+            return dev == other.dev && ino == other.ino &&
+                   size == other.size && mtime == other.mtime &&
+                   ctime == other.ctime;
+        }
+    };
+
+    /** @brief The file the entries are persisted in */
+    std::filesystem::path path;
+
+    /** @brief The entries loaded from the persisted file */
+    std::map<std::string, Entry> cached;
+
+    /** @brief The entries of the volumes looked up since */
+    std::map<std::string, Entry> current;
+
+    /** @brief Whether current differs from cached */
+    bool changed = false;
+};
+
 } // namespace updater
 } // namespace software
 } // namespace phosphor
@@ -1,7 +1,6 @@
 #include "software_utils.hpp"
 
-#include <sys/wait.h>
-#include <unistd.h>
+#include "tar_extract.hpp"
 
 #include <phosphor-logging/lg2.hpp>
 
@@ -10,32 +9,18 @@ PHOSPHOR_LOG2_USING;
 namespace phosphor::software::utils
 {
 
-bool unTar(int imageFd, const std::string& extractDirPath)
+bool unTar(int imageFd, const std::string& extractDirPath, bool consumeImage,
+           TarObserver* observer)
 {
     info("Extracting archive to: {DIR}", "DIR", extractDirPath);
 
-    pid_t pid = fork();
-    if (pid < 0)
+    auto result = extractTar(imageFd, extractDirPath, consumeImage, observer);
+    if (!result)
     {
-        error("fork failed: {ERRNO}", "ERRNO", errno);
-        return false;
-    }
-    if (pid == 0)
-    {
-        dup2(imageFd, STDIN_FILENO);
-        // Pass tar arguments directly to exec to avoid any shell
-        // interpretation of extractDirPath.
-        execlp("tar", "tar", "-xf", "-", "-C", extractDirPath.c_str(),
-               "--no-same-owner", nullptr);
-        _exit(127);
-    }
-
-    int status = 0;
-    waitpid(pid, &status, 0);
-    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
-    {
-        error("tar failed (status {STATUS}) extracting to {DIR}", "STATUS",
-              status, "DIR", extractDirPath);
+        error(
+            "Failed to extract {ENTRY} to {DIR}: {ERROR} ({ERRNO})", "ENTRY",
+            result.entry, "DIR", extractDirPath, "ERROR",
+            std::string(toString(result.error)), "ERRNO", result.errnum);
         return false;
     }
     return true;
@@ -9,6 +9,8 @@ namespace phosphor::software::utils
 
 namespace fs = std::filesystem;
 
+class TarObserver;
+
 struct RemovablePath
 {
     fs::path path;
@@ -33,8 +35,12 @@ struct RemovablePath
  *  @param[in] imageFd - The file descriptor of the image to untar.
  *  @param[in] extractDirPath - The destination directory for the untarred
  * image.
+ *  @param[in] consumeImage - Free the storage of the image file while it is
+ * extracted, for a tarball which is removed afterwards.
+ *  @param[in] observer - Optionally sees the files as they are extracted.
  *  @param[out] bool - The result of the untar operation.
  */
-bool unTar(int imageFd, const std::string& extractDirPath);
+bool unTar(int imageFd, const std::string& extractDirPath,
+           bool consumeImage = false, TarObserver* observer = nullptr);
 
 } // namespace phosphor::software::utils
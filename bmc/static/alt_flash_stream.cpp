@@ -0,0 +1,225 @@
+#include "config.h"
+
+#include "alt_flash_stream.hpp"
+
+#include "images.hpp"
+#include "manifest.hpp"
+#include "utils.hpp"
+#include "version.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace
+{
+constexpr auto ALT_FLASH_DEVICE = "/dev/mtd/alt-bmc";
+constexpr auto SYNC_SERVICE = "xyz.openbmc_project.Software.Sync.service";
+} // namespace
+
+namespace phosphor
+{
+namespace software
+{
+namespace updater
+{
+
+PHOSPHOR_LOG2_USING;
+
+using Manifest = phosphor::software::manager::Manifest;
+using Version = phosphor::software::manager::Version;
+
+AltFlashStream::~AltFlashStream()
+{
+    writer.reset();
+    if (deviceFd >= 0)
+    {
+        close(deviceFd);
+    }
+}
+
+bool AltFlashStream::isForThisBMC() const
+{
+    auto manifest = Manifest::read(extractDir / MANIFEST_FILE_NAME);
+
+    auto purpose = sdbusplus::message::convert_from_string<
+        Version::VersionPurpose>(manifest.getValue("purpose"));
+    if (purpose != Version::VersionPurpose::BMC &&
+        purpose != Version::VersionPurpose::System)
+    {
+        return false;
+    }
+
+    // The same checks as the update manager, which only runs them once the
+    // whole upload was extracted
+    auto machine = manifest.getValue("MachineName");
+    return machine.empty() ||
+           machine == Version::getBMCMachine(OS_RELEASE_FILE);
+}
+
+bool AltFlashStream::takeAltChip()
+{
+    // As obmc-flash-bmc-alt@.service does before writing the chip
+    altTaken = true;
+    ::utils::execute("/bin/systemctl", "stop", SYNC_SERVICE);
+    ::utils::execute("/usr/bin/obmc-flash-bmc", "umount-static-altfs",
+                     "rofs-alt");
+    ::utils::execute("/usr/bin/obmc-flash-bmc", "umount-static-altfs",
+                     "rwfs-alt");
+
+    deviceFd = open(ALT_FLASH_DEVICE, O_RDWR | O_CLOEXEC);
+    if (deviceFd < 0)
+    {
+        error("Failed to open {PATH}: {ERRNO}", "PATH", ALT_FLASH_DEVICE,
+              "ERRNO", errno);
+        return false;
+    }
+
+    auto device = utils::probeFlashDevice(deviceFd);
+    auto md = EVP_get_digestbyname(signature->getHashType().c_str());
+    if (!device || !md)
+    {
+        error("Unable to write {PATH} with {HASH}", "PATH", ALT_FLASH_DEVICE,
+              "HASH", signature->getHashType());
+        return false;
+    }
+
+    writer = std::make_unique<utils::DeltaWriter>(deviceFd, *device, md);
+    return true;
+}
+
+bool AltFlashStream::start()
+{
+    if (!isForThisBMC())
+    {
+        return false;
+    }
+
+    // Only what precedes the image in the archive was extracted
+    signature = std::make_unique<image::Signature>(extractDir,
+                                                   SIGNED_IMAGE_CONF_PATH);
+    if (!signature->verifyMetadata())
+    {
+        info("Extracting {FILE} to verify it", "FILE", image::bmcFullImages);
+        return false;
+    }
+
+    if (!takeAltChip())
+    {
+        release();
+        return false;
+    }
+
+    info("Writing {FILE} to {PATH} while it is uploaded", "FILE",
+         image::bmcFullImages, "PATH", ALT_FLASH_DEVICE);
+    return true;
+}
+
+bool AltFlashStream::extract(const fs::path& path)
+{
+    target = Target::extracted;
+    if (path != image::bmcFullImages)
+    {
+        return true;
+    }
+
+    // A second image of the same name could replace the one on the chip
+    if (imageSeen)
+    {
+        error("{FILE} is repeated in the archive", "FILE",
+              image::bmcFullImages);
+        target = Target::rejected;
+        return false;
+    }
+    imageSeen = true;
+
+    if (start())
+    {
+        target = Target::streamed;
+        return false;
+    }
+    return true;
+}
+
+void AltFlashStream::begin(const fs::path& path)
+{
+    if (target == Target::extracted && next)
+    {
+        next->begin(path);
+    }
+}
+
+bool AltFlashStream::update(std::span<const uint8_t> data)
+{
+    switch (target)
+    {
+        case Target::streamed:
+            return writer->write(data);
+        case Target::rejected:
+            return false;
+        case Target::extracted:
+            break;
+    }
+    return !next || next->update(data);
+}
+
+bool AltFlashStream::end()
+{
+    if (target != Target::streamed)
+    {
+        return target == Target::extracted && (!next || next->end());
+    }
+    target = Target::extracted;
+
+    if (!writer->finish() ||
+        !signature->verifyFileDigest(image::bmcFullImages,
+                                     writer->getDigest()))
+    {
+        error("Failed to write a verified {FILE} to {PATH}", "FILE",
+              image::bmcFullImages, "PATH", ALT_FLASH_DEVICE);
+        return false;
+    }
+
+    const auto& stats = writer->getStats();
+    info("Wrote {WRITTEN} of {BLOCKS} blocks of {FILE} to {PATH}", "WRITTEN",
+         stats.written, "BLOCKS", stats.blocks, "FILE", image::bmcFullImages,
+         "PATH", ALT_FLASH_DEVICE);
+    streamed = true;
+    return true;
+}
+
+bool AltFlashStream::release()
+{
+    if (!altTaken)
+    {
+        return streamed;
+    }
+    altTaken = false;
+
+    // The image is incomplete or failed its verification
+    if (writer && !streamed && !writer->invalidate())
+    {
+        error("Failed to erase {PATH}: {ERRNO}", "PATH", ALT_FLASH_DEVICE,
+              "ERRNO", errno);
+    }
+    writer.reset();
+    if (deviceFd >= 0)
+    {
+        close(deviceFd);
+        deviceFd = -1;
+    }
+
+    // As obmc-flash-bmc-alt@.service does once the chip was written, the
+    // mounts fail harmlessly if the chip was erased
+    ::utils::execute("/usr/bin/obmc-flash-bmc", "static-altfs", "squashfs",
+                     "alt-rofs", "rofs-alt");
+    ::utils::execute("/usr/bin/obmc-flash-bmc", "static-altfs", "jffs2",
+                     "alt-rwfs", "rwfs-alt");
+    ::utils::execute("/bin/systemctl", "start", SYNC_SERVICE);
+    return streamed;
+}
+
+} // namespace updater
+} // namespace software
+} // namespace phosphor
@@ -9,12 +9,16 @@
 #include <phosphor-logging/lg2.hpp>
 
 #include <filesystem>
+#include <string>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace
 {
 constexpr auto PATH_INITRAMFS = "/run/initramfs";
 constexpr auto FLASH_ALT_SERVICE_TMPL = "obmc-flash-bmc-alt@";
+constexpr auto SELECT_ALT_SERVICE_TMPL = "obmc-flash-bmc-alt-select@";
 } // namespace
 
 namespace phosphor
@@ -29,7 +33,58 @@ PHOSPHOR_LOG2_USING;
 namespace fs = std::filesystem;
 using namespace phosphor::software::image;
 
-void Activation::flashWrite()
+namespace
+{
+
+// The uploaded image is deleted once it is staged, so it is moved instead of
+// copied. Within a filesystem that is a rename, otherwise the uploaded file
+// is removed after each copy so the image isn't held in RAM twice.
+// Returns false if the image could not be staged, a missing optional image
+// is not an error.
+bool stageImage(const fs::path& from, const fs::path& to, bool optional)
+{
+    std::error_code ec;
+    fs::rename(from, to, ec);
+    if (!ec)
+    {
+        return true;
+    }
+    if (ec == std::errc::no_such_file_or_directory && optional)
+    {
+        return true;
+    }
+
+    if (ec == std::errc::cross_device_link &&
+        fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec))
+    {
+        fs::remove(from, ec);
+        return true;
+    }
+
+    error("Failed to stage {PATH}: {ERROR_MSG}", "PATH", from, "ERROR_MSG",
+          ec.message());
+
+    // A partial copy must not be programmed on the next reboot
+    fs::remove(to, ec);
+    return false;
+}
+
+#ifdef BMC_STATIC_DUAL_IMAGE
+// The unit which writes the image to the alt chip and selects the chip to
+// boot, or only selects it when the image was written while it was uploaded
+std::string getAltService(const ItemUpdater& parent,
+                          const std::string& versionId)
+{
+    const std::string tmpl = parent.streamedImages.contains(versionId)
+                                 ? SELECT_ALT_SERVICE_TMPL
+                                 : FLASH_ALT_SERVICE_TMPL;
+    return tmpl + versionId + ".service";
+}
+#endif
+
+} // namespace
+
+bool Activation::flashWrite()
 {
 #ifdef BMC_STATIC_DUAL_IMAGE
     if (parent.runningImageSlot != 0)
@@ -39,10 +94,10 @@ void Activation::flashWrite()
              versionId);
         auto method = bus.new_method_call(SYSTEMD_BUSNAME, SYSTEMD_PATH,
                                           SYSTEMD_INTERFACE, "StartUnit");
-        auto serviceFile = FLASH_ALT_SERVICE_TMPL + versionId + ".service";
+        auto serviceFile = getAltService(parent, versionId);
         method.append(serviceFile, "replace");
         bus.call_noreply(method);
-        return;
+        return true;
     }
 #endif
     // For static layout code update, just put images in /run/initramfs.
@@ -51,26 +106,42 @@ void Activation::flashWrite()
     fs::path uploadDir(IMG_UPLOAD_DIR);
     fs::path toPath(PATH_INITRAMFS);
 
+    // The images to stage, and whether they are optional
+    std::vector<std::pair<std::string, bool>> images;
     for (const auto& bmcImage : parent.imageUpdateList)
     {
-        std::error_code ec;
-        fs::copy_file(uploadDir / versionId / bmcImage, toPath / bmcImage,
-                      fs::copy_options::overwrite_existing, ec);
+        images.emplace_back(bmcImage, false);
+    }
+    for (const auto& optionalImage : getOptionalImages())
+    {
+        images.emplace_back(optionalImage, true);
     }
-    for (const auto& optionalImaage : getOptionalImages())
+
+    for (auto it = images.begin(); it != images.end(); ++it)
     {
-        std::error_code ec;
-        fs::copy_file(uploadDir / versionId / optionalImaage,
-                      toPath / optionalImaage,
-                      fs::copy_options::overwrite_existing, ec);
+        if (stageImage(uploadDir / versionId / it->first, toPath / it->first,
+                       it->second))
+        {
+            continue;
+        }
+
+        // The update script programs whatever it finds, so don't leave it
+        // a mix of the new and the running image
+        for (auto staged = images.begin(); staged != it; ++staged)
+        {
+            std::error_code ec;
+            fs::remove(toPath / staged->first, ec);
+        }
+        return false;
     }
+    return true;
 }
 
 void Activation::onStateChanges([[maybe_unused]] sdbusplus::message_t& msg)
 {
 #ifdef BMC_STATIC_DUAL_IMAGE
     uint32_t newStateID;
-    auto serviceFile = FLASH_ALT_SERVICE_TMPL + versionId + ".service";
+    auto serviceFile = getAltService(parent, versionId);
     sdbusplus::object_path newStateObjPath;
     std::string newStateUnit{};
     std::string newStateResult{};
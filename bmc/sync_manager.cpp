@@ -2,14 +2,28 @@
 
 #include "sync_manager.hpp"
 
+#include <fcntl.h>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
-#include <sys/wait.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
 #include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace phosphor
 {
@@ -21,68 +35,675 @@ namespace manager
 PHOSPHOR_LOG2_USING;
 namespace fs = std::filesystem;
 
-int Sync::processEntry(int mask, const fs::path& entryPath)
+namespace // anonymous
 {
-    int status{};
-    pid_t pid = fork();
 
-    if (pid == 0)
-    {
-        fs::path dst(ALT_RWFS);
-        dst /= entryPath.relative_path();
+/** @brief The suffix of the files being written in the alternate rwfs */
+constexpr auto tmpSuffix = ".sync-tmp";
+
+fs::path tmpPath(const fs::path& dst)
+{
+    auto tmp = dst;
+    tmp += tmpSuffix;
+    return tmp;
+}
+
+/** @brief Copy size bytes, in the kernel when the filesystems allow it */
+bool copyData(int in, int out, off_t size)
+{
+    bool useCopyRange = true;
+    std::array<char, 64 * 1024> buffer;
 
-        // rsync needs an additional --delete argument to handle file deletions
-        // so need to differentiate between the different file events.
-        if (mask & IN_CLOSE_WRITE)
+    while (size > 0)
+    {
+        ssize_t n = -1;
+        if (useCopyRange)
         {
-            std::error_code ec;
-            if (!(fs::exists(dst, ec)))
+            n = copy_file_range(in, nullptr, out, nullptr,
+                                static_cast<size_t>(size), 0);
+            if (n < 0 && (errno == EXDEV || errno == EINVAL ||
+                          errno == ENOSYS || errno == EOPNOTSUPP))
             {
-                if (fs::is_directory(entryPath, ec))
-                {
-                    // Source is a directory, create it at the destination.
-                    fs::create_directories(dst, ec);
-                }
-                else
+                useCopyRange = false;
+                continue;
+            }
+        }
+        else
+        {
+            n = read(in, buffer.data(),
+                     std::min<size_t>(buffer.size(), size));
+            if (n > 0)
+            {
+                for (ssize_t done = 0; done < n;)
                 {
-                    // Source is a file, create the directory where this file
-                    // resides at the destination.
-                    fs::create_directories(dst.parent_path(), ec);
+                    auto w = write(out, buffer.data() + done, n - done);
+                    if (w < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    done += w;
                 }
             }
+        }
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (n == 0)
+        {
+            // The file was truncated while it was copied, it will be
+            // copied again on its next event.
+            break;
+        }
+        size -= n;
+    }
+    return true;
+}
+
+/** @brief Copy a regular file, with its owner, mode and times */
+bool copyFile(const fs::path& src, const fs::path& tmp)
+{
+    int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+    {
+        return false;
+    }
+
+    struct stat st{};
+    int out = -1;
+    bool result = fstat(in, &st) == 0;
+    if (result)
+    {
+        out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                   st.st_mode & 07777);
+        result = out >= 0;
+    }
+    if (result)
+    {
+        result = copyData(in, out, st.st_size);
+    }
+    if (result)
+    {
+        // The owner can't always be kept, e.g. on filesystems without owners
+        [[maybe_unused]] auto rc = fchown(out, st.st_uid, st.st_gid);
+        const std::array<timespec, 2> times{st.st_atim, st.st_mtim};
+        result = fchmod(out, st.st_mode & 07777) == 0 &&
+                 futimens(out, times.data()) == 0;
+    }
+
+    if (out >= 0 && close(out) < 0)
+    {
+        result = false;
+    }
+    close(in);
+    return result;
+}
+
+/** @brief Atomically replace dst by a copy of the file or symlink src */
+bool copyEntry(const fs::path& src, const fs::path& dst, fs::file_type type)
+{
+    std::error_code ec;
+    fs::create_directories(dst.parent_path(), ec);
 
-            execl("/usr/bin/rsync", "rsync", "-aI", entryPath.c_str(),
-                  dst.c_str(), nullptr);
+    auto tmp = tmpPath(dst);
+    fs::remove(tmp, ec);
 
-            // execl only returns on fail
-            error("Error ({ERRNO}) occurred during the rsync call on {PATH}",
-                  "ERRNO", errno, "PATH", entryPath);
-            return -1;
+    bool result = false;
+    if (type == fs::file_type::symlink)
+    {
+        auto target = fs::read_symlink(src, ec);
+        if (!ec)
+        {
+            fs::create_symlink(target, tmp, ec);
         }
-        else if (mask & IN_DELETE)
+        result = !ec;
+    }
+    else if (type == fs::file_type::regular)
+    {
+        result = copyFile(src, tmp);
+    }
+    else
+    {
+        // Devices, fifos and sockets aren't synced
+        return true;
+    }
+
+    if (result && rename(tmp.c_str(), dst.c_str()) == 0)
+    {
+        return true;
+    }
+
+    error("Error ({ERRNO}) occurred while syncing {PATH}", "ERRNO", errno,
+          "PATH", src);
+    fs::remove(tmp, ec);
+    return false;
+}
+
+/** @brief Create the directory dst with the mode of src */
+bool copyDirectory(const fs::path& src, const fs::path& dst)
+{
+    std::error_code ec;
+    fs::create_directories(dst, ec);
+    if (ec)
+    {
+        error("Error ({ERROR}) occurred while creating {PATH}", "ERROR",
+              ec.message(), "PATH", dst);
+        return false;
+    }
+    fs::permissions(dst, fs::status(src, ec).permissions(), ec);
+    return true;
+}
+
+/** @brief An entry to copy to the alternate rwfs */
+struct Copy
+{
+    fs::path src;
+    fs::path dst;
+    fs::file_type type;
+};
+
+/** @brief Whether two regular files have the same contents */
+bool sameContents(const fs::path& src, const fs::path& dst)
+{
+    std::ifstream a(src, std::ios::binary);
+    std::ifstream b(dst, std::ios::binary);
+    std::array<char, 64 * 1024> bufferA;
+    std::array<char, 64 * 1024> bufferB;
+
+    while (a && b)
+    {
+        a.read(bufferA.data(), bufferA.size());
+        b.read(bufferB.data(), bufferB.size());
+        if (a.gcount() != b.gcount() ||
+            !std::equal(bufferA.begin(), bufferA.begin() + a.gcount(),
+                        bufferB.begin()))
+        {
+            return false;
+        }
+    }
+    return a.eof() && b.eof();
+}
+
+/** @brief Whether the alternate copy of an entry already matches it
+ *  @details Files of the same size and modification time are assumed to
+ *           match. When only the time differs, e.g. because the copy was
+ *           interrupted by a reset before its times were set, the contents
+ *           are compared and the time is fixed instead of writing the file.
+ */
+bool isUpToDate(const Copy& copy)
+{
+    struct stat src{};
+    struct stat dst{};
+    if (lstat(copy.src.c_str(), &src) != 0 ||
+        lstat(copy.dst.c_str(), &dst) != 0 ||
+        (src.st_mode & S_IFMT) != (dst.st_mode & S_IFMT))
+    {
+        return false;
+    }
+
+    if (S_ISLNK(src.st_mode))
+    {
+        std::error_code ec;
+        return fs::read_symlink(copy.src, ec) == fs::read_symlink(copy.dst, ec);
+    }
+    if (!S_ISREG(src.st_mode))
+    {
+        return true;
+    }
+
+    if (src.st_size != dst.st_size || src.st_mode != dst.st_mode ||
+        src.st_uid != dst.st_uid || src.st_gid != dst.st_gid)
+    {
+        return false;
+    }
+    if (src.st_mtim.tv_sec == dst.st_mtim.tv_sec &&
+        src.st_mtim.tv_nsec == dst.st_mtim.tv_nsec)
+    {
+        return true;
+    }
+    if (!sameContents(copy.src, copy.dst))
+    {
+        return false;
+    }
+
+    const std::array<timespec, 2> times{src.st_atim, src.st_mtim};
+    utimensat(AT_FDCWD, copy.dst.c_str(), times.data(), AT_SYMLINK_NOFOLLOW);
+    return true;
+}
+
+/** @brief Remove from the tree dst what the tree src doesn't have */
+void removeStale(const fs::path& src, const fs::path& dst)
+{
+    std::error_code ec;
+    std::vector<fs::path> removed;
+    for (fs::recursive_directory_iterator it(dst, ec), end; !ec && it != end;
+         it.increment(ec))
+    {
+        auto source = src / it->path().lexically_relative(dst);
+        if (!fs::exists(fs::symlink_status(source, ec)))
         {
-            execl("/usr/bin/rsync", "rsync", "-a", "--delete",
-                  entryPath.c_str(), dst.c_str(), nullptr);
-            // execl only returns on fail
-            error(
-                "Error ({ERRNO}) occurred during the rsync delete call on {PATH}",
-                "ERRNO", errno, "PATH", entryPath);
-            return -1;
+            removed.push_back(it->path());
+            it.disable_recursion_pending();
         }
     }
-    else if (pid > 0)
+    for (const auto& path : removed)
     {
-        waitpid(pid, &status, 0);
+        fs::remove_all(path, ec);
+    }
+}
+
+/**
+ * @brief Prepare the sync of an entry of the sync list.
+ * @details Directories are created and what is gone is removed right away,
+ *          the files and symlinks to copy are added to copies.
+ * @param[in] entryPath - The file or directory, which may be gone.
+ * @param[in] altRoot - The root of the alternate copies.
+ * @param[out] copies - The entries to copy.
+ * @return true if successful.
+ */
+bool planEntry(const fs::path& entryPath, const fs::path& altRoot,
+               std::vector<Copy>& copies)
+{
+    auto dst = altRoot / entryPath.relative_path();
+
+    std::error_code ec;
+    auto type = fs::symlink_status(entryPath, ec).type();
+    if (type == fs::file_type::not_found)
+    {
+        fs::remove_all(dst, ec);
+        if (ec)
+        {
+            error("Error ({ERROR}) occurred while removing {PATH}", "ERROR",
+                  ec.message(), "PATH", dst);
+            return false;
+        }
+        return true;
+    }
+    if (type != fs::file_type::directory)
+    {
+        copies.push_back({entryPath, dst, type});
+        return true;
+    }
+
+    bool result = copyDirectory(entryPath, dst);
+    for (fs::recursive_directory_iterator it(entryPath, ec), end;
+         !ec && it != end; it.increment(ec))
+    {
+        auto target = dst / it->path().lexically_relative(entryPath);
+        auto entryType = it->symlink_status(ec).type();
+        if (entryType == fs::file_type::directory)
+        {
+            result = copyDirectory(it->path(), target) && result;
+        }
+        else
+        {
+            copies.push_back({it->path(), std::move(target), entryType});
+        }
+    }
+    removeStale(entryPath, dst);
+    return result;
+}
+
+/**
+ * @brief Copy the entries which differ from their alternate copy.
+ * @param[in] copies - The entries.
+ * @param[in] compare - Whether to skip the entries which already match.
+ * @param[in] threads - The number of threads which copy.
+ * @return The number of entries which were copied and which failed.
+ */
+std::pair<size_t, size_t> runCopies(const std::vector<Copy>& copies,
+                                    bool compare, size_t threads)
+{
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> copied = 0;
+    std::atomic<size_t> failed = 0;
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < copies.size(); i = next++)
+        {
+            const auto& copy = copies[i];
+            if (compare && isUpToDate(copy))
+            {
+                continue;
+            }
+            if (copyEntry(copy.src, copy.dst, copy.type))
+            {
+                copied++;
+            }
+            else
+            {
+                failed++;
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        threads = std::min(threads, copies.size());
+        for (size_t i = 1; i < threads; i++)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+    }
+    return {copied, failed};
+}
+
+/** @brief Make the alternate copies of the entries of a sync list match */
+void reconcileEntries(const fs::path& syncList, const fs::path& altRoot)
+{
+    auto start = Sync::Clock::now();
+
+    std::vector<Copy> copies;
+    size_t failed = 0;
+    for (auto entry : readSyncList(syncList))
+    {
+        if (!entry.has_filename())
+        {
+            entry = entry.parent_path();
+        }
+        if (!planEntry(entry, altRoot, copies))
+        {
+            failed++;
+        }
+    }
+
+    // Most of the time goes to reading the files, so they are compared
+    // from one thread per core
+    auto threads = std::max(std::thread::hardware_concurrency(), 1U);
+    auto [copied, copyFailed] = runCopies(copies, true, threads);
+
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Sync::Clock::now() - start);
+    info("Reconciled {COUNT} files with the alternate rwfs in {TIME_MS} ms, "
+         "{COPIED} copied, {FAILED} failed",
+         "COUNT", copies.size(), "TIME_MS", time.count(), "COPIED", copied,
+         "FAILED", failed + copyFailed);
+}
+
+} // namespace
+
+Sync::Sync(sd_event& loop) :
+    Sync(loop, ALT_RWFS, fs::path(SYNC_LIST_DIR_PATH) / SYNC_LIST_FILE_NAME)
+{}
+
+Sync::Sync(sd_event& loop, fs::path altRoot, fs::path syncList) :
+    loop(loop), altRoot(std::move(altRoot)), syncList(std::move(syncList))
+{
+    reconcileFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (reconcileFd < 0)
+    {
+        auto error = errno;
+        throw std::runtime_error(std::string("eventfd failed, errno=") +
+                                 std::strerror(error));
+    }
+
+    auto rc = sd_event_add_io(&loop, &reconcileSource, reconcileFd, EPOLLIN,
+                              reconcileDoneCallback, this);
+    if (0 > rc)
+    {
+        close(reconcileFd);
+        throw std::runtime_error(
+            std::string("failed to add to event loop, rc=") +
+            std::strerror(-rc));
+    }
+
+    scheduleReconcile(reconcileInterval);
+}
+
+Sync::~Sync()
+{
+    if (reconciler.joinable())
+    {
+        reconciler.join();
+    }
+    flush();
+    sd_event_source_unref(timer);
+    sd_event_source_unref(reconcileTimer);
+    sd_event_source_unref(reconcileSource);
+    close(reconcileFd);
+}
+
+int Sync::processEntry(int mask, const fs::path& entryPath)
+{
+    if (mask & IN_Q_OVERFLOW)
+    {
+        // Events were lost, compare everything once things settled
+        warning("The sync events overflowed, reconciling the alternate rwfs");
+        scheduleReconcile(settleTime);
+        return 0;
+    }
+
+    if (!(mask & (IN_CLOSE_WRITE | IN_DELETE | IN_CREATE | IN_MOVED_FROM |
+                  IN_MOVED_TO)))
+    {
+        return 0;
+    }
+
+    // The entries of directories in the sync list end with a '/'
+    auto path = entryPath;
+    if (!path.has_filename())
+    {
+        path = path.parent_path();
+    }
+
+    lastEvent = Clock::now();
+    pending.try_emplace(path, lastEvent);
+    schedule();
+    return 0;
+}
+
+void Sync::schedule()
+{
+    auto oldest = std::ranges::min(pending | std::views::values);
+    auto deadline = std::min(lastEvent + settleTime, oldest + maxDelay);
+    auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                    deadline.time_since_epoch())
+                    .count();
+
+    // steady_clock is CLOCK_MONOTONIC
+    int rc = 0;
+    if (timer == nullptr)
+    {
+        rc = sd_event_add_time(&loop, &timer, CLOCK_MONOTONIC, usec, 0,
+                               timerCallback, this);
+    }
+    else
+    {
+        rc = sd_event_source_set_time(timer, usec);
+        if (rc >= 0)
+        {
+            rc = sd_event_source_set_enabled(timer, SD_EVENT_ONESHOT);
+        }
+    }
+
+    if (rc < 0)
+    {
+        error("Failed to arm the sync timer: {RC}", "RC", rc);
+        flush();
+    }
+}
+
+int Sync::timerCallback(sd_event_source* /* s */, uint64_t /* usec */,
+                        void* userdata)
+{
+    static_cast<Sync*>(userdata)->flush();
+    return 0;
+}
+
+void Sync::scheduleReconcile(std::chrono::microseconds delay)
+{
+    auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                    (Clock::now() + delay).time_since_epoch())
+                    .count();
+
+    int rc = 0;
+    if (reconcileTimer == nullptr)
+    {
+        rc = sd_event_add_time(&loop, &reconcileTimer, CLOCK_MONOTONIC, usec,
+                               0, reconcileCallback, this);
     }
     else
     {
-        error("Error ({ERRNO}) occurred during fork", "ERRNO", errno);
-        return -1;
+        rc = sd_event_source_set_time(reconcileTimer, usec);
+        if (rc >= 0)
+        {
+            rc = sd_event_source_set_enabled(reconcileTimer, SD_EVENT_ONESHOT);
+        }
+    }
+
+    if (rc < 0)
+    {
+        error("Failed to arm the reconcile timer: {RC}", "RC", rc);
+    }
+}
+
+int Sync::reconcileCallback(sd_event_source* /* s */, uint64_t /* usec */,
+                            void* userdata)
+{
+    static_cast<Sync*>(userdata)->reconcile();
+    return 0;
+}
+
+int Sync::reconcileDoneCallback(sd_event_source* /* s */, int fd,
+                                uint32_t revents, void* userdata)
+{
+    if (!(revents & EPOLLIN))
+    {
+        return 0;
+    }
+
+    uint64_t count = 0;
+    std::ignore = read(fd, &count, sizeof(count));
+
+    auto sync = static_cast<Sync*>(userdata);
+    if (!sync->reconciler.joinable())
+    {
+        return 0;
     }
+    sync->reconciler.join();
 
+    // Events may have been lost again while it ran
+    sync->scheduleReconcile(
+        std::exchange(sync->reconcileAgain, false) ? settleTime
+                                                   : reconcileInterval);
+
+    // The entries which had events meanwhile were held back
+    if (!sync->pending.empty())
+    {
+        sync->schedule();
+    }
     return 0;
 }
 
+void Sync::flush()
+{
+    // Both would write the same files, the entries wait for the
+    // reconciliation to be done
+    if (pending.empty() || reconciler.joinable())
+    {
+        return;
+    }
+
+    auto entries = std::move(pending);
+    pending.clear();
+
+    size_t failed = 0;
+    for (const auto& [path, first] : entries)
+    {
+        if (!syncEntry(path))
+        {
+            failed++;
+        }
+    }
+
+    // The time from the first event of an entry to it being on the
+    // alternate rwfs, reported to the journal for monitoring
+    auto now = Clock::now();
+    auto lag = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - std::ranges::min(entries | std::views::values));
+    info("Synced {COUNT} entries, {FAILED} failed, lag {LAG_MS} ms", "COUNT",
+         entries.size(), "FAILED", failed, "LAG_MS", lag.count());
+    if (lag > maxDelay * 2)
+    {
+        warning("Syncing to the alternate rwfs lags by {LAG_MS} ms", "LAG_MS",
+                lag.count());
+    }
+}
+
+bool Sync::syncEntry(const fs::path& entryPath) const
+{
+    std::vector<Copy> copies;
+    bool result = planEntry(entryPath, altRoot, copies);
+
+    // A file which had an event changed, the files of a directory which
+    // had one may not have
+    std::error_code ec;
+    bool compare = fs::is_directory(fs::symlink_status(entryPath, ec));
+    auto [copied, failed] = runCopies(copies, compare, 1);
+    return result && failed == 0;
+}
+
+void Sync::reconcile()
+{
+    if (reconciler.joinable())
+    {
+        reconcileAgain = true;
+        return;
+    }
+
+    // What is pending is synced first, the events received from now on
+    // wait for the reconciliation
+    flush();
+
+    reconciler = std::jthread([this]() {
+        reconcileEntries(syncList, altRoot);
+
+        // an eventfd write only fails on counter overflow
+        const uint64_t one = 1;
+        std::ignore = write(reconcileFd, &one, sizeof(one));
+    });
+}
+
+bool Sync::isReconciling() const
+{
+    return reconciler.joinable();
+}
+
+std::vector<fs::path> readSyncList()
+{
+    return readSyncList(fs::path(SYNC_LIST_DIR_PATH) / SYNC_LIST_FILE_NAME);
+}
+
+std::vector<fs::path> readSyncList(const fs::path& syncList)
+{
+    std::vector<fs::path> entries;
+
+    std::error_code ec;
+    if (fs::exists(syncList, ec))
+    {
+        std::string line;
+        std::ifstream file(syncList.c_str());
+        while (std::getline(file, line))
+        {
+            if (!line.empty())
+            {
+                entries.emplace_back(line);
+            }
+        }
+    }
+    return entries;
+}
+
 } // namespace manager
 } // namespace software
 } // namespace phosphor
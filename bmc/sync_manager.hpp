@@ -1,6 +1,12 @@
 #pragma once
 
+#include <systemd/sd-event.h>
+
+#include <chrono>
 #include <filesystem>
+#include <map>
+#include <thread>
+#include <vector>
 
 namespace phosphor
 {
@@ -14,27 +20,144 @@ namespace fs = std::filesystem;
 /** @class Sync
  *  @brief Contains filesystem sync functions.
  *  @details The software manager class that contains functions to perform
- *           sync operations.
+ *           sync operations. The events of a path are coalesced until it
+ *           settles, then the path is copied to, or removed from, the
+ *           alternate rwfs in-process. The reconciliation runs on its own
+ *           threads, the events received meanwhile are synced after it.
  */
 class Sync
 {
   public:
-    Sync() = default;
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief How long a path must be quiet before it is synced */
+    static constexpr auto settleTime = std::chrono::milliseconds(100);
+
+    /** @brief The longest a path waits to be synced while it keeps changing */
+    static constexpr auto maxDelay = std::chrono::seconds(1);
+
+    /** @brief How often everything is compared, in case events were missed */
+    static constexpr auto reconcileInterval = std::chrono::hours(1);
+
+    /**
+     * @brief Constructs Sync.
+     * @param[in] loop - The event loop which runs the sync timer.
+     */
+    explicit Sync(sd_event& loop);
+
+    /**
+     * @brief Constructs Sync.
+     * @param[in] loop - The event loop which runs the sync timer.
+     * @param[in] altRoot - Where the alternate copies of the entries go,
+     *                      instead of the alternate rwfs.
+     * @param[in] syncList - The sync list file to reconcile.
+     */
+    Sync(sd_event& loop, fs::path altRoot, fs::path syncList);
+
     Sync(const Sync&) = delete;
     Sync& operator=(const Sync&) = delete;
-    Sync(Sync&&) = default;
-    Sync& operator=(Sync&&) = default;
-    ~Sync() = default;
+    Sync(Sync&&) = delete;
+    Sync& operator=(Sync&&) = delete;
+
+    /** @brief Waits for the reconciliation, then syncs what is pending */
+    ~Sync();
 
     /**
      * @brief Process requested file or directory.
+     * @details The entry is synced once no event was received for it during
+     *          settleTime, or maxDelay after its first event.
      * @param[in] mask - The inotify mask.
      * @param[in] entryPath - The file or directory to process.
      * @param[out] result - 0 if successful.
      */
-    static int processEntry(int mask, const fs::path& entryPath);
+    int processEntry(int mask, const fs::path& entryPath);
+
+    /** @brief Sync all the pending entries now */
+    void flush();
+
+    /**
+     * @brief Start making the alternate copies of all the sync list entries
+     *        match.
+     * @details The trees are walked and the files which differ are copied
+     *          from one thread per core. Files which match aren't written,
+     *          so after an unclean shutdown only what changed is copied.
+     *          It runs off the event loop, which keeps receiving the events
+     *          but holds their sync back until the reconciliation is done.
+     */
+    void reconcile();
+
+    /** @brief Whether a reconciliation is running */
+    bool isReconciling() const;
+
+  private:
+    /** @brief sd-event timer callback, syncs the pending entries */
+    static int timerCallback(sd_event_source* s, uint64_t usec,
+                             void* userdata);
+
+    /** @brief Arm the timer for the next flush */
+    void schedule();
+
+    /** @brief sd-event timer callback, reconciles everything */
+    static int reconcileCallback(sd_event_source* s, uint64_t usec,
+                                 void* userdata);
+
+    /** @brief Arm the timer for the next reconciliation */
+    void scheduleReconcile(std::chrono::microseconds delay);
+
+    /** @brief sd-event callback, the reconciliation is done */
+    static int reconcileDoneCallback(sd_event_source* s, int fd,
+                                     uint32_t revents, void* userdata);
+
+    /**
+     * @brief Make the alternate copy of an entry match its current state.
+     * @param[in] entryPath - The file or directory, which may be gone.
+     * @return true if successful.
+     */
+    bool syncEntry(const fs::path& entryPath) const;
+
+    /** @brief The event loop */
+    sd_event& loop;
+
+    /** @brief The root of the alternate copies */
+    const fs::path altRoot;
+
+    /** @brief The sync list file */
+    const fs::path syncList;
+
+    /** @brief The timer source, created on the first event */
+    sd_event_source* timer = nullptr;
+
+    /** @brief The reconciliation timer source */
+    sd_event_source* reconcileTimer = nullptr;
+
+    /** @brief The entries to sync, and when their first event was received */
+    std::map<fs::path, Clock::time_point> pending;
+
+    /** @brief When the last event was received */
+    Clock::time_point lastEvent;
+
+    /** @brief The eventfd the reconciliation signals its end with */
+    int reconcileFd = -1;
+
+    /** @brief The event source of reconcileFd */
+    sd_event_source* reconcileSource = nullptr;
+
+    /** @brief Set when a reconciliation was asked for while one runs */
+    bool reconcileAgain = false;
+
+    /** @brief Runs the reconciliation, joined once it signaled its end */
+    std::jthread reconciler;
 };
 
+/** @brief Read the files and directories to sync from the sync list */
+std::vector<fs::path> readSyncList();
+
+/**
+ * @brief Read the files and directories to sync from a sync list file
+ * @param[in] syncList - The sync list file.
+ */
+std::vector<fs::path> readSyncList(const fs::path& syncList);
+
 } // namespace manager
 } // namespace software
 } // namespace phosphor
@@ -23,9 +23,16 @@ int main()
     try
     {
         using namespace phosphor::software::manager;
-        auto syncCallback = std::bind(
-            &Sync::processEntry, std::placeholders::_1, std::placeholders::_2);
+        Sync sync(*loop);
+        auto syncCallback =
+            std::bind(&Sync::processEntry, &sync, std::placeholders::_1,
+                      std::placeholders::_2);
         phosphor::software::manager::SyncWatch watch(*loop, syncCallback);
+
+        // The watches are in place, catch up with what changed while the
+        // manager wasn't running. The events are processed meanwhile.
+        sync.reconcile();
+
         bus.attach_event(loop, SD_EVENT_PRIORITY_NORMAL);
         sd_event_loop(loop);
     }
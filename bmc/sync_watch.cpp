@@ -2,13 +2,14 @@
 
 #include "sync_watch.hpp"
 
+#include "sync_manager.hpp"
+
 #include <sys/inotify.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 
 #include <filesystem>
-#include <fstream>
 #include <system_error>
 
 namespace phosphor
@@ -22,8 +23,17 @@ PHOSPHOR_LOG2_USING;
 
 void SyncWatch::addInotifyWatch(const fs::path& path)
 {
-    auto wd =
-        inotify_add_watch(inotifyFd, path.c_str(), IN_CLOSE_WRITE | IN_DELETE);
+    std::error_code ec;
+    bool isDirectory = fs::is_directory(fs::symlink_status(path, ec));
+
+    // Files are also replaced by renaming new ones over them
+    uint32_t mask = IN_CLOSE_WRITE | IN_DELETE;
+    if (isDirectory)
+    {
+        mask |= IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO;
+    }
+
+    auto wd = inotify_add_watch(inotifyFd, path.c_str(), mask);
     if (-1 == wd)
     {
         error("inotify_add_watch on {PATH} failed: {ERRNO}", "ERRNO", errno,
@@ -32,10 +42,30 @@ void SyncWatch::addInotifyWatch(const fs::path& path)
     }
 
     fileMap[wd] = fs::path(path);
+
+    // inotify watches aren't recursive, watch the subdirectories too
+    if (isDirectory)
+    {
+        for (fs::directory_iterator it(path, ec), end; !ec && it != end;
+             it.increment(ec))
+        {
+            if (it->is_directory(ec) && !it->is_symlink(ec))
+            {
+                addInotifyWatch(it->path());
+            }
+        }
+    }
 }
 
 SyncWatch::SyncWatch(sd_event& loop,
                      std::function<int(int, fs::path&)> syncCallback) :
+    SyncWatch(loop, std::move(syncCallback),
+              fs::path(SYNC_LIST_DIR_PATH) / SYNC_LIST_FILE_NAME)
+{}
+
+SyncWatch::SyncWatch(sd_event& loop,
+                     std::function<int(int, fs::path&)> syncCallback,
+                     const fs::path& syncList) :
     inotifyFd(-1), syncCallback(std::move(syncCallback))
 {
     auto fd = inotify_init1(IN_NONBLOCK);
@@ -53,16 +83,9 @@ SyncWatch::SyncWatch(sd_event& loop,
         return;
     }
 
-    std::error_code ec;
-    auto syncfile = fs::path(SYNC_LIST_DIR_PATH) / SYNC_LIST_FILE_NAME;
-    if (fs::exists(syncfile, ec))
+    for (const auto& entry : readSyncList(syncList))
     {
-        std::string line;
-        std::ifstream file(syncfile.c_str());
-        while (std::getline(file, line))
-        {
-            addInotifyWatch(line);
-        }
+        addInotifyWatch(entry);
     }
 }
 
@@ -82,8 +105,8 @@ int SyncWatch::callback(sd_event_source* /* s */, int fd, uint32_t revents,
         return 0;
     }
 
-    constexpr auto maxBytes = 1024;
-    uint8_t buffer[maxBytes];
+    constexpr auto maxBytes = 4096;
+    alignas(inotify_event) uint8_t buffer[maxBytes];
     auto bytes = read(fd, buffer, maxBytes);
     if (0 > bytes)
     {
@@ -96,31 +119,57 @@ int SyncWatch::callback(sd_event_source* /* s */, int fd, uint32_t revents,
     {
         auto event = reinterpret_cast<inotify_event*>(&buffer[offset]);
 
+        offset += offsetof(inotify_event, name) + event->len;
+
         // Watch was removed, re-add it if file still exists.
         if (event->mask & IN_IGNORED)
         {
             std::error_code ec;
-            if (fs::exists(syncWatch->fileMap[event->wd], ec))
+            auto path = syncWatch->fileMap[event->wd];
+            syncWatch->fileMap.erase(event->wd);
+            if (fs::exists(path, ec))
             {
-                syncWatch->addInotifyWatch(syncWatch->fileMap[event->wd]);
+                syncWatch->addInotifyWatch(path);
+
+                // It was replaced by renaming another file over it, which
+                // is only seen by the watch of the directory, if any
+                auto rc = syncWatch->syncCallback(IN_MOVED_TO, path);
+                if (rc)
+                {
+                    return rc;
+                }
             }
             else
             {
                 info("The inotify watch on {PATH} was removed", "PATH",
-                     syncWatch->fileMap[event->wd]);
+                     path);
             }
-            return 0;
+            continue;
         }
 
-        // fileMap<wd, path>
-        auto rc = syncWatch->syncCallback(static_cast<int>(event->mask),
-                                          syncWatch->fileMap[event->wd]);
+        // The queue overflowed and isn't about a watch
+        fs::path path;
+        if (!(event->mask & IN_Q_OVERFLOW))
+        {
+            // fileMap<wd, path>, events of directories name the entry
+            path = syncWatch->fileMap[event->wd];
+            if (event->len > 0)
+            {
+                path /= event->name;
+            }
+        }
+
+        if ((event->mask & IN_ISDIR) &&
+            (event->mask & (IN_CREATE | IN_MOVED_TO)))
+        {
+            syncWatch->addInotifyWatch(path);
+        }
+
+        auto rc = syncWatch->syncCallback(static_cast<int>(event->mask), path);
         if (rc)
         {
             return rc;
         }
-
-        offset += offsetof(inotify_event, name) + event->len;
     }
 
     return 0;
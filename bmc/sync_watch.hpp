@@ -33,6 +33,16 @@ class SyncWatch
      */
     SyncWatch(sd_event& loop, std::function<int(int, fs::path&)> syncCallback);
 
+    /** @brief ctor - hook inotify watch with sd-event
+     *
+     *  @param[in] loop - sd-event object
+     *  @param[in] syncCallback - The callback function for processing
+     *                            files
+     *  @param[in] syncList - The sync list file of the entries to watch
+     */
+    SyncWatch(sd_event& loop, std::function<int(int, fs::path&)> syncCallback,
+              const fs::path& syncList);
+
     SyncWatch(const SyncWatch&) = delete;
     SyncWatch& operator=(const SyncWatch&) = delete;
     SyncWatch(SyncWatch&&) = default;
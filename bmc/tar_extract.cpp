@@ -0,0 +1,812 @@
+#include "tar_extract.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace phosphor::software::utils
+{
+
+namespace // anonymous
+{
+
+constexpr size_t blockSize = 512;
+
+// File contents are copied through a buffer of this size
+constexpr size_t copyBufferSize = 64 * 1024;
+
+// The largest pax header or GNU long name which is accepted
+constexpr size_t maxExtensionSize = 64 * 1024;
+
+struct Field
+{
+    size_t offset;
+    size_t length;
+};
+
+// The ustar header fields which are used
+constexpr Field nameField{0, 100};
+constexpr Field modeField{100, 8};
+constexpr Field sizeField{124, 12};
+constexpr Field checksumField{148, 8};
+constexpr size_t typeOffset = 156;
+constexpr Field magicField{257, 6};
+constexpr Field prefixField{345, 155};
+
+using Block = std::array<uint8_t, blockSize>;
+
+/** @brief Read until size bytes were read or the end of the file */
+ssize_t readFull(int fd, uint8_t* data, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+bool writeFull(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, data, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+/** @brief Reads the archive from the file descriptor, inflating it when it is
+ *         gzip compressed as tar -z would */
+class Source
+{
+  public:
+    Source(int fd, bool release) :
+        fd(fd), input(copyBufferSize), release(release)
+    {}
+
+    ~Source()
+    {
+        if (gzip)
+        {
+            inflateEnd(&stream);
+        }
+    }
+
+    Source(const Source&) = delete;
+    Source& operator=(const Source&) = delete;
+    Source(Source&&) = delete;
+    Source& operator=(Source&&) = delete;
+
+    /** @brief Read until size bytes were read or the end of the archive
+     *  @param[out] done - The number of bytes read.
+     *  @return none, or why the read failed
+     */
+    TarError read(uint8_t* data, size_t size, size_t& done);
+
+    /** @brief The errno of the last failed read */
+    int errnum = 0;
+
+  private:
+    /** @brief Read more of the file into the empty input buffer
+     *  @return The number of bytes read, 0 at the end of the file.
+     */
+    ssize_t fill();
+
+    /** @brief Check the first bytes of the file for the gzip magic */
+    TarError start();
+
+    /** @brief Free the storage of the part of the file which was read */
+    void releaseRead(size_t n);
+
+    const int fd;
+    std::vector<uint8_t> input;
+    size_t inputBegin = 0;
+    size_t inputEnd = 0;
+
+    /** @brief Whether the file is consumed while it is read */
+    bool release;
+    off_t offset = 0;
+    off_t released = 0;
+
+    bool started = false;
+    bool gzip = false;
+    bool streamEnd = false;
+    z_stream stream{};
+};
+
+ssize_t Source::fill()
+{
+    while (true)
+    {
+        ssize_t n =
+            ::read(fd, input.data() + inputEnd, input.size() - inputEnd);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            errnum = errno;
+        }
+        else
+        {
+            inputEnd += n;
+            releaseRead(n);
+        }
+        return n;
+    }
+}
+
+void Source::releaseRead(size_t n)
+{
+    offset += static_cast<off_t>(n);
+    if (!release)
+    {
+        return;
+    }
+
+    // Whole buffers only, to punch a few large holes rather than many
+    constexpr auto chunk = static_cast<off_t>(copyBufferSize);
+    const off_t end = offset / chunk * chunk;
+    if (end <= released)
+    {
+        return;
+    }
+
+    // Not supported by every filesystem, the file is then kept whole
+    if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, released,
+                  end - released) != 0)
+    {
+        release = false;
+        return;
+    }
+    released = end;
+}
+
+TarError Source::start()
+{
+    started = true;
+
+    // The holes are punched relative to where the archive starts
+    if (release)
+    {
+        offset = released = lseek(fd, 0, SEEK_CUR);
+        release = (offset >= 0);
+    }
+
+    constexpr std::array<uint8_t, 2> gzipMagic = {0x1f, 0x8b};
+    while (inputEnd < gzipMagic.size())
+    {
+        ssize_t n = fill();
+        if (n < 0)
+        {
+            return TarError::readFailed;
+        }
+        if (n == 0)
+        {
+            return TarError::none;
+        }
+    }
+
+    if (std::equal(gzipMagic.begin(), gzipMagic.end(), input.begin()))
+    {
+        // 16 selects the gzip wrapper over the zlib one
+        if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        {
+            return TarError::badCompression;
+        }
+        gzip = true;
+    }
+    return TarError::none;
+}
+
+TarError Source::read(uint8_t* data, size_t size, size_t& done)
+{
+    done = 0;
+
+    if (!started)
+    {
+        auto error = start();
+        if (error != TarError::none)
+        {
+            return error;
+        }
+    }
+
+    if (!gzip)
+    {
+        // what was read to look for the magic
+        const size_t buffered = std::min(size, inputEnd - inputBegin);
+        std::copy_n(input.begin() + inputBegin, buffered, data);
+        inputBegin += buffered;
+        done = buffered;
+
+        const ssize_t n = readFull(fd, data + done, size - done);
+        if (n < 0)
+        {
+            errnum = errno;
+            return TarError::readFailed;
+        }
+        done += n;
+        releaseRead(n);
+        return TarError::none;
+    }
+
+    while (done < size && !streamEnd)
+    {
+        if (inputBegin == inputEnd)
+        {
+            inputBegin = inputEnd = 0;
+            ssize_t n = fill();
+            if (n < 0)
+            {
+                return TarError::readFailed;
+            }
+            if (n == 0)
+            {
+                // a truncated stream, the archive is too short
+                break;
+            }
+        }
+
+        stream.next_in = input.data() + inputBegin;
+        stream.avail_in = static_cast<uInt>(inputEnd - inputBegin);
+        stream.next_out = data + done;
+        stream.avail_out = static_cast<uInt>(
+            std::min<size_t>(size - done, std::numeric_limits<uInt>::max()));
+
+        const uInt availOut = stream.avail_out;
+        const int rc = inflate(&stream, Z_NO_FLUSH);
+
+        inputBegin = inputEnd - stream.avail_in;
+        done += availOut - stream.avail_out;
+
+        if (rc == Z_STREAM_END)
+        {
+            streamEnd = true;
+        }
+        else if (rc != Z_OK && rc != Z_BUF_ERROR)
+        {
+            return TarError::badCompression;
+        }
+    }
+    return TarError::none;
+}
+
+std::string_view getString(const Block& block, Field field)
+{
+    const char* begin =
+        reinterpret_cast<const char*>(block.data() + field.offset);
+    return {begin, strnlen(begin, field.length)};
+}
+
+/** @brief Parse an octal header field, or the GNU base-256 encoding used for
+ *         values which do not fit */
+std::optional<uint64_t> getNumber(const Block& block, Field field)
+{
+    const uint8_t* data = block.data() + field.offset;
+
+    if ((data[0] & 0x80) != 0)
+    {
+        // negative values are never valid here
+        if ((data[0] & 0x40) != 0)
+        {
+            return std::nullopt;
+        }
+        uint64_t value = data[0] & 0x3f;
+        for (size_t i = 1; i < field.length; i++)
+        {
+            if ((value >> 56) != 0)
+            {
+                return std::nullopt;
+            }
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < field.length && data[i] == ' ')
+    {
+        i++;
+    }
+
+    const size_t first = i;
+    uint64_t value = 0;
+    for (; i < field.length && data[i] >= '0' && data[i] <= '7'; i++)
+    {
+        if ((value >> 61) != 0)
+        {
+            return std::nullopt;
+        }
+        value = (value << 3) | (data[i] - '0');
+    }
+
+    // the digits are terminated by a space or a NUL
+    if (i == first || (i < field.length && data[i] != ' ' && data[i] != '\0'))
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool checksumMatches(const Block& block)
+{
+    auto expected = getNumber(block, checksumField);
+    if (!expected)
+    {
+        return false;
+    }
+
+    // The checksum is taken with its own field set to spaces. Some old
+    // archivers summed signed chars, which tar accepts as well.
+    uint64_t unsignedSum = 0;
+    int64_t signedSum = 0;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        const bool inField = i >= checksumField.offset &&
+                             i < checksumField.offset + checksumField.length;
+        const uint8_t c = inField ? ' ' : block[i];
+        unsignedSum += c;
+        signedSum += static_cast<int8_t>(c);
+    }
+    return *expected == unsignedSum ||
+           static_cast<int64_t>(*expected) == signedSum;
+}
+
+bool isZero(const Block& block)
+{
+    return std::ranges::all_of(block, [](uint8_t b) { return b == 0; });
+}
+
+/** @brief Convert an archive member name to a relative path
+ *  @return The path, empty for the archive root, or nullopt if the name is
+ *          absolute or climbs out of the extraction directory.
+ */
+std::optional<fs::path> sanitizePath(std::string_view name)
+{
+    if (name.empty() || name.front() == '/' ||
+        name.find('\0') != std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+
+    fs::path path;
+    while (!name.empty())
+    {
+        const size_t slash = name.find('/');
+        const std::string_view component = name.substr(0, slash);
+        name = (slash == std::string_view::npos) ? std::string_view{}
+                                                 : name.substr(slash + 1);
+
+        if (component.empty() || component == ".")
+        {
+            continue;
+        }
+        if (component == "..")
+        {
+            return std::nullopt;
+        }
+        path /= component;
+    }
+    return path;
+}
+
+/** @brief Sequentially extracts the members of one archive */
+class Extractor
+{
+  public:
+    Extractor(int fd, const fs::path& extractDir, bool releaseInput,
+              TarObserver* observer) :
+        source(fd, releaseInput), extractDir(extractDir), observer(observer),
+        buffer(copyBufferSize)
+    {}
+
+    TarResult run();
+
+  private:
+    /** @brief The header fields overridden by pax or GNU extensions */
+    struct Overrides
+    {
+        std::optional<std::string> name;
+        std::optional<uint64_t> size;
+    };
+
+    TarResult fail(TarError error, int errnum = 0)
+    {
+        return {error, name, errnum};
+    }
+
+    /** @brief Read the data of an entry, with its padding, passing the data
+     *         in chunks to sink, which returns false to abort. */
+    template <typename Sink>
+    TarResult readData(uint64_t size, Sink&& sink);
+
+    TarResult readExtension(uint64_t size, std::string& data);
+    TarResult parsePax(const std::string& data);
+    TarResult extractFile(const fs::path& relative, uint64_t size,
+                          mode_t mode);
+
+    Source source;
+    const fs::path& extractDir;
+    TarObserver* const observer;
+    std::vector<uint8_t> buffer;
+
+    std::string name;
+    Overrides overrides;
+};
+
+template <typename Sink>
+TarResult Extractor::readData(uint64_t size, Sink&& sink)
+{
+    if (size > std::numeric_limits<uint64_t>::max() - blockSize)
+    {
+        return fail(TarError::badHeader);
+    }
+    uint64_t remaining = (size + blockSize - 1) / blockSize * blockSize;
+
+    while (remaining > 0)
+    {
+        const size_t chunk =
+            static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+
+        size_t n = 0;
+        auto error = source.read(buffer.data(), chunk, n);
+        if (error != TarError::none)
+        {
+            return fail(error, source.errnum);
+        }
+        if (n != chunk)
+        {
+            return fail(TarError::truncated);
+        }
+
+        // strip the padding of the last block
+        const size_t used =
+            static_cast<size_t>(std::min<uint64_t>(chunk, size));
+        size -= used;
+        remaining -= chunk;
+
+        if (used > 0 && !sink(buffer.data(), used))
+        {
+            return fail(TarError::writeFailed, errno);
+        }
+    }
+    return {};
+}
+
+TarResult Extractor::readExtension(uint64_t size, std::string& data)
+{
+    if (size > maxExtensionSize)
+    {
+        return fail(TarError::badHeader);
+    }
+
+    data.clear();
+    return readData(size, [&data](const uint8_t* chunk, size_t length) {
+        data.append(reinterpret_cast<const char*>(chunk), length);
+        return true;
+    });
+}
+
+TarResult Extractor::parsePax(const std::string& data)
+{
+    // records of "<length> <key>=<value>\n", the length counting the record
+    std::string_view records = data;
+    while (!records.empty())
+    {
+        size_t length = 0;
+        auto [end, ec] = std::from_chars(
+            records.data(), records.data() + records.size(), length);
+        const size_t keyOffset = end - records.data() + 1;
+        if (ec != std::errc() || keyOffset >= length ||
+            length > records.size() || *end != ' ' ||
+            records[length - 1] != '\n')
+        {
+            return fail(TarError::badHeader);
+        }
+
+        const std::string_view record =
+            records.substr(keyOffset, length - keyOffset - 1);
+        records.remove_prefix(length);
+
+        const size_t equals = record.find('=');
+        if (equals == std::string_view::npos)
+        {
+            return fail(TarError::badHeader);
+        }
+        const std::string_view key = record.substr(0, equals);
+        const std::string_view value = record.substr(equals + 1);
+
+        if (key == "path")
+        {
+            overrides.name = std::string(value);
+        }
+        else if (key == "size")
+        {
+            uint64_t size = 0;
+            auto [sizeEnd, sizeEc] = std::from_chars(
+                value.data(), value.data() + value.size(), size);
+            if (sizeEc != std::errc() || sizeEnd != value.data() + value.size())
+            {
+                return fail(TarError::badHeader);
+            }
+            overrides.size = size;
+        }
+    }
+    return {};
+}
+
+TarResult Extractor::extractFile(const fs::path& relative, uint64_t size,
+                                 mode_t mode)
+{
+    int out = -1;
+    if (!observer || observer->extract(relative))
+    {
+        const fs::path path = extractDir / relative;
+
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        if (ec)
+        {
+            return fail(TarError::writeFailed, ec.value());
+        }
+
+        // Nothing extracted can be a symlink, refuse to follow one regardless
+        out = open(path.c_str(),
+                   O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, mode);
+        if (out < 0)
+        {
+            return fail(TarError::writeFailed, errno);
+        }
+    }
+
+    if (observer)
+    {
+        observer->begin(relative);
+    }
+
+    bool rejected = false;
+    auto result = readData(
+        size, [this, out, &rejected](const uint8_t* data, size_t length) {
+            if (out >= 0 && !writeFull(out, data, length))
+            {
+                return false;
+            }
+            if (observer && !observer->update({data, length}))
+            {
+                rejected = true;
+                return false;
+            }
+            return true;
+        });
+    if (rejected)
+    {
+        result = fail(TarError::rejected);
+    }
+
+    if (out >= 0 && close(out) < 0 && result)
+    {
+        return fail(TarError::writeFailed, errno);
+    }
+    if (result && observer && !observer->end())
+    {
+        return fail(TarError::rejected);
+    }
+    return result;
+}
+
+TarResult Extractor::run()
+{
+    Block header;
+    std::string extension;
+
+    while (true)
+    {
+        size_t n = 0;
+        auto error = source.read(header.data(), header.size(), n);
+        if (error != TarError::none)
+        {
+            return fail(error, source.errnum);
+        }
+        if (n != header.size())
+        {
+            // the archive ends with zero blocks, not with the file
+            return fail(TarError::truncated);
+        }
+
+        if (isZero(header))
+        {
+            if (overrides.name || overrides.size)
+            {
+                return fail(TarError::truncated);
+            }
+            return {};
+        }
+
+        if (!checksumMatches(header))
+        {
+            return fail(TarError::badChecksum);
+        }
+
+        auto size = getNumber(header, sizeField);
+        if (!size)
+        {
+            return fail(TarError::badHeader);
+        }
+        const char type = static_cast<char>(header[typeOffset]);
+
+        name = getString(header, nameField);
+        // only POSIX ustar has a prefix, GNU uses the space for other fields
+        const std::string_view magic = getString(header, magicField);
+        if (magic == "ustar" && header[magicField.offset + 5] == '\0')
+        {
+            const std::string_view prefix = getString(header, prefixField);
+            if (!prefix.empty())
+            {
+                name = std::string(prefix) + "/" + name;
+            }
+        }
+
+        // extensions describing the next entry
+        if (type == 'x' || type == 'L')
+        {
+            auto result = readExtension(*size, extension);
+            if (!result)
+            {
+                return result;
+            }
+            if (type == 'L')
+            {
+                overrides.name = extension.substr(0, extension.find('\0'));
+                continue;
+            }
+            result = parsePax(extension);
+            if (!result)
+            {
+                return result;
+            }
+            continue;
+        }
+
+        // global pax headers and GNU long link names don't affect what is
+        // extracted
+        if (type == 'g' || type == 'K')
+        {
+            auto result = readExtension(*size, extension);
+            if (!result)
+            {
+                return result;
+            }
+            continue;
+        }
+
+        if (overrides.name)
+        {
+            name = *overrides.name;
+        }
+        if (overrides.size)
+        {
+            size = overrides.size;
+        }
+        overrides = {};
+
+        const bool isDirectory =
+            type == '5' ||
+            ((type == '0' || type == '\0') && name.ends_with('/'));
+        const bool isFile =
+            !isDirectory && (type == '0' || type == '\0' || type == '7');
+        if (!isDirectory && !isFile)
+        {
+            return fail(TarError::unsupportedType);
+        }
+
+        auto relative = sanitizePath(name);
+        if (!relative || (relative->empty() && isFile))
+        {
+            return fail(TarError::unsafePath);
+        }
+
+        if (isDirectory)
+        {
+            std::error_code ec;
+            fs::create_directories(extractDir / *relative, ec);
+            if (ec)
+            {
+                return fail(TarError::writeFailed, ec.value());
+            }
+
+            // directories have no data, but skip it if there is some
+            auto result = readData(
+                *size, [](const uint8_t*, size_t) { return true; });
+            if (!result)
+            {
+                return result;
+            }
+            continue;
+        }
+
+        auto mode = getNumber(header, modeField);
+        auto result = extractFile(
+            *relative, *size, mode ? static_cast<mode_t>(*mode & 0777) : 0644);
+        if (!result)
+        {
+            return result;
+        }
+    }
+}
+
+} // namespace
+
+std::string_view toString(TarError error)
+{
+    switch (error)
+    {
+        case TarError::none:
+            return "none";
+        case TarError::readFailed:
+            return "read failed";
+        case TarError::truncated:
+            return "truncated archive";
+        case TarError::badChecksum:
+            return "header checksum mismatch";
+        case TarError::badHeader:
+            return "malformed header";
+        case TarError::badCompression:
+            return "corrupt compressed data";
+        case TarError::unsafePath:
+            return "unsafe path";
+        case TarError::unsupportedType:
+            return "unsupported entry type";
+        case TarError::writeFailed:
+            return "write failed";
+        case TarError::rejected:
+            return "rejected by the observer";
+    }
+    return "unknown";
+}
+
+TarResult extractTar(int fd, const fs::path& extractDir, bool releaseInput,
+                     TarObserver* observer)
+{
+    Extractor extractor(fd, extractDir, releaseInput, observer);
+    return extractor.run();
+}
+
+} // namespace phosphor::software::utils
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace phosphor::software::utils
+{
+
+namespace fs = std::filesystem;
+
+/** @brief The reasons an archive could not be extracted */
+enum class TarError
+{
+    none,
+    readFailed,
+    truncated,
+    badChecksum,
+    badHeader,
+    badCompression,
+    unsafePath,
+    unsupportedType,
+    writeFailed,
+    rejected,
+};
+
+/** @struct TarResult
+ *  @brief The outcome of extracting an archive.
+ */
+struct TarResult
+{
+    /** @brief Why the extraction stopped, none on success */
+    TarError error = TarError::none;
+
+    /** @brief The name of the entry being extracted when it failed */
+    std::string entry;
+
+    /** @brief The errno of a failed read or write, 0 otherwise */
+    int errnum = 0;
+
+    explicit operator bool() const
+    {
+        return error == TarError::none;
+    }
+};
+
+/** @class TarObserver
+ *  @brief Sees the contents of the regular files while they are extracted.
+ */
+class TarObserver
+{
+  public:
+    virtual ~TarObserver() = default;
+
+    /** @brief Called first for each regular file, to know where it goes
+     *  @param[in] path - The path of the file in the extraction directory.
+     *  @return false if the observer consumes the data of the file itself,
+     *          the file is then not written to the extraction directory.
+     */
+    virtual bool extract(const fs::path& /*path*/)
+    {
+        return true;
+    }
+
+    /** @brief Called before the data of a file is read
+     *  @param[in] path - The path of the file in the extraction directory.
+     */
+    virtual void begin(const fs::path& path) = 0;
+
+    /** @brief Called with each chunk of the data of the file
+     *  @param[in] data - The next bytes of the file.
+     *  @return false to fail the extraction.
+     */
+    virtual bool update(std::span<const uint8_t> data) = 0;
+
+    /** @brief Called once the file was completely written and closed
+     *  @return false to fail the extraction.
+     */
+    virtual bool end() = 0;
+};
+
+/** @brief Get a printable name of a tar error
+ *  @param[in] error - The error.
+ *  @return The name of the error.
+ */
+std::string_view toString(TarError error);
+
+/** @brief Extract a ustar, pax or GNU tar archive, optionally gzip compressed.
+ *  @details The archive is read sequentially from the current offset of the
+ *           file descriptor, so it may also be a pipe or a socket, and the
+ *           files are written as they are read through a fixed size buffer.
+ *           Only regular files and directories are extracted. Links, devices
+ *           and any entry which would land outside of extractDir fail the
+ *           extraction, since the upload directory holds untrusted images.
+ *  @param[in] fd - The file descriptor to read the archive from.
+ *  @param[in] extractDir - The existing destination directory.
+ *  @param[in] releaseInput - Punch holes in the archive file behind the read
+ *                            offset, so that an archive in tmpfs and its
+ *                            extracted files don't take twice the memory.
+ *                            The file must be writable and is useless after.
+ *  @param[in] observer - Optionally sees the files as they are extracted,
+ *                        and may consume some instead.
+ *  @return The result of the extraction.
+ */
+TarResult extractTar(int fd, const fs::path& extractDir,
+                     bool releaseInput = false,
+                     TarObserver* observer = nullptr);
+
+} // namespace phosphor::software::utils
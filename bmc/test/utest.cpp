@@ -1,17 +1,40 @@
 #include "config.h"
 
+#include "flash_delta.hpp"
+#include "image_digests.hpp"
+#include "image_manager.hpp"
 #include "image_verify.hpp"
+#include "serialize.hpp"
+#include "sync_manager.hpp"
+#include "sync_watch.hpp"
+#include "tar_extract.hpp"
 #include "utils.hpp"
 #include "version.hpp"
 
+#include <fcntl.h>
 #include <openssl/evp.h>
 #include <stdlib.h>
-
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <systemd/sd-event.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -20,6 +43,8 @@ using namespace phosphor::software::manager;
 using namespace phosphor::software::image;
 
 namespace fs = std::filesystem;
+namespace softwareUtils = phosphor::software::utils;
+using phosphor::software::updater::ReleaseCache;
 
 class VersionTest : public testing::Test
 {
@@ -99,6 +124,26 @@ TEST_F(VersionTest, TestGetValueWithCRLF)
     EXPECT_EQ(Version::getValue(manifestFilePath, "purpose"), purpose);
 }
 
+/** @brief Make sure a parsed manifest keeps repeated keys in order*/
+TEST(ManifestTest, TestParse)
+{
+    Manifest manifest("version=test-version\r\n"
+                      "not a key\n"
+                      "CompatibleName=foo.bar\n"
+                      "SHA512_Hash_Type=SHA512,ML-DSA-87\n"
+                      "CompatibleName=baz.bim\n"
+                      "ExtendedVersion=a=b");
+
+    EXPECT_EQ(manifest.getValue("version"), "test-version");
+    EXPECT_EQ(manifest.getValue("ExtendedVersion"), "a=b");
+    EXPECT_EQ(manifest.getValue("purpose"), "");
+    EXPECT_EQ(manifest.getRepeatedValues("CompatibleName"),
+              (std::vector<std::string>{"foo.bar", "baz.bim"}));
+
+    ASSERT_EQ(manifest.getEntries().size(), 5);
+    EXPECT_EQ(manifest.getEntries()[2].first, "SHA512_Hash_Type");
+}
+
 TEST_F(VersionTest, TestGetVersionWithQuotes)
 {
     auto releasePath = _directory + "/" + "os-release";
@@ -286,6 +331,14 @@ TEST_F(SignatureTest, TestSignatureVerify)
     EXPECT_TRUE(signature->verify());
 }
 
+/** @brief Test failure scenario with a missing image file*/
+TEST_F(SignatureTest, TestMissingImageFile)
+{
+    std::string rwfsFile = extractPath.string() + "/" + "image-rwfs";
+    command("rm " + rwfsFile);
+    EXPECT_FALSE(signature->verify());
+}
+
 /** @brief Test failure scenario with corrupted signature file*/
 TEST_F(SignatureTest, TestCorruptSignatureFile)
 {
@@ -321,6 +374,21 @@ TEST_F(SignatureTest, TestNoConfigFileInSystem)
     EXPECT_FALSE(signature->verify());
 }
 
+/** @brief Test failure scenario with a replaced system key*/
+TEST_F(SignatureTest, TestReplacedSystemKey)
+{
+    EXPECT_TRUE(signature->verify());
+
+    // The key parsed by the first verification must not be used anymore
+    std::string otherKeyFile = extractPath.string() + "/" + "other.pem";
+    command("openssl genrsa  -out " + otherKeyFile + " 4096");
+    command("openssl rsa -in " + otherKeyFile + " -outform PEM " +
+            "-pubout -out " + signedConfOpenBMCPath.string() + "/publickey");
+
+    signature = std::make_unique<Signature>(extractPath, signedConfPath);
+    EXPECT_FALSE(signature->verify());
+}
+
 #ifdef WANT_SIGNATURE_VERIFY
 /** @brief Test for failure scenario without full verification */
 TEST_F(SignatureTest, TestNoFullSignature)
@@ -351,6 +419,115 @@ TEST_F(SignatureTest, TestNoFullSignatureForBIOS)
 }
 #endif
 
+/** @brief Test the verification of a file which was streamed elsewhere*/
+TEST_F(SignatureTest, TestVerifyFileDigest)
+{
+    EXPECT_TRUE(signature->verifyMetadata());
+    EXPECT_EQ(signature->getHashType(), "RSA-SHA256");
+
+    std::string rofs = "image-rofs file \n";
+    ImageDigests::Digest digest(EVP_MAX_MD_SIZE);
+    unsigned int size = 0;
+    ASSERT_EQ(EVP_Digest(rofs.data(), rofs.size(), digest.data(), &size,
+                         EVP_sha256(), nullptr),
+              1);
+    digest.resize(size);
+    EXPECT_TRUE(signature->verifyFileDigest("image-rofs", digest));
+
+    digest[0] ^= 1;
+    EXPECT_FALSE(signature->verifyFileDigest("image-rofs", digest));
+    EXPECT_FALSE(signature->verifyFileDigest("image-bmc", digest));
+}
+
+/** @brief Test that the metadata is verified before anything is streamed*/
+TEST_F(SignatureTest, TestVerifyMetadataCorruptManifest)
+{
+    std::string manifestFile = extractPath.string() + "/" + "MANIFEST";
+    command("echo \"MachineName=other\" >> " + manifestFile);
+
+    signature = std::make_unique<Signature>(extractPath, signedConfPath);
+    EXPECT_FALSE(signature->verifyMetadata());
+}
+
+/** @brief Signature tests on an image extracted from a tarball, with the
+ *         digests computed during the extraction */
+class ExtractedSignatureTest : public SignatureTest
+{
+  protected:
+    void SetUp() override
+    {
+        SignatureTest::SetUp();
+
+        // The MANIFEST goes first, as in the images from the build
+        fs::path tarball = extractPath.parent_path() / "image.tar";
+        command("cd " + extractPath.string() + " && tar -cf " +
+                tarball.string() + " MANIFEST $(ls -A | grep -v '^MANIFEST$')");
+
+        imagePath = extractPath.parent_path() / "extracted";
+        fs::create_directories(imagePath);
+
+        DigestCollector collector(imagePath);
+        int fd = open(tarball.c_str(), O_RDONLY);
+        ASSERT_TRUE(
+            softwareUtils::extractTar(fd, imagePath, false, &collector));
+        close(fd);
+        DigestStore::instance().add(imagePath, collector.takeDigests());
+
+        signature = std::make_unique<Signature>(imagePath, signedConfPath);
+    }
+
+    void TearDown() override
+    {
+        DigestStore::instance().erase(imagePath);
+        SignatureTest::TearDown();
+    }
+
+    fs::path imagePath;
+};
+
+/** @brief Test for success scenario using the digests*/
+TEST_F(ExtractedSignatureTest, TestSignatureVerify)
+{
+    auto digests = DigestStore::instance().find(imagePath);
+    ASSERT_NE(digests, nullptr);
+    EXPECT_NE(digests->find(imagePath, "image-rofs", "RSA-SHA256"), nullptr);
+    EXPECT_NE(digests->find(imagePath, "MANIFEST", "RSA-SHA256"), nullptr);
+    EXPECT_TRUE(signature->verify());
+}
+
+/** @brief Test that the digests are verified instead of the files*/
+TEST_F(ExtractedSignatureTest, TestWrongDigest)
+{
+    auto digests = *DigestStore::instance().find(imagePath);
+    digests.add("image-rofs", "RSA-SHA256", ImageDigests::Digest(32));
+    DigestStore::instance().add(imagePath, std::move(digests));
+
+    signature = std::make_unique<Signature>(imagePath, signedConfPath);
+    EXPECT_FALSE(signature->verify());
+}
+
+/** @brief Test that a file modified after the extraction is read again*/
+TEST_F(ExtractedSignatureTest, TestFileModifiedAfterExtraction)
+{
+    std::ofstream(imagePath / "image-rofs", std::ios::app) << "modified";
+
+    auto digests = DigestStore::instance().find(imagePath);
+    ASSERT_NE(digests, nullptr);
+    EXPECT_EQ(digests->find(imagePath, "image-rofs", "RSA-SHA256"), nullptr);
+
+    signature = std::make_unique<Signature>(imagePath, signedConfPath);
+    EXPECT_FALSE(signature->verify());
+}
+
+/** @brief Test for success scenario without the digests*/
+TEST_F(ExtractedSignatureTest, TestSignatureVerifyWithoutDigests)
+{
+    DigestStore::instance().erase(imagePath);
+
+    signature = std::make_unique<Signature>(imagePath, signedConfPath);
+    EXPECT_TRUE(signature->verify());
+}
+
 class FileTest : public testing::Test
 {
   protected:
@@ -465,3 +642,1296 @@ TEST(ExecTest, TestConstructArgv)
     EXPECT_EQ(charArray[2], arg2);
     EXPECT_EQ(charArray[3], nullptr);
 }
+
+class TarTest : public testing::Test
+{
+  protected:
+    static void command(const std::string& cmd)
+    {
+        auto val = std::system(cmd.c_str());
+        if (val)
+        {
+            std::cout << "COMMAND Error: " << val << std::endl;
+        }
+    }
+
+    static std::string readFile(const fs::path& path)
+    {
+        std::ifstream f(path);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    /** @brief Build a ustar archive with a single regular file */
+    static std::string createArchive(const std::string& name,
+                                     const std::string& data)
+    {
+        std::string header(512, '\0');
+        std::copy(name.begin(), name.end(), header.begin());
+        std::snprintf(&header[100], 8, "%07o", 0644);
+        std::snprintf(&header[124], 12, "%011zo", data.size());
+        std::fill_n(&header[148], 8, ' ');
+        header[156] = '0';
+        std::copy_n("ustar\0" "00", 8, &header[257]);
+
+        unsigned sum = 0;
+        for (char c : header)
+        {
+            sum += static_cast<unsigned char>(c);
+        }
+        std::snprintf(&header[148], 8, "%06o", sum);
+
+        std::string archive = header + data;
+        archive.resize((archive.size() + 511) / 512 * 512 + 1024, '\0');
+        return archive;
+    }
+
+    softwareUtils::TarResult extract(const fs::path& archive)
+    {
+        int fd = open(archive.c_str(), O_RDONLY);
+        auto result = softwareUtils::extractTar(fd, extractDir);
+        close(fd);
+        return result;
+    }
+
+    void SetUp() override
+    {
+        tmpDir = fs::temp_directory_path() / "testTarXXXXXX";
+        if (!mkdtemp(tmpDir.data()))
+        {
+            throw "Failed to create tmp dir";
+        }
+
+        srcDir = fs::path(tmpDir) / "src";
+        extractDir = fs::path(tmpDir) / "extract";
+        fs::create_directories(srcDir / "sub");
+        fs::create_directories(extractDir);
+
+        std::ofstream(srcDir / "MANIFEST") << "version=2.14.0\n";
+        std::ofstream(srcDir / "sub" / "image-rofs")
+            << std::string(100000, 'r');
+        std::ofstream(srcDir / std::string(120, 'n')) << "long name\n";
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(tmpDir);
+    }
+
+    void expectExtracted()
+    {
+        EXPECT_EQ(readFile(extractDir / "MANIFEST"), "version=2.14.0\n");
+        EXPECT_EQ(readFile(extractDir / "sub" / "image-rofs"),
+                  std::string(100000, 'r'));
+        EXPECT_EQ(readFile(extractDir / std::string(120, 'n')),
+                  "long name\n");
+    }
+
+    std::string tmpDir;
+    fs::path srcDir;
+    fs::path extractDir;
+};
+
+TEST_F(TarTest, TestExtractGnu)
+{
+    auto archive = fs::path(tmpDir) / "gnu.tar";
+    command("tar --format=gnu -cf " + archive.string() + " -C " +
+            srcDir.string() + " .");
+
+    auto result = extract(archive);
+    EXPECT_TRUE(result);
+    expectExtracted();
+}
+
+TEST_F(TarTest, TestExtractPax)
+{
+    auto archive = fs::path(tmpDir) / "pax.tar";
+    command("tar --format=pax -cf " + archive.string() + " -C " +
+            srcDir.string() + " .");
+
+    auto result = extract(archive);
+    EXPECT_TRUE(result);
+    expectExtracted();
+}
+
+TEST_F(TarTest, TestRejectParentPath)
+{
+    auto archive = fs::path(tmpDir) / "parent.tar";
+    std::ofstream(archive) << createArchive("sub/../../escaped", "data");
+
+    auto result = extract(archive);
+    EXPECT_EQ(result.error, softwareUtils::TarError::unsafePath);
+    EXPECT_EQ(result.entry, "sub/../../escaped");
+    EXPECT_FALSE(fs::exists(fs::path(tmpDir) / "escaped"));
+}
+
+TEST_F(TarTest, TestRejectSymlink)
+{
+    fs::create_symlink("/etc", srcDir / "link");
+    auto archive = fs::path(tmpDir) / "link.tar";
+    command("tar -cf " + archive.string() + " -C " + srcDir.string() +
+            " link");
+
+    auto result = extract(archive);
+    EXPECT_EQ(result.error, softwareUtils::TarError::unsupportedType);
+    EXPECT_FALSE(fs::exists(extractDir / "link"));
+}
+
+TEST_F(TarTest, TestTruncated)
+{
+    auto archive = fs::path(tmpDir) / "truncated.tar";
+    std::string data = createArchive("MANIFEST", std::string(2000, 'm'));
+    data.resize(1024);
+    std::ofstream(archive) << data;
+
+    auto result = extract(archive);
+    EXPECT_EQ(result.error, softwareUtils::TarError::truncated);
+}
+
+TEST_F(TarTest, TestBadChecksum)
+{
+    auto archive = fs::path(tmpDir) / "checksum.tar";
+    std::string data = createArchive("MANIFEST", "version=1\n");
+    data[0] = 'N';
+    std::ofstream(archive) << data;
+
+    auto result = extract(archive);
+    EXPECT_EQ(result.error, softwareUtils::TarError::badChecksum);
+    EXPECT_TRUE(fs::is_empty(extractDir));
+}
+
+TEST_F(TarTest, TestExtractGzip)
+{
+    auto archive = fs::path(tmpDir) / "image.tar.gz";
+    command("tar -czf " + archive.string() + " -C " + srcDir.string() + " .");
+
+    auto result = extract(archive);
+    EXPECT_TRUE(result);
+    expectExtracted();
+}
+
+TEST_F(TarTest, TestReleaseInput)
+{
+    auto archive = fs::path(tmpDir) / "release.tar";
+    command("tar --format=gnu -cf " + archive.string() + " -C " +
+            srcDir.string() + " .");
+
+    int fd = open(archive.c_str(), O_RDWR);
+    auto result = softwareUtils::extractTar(fd, extractDir, true);
+    close(fd);
+
+    EXPECT_TRUE(result);
+    expectExtracted();
+
+    // What was read doesn't take space anymore
+    struct stat st{};
+    ASSERT_EQ(stat(archive.c_str(), &st), 0);
+    EXPECT_LT(st.st_blocks * 512, st.st_size);
+}
+
+/** @brief Takes the data of one file instead of the extraction */
+class TakingObserver : public softwareUtils::TarObserver
+{
+  public:
+    explicit TakingObserver(const fs::path& taken) : taken(taken) {}
+
+    bool extract(const fs::path& path) override
+    {
+        return path != taken;
+    }
+
+    void begin(const fs::path& path) override
+    {
+        current = path;
+    }
+
+    bool update(std::span<const uint8_t> data) override
+    {
+        if (current == taken)
+        {
+            if (data.size() > maxSize)
+            {
+                rejected = true;
+            }
+            takenData.append(reinterpret_cast<const char*>(data.data()),
+                             data.size());
+        }
+        return !rejected;
+    }
+
+    bool end() override
+    {
+        return true;
+    }
+
+    fs::path taken;
+    fs::path current;
+    std::string takenData;
+    size_t maxSize = SIZE_MAX;
+    bool rejected = false;
+};
+
+TEST_F(TarTest, TestObserverTakesFile)
+{
+    auto archive = fs::path(tmpDir) / "image.tar";
+    command("tar -cf " + archive.string() + " -C " + srcDir.string() + " .");
+
+    TakingObserver observer(fs::path("sub") / "image-rofs");
+    int fd = open(archive.c_str(), O_RDONLY);
+    auto result = softwareUtils::extractTar(fd, extractDir, false, &observer);
+    close(fd);
+
+    EXPECT_TRUE(result);
+    EXPECT_EQ(observer.takenData, std::string(100000, 'r'));
+    EXPECT_FALSE(fs::exists(extractDir / "sub" / "image-rofs"));
+    EXPECT_EQ(readFile(extractDir / "MANIFEST"), "version=2.14.0\n");
+}
+
+TEST_F(TarTest, TestObserverRejectsFile)
+{
+    auto archive = fs::path(tmpDir) / "image.tar";
+    command("tar -cf " + archive.string() + " -C " + srcDir.string() + " .");
+
+    TakingObserver observer(fs::path("sub") / "image-rofs");
+    observer.maxSize = 0;
+    int fd = open(archive.c_str(), O_RDONLY);
+    auto result = softwareUtils::extractTar(fd, extractDir, false, &observer);
+    close(fd);
+
+    EXPECT_FALSE(result);
+    EXPECT_EQ(result.error, softwareUtils::TarError::rejected);
+    EXPECT_EQ(result.entry, "./sub/image-rofs");
+}
+
+/** @brief Make sure only the blocks which changed are written again */
+TEST(FlashDeltaTest, TestWriteChangedBlocks)
+{
+    std::string tmpDir = fs::temp_directory_path() / "testFlashXXXXXX";
+    ASSERT_NE(mkdtemp(tmpDir.data()), nullptr);
+    auto imagePath = fs::path(tmpDir) / "image-bmc";
+    auto devicePath = fs::path(tmpDir) / "alt-bmc";
+
+    softwareUtils::FlashDevice device{.size = 1024 * 1024, .blockSize = 4096};
+    std::string image(10 * 4096 + 100, 'a');
+
+    auto write = [&](softwareUtils::DeltaStats& stats) {
+        std::ofstream(imagePath, std::ios::binary | std::ios::trunc) << image;
+        int imageFd = open(imagePath.c_str(), O_RDONLY);
+        int deviceFd = open(devicePath.c_str(), O_RDWR | O_CREAT, 0644);
+        auto result =
+            softwareUtils::writeDelta(imageFd, deviceFd, device, stats);
+        close(deviceFd);
+        close(imageFd);
+        return result;
+    };
+
+    softwareUtils::DeltaStats stats;
+    ASSERT_TRUE(write(stats));
+    EXPECT_EQ(stats.imageSize, image.size());
+    EXPECT_EQ(stats.blocks, 11);
+    EXPECT_EQ(stats.written, 11);
+
+    image[5 * 4096 + 7] = 'b';
+    ASSERT_TRUE(write(stats));
+    EXPECT_EQ(stats.blocks, 11);
+    EXPECT_EQ(stats.written, 1);
+
+    std::ifstream f(devicePath, std::ios::binary);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    EXPECT_EQ(ss.str(), image);
+
+    // An image which doesn't fit the partition is rejected
+    device.size = 4096;
+    EXPECT_FALSE(write(stats));
+
+    fs::remove_all(tmpDir);
+}
+
+/** @brief Make sure an image written in pieces is checked and can be erased */
+TEST(FlashDeltaTest, TestStreamedWrite)
+{
+    std::string tmpDir = fs::temp_directory_path() / "testFlashXXXXXX";
+    ASSERT_NE(mkdtemp(tmpDir.data()), nullptr);
+    auto devicePath = fs::path(tmpDir) / "alt-bmc";
+
+    softwareUtils::FlashDevice device{.size = 1024 * 1024, .blockSize = 4096};
+    std::string image;
+    for (size_t i = 0; i < 3 * 4096 + 10; i++)
+    {
+        image += static_cast<char>('a' + i % 26);
+    }
+
+    int deviceFd = open(devicePath.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(deviceFd, 0);
+    softwareUtils::DeltaWriter writer(deviceFd, device, EVP_sha512());
+
+    // Chunks which don't match the blocks, as they come from the archive
+    std::span<const uint8_t> data(
+        reinterpret_cast<const uint8_t*>(image.data()), image.size());
+    for (size_t offset = 0; offset < data.size(); offset += 1000)
+    {
+        const size_t chunk = std::min<size_t>(1000, data.size() - offset);
+        ASSERT_TRUE(writer.write(data.subspan(offset, chunk)));
+    }
+    ASSERT_TRUE(writer.finish());
+    EXPECT_EQ(writer.getStats().blocks, 4);
+
+    std::vector<uint8_t> expected(EVP_MAX_MD_SIZE);
+    unsigned int size = 0;
+    ASSERT_EQ(EVP_Digest(image.data(), image.size(), expected.data(), &size,
+                         EVP_sha512(), nullptr),
+              1);
+    expected.resize(size);
+    EXPECT_EQ(writer.getDigest(), expected);
+
+    std::stringstream ss;
+    ss << std::ifstream(devicePath, std::ios::binary).rdbuf();
+    EXPECT_EQ(ss.str(), image);
+
+    // Nothing is left to boot from
+    EXPECT_TRUE(writer.invalidate());
+    close(deviceFd);
+    ss.str("");
+    ss << std::ifstream(devicePath, std::ios::binary).rdbuf();
+    EXPECT_EQ(ss.str().substr(0, 4096), std::string(4096, '\xff'));
+
+    fs::remove_all(tmpDir);
+}
+
+class ReleaseCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        tmpDir = fs::temp_directory_path() / "testReleasesXXXXXX";
+        if (!mkdtemp(tmpDir.data()))
+        {
+            throw "Failed to create tmp dir";
+        }
+        cachePath = fs::path(tmpDir) / "persist" / "releases";
+
+        writeRelease("rofs-a", "1.0");
+        writeRelease("rofs-b", "2.0");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(tmpDir);
+    }
+
+    fs::path osRelease(const std::string& volume) const
+    {
+        return fs::path(tmpDir) / volume / "os-release";
+    }
+
+    void writeRelease(const std::string& volume, const std::string& version)
+    {
+        fs::create_directories(osRelease(volume).parent_path());
+        std::ofstream(osRelease(volume), std::ios::trunc)
+            << "VERSION_ID=" << version << "\nEXTENDED_VERSION=ext-"
+            << version << "\n";
+    }
+
+    std::string readCache() const
+    {
+        std::ifstream f(cachePath);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    /** @brief Replace text in the persisted cache, to tell whether a value
+     *         came from the cache or from the os-release file */
+    void editCache(const std::string& from, const std::string& to)
+    {
+        auto text = readCache();
+        auto pos = text.find(from);
+        ASSERT_NE(pos, std::string::npos);
+        text.replace(pos, from.size(), to);
+        std::ofstream(cachePath, std::ios::trunc) << text;
+    }
+
+    /** @brief Look up all the volumes and persist them */
+    void fill()
+    {
+        ReleaseCache cache(cachePath);
+        cache.get("rofs-a", osRelease("rofs-a"));
+        cache.get("rofs-b", osRelease("rofs-b"));
+        cache.store();
+        ASSERT_TRUE(fs::exists(cachePath));
+    }
+
+    std::string tmpDir;
+    fs::path cachePath;
+};
+
+TEST_F(ReleaseCacheTest, TestReadRelease)
+{
+    ReleaseCache cache(cachePath);
+    auto release = cache.get("rofs-a", osRelease("rofs-a"));
+    EXPECT_EQ(release.version, "1.0");
+    EXPECT_EQ(release.extendedVersion, "ext-1.0");
+}
+
+TEST_F(ReleaseCacheTest, TestCacheHit)
+{
+    fill();
+    editCache("\"1.0\"", "\"cached\"");
+
+    ReleaseCache cache(cachePath);
+    EXPECT_EQ(cache.get("rofs-a", osRelease("rofs-a")).version, "cached");
+}
+
+TEST_F(ReleaseCacheTest, TestStaleStamp)
+{
+    fill();
+    editCache("\"1.0\"", "\"cached\"");
+
+    // The file changed since it was cached, so its stamp did too. The size
+    // changes as well, the times may not within a clock tick.
+    writeRelease("rofs-a", "1.1.1");
+
+    ReleaseCache cache(cachePath);
+    auto release = cache.get("rofs-a", osRelease("rofs-a"));
+    EXPECT_EQ(release.version, "1.1.1");
+    EXPECT_EQ(release.extendedVersion, "ext-1.1.1");
+    EXPECT_EQ(cache.get("rofs-b", osRelease("rofs-b")).version, "2.0");
+
+    cache.store();
+    EXPECT_NE(readCache().find("\"1.1.1\""), std::string::npos);
+}
+
+TEST_F(ReleaseCacheTest, TestVersionMismatch)
+{
+    fill();
+    editCache("\"1.0\"", "\"cached\"");
+    editCache("\"version\": 1,", "\"version\": 0,");
+
+    ReleaseCache cache(cachePath);
+    EXPECT_EQ(cache.get("rofs-a", osRelease("rofs-a")).version, "1.0");
+}
+
+TEST_F(ReleaseCacheTest, TestCorruptCache)
+{
+    fs::create_directories(cachePath.parent_path());
+    std::ofstream(cachePath) << "{ \"version\": 1, \"releases\": [ { \"key";
+
+    ReleaseCache cache(cachePath);
+    EXPECT_FALSE(fs::exists(cachePath));
+    EXPECT_EQ(cache.get("rofs-a", osRelease("rofs-a")).version, "1.0");
+
+    std::ofstream(cachePath) << "not json";
+    ReleaseCache other(cachePath);
+    EXPECT_FALSE(fs::exists(cachePath));
+}
+
+TEST_F(ReleaseCacheTest, TestStoreDropsGoneVolumes)
+{
+    fill();
+    EXPECT_NE(readCache().find("rofs-b"), std::string::npos);
+
+    // rofs-b is not mounted anymore
+    ReleaseCache cache(cachePath);
+    cache.get("rofs-a", osRelease("rofs-a"));
+    cache.store();
+
+    auto text = readCache();
+    EXPECT_NE(text.find("rofs-a"), std::string::npos);
+    EXPECT_EQ(text.find("rofs-b"), std::string::npos);
+}
+
+TEST_F(ReleaseCacheTest, TestInvalidate)
+{
+    fill();
+    ReleaseCache::invalidate(cachePath);
+    EXPECT_FALSE(fs::exists(cachePath));
+}
+
+class SyncTest : public testing::Test
+{
+  protected:
+    static std::string readFile(const fs::path& path)
+    {
+        std::ifstream f(path);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    void SetUp() override
+    {
+        tmpDir = fs::temp_directory_path() / "testSyncXXXXXX";
+        if (!mkdtemp(tmpDir.data()))
+        {
+            throw "Failed to create tmp dir";
+        }
+        srcDir = fs::path(tmpDir) / "src";
+        altRoot = fs::path(tmpDir) / "alt";
+        fs::create_directories(srcDir / "dir" / "sub");
+
+        std::ofstream(srcDir / "file") << "file";
+        std::ofstream(srcDir / "dir" / "a") << "a";
+        std::ofstream(srcDir / "dir" / "sub" / "b") << "b";
+
+        syncList = fs::path(tmpDir) / "synclist";
+        std::ofstream(syncList) << (srcDir / "file").string() << "\n"
+                                << (srcDir / "dir" / "").string() << "\n";
+
+        ASSERT_GE(sd_event_new(&loop), 0);
+    }
+
+    void TearDown() override
+    {
+        sd_event_unref(loop);
+        fs::remove_all(tmpDir);
+    }
+
+    /** @brief The alternate copy of a path */
+    fs::path alt(const fs::path& path) const
+    {
+        return altRoot / path.relative_path();
+    }
+
+    static ino_t inode(const fs::path& path)
+    {
+        struct stat st{};
+        stat(path.c_str(), &st);
+        return st.st_ino;
+    }
+
+    /** @brief Run the event loop until done returns true, or a timeout */
+    bool runUntil(const std::function<bool()>& done)
+    {
+        for (int i = 0; i < 50 && !done(); i++)
+        {
+            if (sd_event_run(loop, 100000) < 0)
+            {
+                return false;
+            }
+        }
+        return done();
+    }
+
+    /** @brief Run a reconciliation to its end */
+    void reconcile(Sync& sync)
+    {
+        sync.reconcile();
+        ASSERT_TRUE(runUntil([&sync]() { return !sync.isReconciling(); }));
+    }
+
+    std::string tmpDir;
+    fs::path srcDir;
+    fs::path altRoot;
+    fs::path syncList;
+    sd_event* loop = nullptr;
+};
+
+TEST_F(SyncTest, TestWriteFile)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "file";
+    fs::permissions(file, fs::perms::owner_read | fs::perms::owner_write);
+    sync.processEntry(IN_CLOSE_WRITE, file);
+    EXPECT_FALSE(fs::exists(alt(file)));
+
+    sync.flush();
+    EXPECT_EQ(readFile(alt(file)), "file");
+    EXPECT_EQ(fs::status(alt(file)).permissions(),
+              fs::perms::owner_read | fs::perms::owner_write);
+    EXPECT_EQ(fs::last_write_time(alt(file)), fs::last_write_time(file));
+
+    // Events which don't change the file are ignored
+    std::ofstream(file) << "changed";
+    sync.processEntry(IN_ACCESS, file);
+    sync.flush();
+    EXPECT_EQ(readFile(alt(file)), "file");
+}
+
+TEST_F(SyncTest, TestReplaceByRename)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "dir" / "a";
+    sync.processEntry(IN_CLOSE_WRITE, file);
+    sync.flush();
+    ASSERT_EQ(readFile(alt(file)), "a");
+
+    // As editors and atomic writers do, through the watch of the directory
+    auto tmp = srcDir / "dir" / "a.new";
+    std::ofstream(tmp) << "replaced";
+    sync.processEntry(IN_CREATE, tmp);
+    sync.processEntry(IN_CLOSE_WRITE, tmp);
+    fs::rename(tmp, file);
+    sync.processEntry(IN_MOVED_FROM, tmp);
+    sync.processEntry(IN_MOVED_TO, file);
+    sync.flush();
+
+    EXPECT_EQ(readFile(alt(file)), "replaced");
+    EXPECT_FALSE(fs::exists(alt(tmp)));
+    for (const auto& entry : fs::directory_iterator(alt(srcDir / "dir")))
+    {
+        EXPECT_NE(entry.path().extension(), ".sync-tmp");
+    }
+}
+
+TEST_F(SyncTest, TestDelete)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "file";
+    sync.processEntry(IN_CLOSE_WRITE, file);
+    sync.flush();
+    ASSERT_TRUE(fs::exists(alt(file)));
+
+    fs::remove(file);
+    sync.processEntry(IN_DELETE, file);
+    sync.flush();
+    EXPECT_FALSE(fs::exists(alt(file)));
+}
+
+TEST_F(SyncTest, TestRemoveDirectory)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    // Directories are in the sync list with a trailing '/'
+    auto dir = srcDir / "dir" / "";
+    sync.processEntry(IN_CLOSE_WRITE, dir);
+    sync.flush();
+    ASSERT_EQ(readFile(alt(srcDir / "dir" / "sub" / "b")), "b");
+
+    fs::remove_all(srcDir / "dir" / "sub");
+    sync.processEntry(IN_DELETE, dir);
+    sync.flush();
+    EXPECT_FALSE(fs::exists(alt(srcDir / "dir" / "sub")));
+    EXPECT_EQ(readFile(alt(srcDir / "dir" / "a")), "a");
+
+    fs::remove_all(srcDir / "dir");
+    sync.processEntry(IN_DELETE, dir);
+    sync.flush();
+    EXPECT_FALSE(fs::exists(alt(srcDir / "dir")));
+}
+
+TEST_F(SyncTest, TestSymlink)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    // The link is copied, not what it points to
+    auto link = srcDir / "dir" / "link";
+    fs::create_symlink("missing", link);
+    sync.processEntry(IN_CREATE, link);
+    sync.flush();
+
+    ASSERT_TRUE(fs::is_symlink(fs::symlink_status(alt(link))));
+    EXPECT_EQ(fs::read_symlink(alt(link)), "missing");
+}
+
+TEST_F(SyncTest, TestCoalesceEvents)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "file";
+    for (int i = 0; i < 5; i++)
+    {
+        std::ofstream(file) << "write " << i;
+        sync.processEntry(IN_CLOSE_WRITE, file);
+    }
+
+    // Nothing is synced until the file settles
+    ASSERT_GE(sd_event_run(loop, 0), 0);
+    EXPECT_FALSE(fs::exists(alt(file)));
+
+    // Then the last contents are synced once, by the timer
+    auto timeout = std::chrono::duration_cast<std::chrono::microseconds>(
+        Sync::maxDelay * 2);
+    ASSERT_GT(sd_event_run(loop, timeout.count()), 0);
+    EXPECT_EQ(readFile(alt(file)), "write 4");
+
+    // Every sync writes a new copy, nothing was left to write
+    struct stat synced{};
+    ASSERT_EQ(stat(alt(file).c_str(), &synced), 0);
+    sync.flush();
+    struct stat flushed{};
+    ASSERT_EQ(stat(alt(file).c_str(), &flushed), 0);
+    EXPECT_EQ(flushed.st_ino, synced.st_ino);
+}
+
+TEST_F(SyncTest, TestReconcile)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    reconcile(sync);
+    EXPECT_EQ(readFile(alt(srcDir / "file")), "file");
+    EXPECT_EQ(readFile(alt(srcDir / "dir" / "a")), "a");
+    EXPECT_EQ(readFile(alt(srcDir / "dir" / "sub" / "b")), "b");
+
+    // Files of the same size and time aren't written again
+    auto ino = inode(alt(srcDir / "dir" / "a"));
+    reconcile(sync);
+    EXPECT_EQ(inode(alt(srcDir / "dir" / "a")), ino);
+}
+
+TEST_F(SyncTest, TestReconcileFixesTime)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "dir" / "a";
+    reconcile(sync);
+    auto ino = inode(alt(file));
+
+    // As after a copy cut short before its time was set
+    fs::last_write_time(alt(file),
+                        fs::last_write_time(file) - std::chrono::hours(1));
+    reconcile(sync);
+    EXPECT_EQ(inode(alt(file)), ino);
+    EXPECT_EQ(fs::last_write_time(alt(file)), fs::last_write_time(file));
+
+    // Contents of the same size which differ are copied
+    std::ofstream(alt(file)) << "x";
+    reconcile(sync);
+    EXPECT_EQ(readFile(alt(file)), "a");
+    EXPECT_EQ(fs::last_write_time(alt(file)), fs::last_write_time(file));
+}
+
+TEST_F(SyncTest, TestReconcileRemovesStale)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    reconcile(sync);
+    std::ofstream(alt(srcDir / "dir" / "stale")) << "stale";
+    fs::create_directories(alt(srcDir / "dir" / "gone" / "sub"));
+    std::ofstream(alt(srcDir / "dir" / "gone" / "sub" / "c")) << "c";
+    fs::remove(srcDir / "dir" / "sub" / "b");
+
+    reconcile(sync);
+    EXPECT_FALSE(fs::exists(alt(srcDir / "dir" / "stale")));
+    EXPECT_FALSE(fs::exists(alt(srcDir / "dir" / "gone")));
+    EXPECT_FALSE(fs::exists(alt(srcDir / "dir" / "sub" / "b")));
+    EXPECT_TRUE(fs::is_directory(alt(srcDir / "dir" / "sub")));
+    EXPECT_EQ(readFile(alt(srcDir / "dir" / "a")), "a");
+}
+
+TEST_F(SyncTest, TestEventsDuringReconcile)
+{
+    Sync sync(*loop, altRoot, syncList);
+
+    auto file = srcDir / "file";
+    sync.reconcile();
+    std::ofstream(file) << "changed";
+    sync.processEntry(IN_CLOSE_WRITE, file);
+    sync.flush();
+
+    // The entry is synced once the reconciliation is done
+    EXPECT_TRUE(runUntil([&]() {
+        return !sync.isReconciling() && readFile(alt(file)) == "changed";
+    }));
+}
+
+TEST_F(SyncTest, TestWatchNewDirectory)
+{
+    std::vector<fs::path> paths;
+    SyncWatch watch(
+        *loop,
+        [&paths](int, fs::path& path) {
+            paths.push_back(path);
+            return 0;
+        },
+        syncList);
+
+    auto seen = [&paths](const fs::path& path) {
+        return std::ranges::find(paths, path) != paths.end();
+    };
+
+    // The directory gets a watch of its own when it is created
+    auto dir = srcDir / "dir" / "new";
+    fs::create_directory(dir);
+    ASSERT_TRUE(runUntil([&]() { return seen(dir); }));
+
+    std::ofstream(dir / "c") << "c";
+    EXPECT_TRUE(runUntil([&]() { return seen(dir / "c"); }));
+}
+
+TEST_F(SyncTest, TestWatchReplacedFile)
+{
+    std::vector<fs::path> paths;
+    SyncWatch watch(
+        *loop,
+        [&paths](int, fs::path& path) {
+            paths.push_back(path);
+            return 0;
+        },
+        syncList);
+
+    auto seen = [&paths](const fs::path& path) {
+        return std::ranges::find(paths, path) != paths.end();
+    };
+
+    // The directory of the file isn't watched, only the file itself
+    auto tmp = srcDir / "file.new";
+    std::ofstream(tmp) << "replaced";
+    fs::rename(tmp, srcDir / "file");
+    ASSERT_TRUE(runUntil([&]() { return seen(srcDir / "file"); }));
+
+    // and it is watched again
+    paths.clear();
+    std::ofstream(srcDir / "file") << "written";
+    EXPECT_TRUE(runUntil([&]() { return seen(srcDir / "file"); }));
+}
+
+class ImageManagerTest : public testing::Test
+{
+  protected:
+    using OperationStatus = UploadProgress::OperationStatus;
+
+    static void command(const std::string& cmd)
+    {
+        auto val = std::system(cmd.c_str());
+        if (val)
+        {
+            std::cout << "COMMAND Error: " << val << std::endl;
+        }
+    }
+
+    void SetUp() override
+    {
+        tmpDir = fs::temp_directory_path() / "testImageManagerXXXXXX";
+        if (!mkdtemp(tmpDir.data()))
+        {
+            throw "Failed to create tmp dir";
+        }
+        uploadDir = fs::path(tmpDir) / "upload";
+        fs::create_directories(uploadDir);
+        osReleaseFile = fs::path(tmpDir) / "os-release";
+        std::ofstream(osReleaseFile) << "OPENBMC_TARGET_MACHINE=\"test\"\n";
+
+        ASSERT_GE(sd_event_new(&loop), 0);
+    }
+
+    void TearDown() override
+    {
+        sd_event_unref(loop);
+        fs::remove_all(tmpDir);
+    }
+
+    /** @brief The environment, with an object mapper which can be held */
+    Manager::Environment environment()
+    {
+        return {uploadDir, osReleaseFile, [this]() {
+                    std::unique_lock<std::mutex> guard(mutex);
+                    lookups++;
+                    changed.notify_all();
+                    changed.wait(guard, [this]() { return !blocked; });
+                    return objects;
+                }};
+    }
+
+    /** @brief Let the workers past the object mapper */
+    void release()
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            blocked = false;
+        }
+        changed.notify_all();
+    }
+
+    /** @brief Wait for the workers to reach the object mapper */
+    bool waitForLookups(size_t count)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        return changed.wait_for(guard, std::chrono::seconds(5), [&]() {
+            return lookups >= count;
+        });
+    }
+
+    /** @brief Create an image tarball of a version */
+    fs::path createTarball(const std::string& version)
+    {
+        auto imageDir = fs::path(tmpDir) / ("image-" + version);
+        fs::create_directories(imageDir);
+        std::ofstream(imageDir / "MANIFEST")
+            << "purpose=xyz.openbmc_project.Software.Version."
+               "VersionPurpose.BMC\nversion="
+            << version << "\nMachineName=test\n";
+
+        auto tarball = fs::path(tmpDir) / (version + ".tar");
+        command("tar -cf " + tarball.string() + " -C " + imageDir.string() +
+                " MANIFEST");
+        return tarball;
+    }
+
+    /** @brief Create a tarball which fails to be extracted */
+    fs::path createInvalidTarball(const std::string& name)
+    {
+        auto tarball = fs::path(tmpDir) / (name + ".tar");
+        std::ofstream(tarball) << "not a tarball " << name;
+        return tarball;
+    }
+
+    /** @brief The version id of a tarball, before it is salted */
+    static std::string idOf(const fs::path& tarball)
+    {
+        std::ifstream file(tarball, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int size = 0;
+        EVP_Digest(contents.data(), contents.size(), digest, &size,
+                   EVP_sha256(), nullptr);
+
+        std::string hex;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            char byte[3];
+            snprintf(byte, sizeof(byte), "%02x", digest[i]);
+            hex += byte;
+        }
+        return Version::getId(hex);
+    }
+
+    /** @brief The ids of the images extracted to the upload dir */
+    std::vector<std::string> images()
+    {
+        std::vector<std::string> ids;
+        for (const auto& entry : fs::directory_iterator(uploadDir))
+        {
+            if (fs::exists(entry.path() / "MANIFEST"))
+            {
+                ids.push_back(entry.path().filename());
+            }
+        }
+        return ids;
+    }
+
+    /** @brief Run the event loop until done returns true, or a timeout */
+    bool runUntil(const std::function<bool()>& done)
+    {
+        for (int i = 0; i < 50 && !done(); i++)
+        {
+            if (sd_event_run(loop, 100000) < 0)
+            {
+                return false;
+            }
+        }
+        return done();
+    }
+
+    static bool isFinished(const Manager& manager, uint64_t upload)
+    {
+        const auto* progress = manager.getUploadProgress(upload);
+        return progress && progress->status() != OperationStatus::InProgress;
+    }
+
+    std::string tmpDir;
+    fs::path uploadDir;
+    fs::path osReleaseFile;
+    sd_event* loop = nullptr;
+    sdbusplus::bus_t bus = sdbusplus::bus::new_default();
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool blocked = false;
+    size_t lookups = 0;
+    std::vector<std::string> objects;
+};
+
+TEST_F(ImageManagerTest, TestProcessImage)
+{
+    Manager manager(bus, loop, environment());
+
+    auto tarball = createTarball("1.0");
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    const auto* progress = manager.getUploadProgress(0);
+    ASSERT_NE(progress, nullptr);
+    EXPECT_NE(progress->startTime(), 0);
+
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 0); }));
+    EXPECT_EQ(progress->status(), OperationStatus::Completed);
+    EXPECT_EQ(progress->progress(), 100);
+    EXPECT_NE(progress->completedTime(), 0);
+
+    // The tarball is replaced by the extracted image
+    EXPECT_FALSE(fs::exists(tarball));
+    size_t images = 0;
+    for (const auto& entry : fs::directory_iterator(uploadDir))
+    {
+        EXPECT_TRUE(fs::exists(entry.path() / "MANIFEST"));
+        images++;
+    }
+    EXPECT_EQ(images, 1);
+}
+
+TEST_F(ImageManagerTest, TestProgressStates)
+{
+    Manager manager(bus, loop, environment());
+    blocked = true;
+
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(manager.processImage(createTarball("1." + std::to_string(i))),
+                  0);
+    }
+
+    // Queued
+    for (uint64_t i = 0; i < 3; i++)
+    {
+        const auto* progress = manager.getUploadProgress(i);
+        ASSERT_NE(progress, nullptr);
+        EXPECT_EQ(progress->status(), OperationStatus::InProgress);
+        EXPECT_EQ(progress->progress(), 0);
+    }
+
+    // Each worker extracts one, the third one waits for a worker
+    ASSERT_TRUE(waitForLookups(Manager::maxWorkers));
+    ASSERT_TRUE(runUntil([&]() {
+        return manager.getUploadProgress(0)->progress() == 10 &&
+               manager.getUploadProgress(1)->progress() == 10;
+    }));
+    EXPECT_EQ(manager.getUploadProgress(2)->progress(), 0);
+    EXPECT_EQ(manager.getUploadProgress(0)->status(),
+              OperationStatus::InProgress);
+
+    release();
+    ASSERT_TRUE(runUntil([&]() {
+        return isFinished(manager, 0) && isFinished(manager, 1) &&
+               isFinished(manager, 2);
+    }));
+    for (uint64_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(manager.getUploadProgress(i)->status(),
+                  OperationStatus::Completed);
+    }
+}
+
+TEST_F(ImageManagerTest, TestRejectWhenFull)
+{
+    Manager manager(bus, loop, environment());
+    blocked = true;
+
+    for (size_t i = 0; i < Manager::maxQueued; i++)
+    {
+        EXPECT_EQ(manager.processImage(createTarball("1." + std::to_string(i))),
+                  0);
+    }
+
+    // The upload dir isn't filled any further
+    auto rejected = createTarball("2.0");
+    EXPECT_EQ(manager.processImage(rejected), -1);
+    EXPECT_FALSE(fs::exists(rejected));
+    ASSERT_TRUE(isFinished(manager, Manager::maxQueued));
+    EXPECT_EQ(manager.getUploadProgress(Manager::maxQueued)->status(),
+              OperationStatus::Failed);
+
+    release();
+    ASSERT_TRUE(runUntil([&]() {
+        for (size_t i = 0; i < Manager::maxQueued; i++)
+        {
+            if (!isFinished(manager, i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }));
+
+    // Once they were processed, there is room again
+    EXPECT_EQ(manager.processImage(createTarball("3.0")), 0);
+}
+
+TEST_F(ImageManagerTest, TestPruneFinished)
+{
+    Manager manager(bus, loop, environment());
+
+    const uint64_t uploads = Manager::maxFinished + 2;
+    for (uint64_t i = 0; i < uploads; i++)
+    {
+        EXPECT_EQ(manager.processImage(
+                      createInvalidTarball("invalid" + std::to_string(i))),
+                  0);
+        ASSERT_TRUE(runUntil([&]() {
+            return manager.getUploadProgress(i) == nullptr ||
+                   isFinished(manager, i);
+        }));
+    }
+
+    // Only the last ones are kept
+    for (uint64_t i = 0; i < uploads; i++)
+    {
+        const auto* progress = manager.getUploadProgress(i);
+        if (i < uploads - Manager::maxFinished)
+        {
+            EXPECT_EQ(progress, nullptr);
+        }
+        else
+        {
+            ASSERT_NE(progress, nullptr);
+            EXPECT_EQ(progress->status(), OperationStatus::Failed);
+        }
+    }
+}
+
+TEST_F(ImageManagerTest, TestShutdownWithQueuedJobs)
+{
+    auto manager = std::make_unique<Manager>(bus, loop, environment());
+    blocked = true;
+
+    std::vector<fs::path> tarballs;
+    for (int i = 0; i < 5; i++)
+    {
+        tarballs.push_back(createTarball("1." + std::to_string(i)));
+        EXPECT_EQ(manager->processImage(tarballs.back()), 0);
+    }
+    ASSERT_TRUE(waitForLookups(Manager::maxWorkers));
+
+    // The workers finish the tarballs they have, the queued ones are
+    // dropped
+    std::jthread releaser([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release();
+    });
+    manager.reset();
+
+    EXPECT_EQ(lookups, Manager::maxWorkers);
+    for (const auto& tarball : tarballs)
+    {
+        EXPECT_FALSE(fs::exists(tarball));
+    }
+}
+
+TEST_F(ImageManagerTest, TestDuplicateUpload)
+{
+    Manager manager(bus, loop, environment());
+
+    auto tarball = createTarball("1.0");
+    auto copy = fs::path(tmpDir) / "copy.tar";
+    fs::copy_file(tarball, copy);
+    auto again = fs::path(tmpDir) / "again.tar";
+    fs::copy_file(tarball, again);
+    auto id = idOf(tarball);
+
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 0); }));
+    EXPECT_EQ(lookups, 1);
+
+    // Completes with the version of the first upload, without being
+    // extracted again
+    EXPECT_EQ(manager.processImage(copy), 0);
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 1); }));
+    EXPECT_EQ(manager.getUploadProgress(1)->status(),
+              OperationStatus::Completed);
+    EXPECT_FALSE(fs::exists(copy));
+    EXPECT_EQ(lookups, 1);
+    EXPECT_EQ(images(), std::vector<std::string>{id});
+
+    // Once the version is deleted, the image is extracted again
+    manager.erase(id);
+    EXPECT_TRUE(images().empty());
+    EXPECT_EQ(manager.processImage(again), 0);
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 2); }));
+    EXPECT_EQ(manager.getUploadProgress(2)->status(),
+              OperationStatus::Completed);
+    EXPECT_EQ(images(), std::vector<std::string>{id});
+}
+
+TEST_F(ImageManagerTest, TestDuplicateWhileExtracting)
+{
+    Manager manager(bus, loop, environment());
+    blocked = true;
+
+    auto tarball = createTarball("1.0");
+    auto copy = fs::path(tmpDir) / "copy.tar";
+    fs::copy_file(tarball, copy);
+    auto id = idOf(tarball);
+
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    ASSERT_TRUE(waitForLookups(1));
+    EXPECT_EQ(manager.processImage(copy), 0);
+
+    // The duplicate waits for the image to be extracted by the first upload
+    ASSERT_TRUE(runUntil([&]() { return !fs::exists(copy); }));
+    for (int i = 0; i < 3; i++)
+    {
+        sd_event_run(loop, 100000);
+    }
+    EXPECT_FALSE(isFinished(manager, 1));
+
+    release();
+    ASSERT_TRUE(runUntil([&]() {
+        return isFinished(manager, 0) && isFinished(manager, 1);
+    }));
+    EXPECT_EQ(manager.getUploadProgress(0)->status(),
+              OperationStatus::Completed);
+    EXPECT_EQ(manager.getUploadProgress(1)->status(),
+              OperationStatus::Completed);
+    EXPECT_EQ(lookups, 1);
+    EXPECT_EQ(images(), std::vector<std::string>{id});
+}
+
+TEST_F(ImageManagerTest, TestDuplicateOfFailedUpload)
+{
+    Manager manager(bus, loop, environment());
+    blocked = true;
+
+    auto tarball = createInvalidTarball("invalid");
+    auto copy = fs::path(tmpDir) / "copy.tar";
+    fs::copy_file(tarball, copy);
+
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    ASSERT_TRUE(waitForLookups(1));
+    EXPECT_EQ(manager.processImage(copy), 0);
+    ASSERT_TRUE(runUntil([&]() { return !fs::exists(copy); }));
+
+    // Fails along with the upload it duplicates
+    release();
+    ASSERT_TRUE(runUntil([&]() {
+        return isFinished(manager, 0) && isFinished(manager, 1);
+    }));
+    EXPECT_EQ(manager.getUploadProgress(0)->status(), OperationStatus::Failed);
+    EXPECT_EQ(manager.getUploadProgress(1)->status(), OperationStatus::Failed);
+}
+
+TEST_F(ImageManagerTest, TestIdCollisionOnDBus)
+{
+    Manager manager(bus, loop, environment());
+
+    // e.g. the version of the item updater once the image was activated,
+    // which this service doesn't manage
+    auto tarball = createTarball("1.0");
+    auto id = idOf(tarball);
+    objects.push_back(std::string{SOFTWARE_OBJPATH} + '/' + id);
+
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 0); }));
+    EXPECT_EQ(manager.getUploadProgress(0)->status(),
+              OperationStatus::Completed);
+
+    // Extracted under a salted id
+    EXPECT_EQ(lookups, 2);
+    auto ids = images();
+    ASSERT_EQ(ids.size(), 1);
+    EXPECT_NE(ids.front(), id);
+}
+
+TEST_F(ImageManagerTest, TestStaleImageDir)
+{
+    Manager manager(bus, loop, environment());
+
+    // Left behind by a previous run, it isn't replaced by the rename
+    auto tarball = createTarball("1.0");
+    auto id = idOf(tarball);
+    fs::create_directories(uploadDir / id);
+    std::ofstream(uploadDir / id / "other") << "other";
+
+    EXPECT_EQ(manager.processImage(tarball), 0);
+    ASSERT_TRUE(runUntil([&]() { return isFinished(manager, 0); }));
+    EXPECT_EQ(manager.getUploadProgress(0)->status(),
+              OperationStatus::Completed);
+
+    EXPECT_TRUE(fs::exists(uploadDir / id / "other"));
+    auto ids = images();
+    ASSERT_EQ(ids.size(), 1);
+    EXPECT_NE(ids.front(), id);
+}
@@ -12,7 +12,7 @@ namespace updater
 
 namespace softwareServer = sdbusplus::server::xyz::openbmc_project::software;
 
-void Activation::flashWrite()
+bool Activation::flashWrite()
 {
     auto method = bus.new_method_call(SYSTEMD_BUSNAME, SYSTEMD_PATH,
                                       SYSTEMD_INTERFACE, "StartUnit");
@@ -25,7 +25,8 @@ void Activation::flashWrite()
     method.append(roServiceFile, "replace");
     bus.call_noreply(method);
 
-    return;
+    // The services report their result through onStateChanges
+    return true;
 }
 
 void Activation::onStateChanges(sdbusplus::message_t& msg)
@@ -1,9 +1,18 @@
 #include "update_manager.hpp"
 
+#if defined BMC_STATIC_DUAL_IMAGE && defined WANT_SIGNATURE_VERIFY
+#include "alt_flash_stream.hpp"
+#endif
+#ifdef WANT_SIGNATURE_VERIFY
+#include "image_digests.hpp"
+#endif
 #include "item_updater.hpp"
 #include "software_utils.hpp"
 #include "version.hpp"
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/lg2.hpp>
@@ -11,7 +20,13 @@
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Software/Image/error.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <future>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 
 PHOSPHOR_LOG2_USING;
 
@@ -24,6 +39,7 @@ namespace SoftwareLogging = phosphor::logging::xyz::openbmc_project::software;
 namespace SoftwareErrors =
     sdbusplus::error::xyz::openbmc_project::software::image;
 using namespace phosphor::logging;
+using Manifest = phosphor::software::manager::Manifest;
 using Version = phosphor::software::manager::Version;
 using ActivationIntf = phosphor::software::updater::Activation;
 using ManifestFail = SoftwareLogging::image::ManifestFileFailure;
@@ -45,6 +61,43 @@ void Manager::processImageFailed(sdbusplus::message::unix_fd image,
     }
 }
 
+/** @brief Run work on a thread of its own, and resume once it is done
+ *  @details The context keeps serving D-Bus meanwhile. The eventfd is
+ *           signalled by the thread once the result is set.
+ */
+template <typename Work>
+auto runInThread(sdbusplus::async::context& ctx, Work work)
+    -> sdbusplus::async::task<std::invoke_result_t<Work>>
+{
+    const int notifyFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (notifyFd < 0)
+    {
+        co_return work();
+    }
+
+    std::packaged_task<std::invoke_result_t<Work>()> task(std::move(work));
+    auto result = task.get_future();
+    {
+        std::jthread worker([&task, notifyFd]() {
+            task();
+
+            // an eventfd write only fails on counter overflow
+            const uint64_t one = 1;
+            std::ignore = write(notifyFd, &one, sizeof(one));
+        });
+
+        sdbusplus::async::fdio fdio(ctx, notifyFd);
+        while (result.wait_for(std::chrono::seconds(0)) !=
+               std::future_status::ready)
+        {
+            co_await fdio.next();
+        }
+    }
+    close(notifyFd);
+
+    co_return result.get();
+}
+
 bool verifyImagePurpose(Version::VersionPurpose purpose,
                         ItemUpdaterIntf::UpdaterType type)
 {
@@ -78,8 +131,55 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
     tmpDirPath = tmpDir;
     softwareUtils::RemovablePath tmpDirToRemove(tmpDirPath);
 
-    // Untar tarball into the tmp dir
-    if (!softwareUtils::unTar(image, tmpDirPath.string()))
+    fs::path manifestPath = tmpDirPath;
+    manifestPath /= MANIFEST_FILE_NAME;
+
+#ifdef WANT_SIGNATURE_VERIFY
+    // Hash the files for the signature verification while they stream by,
+    // the digests stay in this process, which verifies the image
+    image::DigestCollector digests(tmpDirPath);
+    softwareUtils::TarObserver* observer = &digests;
+#else
+    softwareUtils::TarObserver* observer = nullptr;
+#endif
+
+#if defined BMC_STATIC_DUAL_IMAGE && defined WANT_SIGNATURE_VERIFY
+    // Running from the secondary chip, an image which is activated right away
+    // is written to the primary one while it is uploaded, rather than held in
+    // RAM until the activation
+    std::optional<updater::AltFlashStream> altStream;
+    if (itemUpdater.runningImageSlot != 0 &&
+        (applyTime == ApplyTimeIntf::RequestedApplyTimes::Immediate ||
+         applyTime == ApplyTimeIntf::RequestedApplyTimes::OnReset))
+    {
+        altStream.emplace(tmpDirPath, observer);
+        observer = &*altStream;
+    }
+#endif
+
+    // Untar tarball into the tmp dir and parse the manifest once for all
+    // the keys below, off the D-Bus context
+    auto extracted = co_await runInThread(
+        ctx, [fd = image.fd, tmpDirPath, manifestPath, observer]() {
+            std::optional<Manifest> manifest;
+            if (softwareUtils::unTar(fd, tmpDirPath.string(), false, observer))
+            {
+                manifest = Manifest::read(manifestPath);
+            }
+            return manifest;
+        });
+
+#if defined BMC_STATIC_DUAL_IMAGE && defined WANT_SIGNATURE_VERIFY
+    // The chip is given back whether the extraction succeeded or not
+    bool streamed = false;
+    if (altStream)
+    {
+        streamed = co_await runInThread(
+            ctx, [&altStream]() { return altStream->release(); });
+    }
+#endif
+
+    if (!extracted)
     {
         error("Error occurred during untar");
         processImageFailed(image, id);
@@ -87,12 +187,10 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
             UnTarFail::PATH(tmpDirPath.c_str()));
         co_return;
     }
-
-    fs::path manifestPath = tmpDirPath;
-    manifestPath /= MANIFEST_FILE_NAME;
+    const auto& manifest = *extracted;
 
     // Get version
-    auto version = Version::getValue(manifestPath.string(), "version");
+    auto version = manifest.getValue("version");
     if (version.empty())
     {
         error("Unable to read version from manifest file");
@@ -117,8 +215,7 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
     }
 
     // Get machine name for image to be upgraded
-    std::string machineStr =
-        Version::getValue(manifestPath.string(), "MachineName");
+    std::string machineStr = manifest.getValue("MachineName");
     if (!machineStr.empty())
     {
         if (machineStr != currMachine)
@@ -142,7 +239,7 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
     }
 
     // Get purpose
-    auto purposeString = Version::getValue(manifestPath.string(), "purpose");
+    auto purposeString = manifest.getValue("purpose");
     if (purposeString.empty())
     {
         error("Unable to read purpose from manifest file");
@@ -173,12 +270,11 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
     }
 
     // Get ExtendedVersion
-    std::string extendedVersion =
-        Version::getValue(manifestPath.string(), "ExtendedVersion");
+    std::string extendedVersion = manifest.getValue("ExtendedVersion");
 
     // Get CompatibleNames
     std::vector<std::string> compatibleNames =
-        Version::getRepeatedValues(manifestPath.string(), "CompatibleName");
+        manifest.getRepeatedValues("CompatibleName");
 
     // Rename IMG_UPLOAD_DIR/imageXXXXXX to IMG_UPLOAD_DIR/id as Manifest
     // parsing succeeded.
@@ -187,6 +283,18 @@ auto Manager::processImage(sdbusplus::message::unix_fd image,
     fs::rename(tmpDirPath, imageDirPath, ec);
     tmpDirToRemove.path.clear();
 
+#ifdef WANT_SIGNATURE_VERIFY
+    // Renaming the directory leaves the stamps of the files unchanged
+    image::DigestStore::instance().add(imageDirPath, digests.takeDigests());
+#endif
+
+#if defined BMC_STATIC_DUAL_IMAGE && defined WANT_SIGNATURE_VERIFY
+    if (streamed)
+    {
+        itemUpdater.streamedImages.insert(id);
+    }
+#endif
+
     auto filePath = imageDirPath.string();
     // Create Version object
     auto state = itemUpdater.verifyAndCreateObjects(
@@ -30,25 +30,20 @@ using namespace sdbusplus::error::xyz::openbmc_project::common;
 std::string Version::getValue(const std::string& manifestFilePath,
                               std::string key)
 {
-    std::vector<std::string> values = getRepeatedValues(manifestFilePath, key);
-    if (values.empty())
-    {
-        return std::string{};
-    }
-    if (values.size() > 1)
+    if (manifestFilePath.empty())
     {
-        error("Multiple values found in MANIFEST file for key: {KEY}", "KEY",
-              key);
+        error("ManifestFilePath is empty.");
+        elog<InvalidArgument>(
+            Argument::ARGUMENT_NAME("manifestFilePath"),
+            Argument::ARGUMENT_VALUE(manifestFilePath.c_str()));
     }
-    return values.at(0);
+
+    return Manifest::read(manifestFilePath).getValue(key);
 }
 
 std::vector<std::string> Version::getRepeatedValues(
     const std::string& manifestFilePath, std::string key)
 {
-    key = key + "=";
-    auto keySize = key.length();
-
     if (manifestFilePath.empty())
     {
         error("ManifestFilePath is empty.");
@@ -57,45 +52,7 @@ std::vector<std::string> Version::getRepeatedValues(
             Argument::ARGUMENT_VALUE(manifestFilePath.c_str()));
     }
 
-    std::vector<std::string> values{};
-    std::ifstream efile;
-    std::string line;
-    efile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    // Too many GCC bugs (53984, 66145) to do this the right way...
-    try
-    {
-        efile.open(manifestFilePath);
-        while (getline(efile, line))
-        {
-            if (!line.empty() && line.back() == '\r')
-            {
-                // If the manifest has CRLF line terminators, e.g. is created on
-                // Windows, the line will contain \r at the end, remove it.
-                line.pop_back();
-            }
-            if (line.compare(0, keySize, key) == 0)
-            {
-                values.push_back(line.substr(keySize));
-            }
-        }
-        efile.close();
-    }
-    catch (const std::exception& e)
-    {
-        if (!efile.eof())
-        {
-            error("Error occurred when reading MANIFEST file: {ERROR}", "KEY",
-                  key, "ERROR", e);
-        }
-    }
-
-    if (values.empty())
-    {
-        info("No values found in MANIFEST file for key: {KEY}", "KEY", key);
-    }
-
-    return values;
+    return Manifest::read(manifestFilePath).getRepeatedValues(key);
 }
 
 using EVP_MD_CTX_Ptr =
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "manifest.hpp"
 #include "xyz/openbmc_project/Common/FilePath/server.hpp"
 #include "xyz/openbmc_project/Inventory/Decorator/Compatible/server.hpp"
 #include "xyz/openbmc_project/Object/Delete/server.hpp"
@@ -102,6 +103,7 @@ class Version : public VersionInherit
 
     /**
      * @brief Read the manifest file to get the value of the key.
+     *        Use a Manifest to look up several keys.
      *
      * @return The value of the key.
      **/
@@ -0,0 +1,363 @@
+#include "bus_scheduler.hpp"
+
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+#include <tuple>
+
+extern "C"
+{
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+}
+
+namespace phosphor::i2c
+{
+
+BusScheduler::~BusScheduler() = default;
+
+BusScheduler& BusScheduler::instance()
+{
+    static BusScheduler scheduler;
+    return scheduler;
+}
+
+BusScheduler::Bus* BusScheduler::getBus(uint16_t bus)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto it = buses.find(bus);
+    if (it != buses.end())
+    {
+        return it->second.get();
+    }
+
+    std::unique_ptr<Transport> transport =
+        transportFactory ? transportFactory(bus) : DeviceTransport::open(bus);
+
+    if (transport == nullptr)
+    {
+        // retry next time, the bus may show up later
+        return nullptr;
+    }
+
+    return buses
+        .emplace(bus, std::make_unique<Bus>(bus, std::move(transport)))
+        .first->second.get();
+}
+
+bool BusScheduler::openBus(uint16_t bus)
+{
+    return getBus(bus) != nullptr;
+}
+
+bool BusScheduler::supportsProtocolMangling(uint16_t bus)
+{
+    Bus* b = getBus(bus);
+
+    return b != nullptr && b->supportsProtocolMangling();
+}
+
+void BusScheduler::setTransportFactory(TransportFactory factory)
+{
+    std::map<uint16_t, std::unique_ptr<Bus>> closed;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        transportFactory = std::move(factory);
+        closed.swap(buses);
+    }
+
+    // the bus threads are joined here, without holding the lock
+    closed.clear();
+}
+
+int BusScheduler::transfer(uint16_t bus, const void* client,
+                           struct i2c_msg* msgs, size_t count)
+{
+    return submit(bus, client, msgs, count, -1).get();
+}
+
+std::future<int> BusScheduler::submit(uint16_t bus, const void* client,
+                                      struct i2c_msg* msgs, size_t count,
+                                      int notifyFd)
+{
+    int error = -EINVAL;
+
+    if (count > 0 && count <= I2C_RDWR_IOCTL_MAX_MSGS)
+    {
+        Bus* b = getBus(bus);
+
+        if (b != nullptr)
+        {
+            return b->submit(client, msgs, count, notifyFd);
+        }
+
+        error = -ENODEV;
+    }
+
+    Transaction failed{client, msgs, count, std::chrono::steady_clock::now(),
+                       notifyFd, std::promise<int>()};
+    std::future<int> result = failed.done.get_future();
+
+    complete(failed, error);
+
+    return result;
+}
+
+void BusScheduler::cancel(uint16_t bus, const void* client)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    auto it = buses.find(bus);
+    if (it == buses.end())
+    {
+        return;
+    }
+
+    Bus* b = it->second.get();
+
+    guard.unlock();
+
+    b->cancel(client);
+}
+
+BusStats BusScheduler::getStats(uint16_t bus)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    auto it = buses.find(bus);
+    if (it == buses.end())
+    {
+        return {};
+    }
+
+    Bus* b = it->second.get();
+
+    guard.unlock();
+
+    return b->getStats();
+}
+
+void BusScheduler::logStats(uint16_t bus, const BusStats& since)
+{
+    const BusStats now = getStats(bus);
+
+    const uint64_t transactions = now.transactions - since.transactions;
+
+    if (transactions == 0)
+    {
+        return;
+    }
+
+    const auto meanWait = (now.totalWait - since.totalWait) / transactions;
+
+    lg2::info(
+        "i2c-{BUS}: {TRANSACTIONS} transactions, mean queue wait {MEAN_WAIT_US}us, queue depth {DEPTH}, max wait {MAX_WAIT_US}us and max depth {MAX_DEPTH} since startup",
+        "BUS", bus, "TRANSACTIONS", transactions, "MEAN_WAIT_US",
+        meanWait.count(), "DEPTH", now.queueDepth, "MAX_WAIT_US",
+        now.maxWait.count(), "MAX_DEPTH", now.maxQueueDepth);
+}
+
+BusScheduler::Bus::Bus(uint16_t bus, std::unique_ptr<Transport> transport) :
+    busNumber(bus), transport(std::move(transport))
+{
+    worker = std::thread([this]() { run(); });
+}
+
+BusScheduler::Bus::~Bus()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+std::future<int> BusScheduler::Bus::submit(
+    const void* client, struct i2c_msg* msgs, size_t count, int notifyFd)
+{
+    auto txn = std::make_unique<Transaction>(
+        client, msgs, count, std::chrono::steady_clock::now(), notifyFd,
+        std::promise<int>());
+
+    std::future<int> result = txn->done.get_future();
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        bytes += msgs[i].len;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        ClientQueues& queues =
+            (bytes > shortTransferMax) ? bulkQueues : shortQueues;
+
+        auto it = std::ranges::find_if(
+            queues, [client](const auto& q) { return q.first == client; });
+
+        if (it == queues.end())
+        {
+            queues.emplace_back(client,
+                                std::deque<std::unique_ptr<Transaction>>());
+            it = std::prev(queues.end());
+        }
+
+        it->second.push_back(std::move(txn));
+
+        stats.queueDepth++;
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, stats.queueDepth);
+    }
+
+    cv.notify_one();
+
+    return result;
+}
+
+void BusScheduler::Bus::cancel(const void* client)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    for (ClientQueues* queues : {&shortQueues, &bulkQueues})
+    {
+        auto it = std::ranges::find_if(
+            *queues, [client](const auto& q) { return q.first == client; });
+
+        if (it == queues->end())
+        {
+            continue;
+        }
+
+        for (auto& txn : it->second)
+        {
+            stats.queueDepth--;
+            complete(*txn, -ECANCELED);
+        }
+
+        queues->erase(it);
+    }
+
+    runningDone.wait(guard, [this, client]() { return running != client; });
+}
+
+void BusScheduler::complete(Transaction& txn, int result)
+{
+    txn.done.set_value(result);
+
+    if (txn.notifyFd < 0)
+    {
+        return;
+    }
+
+    // an eventfd write only fails on counter overflow
+    const uint64_t one = 1;
+    std::ignore = write(txn.notifyFd, &one, sizeof(one));
+}
+
+BusStats BusScheduler::Bus::getStats()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
+
+bool BusScheduler::Bus::supportsProtocolMangling() const
+{
+    return transport->supportsProtocolMangling();
+}
+
+std::unique_ptr<BusScheduler::Transaction>
+    BusScheduler::Bus::popRoundRobin(ClientQueues& queues)
+{
+    auto [client, pending] = std::move(queues.front());
+    queues.pop_front();
+
+    std::unique_ptr<Transaction> txn = std::move(pending.front());
+    pending.pop_front();
+
+    // move the client to the back, so the others get their turn
+    if (!pending.empty())
+    {
+        queues.emplace_back(client, std::move(pending));
+    }
+
+    return txn;
+}
+
+std::unique_ptr<BusScheduler::Transaction> BusScheduler::Bus::next()
+{
+    const bool bulkWaiting = !bulkQueues.empty();
+
+    if (!shortQueues.empty() && (!bulkWaiting || shortBurst < maxShortBurst))
+    {
+        if (bulkWaiting)
+        {
+            shortBurst++;
+        }
+        return popRoundRobin(shortQueues);
+    }
+
+    shortBurst = 0;
+
+    return popRoundRobin(bulkQueues);
+}
+
+void BusScheduler::Bus::run()
+{
+    while (true)
+    {
+        std::unique_ptr<Transaction> txn;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+
+            cv.wait(guard, [this]() {
+                return stopping || !shortQueues.empty() || !bulkQueues.empty();
+            });
+
+            if (shortQueues.empty() && bulkQueues.empty())
+            {
+                return;
+            }
+
+            txn = next();
+
+            const auto wait = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - txn->enqueued);
+
+            stats.queueDepth--;
+            stats.transactions++;
+            stats.totalWait += wait;
+            stats.maxWait = std::max(stats.maxWait, wait);
+
+            running = txn->client;
+        }
+
+        complete(*txn, execute(*txn));
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            running = nullptr;
+        }
+        runningDone.notify_all();
+    }
+}
+
+int BusScheduler::Bus::execute(Transaction& txn) const
+{
+    return transport->transfer(txn.msgs, txn.count);
+}
+
+} // namespace phosphor::i2c
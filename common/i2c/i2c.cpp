@@ -1,7 +1,15 @@
 #include "i2c.hpp"
 
+#include "bus_scheduler.hpp"
+
+#include <sys/eventfd.h>
 #include <unistd.h>
 
+#include <sdbusplus/async/fdio.hpp>
+
+#include <cerrno>
+#include <future>
+
 extern "C"
 {
 #include <i2c/smbus.h>
@@ -12,23 +20,41 @@ extern "C"
 namespace phosphor::i2c
 {
 
-int I2C::open()
+namespace
 {
-    int ret = 0;
-    fd = ::open(busStr.c_str(), O_RDWR);
-    if (fd < 0)
-    {
-        return fd;
-    }
 
-    ret = ioctl(fd, I2C_SLAVE_FORCE, deviceNode);
-    if (ret < 0)
+// Closes the eventfd of a transaction on every exit of I2C::transfer.
+// Until the eventfd was signalled, the bus thread may still write to it,
+// even if the result is already available, so the transaction is
+// cancelled first, which waits for the bus thread to be done with it.
+struct TransferGuard
+{
+    uint16_t bus;
+    const void* client;
+    int notifyFd;
+    bool signalled = false;
+
+    ~TransferGuard()
     {
-        close();
-        return ret;
+        if (!signalled)
+        {
+            BusScheduler::instance().cancel(bus, client);
+        }
+
+        ::close(notifyFd);
     }
+};
 
-    return 0;
+} // namespace
+
+int I2C::open()
+{
+    opened = BusScheduler::instance().openBus(bus);
+
+    protocolMangling =
+        opened && BusScheduler::instance().supportsProtocolMangling(bus);
+
+    return opened ? 0 : -1;
 }
 
 sdbusplus::async::task<bool> I2C::sendReceive(
@@ -37,14 +63,13 @@ sdbusplus::async::task<bool> I2C::sendReceive(
 {
     bool result = true;
 
-    if (fd <= 0)
+    if (!opened)
     {
         result = false;
     }
     else
     {
         struct i2c_msg msg[2];
-        struct i2c_rdwr_ioctl_data readWriteData;
         int msgIndex = 0;
 
         if (writeSize)
@@ -65,69 +90,180 @@ sdbusplus::async::task<bool> I2C::sendReceive(
             msgIndex++;
         }
 
-        readWriteData.msgs = msg;
-        readWriteData.nmsgs = msgIndex;
-
-        if (ioctl(fd, I2C_RDWR, &readWriteData) < 0)
-        {
-            result = false;
-        }
+        result = co_await transfer(msg, msgIndex) >= 0;
     }
     co_return result;
 }
 
-bool I2C::sendReceive(const std::vector<uint8_t>& writeData,
-                      std::vector<uint8_t>& readData) const
+size_t I2C::buildMessages(const std::vector<uint8_t>& writeData,
+                          std::vector<uint8_t>& readData,
+                          struct i2c_msg* msg) const
 {
-    bool result = true;
+    size_t msgIndex = 0;
 
-    if (fd <= 0)
+    if (!writeData.empty())
+    {
+        msg[msgIndex].addr = deviceNode;
+        msg[msgIndex].flags = 0;
+        msg[msgIndex].len = writeData.size();
+        msg[msgIndex].buf = const_cast<uint8_t*>(writeData.data());
+        msgIndex++;
+    }
+
+    if (!readData.empty())
+    {
+        msg[msgIndex].addr = deviceNode;
+        msg[msgIndex].flags = I2C_M_RD;
+        msg[msgIndex].len = readData.size();
+        msg[msgIndex].buf = readData.data();
+        msgIndex++;
+    }
+
+    return msgIndex;
+}
+
+sdbusplus::async::task<bool> I2C::sendReceive(
+    const std::vector<uint8_t>& writeData, std::vector<uint8_t>& readData) const
+{
+    if (!opened)
+    {
+        co_return false;
+    }
+
+    struct i2c_msg msg[2];
+    const size_t count = buildMessages(writeData, readData, msg);
+
+    co_return co_await transfer(msg, count) >= 0;
+}
+
+bool I2C::sendReceiveBlocking(const std::vector<uint8_t>& writeData,
+                              std::vector<uint8_t>& readData) const
+{
+    if (!opened)
     {
         return false;
     }
-    else
+
+    struct i2c_msg msg[2];
+    const size_t count = buildMessages(writeData, readData, msg);
+
+    return BusScheduler::instance().transfer(bus, this, msg, count) >= 0;
+}
+
+sdbusplus::async::task<int> I2C::sendReceiveBatch(
+    std::span<I2CMessage> messages) const
+{
+    for (I2CMessage& message : messages)
     {
-        struct i2c_msg msg[2];
-        struct i2c_rdwr_ioctl_data readWriteData;
-        int msgIndex = 0;
+        message.transferred = false;
+    }
+
+    if (!opened)
+    {
+        co_return -ENODEV;
+    }
 
-        if (!writeData.empty())
+    if (messages.empty() || messages.size() > maxBatchMessages)
+    {
+        co_return -EINVAL;
+    }
+
+    struct i2c_msg msg[maxBatchMessages];
+
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+        msg[i].addr = deviceNode;
+        msg[i].flags = (messages[i].read ? I2C_M_RD : 0) |
+                       (messages[i].stop && protocolMangling ? I2C_M_STOP : 0);
+        msg[i].len = messages[i].size;
+        msg[i].buf = messages[i].data;
+    }
+
+    for (size_t start = 0; start < messages.size();)
+    {
+        // each transfer ends with a STOP
+        size_t end = messages.size();
+
+        if (!protocolMangling)
         {
-            msg[msgIndex].addr = deviceNode;
-            msg[msgIndex].flags = 0;
-            msg[msgIndex].len = writeData.size();
-            msg[msgIndex].buf = const_cast<uint8_t*>(writeData.data());
-            msgIndex++;
+            end = start + 1;
+            while (end < messages.size() && !messages[end - 1].stop)
+            {
+                end++;
+            }
         }
 
-        if (!readData.empty())
+        const size_t count = end - start;
+        const int transferred = co_await transfer(msg + start, count);
+
+        if (transferred < 0)
         {
-            msg[msgIndex].addr = deviceNode;
-            msg[msgIndex].flags = I2C_M_RD;
-            msg[msgIndex].len = readData.size();
-            msg[msgIndex].buf = readData.data();
-            msgIndex++;
+            co_return transferred;
         }
 
-        readWriteData.msgs = msg;
-        readWriteData.nmsgs = msgIndex;
+        for (int i = 0; i < transferred; i++)
+        {
+            messages[start + i].transferred = true;
+        }
 
-        if (ioctl(fd, I2C_RDWR, &readWriteData) < 0)
+        if (transferred != static_cast<int>(count))
         {
-            result = false;
+            co_return -EIO;
         }
+
+        start = end;
     }
 
-    return result;
+    co_return 0;
+}
+
+sdbusplus::async::task<int> I2C::transfer(struct i2c_msg* msgs,
+                                          size_t count) const
+{
+    BusScheduler& scheduler = BusScheduler::instance();
+
+    const int notifyFd =
+        (ctx != nullptr) ? eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK) : -1;
+
+    if (notifyFd < 0)
+    {
+        co_return scheduler.transfer(bus, this, msgs, count);
+    }
+
+    // The coroutine may be destroyed while it waits, e.g. when it is
+    // stopped. The bus thread must then be done with the messages before
+    // they go away with the frame.
+    TransferGuard guard{bus, this, notifyFd};
+
+    std::future<int> result =
+        scheduler.submit(bus, this, msgs, count, notifyFd);
+
+    sdbusplus::async::fdio fdio(*ctx, notifyFd);
+
+    // The eventfd is signalled after the result was set, so once it is
+    // drained the result is available and the bus thread won't touch the
+    // eventfd again. It may already be signalled, no need to wait then.
+    uint64_t signals = 0;
+
+    while (read(notifyFd, &signals, sizeof(signals)) != sizeof(signals))
+    {
+        co_await fdio.next();
+    }
+
+    guard.signalled = true;
+
+    co_return result.get();
 }
 
 void I2C::close()
 {
-    if (fd != invalidFd)
+    if (opened)
     {
-        ::close(fd);
-        fd = invalidFd;
+        // the bus thread must be done with our buffers
+        BusScheduler::instance().cancel(bus, this);
     }
+
+    opened = false;
 }
 
 } // namespace phosphor::i2c
@@ -0,0 +1,66 @@
+#include "i2c_transport.hpp"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+extern "C"
+{
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+}
+
+namespace phosphor::i2c
+{
+
+DeviceTransport::DeviceTransport(int fd, unsigned long functionality) :
+    fd(fd), functionality(functionality)
+{}
+
+DeviceTransport::~DeviceTransport()
+{
+    ::close(fd);
+}
+
+std::unique_ptr<Transport> DeviceTransport::open(uint16_t bus)
+{
+    const std::string busStr = "/dev/i2c-" + std::to_string(bus);
+
+    const int fd = ::open(busStr.c_str(), O_RDWR | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    // without the flags, assume the adapter only supports plain transfers
+    unsigned long functionality = 0;
+    if (ioctl(fd, I2C_FUNCS, &functionality) < 0)
+    {
+        functionality = 0;
+    }
+
+    return std::unique_ptr<Transport>(new DeviceTransport(fd, functionality));
+}
+
+int DeviceTransport::transfer(struct i2c_msg* msgs, size_t count)
+{
+    struct i2c_rdwr_ioctl_data readWriteData;
+
+    readWriteData.msgs = msgs;
+    readWriteData.nmsgs = count;
+
+    const int ret = ioctl(fd, I2C_RDWR, &readWriteData);
+
+    return (ret < 0) ? -errno : ret;
+}
+
+bool DeviceTransport::supportsProtocolMangling() const
+{
+    return (functionality & I2C_FUNC_PROTOCOL_MANGLING) != 0;
+}
+
+} // namespace phosphor::i2c
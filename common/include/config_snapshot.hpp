@@ -0,0 +1,145 @@
+#pragma once
+
+#include <boost/container/flat_map.hpp>
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async.hpp>
+#include <sdbusplus/async/context.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace phosphor::software::config
+{
+
+/* This class holds all properties of the configuration interfaces of a single
+ * entity-manager object. It is fetched with one GetManagedObjects for all
+ * objects (or taken directly from the InterfacesAdded signal) so that the code
+ * updaters can read their configuration without further D-Bus round trips.
+ */
+class ConfigSnapshot
+{
+  public:
+    using PropertyValue =
+        std::variant<std::vector<std::string>, std::string, int64_t, uint64_t,
+                     double, int32_t, uint32_t, int16_t, uint16_t, uint8_t,
+                     bool>;
+    using PropertyMap = boost::container::flat_map<std::string, PropertyValue>;
+    using InterfaceMap = boost::container::flat_map<std::string, PropertyMap>;
+    using ObjectMap = boost::container::flat_map<std::string, InterfaceMap>;
+
+    // Where entity-manager hosts its object manager
+    static constexpr auto managerPath = "/xyz/openbmc_project/inventory";
+
+    ConfigSnapshot() = default;
+
+    explicit ConfigSnapshot(InterfaceMap interfaces) :
+        interfaces(std::move(interfaces))
+    {}
+
+    // @param ctx           the async context
+    // @param service       the dbus name where our configuration is
+    // @param path          the object path of the configuration
+    // @param interfaces    the configuration interfaces to fetch, with their
+    //                      sub-interfaces
+    // @returns             the snapshot, std::nullopt if the call failed or
+    //                      the object has none of the interfaces.
+    //                      Properties of unsupported types are left out.
+    static sdbusplus::async::task<std::optional<ConfigSnapshot>> fetch(
+        sdbusplus::async::context& ctx, const std::string& service,
+        const std::string& path, const std::vector<std::string>& interfaces);
+
+    // Fetches the configuration of all objects below 'managerPath' with a
+    // single GetManagedObjects.
+    // @param ctx           the async context
+    // @param service       the dbus name where our configuration is
+    // @param interfaces    the configuration interfaces to fetch, with their
+    //                      sub-interfaces
+    // @returns             the objects which have any of the interfaces,
+    //                      std::nullopt if the call failed
+    static sdbusplus::async::task<std::optional<ObjectMap>> fetchAll(
+        sdbusplus::async::context& ctx, const std::string& service,
+        const std::vector<std::string>& interfaces);
+
+    // Reads the a{sv} reply of a GetAll. Properties of types which are not
+    // a 'PropertyValue' are skipped.
+    // @param msg    the message, positioned at the property array
+    // @returns      the properties which could be decoded
+    static PropertyMap decodeProperties(sdbusplus::message_t& msg);
+
+    // Reads the a{oa{sa{sv}}} reply of a GetManagedObjects. Properties of
+    // types which are not a 'PropertyValue' are skipped.
+    // @param msg           the message, positioned at the object array
+    // @param interfaces    the interfaces to decode, with their
+    //                      sub-interfaces. The others are skipped.
+    // @returns             the objects which have any of the interfaces
+    static ObjectMap decodeManagedObjects(
+        sdbusplus::message_t& msg, const std::vector<std::string>& interfaces);
+
+    // @returns      true if 'interfaceName' is 'configIface' or one of its
+    //               sub-interfaces like <configIface>.FirmwareInfo
+    static bool isConfigInterface(const std::string& interfaceName,
+                                  const std::string& configIface);
+
+    // @returns      true if the snapshot contains the interface
+    bool hasInterface(const std::string& interface) const;
+
+    // @returns      the property value, or std::nullopt if the property
+    //               is missing or has a different type
+    template <typename T>
+    std::optional<T> get(const std::string& interface,
+                         const std::string& property) const
+    {
+        auto itIntf = interfaces.find(interface);
+        if (itIntf == interfaces.end())
+        {
+            return std::nullopt;
+        }
+
+        auto itProp = itIntf->second.find(property);
+        if (itProp == itIntf->second.end())
+        {
+            return std::nullopt;
+        }
+
+        const T* value = std::get_if<T>(&itProp->second);
+        if (value == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        return *value;
+    }
+
+    // Same as 'get', but logs an error in case the property is missing.
+    template <typename T>
+    std::optional<T> getRequired(const std::string& interface,
+                                 const std::string& property) const
+    {
+        std::optional<T> value = get<T>(interface, property);
+
+        if (!value.has_value())
+        {
+            lg2::error("Missing property {PROPERTY} on interface {INTF}",
+                       "PROPERTY", property, "INTF", interface);
+        }
+
+        return value;
+    }
+
+    // Reads the 'Name' and 'Polarity' of the <configIface>.MuxOutputs<N>
+    // interfaces, stopping at the first index which is missing.
+    // @param configIface    the configuration interface of the device
+    // @param names          the gpio line names
+    // @param polarities     true for each gpio line with 'High' polarity
+    void getMuxOutputs(const std::string& configIface,
+                       std::vector<std::string>& names,
+                       std::vector<bool>& polarities) const;
+
+  private:
+    InterfaceMap interfaces;
+};
+
+}; // namespace phosphor::software::config
@@ -3,6 +3,7 @@
 #include "events.hpp"
 #include "software.hpp"
 #include "software_config.hpp"
+#include "update_timing.hpp"
 
 #include <sdbusplus/async/context.hpp>
 #include <xyz/openbmc_project/Association/Definitions/aserver.hpp>
@@ -10,6 +11,8 @@
 #include <xyz/openbmc_project/Software/Update/aserver.hpp>
 #include <xyz/openbmc_project/Software/Version/aserver.hpp>
 
+#include <functional>
+#include <optional>
 #include <string>
 
 using ActivationInterface =
@@ -20,6 +23,17 @@ namespace phosphor::software::manager
 class SoftwareManager;
 };
 
+namespace pldm_package_util
+{
+class PackageIndex;
+class MappedPackage;
+};
+
+namespace phosphor::software::update
+{
+class GroupUpdate;
+};
+
 namespace phosphor::software::device
 {
 
@@ -62,9 +76,31 @@ class Device
         sdbusplus::message::unix_fd image, RequestedApplyTimes applyTime,
         std::unique_ptr<Software> softwareUpdateExternal);
 
+    // @brief                      Same as above, for a package which is
+    //                             already mapped and parsed, like for a
+    //                             group update.
+    // @param package              The mapped pldm package, nullptr if it
+    //                             could not be mapped
+    sdbusplus::async::task<bool> startUpdateAsync(
+        std::shared_ptr<const pldm_package_util::MappedPackage> package,
+        RequestedApplyTimes applyTime,
+        std::unique_ptr<Software> softwareUpdateExternal);
+
     // Value of 'Type' field for the configuration in EM exposes record
     std::string getEMConfigType() const;
 
+    // @param packageIndex    the parsed pldm package
+    // @returns               true if the package has a component image
+    //                        for this device
+    bool isApplicable(
+        const pldm_package_util::PackageIndex& packageIndex) const;
+
+    // @returns     an identifier of the bus this device is accessed through.
+    //              Group updates do not update devices on the same bus
+    //              concurrently. std::nullopt if the device does not share
+    //              its bus with other devices.
+    virtual std::optional<std::string> getUpdateBus() const;
+
   protected:
     // The apply times for updates which are supported by the device
     // Override this if your device deviates from the default set of apply
@@ -99,6 +135,13 @@ class Device
 
     bool updateInProgress = false;
 
+    // @brief               Marks the start of a phase of the update, for
+    //                      timing. Ends the previous phase.
+    //                      Call this from 'updateDevice', time which is not
+    //                      attributed to a phase counts as programming.
+    // @param phase         the phase which starts now
+    void beginUpdatePhase(update::UpdatePhase phase);
+
   private:
     // @param componentImage       component image as extracted from update pkg
     // @param componentImageSize   size of 'componentImage'
@@ -111,14 +154,26 @@ class Device
         const std::string& componentVersion, RequestedApplyTimes applyTime);
 
     // @brief     extracts the information we need from the pldm package
+    // @param package         the mapped package
     // @returns   true on success
     sdbusplus::async::task<bool> getImageInfo(
         const sdbusplus::object_path& objectPath,
-        std::unique_ptr<void, std::function<void(void*)>>& pldmPackage,
-        size_t pldmPackageSize, uint8_t** matchingComponentImage,
-        size_t* componentImageSize, std::string& componentVersion);
+        const pldm_package_util::MappedPackage& package,
+        const uint8_t** matchingComponentImage, size_t* componentImageSize,
+        std::string& componentVersion);
+
+    // @param version     the version the device was updated to
+    // @param success     if the update was successful
+    void finishUpdateTiming(const std::string& version, bool success);
+
+    // Only present while an update is running
+    std::optional<update::UpdateTimer> updateTimer;
+
+    // Set during a group update, to aggregate the progress of all devices
+    std::function<void(uint8_t)> updateProgressListener;
 
     friend update::SoftwareUpdate;
+    friend update::GroupUpdate;
     friend Software;
     friend manager::SoftwareManager;
 };
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "software_update.hpp"
+
+#include <sdbusplus/async/context.hpp>
+#include <xyz/openbmc_project/Association/Definitions/aserver.hpp>
+#include <xyz/openbmc_project/Software/Activation/aserver.hpp>
+#include <xyz/openbmc_project/Software/ActivationProgress/aserver.hpp>
+#include <xyz/openbmc_project/Software/Update/aserver.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace phosphor::software::device
+{
+class Device;
+}
+
+namespace phosphor::software::manager
+{
+class SoftwareManager;
+}
+
+namespace pldm_package_util
+{
+class MappedPackage;
+}
+
+namespace phosphor::software::update
+{
+
+class GroupUpdateJob;
+
+using GroupUpdateActivation =
+    sdbusplus::aserver::xyz::openbmc_project::software::Activation<
+        GroupUpdateJob>;
+using GroupUpdateActivationProgress =
+    sdbusplus::aserver::xyz::openbmc_project::software::ActivationProgress<
+        GroupUpdateJob>;
+using GroupUpdateAssociationDefinitions =
+    sdbusplus::aserver::xyz::openbmc_project::association::Definitions<
+        GroupUpdateJob>;
+
+// This represents one group update which fans out to many devices.
+// It aggregates the progress of all devices, and associates to the
+// pending software of every device so the per-device results can be read
+// from their Activation property.
+class GroupUpdateJob : private GroupUpdateActivation
+{
+  public:
+    // @param ctx           the async context
+    // @param objectPath    where to host the job on dbus
+    // @param devices       the devices which will be updated
+    GroupUpdateJob(sdbusplus::async::context& ctx,
+                   const sdbusplus::object_path& objectPath,
+                   const std::vector<device::Device*>& devices);
+
+    // @param softwarePath  object path of the pending software of a device
+    void addSoftware(const sdbusplus::object_path& softwarePath);
+
+    // @param device        the device
+    // @param progress      update progress of that device in percent
+    void setDeviceProgress(const device::Device* device, uint8_t progress);
+
+    // @param device        the device
+    // @param success       if the update of that device was successful
+    void setDeviceResult(const device::Device* device, bool success);
+
+    // @returns             true once all devices have a result
+    bool isDone() const;
+
+    const sdbusplus::object_path objectPath;
+
+  private:
+    void updateAssociations();
+
+    std::map<const device::Device*, uint8_t> deviceProgress;
+
+    std::map<const device::Device*, bool> deviceResults;
+
+    std::vector<std::tuple<std::string, std::string, std::string>> assocs;
+
+    std::unique_ptr<GroupUpdateActivationProgress> activationProgress;
+
+    std::unique_ptr<GroupUpdateAssociationDefinitions> associationDefinitions;
+
+    sdbusplus::async::context& ctx;
+};
+
+// The group update interface of a code updater. A single StartUpdate call
+// applies the package to every device whose descriptor matches it.
+// Devices on the same bus are updated one after the other, devices on
+// different buses are updated concurrently.
+class GroupUpdate :
+    public sdbusplus::aserver::xyz::openbmc_project::software::Update<
+        GroupUpdate>
+{
+  public:
+    GroupUpdate(const GroupUpdate&) = delete;
+    GroupUpdate(GroupUpdate&&) = delete;
+    GroupUpdate& operator=(const GroupUpdate&) = delete;
+    GroupUpdate& operator=(GroupUpdate&&) = delete;
+
+    // @param ctx                 the async context
+    // @param path                where to host the interface on dbus
+    // @param manager             the manager owning the devices
+    // @param allowedApplyTimes   the apply times to allow
+    GroupUpdate(sdbusplus::async::context& ctx,
+                const sdbusplus::object_path& path,
+                manager::SoftwareManager& manager,
+                const std::set<RequestedApplyTimes>& allowedApplyTimes);
+
+    ~GroupUpdate();
+
+    auto method_call(start_update_t su, auto image, auto applyTime)
+        -> sdbusplus::async::task<start_update_t::return_type>;
+
+    auto get_property(allowed_apply_times_t aat) const;
+
+    // How many finished jobs we keep around so their results can be read
+    static constexpr size_t maxRetainedJobs = 8;
+
+  private:
+    // @param job           the job to report progress to
+    // @param devices       the devices on one bus, updated in order
+    // @param package       the package, mapped and parsed once for the group
+    // @param applyTime     when the update should be applied
+    sdbusplus::async::task<> updateBus(
+        GroupUpdateJob& job, std::vector<device::Device*> devices,
+        std::shared_ptr<const pldm_package_util::MappedPackage> package,
+        RequestedApplyTimes applyTime);
+
+    void pruneJobs();
+
+    sdbusplus::async::context& ctx;
+
+    const sdbusplus::object_path objectPath;
+
+    manager::SoftwareManager& manager;
+
+    const std::set<RequestedApplyTimes> allowedApplyTimes;
+
+    std::map<sdbusplus::object_path, std::unique_ptr<GroupUpdateJob>> jobs;
+
+    // creation order of 'jobs', oldest first
+    std::vector<sdbusplus::object_path> jobOrder;
+};
+
+}; // namespace phosphor::software::update
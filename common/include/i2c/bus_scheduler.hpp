@@ -0,0 +1,233 @@
+#pragma once
+
+#include "i2c_transport.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+extern "C"
+{
+#include <linux/i2c.h>
+}
+
+namespace phosphor::i2c
+{
+
+// Statistics of the transaction queue of one bus
+struct BusStats
+{
+    // transactions currently waiting to be executed
+    size_t queueDepth = 0;
+    size_t maxQueueDepth = 0;
+
+    // transactions executed so far
+    uint64_t transactions = 0;
+
+    // time transactions spent in the queue before being executed
+    std::chrono::microseconds totalWait{0};
+    std::chrono::microseconds maxWait{0};
+};
+
+// Process-wide scheduler for i2c transactions. It owns one transport per
+// bus, by default the kernel bus device, and
+// executes the transactions of each bus in order on a dedicated thread,
+// so different buses are served in parallel while transactions of different
+// devices on the same bus never interleave mid-transaction.
+//
+// Fairness: short transactions (e.g. version/CRC reads) are served before
+// bulk transactions (e.g. firmware programming). After 'maxShortBurst'
+// consecutive short transactions, one waiting bulk transaction is served so
+// neither class is starved. Within a class, clients are served round robin.
+class BusScheduler
+{
+  public:
+    // Transactions moving more bytes than this are considered bulk.
+    // 8 bytes cover a PMBus command with a word write or a block read of a
+    // 32 bit version/CRC, including PEC. At 100 kHz a byte takes about
+    // 90us on the wire, so a short transaction occupies the bus for less
+    // than 1ms. Firmware is mostly written in blocks of 16 (Lattice pages)
+    // to 32 bytes (PMBus block writes), which take 2-4ms each. Programming
+    // sequences built from word writes count as short, which is fine since
+    // they don't hold the bus any longer than a version read does, and
+    // clients are served round robin within a class anyway.
+    static constexpr size_t shortTransferMax = 8;
+
+    static constexpr size_t maxShortBurst = 4;
+
+    BusScheduler(const BusScheduler&) = delete;
+    BusScheduler& operator=(const BusScheduler&) = delete;
+    BusScheduler(BusScheduler&&) = delete;
+    BusScheduler& operator=(BusScheduler&&) = delete;
+
+    ~BusScheduler();
+
+    // @returns     the scheduler shared by all devices in this process
+    static BusScheduler& instance();
+
+    // @param bus       the i2c bus number
+    // @returns         true if the bus device can be opened
+    bool openBus(uint16_t bus);
+
+    // @param bus       the i2c bus number
+    // @returns         true if the adapter of the bus honors I2C_M_STOP,
+    //                  false if it doesn't or the bus cannot be opened
+    bool supportsProtocolMangling(uint16_t bus);
+
+    // Replaces how the transport of a bus is created, e.g. by a simulated
+    // bus in unit tests. Buses which are already open are closed, so this
+    // must be called while no I2C instance is open.
+    // @param factory   the factory, nullptr restores the kernel bus device
+    void setTransportFactory(TransportFactory factory);
+
+    // Queues the transaction and waits for it to be executed.
+    // @param bus       the i2c bus number
+    // @param client    identifies the caller, for round robin
+    // @param msgs      the messages of the transaction
+    // @param count     number of messages, at most I2C_RDWR_IOCTL_MAX_MSGS
+    // @returns         the number of messages which were transferred,
+    //                  negative errno on failure
+    int transfer(uint16_t bus, const void* client, struct i2c_msg* msgs,
+                 size_t count);
+
+    // Queues the transaction without waiting for it.
+    // The messages must stay valid until the transaction completed.
+    // @param notifyFd  an eventfd which is signalled once the result is
+    //                  available, or -1. It must stay open until it was
+    //                  signalled or the client was cancelled.
+    // @returns         the result, as for 'transfer'
+    std::future<int> submit(uint16_t bus, const void* client,
+                            struct i2c_msg* msgs, size_t count, int notifyFd);
+
+    // Drops the queued transactions of a client and waits for its running
+    // transaction, so the client can release its buffers.
+    // @param bus       the i2c bus number
+    // @param client    the client
+    void cancel(uint16_t bus, const void* client);
+
+    // @param bus       the i2c bus number
+    // @returns         the statistics of that bus
+    BusStats getStats(uint16_t bus);
+
+    // Logs the queue statistics of the bus since 'since' at info level.
+    // @param bus       the i2c bus number
+    // @param since     statistics taken earlier, e.g. before an update
+    void logStats(uint16_t bus, const BusStats& since);
+
+  private:
+    BusScheduler() = default;
+
+    struct Transaction
+    {
+        const void* client;
+        struct i2c_msg* msgs;
+        size_t count;
+        std::chrono::steady_clock::time_point enqueued;
+        int notifyFd;
+        std::promise<int> done;
+    };
+
+    // Publishes the result and then signals the eventfd of the transaction,
+    // so a waiter which drained the eventfd finds the result.
+    // @param txn       the transaction to complete
+    // @param result    its result
+    static void complete(Transaction& txn, int result);
+
+    class Bus
+    {
+      public:
+        Bus(uint16_t bus, std::unique_ptr<Transport> transport);
+        ~Bus();
+
+        Bus(const Bus&) = delete;
+        Bus& operator=(const Bus&) = delete;
+        Bus(Bus&&) = delete;
+        Bus& operator=(Bus&&) = delete;
+
+        std::future<int> submit(const void* client, struct i2c_msg* msgs,
+                                 size_t count, int notifyFd);
+
+        void cancel(const void* client);
+
+        BusStats getStats();
+
+        bool supportsProtocolMangling() const;
+
+      private:
+        // one queue per client, in round robin order
+        using ClientQueues = std::deque<
+            std::pair<const void*, std::deque<std::unique_ptr<Transaction>>>>;
+
+        void run();
+
+        std::unique_ptr<Transaction> next();
+
+        static std::unique_ptr<Transaction> popRoundRobin(
+            ClientQueues& queues);
+
+        int execute(Transaction& txn) const;
+
+        const uint16_t busNumber;
+
+        const std::unique_ptr<Transport> transport;
+
+        std::mutex lock;
+        std::condition_variable cv;
+        bool stopping = false;
+
+        // the client of the transaction being executed
+        const void* running = nullptr;
+        std::condition_variable runningDone;
+
+        ClientQueues shortQueues;
+        ClientQueues bulkQueues;
+
+        // consecutive short transactions while bulk ones were waiting
+        size_t shortBurst = 0;
+
+        BusStats stats;
+
+        std::thread worker;
+    };
+
+    std::mutex lock;
+
+    std::map<uint16_t, std::unique_ptr<Bus>> buses;
+
+    TransportFactory transportFactory;
+
+    Bus* getBus(uint16_t bus);
+};
+
+// Logs the queue statistics of a bus for its lifetime, e.g. the duration of
+// a firmware update, once it goes out of scope
+class BusStatsSummary
+{
+  public:
+    explicit BusStatsSummary(uint16_t bus) :
+        bus(bus), since(BusScheduler::instance().getStats(bus))
+    {}
+
+    BusStatsSummary(const BusStatsSummary&) = delete;
+    BusStatsSummary& operator=(const BusStatsSummary&) = delete;
+    BusStatsSummary(BusStatsSummary&&) = delete;
+    BusStatsSummary& operator=(BusStatsSummary&&) = delete;
+
+    ~BusStatsSummary()
+    {
+        BusScheduler::instance().logStats(bus, since);
+    }
+
+  private:
+    const uint16_t bus;
+    const BusStats since;
+};
+
+} // namespace phosphor::i2c
@@ -8,7 +8,9 @@
 
 #include <cstdint>
 #include <cstring>
+#include <span>
 #include <string>
+#include <vector>
 
 extern "C"
 {
@@ -20,11 +22,38 @@ extern "C"
 namespace phosphor::i2c
 {
 
+// One message of a batched transfer
+struct I2CMessage
+{
+    // read from the device into 'data', instead of writing 'data'
+    bool read = false;
+
+    // end the message with a STOP instead of a repeated START
+    bool stop = false;
+
+    uint8_t* data = nullptr;
+
+    uint16_t size = 0;
+
+    // set by sendReceiveBatch once the message was transferred
+    bool transferred = false;
+};
+
+// Transactions are not issued on a private fd, but queued on the
+// process-wide BusScheduler, which owns one fd per bus.
 class I2C
 {
   public:
-    explicit I2C(uint16_t bus, uint16_t node) :
-        busStr("/dev/i2c-" + std::to_string(bus)), deviceNode(node)
+    explicit I2C(uint16_t bus, uint16_t node) : bus(bus), deviceNode(node)
+    {
+        open();
+    }
+
+    // The coroutine methods of this instance suspend until the bus thread
+    // has executed the transfer, so the event loop of 'ctx' keeps running.
+    // Without a context, they block until the transfer is done.
+    explicit I2C(sdbusplus::async::context& ctx, uint16_t bus,
+                 uint16_t node) : ctx(&ctx), bus(bus), deviceNode(node)
     {
         open();
     }
@@ -42,21 +71,55 @@ class I2C
     sdbusplus::async::task<bool> sendReceive(
         uint8_t* writeData, uint8_t writeSize, uint8_t* readData,
         uint8_t readSize) const;
-    bool sendReceive(const std::vector<uint8_t>& writeData,
-                     std::vector<uint8_t>& readData) const;
+    sdbusplus::async::task<bool> sendReceive(
+        const std::vector<uint8_t>& writeData,
+        std::vector<uint8_t>& readData) const;
+
+    // Blocks the calling thread until the transfer is done, even with a
+    // context. Only for callers which don't run on the event loop.
+    bool sendReceiveBlocking(const std::vector<uint8_t>& writeData,
+                             std::vector<uint8_t>& readData) const;
+
+    // If the adapter supports I2C_FUNC_PROTOCOL_MANGLING, the messages are
+    // transferred in a single I2C_RDWR ioctl, which saves a kernel round
+    // trip per message. Otherwise the adapter would ignore I2C_M_STOP, so
+    // there is one transfer for each message with 'stop' instead, and
+    // batching only saves something for messages without 'stop'.
+    // The transfers stop at the first one which fails, 'transferred' tells
+    // which messages made it.
+    // @param messages      at most 'maxBatchMessages' messages
+    // @returns             0 if all messages were transferred, negative
+    //                      errno of the failed transfer otherwise
+    sdbusplus::async::task<int> sendReceiveBatch(
+        std::span<I2CMessage> messages) const;
+
+    static constexpr size_t maxBatchMessages = I2C_RDWR_IOCTL_MAX_MSGS;
 
     bool isOpen() const
     {
-        return (fd != invalidFd);
+        return opened;
     }
 
     void close();
 
   private:
-    static constexpr int invalidFd = -1;
-    int fd = invalidFd;
-    std::string busStr;
+    // @param msg   receives at most a write and a read message
+    // @returns     the number of messages in 'msg'
+    size_t buildMessages(const std::vector<uint8_t>& writeData,
+                         std::vector<uint8_t>& readData,
+                         struct i2c_msg* msg) const;
+
+    // @returns     the number of transferred messages, negative errno on
+    //              failure
+    sdbusplus::async::task<int> transfer(struct i2c_msg* msgs,
+                                         size_t count) const;
+
+    sdbusplus::async::context* ctx = nullptr;
+    uint16_t bus;
     uint16_t deviceNode;
+    bool opened = false;
+    // the adapter honors I2C_M_STOP
+    bool protocolMangling = false;
     int open();
 }; // end class I2C
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+extern "C"
+{
+#include <linux/i2c.h>
+}
+
+namespace phosphor::i2c
+{
+
+// Executes the transactions of one i2c bus. The BusScheduler owns one
+// transport per bus and only calls it from the thread of that bus.
+class Transport
+{
+  public:
+    Transport() = default;
+    virtual ~Transport() = default;
+
+    Transport(const Transport&) = delete;
+    Transport& operator=(const Transport&) = delete;
+    Transport(Transport&&) = delete;
+    Transport& operator=(Transport&&) = delete;
+
+    // @param msgs      the messages of the transaction
+    // @param count     number of messages, at most I2C_RDWR_IOCTL_MAX_MSGS
+    // @returns         the number of messages which were transferred,
+    //                  negative errno on failure
+    virtual int transfer(struct i2c_msg* msgs, size_t count) = 0;
+
+    // @returns         true if the adapter honors I2C_M_STOP within a
+    //                  transaction (I2C_FUNC_PROTOCOL_MANGLING). May be
+    //                  called from any thread.
+    virtual bool supportsProtocolMangling() const = 0;
+};
+
+// The /dev/i2c-N character device of the kernel
+class DeviceTransport : public Transport
+{
+  public:
+    ~DeviceTransport() override;
+
+    DeviceTransport(const DeviceTransport&) = delete;
+    DeviceTransport& operator=(const DeviceTransport&) = delete;
+    DeviceTransport(DeviceTransport&&) = delete;
+    DeviceTransport& operator=(DeviceTransport&&) = delete;
+
+    // @param bus       the i2c bus number
+    // @returns         the transport, nullptr if the bus device cannot be
+    //                  opened
+    static std::unique_ptr<Transport> open(uint16_t bus);
+
+    int transfer(struct i2c_msg* msgs, size_t count) override;
+
+    bool supportsProtocolMangling() const override;
+
+  private:
+    DeviceTransport(int fd, unsigned long functionality);
+
+    const int fd;
+
+    // the I2C_FUNC_* flags of the adapter
+    const unsigned long functionality;
+};
+
+// Creates the transport of a bus, returns nullptr if there is no such bus
+using TransportFactory =
+    std::function<std::unique_ptr<Transport>(uint16_t bus)>;
+
+} // namespace phosphor::i2c
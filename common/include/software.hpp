@@ -4,6 +4,7 @@
 
 #include <sdbusplus/async/context.hpp>
 #include <xyz/openbmc_project/Association/Definitions/aserver.hpp>
+#include <xyz/openbmc_project/Common/Progress/aserver.hpp>
 #include <xyz/openbmc_project/Software/Activation/aserver.hpp>
 #include <xyz/openbmc_project/Software/ActivationBlocksTransition/aserver.hpp>
 #include <xyz/openbmc_project/Software/ActivationProgress/aserver.hpp>
@@ -17,6 +18,11 @@ namespace phosphor::software::device
 class Device;
 }
 
+namespace phosphor::software::update
+{
+class GroupUpdate;
+}
+
 namespace phosphor::software
 {
 
@@ -27,6 +33,8 @@ using SoftwareVersion =
     sdbusplus::aserver::xyz::openbmc_project::software::Version<Software>;
 using SoftwareActivation =
     sdbusplus::aserver::xyz::openbmc_project::software::Activation<Software>;
+using SoftwareProgress =
+    sdbusplus::aserver::xyz::openbmc_project::common::Progress<Software>;
 using SoftwareAssociationDefinitions =
     sdbusplus::aserver::xyz::openbmc_project::association::Definitions<
         Software>;
@@ -79,6 +87,10 @@ class Software : private SoftwareActivation
                         ActivationProgress<Software>>
         softwareActivationProgress = nullptr;
 
+    // Start time of the update, and its completion time once it is done.
+    // Kept after the update to tell how long it took.
+    std::unique_ptr<SoftwareProgress> softwareProgress = nullptr;
+
     static long int getRandomId();
 
   protected:
@@ -127,6 +139,7 @@ class Software : private SoftwareActivation
     sdbusplus::async::context& ctx;
 
     friend update::SoftwareUpdate;
+    friend update::GroupUpdate;
     friend device::Device;
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "config_snapshot.hpp"
 #include "device.hpp"
+#include "group_update.hpp"
 #include "sdbusplus/async/match.hpp"
 
 #include <boost/asio/steady_timer.hpp>
@@ -9,31 +11,63 @@
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/async/context.hpp>
 #include <sdbusplus/timer.hpp>
+#include <xyz/openbmc_project/State/ServiceReady/aserver.hpp>
 
+#include <deque>
 #include <set>
 #include <string>
 
 using namespace phosphor::software::config;
 using namespace phosphor::software::device;
 
+class SoftwareManagerTest;
+
 namespace phosphor::software::manager
 {
 
+class SoftwareManager;
+
+using SoftwareManagerServiceReady =
+    sdbusplus::aserver::xyz::openbmc_project::state::ServiceReady<
+        SoftwareManager>;
+
 // This is the base class for the code updater
 // Every code updater can inherit from this
 class SoftwareManager
 {
   public:
+    // Default number of devices which may be initialized concurrently, set
+    // by the 'max-concurrent-device-inits' meson option
+    static const size_t defaultMaxConcurrentInits;
+
+    // @param ctx                   the async context
+    // @param serviceNameSuffix     suffix of the dbus name to request
+    // @param maxConcurrentInits    upper bound on devices which are
+    //                              initialized at the same time
     SoftwareManager(sdbusplus::async::context& ctx,
-                    const std::string& serviceNameSuffix);
+                    const std::string& serviceNameSuffix,
+                    size_t maxConcurrentInits = defaultMaxConcurrentInits);
 
     // Fetches initial configuration from dbus and initializes devices.
     // This should be called once by a code updater at startup.
+    // Devices are initialized concurrently, bounded by 'maxConcurrentInits'.
+    // Once all devices found at startup are initialized, the State of the
+    // ServiceReady interface at <software namespace>/service/<suffix> goes
+    // from Starting to Enabled.
     // @param configurationInterfaces    the dbus interfaces from which to fetch
     // configuration
     sdbusplus::async::task<> initDevices(
         const std::vector<std::string>& configurationInterfaces);
 
+    // @returns true once all devices found at startup have been initialized
+    bool isDiscoveryComplete() const;
+
+    // Hosts the group update interface, which applies one package to all
+    // devices matching it.
+    // @param allowedApplyTimes    the apply times to allow for group updates
+    void enableGroupUpdate(
+        const std::set<RequestedApplyTimes>& allowedApplyTimes);
+
     // Map of EM config object path to device.
     std::map<sdbusplus::object_path, std::unique_ptr<Device>> devices;
 
@@ -47,23 +81,49 @@ class SoftwareManager
     // by all devices.
     //                      Also includes the object path to fetch other
     //                      configuration properties.
+    // @param snapshot      All properties of the configuration interfaces,
+    //                      fetched in one pass. Prefer this over additional
+    //                      property lookups on dbus.
     // @returns true        if the configuration was accepted
     virtual sdbusplus::async::task<bool> initDevice(
         const std::string& service, const sdbusplus::object_path& path,
-        SoftwareConfig& config) = 0;
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) = 0;
 
     std::string getBusName();
 
     sdbusplus::async::context& ctx;
 
   private:
-    sdbusplus::async::task<void> handleInterfaceAdded(
-        const std::string& service, const sdbusplus::object_path& path,
-        const std::string& interface);
+    // A configuration object which is waiting to be initialized
+    struct PendingInit
+    {
+        std::string service;
+        sdbusplus::object_path path;
+        std::string interface;
+        // taken from the initial scan or the InterfacesAdded signal, if it
+        // carried all configuration interfaces. Otherwise fetched on init.
+        std::optional<ConfigSnapshot> snapshot;
+    };
+
+    // Queues a configuration object for initialization and spawns another
+    // init worker if we are below the concurrency bound.
+    void queueInterfaceAdded(PendingInit pending);
+
+    // Marks the result of the initial scan as queued, discovery completes
+    // once the queued devices are initialized.
+    void finishInitialScan();
+
+    // Initializes queued configuration objects until the queue is empty.
+    sdbusplus::async::task<void> initWorker();
+
+    // Enables the ServiceReady state once the initial scan is done and all
+    // init workers have finished.
+    void checkDiscoveryComplete();
+
+    sdbusplus::async::task<void> handleInterfaceAdded(PendingInit pending);
 
     sdbusplus::async::task<void> handleInterfaceAddedGuarded(
-        const std::string& service, const std::string& path,
-        const std::string& interface);
+        PendingInit& pending);
 
     sdbusplus::async::task<void> handleInterfaceRemoved(
         const sdbusplus::object_path& path);
@@ -84,8 +144,25 @@ class SoftwareManager
 
     friend Software;
     friend Device;
+    friend ::SoftwareManagerTest;
+
+    std::unique_ptr<update::GroupUpdate> groupUpdate;
 
     std::set<sdbusplus::object_path> initializingPaths;
+
+    std::deque<PendingInit> pendingInits;
+
+    const size_t maxConcurrentInits;
+
+    size_t activeInitWorkers = 0;
+
+    // set once the result of the initial GetSubTree has been queued
+    bool initialScanQueued = false;
+
+    bool discoveryComplete = false;
+
+    // Starting until discovery is complete, then Enabled
+    std::unique_ptr<SoftwareManagerServiceReady> serviceReady;
 };
 
 }; // namespace phosphor::software::manager
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor::software::update
+{
+
+// The phases of an update, in the order they usually happen.
+// Parse, Match and Reset are timed by the common code, Verify by the device
+// specific update function. Time not attributed to a specific phase
+// while the device is being updated counts as Program.
+enum class UpdatePhase
+{
+    Parse,
+    Match,
+    Verify,
+    Program,
+    Reset,
+};
+
+// @returns     a short name of the phase, e.g. for log entries
+std::string_view getPhaseName(UpdatePhase phase);
+
+// Measures the duration of the phases of one update, and estimates
+// throughput and remaining time from the reported progress.
+class UpdateTimer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t phaseCount =
+        static_cast<size_t>(UpdatePhase::Reset) + 1;
+
+    // @param now           when the update started
+    explicit UpdateTimer(Clock::time_point now = Clock::now());
+
+    // Ends the current phase, if any, and starts the next one.
+    // @param phase         the phase which starts now
+    // @param now           the current time
+    void beginPhase(UpdatePhase phase, Clock::time_point now = Clock::now());
+
+    // Ends the current phase, if any.
+    // @param now           the current time
+    void endPhase(Clock::time_point now = Clock::now());
+
+    // Accounts time to a phase which was measured elsewhere, e.g. when the
+    // package was parsed once for several devices.
+    // @param phase         the phase
+    // @param duration      time spent in that phase
+    void addPhaseDuration(UpdatePhase phase, Clock::duration duration);
+
+    // @returns             the phase which is running, if any
+    std::optional<UpdatePhase> getPhase() const;
+
+    // @param size          size of the component image, in bytes
+    void setImageSize(size_t size);
+
+    size_t getImageSize() const;
+
+    // @param phase         the phase
+    // @returns             time spent in that phase, without the
+    //                      phase which is still running
+    std::chrono::milliseconds getPhaseDuration(UpdatePhase phase) const;
+
+    // @param now           the current time
+    // @returns             the time since the update started
+    std::chrono::milliseconds getElapsed(
+        Clock::time_point now = Clock::now()) const;
+
+    // @param progress      the update progress in percent
+    // @param now           the current time
+    // @returns             bytes per second written to the device,
+    //                      0 if it cannot be estimated yet
+    uint64_t getThroughput(uint8_t progress,
+                           Clock::time_point now = Clock::now()) const;
+
+    // @param progress      the update progress in percent
+    // @param now           the current time
+    // @returns             the estimated time until the device is updated,
+    //                      std::nullopt if it cannot be estimated yet
+    std::optional<std::chrono::milliseconds> getRemaining(
+        uint8_t progress, Clock::time_point now = Clock::now()) const;
+
+    // @returns             bytes per second over the completed verify
+    //                      and program phases, 0 if nothing was timed
+    uint64_t getAverageThroughput() const;
+
+    // @returns             the phase durations, e.g. "parse=1 match=0 ..."
+    std::string getSummary() const;
+
+  private:
+    const Clock::time_point start;
+
+    std::optional<UpdatePhase> phase;
+
+    Clock::time_point phaseStart;
+
+    std::array<Clock::duration, phaseCount> durations{};
+
+    // when the device specific update function started
+    std::optional<Clock::time_point> deviceStart;
+
+    size_t imageSize = 0;
+};
+
+// Persists one line per completed update, keeping only the most recent
+// entries, so timing regressions can be found across firmware releases.
+class UpdateTimingLog
+{
+  public:
+    // @param path          the log file
+    // @param maxEntries    how many entries to keep
+    UpdateTimingLog(std::filesystem::path path, size_t maxEntries);
+
+    // @param entry         the entry to add, must not contain newlines
+    // @returns             true if the log was written
+    bool append(const std::string& entry) const;
+
+    // Same as 'append', but writes the log on a separate thread, so the
+    // event loop doesn't wait for the file system.
+    // @param entry         the entry to add, must not contain newlines
+    // @returns             the result of 'append', may be discarded
+    std::future<bool> appendAsync(std::string entry) const;
+
+    // @returns             the entries, oldest first
+    std::vector<std::string> read() const;
+
+  private:
+    const std::filesystem::path path;
+
+    const size_t maxEntries;
+};
+
+}; // namespace phosphor::software::update
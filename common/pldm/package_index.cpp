@@ -0,0 +1,309 @@
+#include "package_index.hpp"
+
+#include "pldm_package_util.hpp"
+
+#include <openssl/evp.h>
+#include <sys/stat.h>
+
+#include <libpldm++/firmware_update.hpp>
+#include <phosphor-logging/lg2.hpp>
+
+#include <functional>
+
+PHOSPHOR_LOG2_USING;
+
+using namespace pldm::fw_update;
+
+namespace pldm_package_util
+{
+
+using EVP_MD_CTX_Ptr =
+    std::unique_ptr<EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>;
+
+size_t PackageIndex::KeyHash::operator()(const Key& key) const
+{
+    const size_t h = std::hash<std::string>{}(key.second);
+    return h ^ (std::hash<uint32_t>{}(key.first) + 0x9e3779b9 + (h << 6) +
+                (h >> 2));
+}
+
+std::shared_ptr<const PackageIndex> PackageIndex::create(const uint8_t* buf,
+                                                         size_t size)
+{
+    std::unique_ptr<Package> package = parsePLDMPackage(buf, size);
+
+    if (package == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<PackageIndex>();
+
+    const std::vector<ComponentImageInfo>& cs =
+        package->componentImageInformation;
+
+    for (const FirmwareDeviceIDRecord& record :
+         package->firmwareDeviceIdRecords)
+    {
+        std::optional<uint32_t> vendorIANA = getRecordVendorIANA(record);
+        std::optional<std::string> compatible = getRecordCompatible(record);
+
+        if (!vendorIANA.has_value() || !compatible.has_value())
+        {
+            continue;
+        }
+
+        Key key{vendorIANA.value(), compatible.value()};
+
+        // the first matching record wins, as in
+        // findMatchingDeviceDescriptorIndex
+        if (index->components.contains(key))
+        {
+            continue;
+        }
+
+        const std::vector<size_t>& ac = record.applicableComponents;
+
+        if (ac.empty())
+        {
+            error("no applicable component image for {IANA}, {COMPATIBLE}",
+                  "IANA", lg2::hex, vendorIANA.value(), "COMPATIBLE",
+                  compatible.value());
+            continue;
+        }
+
+        // component is 0 based index
+        const size_t component = ac[0];
+
+        if (component >= cs.size())
+        {
+            error("applicable component out of bounds");
+            continue;
+        }
+
+        const ComponentImageInfo& c = cs[component];
+
+        index->components.emplace(
+            std::move(key),
+            ComponentImageLocation{
+                static_cast<size_t>(c.componentLocation.ptr - buf),
+                c.componentLocation.length, c.componentVersion});
+    }
+
+    debug("indexed PLDM package with {COUNT} device records", "COUNT",
+          index->components.size());
+
+    return index;
+}
+
+const ComponentImageLocation* PackageIndex::find(
+    uint32_t vendorIANA, const std::string& compatible) const
+{
+    auto it = components.find(Key{vendorIANA, compatible});
+
+    if (it == components.end())
+    {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+size_t PackageIndex::size() const
+{
+    return components.size();
+}
+
+PackageIndexCache& PackageIndexCache::instance()
+{
+    static PackageIndexCache cache;
+    return cache;
+}
+
+std::optional<PackageIndexCache::ContentKey> PackageIndexCache::hashHeader(
+    const uint8_t* buf, size_t size)
+{
+    // PackageHeaderSize follows the UUID and PackageHeaderFormatRevision
+    constexpr size_t headerSizeOffset = 17;
+
+    if (size < headerSizeOffset + 2)
+    {
+        return std::nullopt;
+    }
+
+    const size_t headerSize = buf[headerSizeOffset] |
+                              (size_t(buf[headerSizeOffset + 1]) << 8);
+
+    if (headerSize < headerSizeOffset + 2 || headerSize > size)
+    {
+        return std::nullopt;
+    }
+
+    // the size is part of the key, since the offsets of the component images
+    // are only valid for a package which is large enough
+    const uint64_t packageSize = size;
+
+    ContentKey contentKey{};
+    unsigned int digestSize = 0;
+
+    EVP_MD_CTX_Ptr ctx(EVP_MD_CTX_new(), &::EVP_MD_CTX_free);
+
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) <= 0 ||
+        EVP_DigestUpdate(ctx.get(), buf, headerSize) <= 0 ||
+        EVP_DigestUpdate(ctx.get(), &packageSize, sizeof(packageSize)) <= 0 ||
+        EVP_DigestFinal_ex(ctx.get(), contentKey.data(), &digestSize) <= 0 ||
+        digestSize != contentKey.size())
+    {
+        return std::nullopt;
+    }
+
+    return contentKey;
+}
+
+std::shared_ptr<const PackageIndex> PackageIndexCache::acquire(
+    int fd, const uint8_t* buf, size_t size)
+{
+    struct stat st{};
+
+    if (fstat(fd, &st) != 0)
+    {
+        error("could not stat package fd {FD}, not caching", "FD", fd);
+        return PackageIndex::create(buf, size);
+    }
+
+    // the header is hashed on every acquire, since the package may have
+    // been written to since the file was last seen
+    const std::optional<ContentKey> optContentKey = hashHeader(buf, size);
+
+    if (!optContentKey.has_value())
+    {
+        error("could not hash the header of package fd {FD}, not caching",
+              "FD", fd);
+        return PackageIndex::create(buf, size);
+    }
+
+    const ContentKey& contentKey = optContentKey.value();
+    const FileKey fileKey{st.st_dev, st.st_ino};
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto itEntry = entries.find(contentKey);
+
+    if (itEntry == entries.end())
+    {
+        std::shared_ptr<const PackageIndex> index =
+            PackageIndex::create(buf, size);
+
+        if (index == nullptr)
+        {
+            return nullptr;
+        }
+
+        itEntry = entries.emplace(contentKey, Entry{index, {}}).first;
+    }
+    else
+    {
+        debug("using cached PLDM package index");
+    }
+
+    Entry& entry = itEntry->second;
+
+    entry.files[fileKey]++;
+
+    // the returned pointer keeps the entry referenced until it is dropped
+    std::shared_ptr<const PackageIndex> index = entry.index;
+
+    return {index.get(),
+            [this, index, contentKey, fileKey](const PackageIndex*) {
+                release(contentKey, fileKey);
+            }};
+}
+
+void PackageIndexCache::release(const ContentKey& contentKey,
+                                const FileKey& fileKey)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto itEntry = entries.find(contentKey);
+
+    if (itEntry == entries.end())
+    {
+        return;
+    }
+
+    Entry& entry = itEntry->second;
+
+    auto itFile = entry.files.find(fileKey);
+
+    if (itFile != entry.files.end() && --itFile->second == 0)
+    {
+        entry.files.erase(itFile);
+    }
+
+    if (entry.files.empty())
+    {
+        debug("evicting PLDM package index");
+        entries.erase(itEntry);
+    }
+}
+
+size_t PackageIndexCache::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    return entries.size();
+}
+
+MappedPackage::MappedPackage(
+    std::unique_ptr<void, std::function<void(void*)>> mapping, size_t size,
+    std::shared_ptr<const PackageIndex> packageIndex,
+    std::chrono::steady_clock::duration parseDuration) :
+    mapping(std::move(mapping)), mappingSize(size),
+    packageIndex(std::move(packageIndex)), parseDuration(parseDuration)
+{}
+
+std::shared_ptr<const MappedPackage> MappedPackage::map(
+    sdbusplus::message::unix_fd image)
+{
+    size_t size = 0;
+    auto mapping = mmapImagePackage(image, &size);
+
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto parseStart = std::chrono::steady_clock::now();
+
+    std::shared_ptr<const PackageIndex> packageIndex =
+        PackageIndexCache::instance().acquire(
+            image.fd, static_cast<const uint8_t*>(mapping.get()), size);
+
+    const auto parseDuration = std::chrono::steady_clock::now() - parseStart;
+
+    return std::shared_ptr<const MappedPackage>(
+        new MappedPackage(std::move(mapping), size, std::move(packageIndex),
+                          parseDuration));
+}
+
+const uint8_t* MappedPackage::data() const
+{
+    return static_cast<const uint8_t*>(mapping.get());
+}
+
+size_t MappedPackage::size() const
+{
+    return mappingSize;
+}
+
+const PackageIndex* MappedPackage::index() const
+{
+    return packageIndex.get();
+}
+
+std::chrono::steady_clock::duration MappedPackage::getParseDuration() const
+{
+    return parseDuration;
+}
+
+} // namespace pldm_package_util
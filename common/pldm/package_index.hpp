@@ -0,0 +1,163 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <sdbusplus/message/native_types.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace pldm_package_util
+{
+
+// Location of a component image inside a pldm package
+struct ComponentImageLocation
+{
+    // offset of the component image from the start of the package
+    size_t offset;
+    size_t size;
+    std::string version;
+};
+
+// This is the result of parsing a pldm package once. It maps
+// (vendor iana, compatible) of every firmware device id record to the
+// location of its applicable component image.
+// Since only offsets are stored, the index is valid for any mapping
+// of the same package contents.
+class PackageIndex
+{
+  public:
+    // @param buf           pointer to the pldm package
+    // @param size          size of 'buf'
+    // @returns             the index, nullptr if the package could not be
+    //                      parsed
+    static std::shared_ptr<const PackageIndex> create(const uint8_t* buf,
+                                                      size_t size);
+
+    // @param vendorIANA    vendor iana of device
+    // @param compatible    'compatible' string of device
+    // @returns             the component image of the first record matching
+    //                      the device, nullptr if there is none
+    const ComponentImageLocation* find(uint32_t vendorIANA,
+                                       const std::string& compatible) const;
+
+    // @returns             number of devices this package has components for
+    size_t size() const;
+
+  private:
+    using Key = std::pair<uint32_t, std::string>;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    std::unordered_map<Key, ComponentImageLocation, KeyHash> components;
+};
+
+// Process-wide cache of parsed pldm packages, so that a package which is
+// sent to many devices is only parsed once.
+//
+// The index only depends on the package header, which holds the device
+// records and the offsets of the component images. Entries are keyed by the
+// SHA-256 of the header and the size of the package, so the component images,
+// which make up almost all of a package, are never read. The memfds which
+// currently reference an entry are tracked by inode. Once the last user of
+// an entry drops its reference, which happens right before the memfd
+// of the update is closed, the entry is evicted.
+class PackageIndexCache
+{
+  public:
+    // @returns             the cache shared by all devices in this process
+    static PackageIndexCache& instance();
+
+    // @param fd            file descriptor of the package
+    // @param buf           the mapped package
+    // @param size          size of 'buf'
+    // @returns             the index for the package, nullptr if the package
+    //                      could not be parsed. Hold on to it for as long
+    //                      as the package is in use.
+    std::shared_ptr<const PackageIndex> acquire(int fd, const uint8_t* buf,
+                                                size_t size);
+
+    // @returns             number of packages in the cache
+    size_t size() const;
+
+  private:
+    // (device, inode) of an open package file
+    using FileKey = std::pair<dev_t, ino_t>;
+
+    // SHA-256 of the header and the size of a package
+    using ContentKey = std::array<uint8_t, 32>;
+
+    // @returns             the key of the package, std::nullopt if it has
+    //                      no valid header size or could not be hashed
+    static std::optional<ContentKey> hashHeader(const uint8_t* buf,
+                                                size_t size);
+
+    struct Entry
+    {
+        std::shared_ptr<const PackageIndex> index;
+
+        // number of outstanding references per open package file
+        std::map<FileKey, size_t> files;
+    };
+
+    void release(const ContentKey& contentKey, const FileKey& fileKey);
+
+    mutable std::mutex lock;
+
+    std::map<ContentKey, Entry> entries;
+};
+
+// A pldm package which is mapped once, together with its index from the
+// PackageIndexCache. A group update shares it between all devices which are
+// updated from the package.
+class MappedPackage
+{
+  public:
+    // @param image         file descriptor of the package, the mapping
+    //                      stays valid once it is closed
+    // @returns             the package, nullptr if it could not be mapped
+    static std::shared_ptr<const MappedPackage> map(
+        sdbusplus::message::unix_fd image);
+
+    // @returns             the mapped package
+    const uint8_t* data() const;
+
+    // @returns             size of the mapped package
+    size_t size() const;
+
+    // @returns             the index, nullptr if the package could not be
+    //                      parsed
+    const PackageIndex* index() const;
+
+    // @returns             time it took to look up or parse the index,
+    //                      without mapping the package
+    std::chrono::steady_clock::duration getParseDuration() const;
+
+  private:
+    MappedPackage(std::unique_ptr<void, std::function<void(void*)>> mapping,
+                  size_t size, std::shared_ptr<const PackageIndex> packageIndex,
+                  std::chrono::steady_clock::duration parseDuration);
+
+    std::unique_ptr<void, std::function<void(void*)>> mapping;
+
+    size_t mappingSize;
+
+    std::shared_ptr<const PackageIndex> packageIndex;
+
+    std::chrono::steady_clock::duration parseDuration;
+};
+
+} // namespace pldm_package_util
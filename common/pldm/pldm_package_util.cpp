@@ -16,6 +16,7 @@
 #include <cassert>
 #include <cstring>
 #include <functional>
+#include <optional>
 
 PHOSPHOR_LOG2_USING;
 
@@ -108,18 +109,18 @@ std::unique_ptr<void, std::function<void(void*)>> mmapImagePackage(
     return dataUnique;
 }
 
-bool fwDeviceIDRecordMatchesCompatible(const FirmwareDeviceIDRecord& record,
-                                       const std::string& compatible)
+std::optional<std::string> getRecordCompatible(
+    const FirmwareDeviceIDRecord& record)
 {
     const auto& desc = record.recordDescriptors;
     if (desc.empty())
     {
-        return false;
+        return std::nullopt;
     }
 
     if (!desc.contains(PLDM_FWUP_VENDOR_DEFINED))
     {
-        return false;
+        return std::nullopt;
     }
 
     auto& v = desc.at(PLDM_FWUP_VENDOR_DEFINED);
@@ -127,28 +128,26 @@ bool fwDeviceIDRecordMatchesCompatible(const FirmwareDeviceIDRecord& record,
     if (!v->vendorDefinedDescriptorTitle.has_value())
     {
         debug("descriptor does not have the vendor defined descriptor info");
-        return false;
+        return std::nullopt;
     }
 
-    std::string actualCompatible = v->vendorDefinedDescriptorTitle.value();
-
-    return compatible == actualCompatible;
+    return v->vendorDefinedDescriptorTitle.value();
 }
 
-bool fwDeviceIDRecordMatchesIANA(const FirmwareDeviceIDRecord& record,
-                                 uint32_t vendorIANA)
+std::optional<uint32_t> getRecordVendorIANA(
+    const FirmwareDeviceIDRecord& record)
 {
     const auto& desc = record.recordDescriptors;
 
     if (desc.empty())
     {
-        return false;
+        return std::nullopt;
     }
 
     if (!desc.contains(PLDM_FWUP_IANA_ENTERPRISE_ID))
     {
         error("did not find iana enterprise id");
-        return false;
+        return std::nullopt;
     }
 
     auto& viana = desc.at(PLDM_FWUP_IANA_ENTERPRISE_ID);
@@ -158,13 +157,22 @@ bool fwDeviceIDRecordMatchesIANA(const FirmwareDeviceIDRecord& record,
     if (dd.data.size() != 4)
     {
         error("descriptor data wrong size ( != 4) for vendor iana");
-        return false;
+        return std::nullopt;
     }
 
-    const uint32_t actualIANA =
-        dd.data[0] | dd.data[1] << 8 | dd.data[2] << 16 | dd.data[3] << 24;
+    return dd.data[0] | dd.data[1] << 8 | dd.data[2] << 16 | dd.data[3] << 24;
+}
+
+bool fwDeviceIDRecordMatchesCompatible(const FirmwareDeviceIDRecord& record,
+                                       const std::string& compatible)
+{
+    return getRecordCompatible(record) == compatible;
+}
 
-    return actualIANA == vendorIANA;
+bool fwDeviceIDRecordMatchesIANA(const FirmwareDeviceIDRecord& record,
+                                 uint32_t vendorIANA)
+{
+    return getRecordVendorIANA(record) == vendorIANA;
 }
 
 bool fwDeviceIDRecordMatches(const FirmwareDeviceIDRecord& record,
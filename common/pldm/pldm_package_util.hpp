@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 
 namespace pldm_package_util
 {
@@ -28,6 +30,17 @@ int readImagePackage(FILE* file, uint8_t* packageData, size_t packageSize);
 std::unique_ptr<void, std::function<void(void*)>> mmapImagePackage(
     sdbusplus::message::unix_fd image, size_t* sizeOut);
 
+// @param record        firmware device id record of a package
+// @returns             the vendor defined descriptor title, which holds
+//                      the 'compatible' string of the device
+std::optional<std::string> getRecordCompatible(
+    const pldm::fw_update::FirmwareDeviceIDRecord& record);
+
+// @param record        firmware device id record of a package
+// @returns             the IANA enterprise id of the record
+std::optional<uint32_t> getRecordVendorIANA(
+    const pldm::fw_update::FirmwareDeviceIDRecord& record);
+
 // @param buf                    original package buffer
 // @param package                Package instance
 // @param compatible             'compatible' string of device
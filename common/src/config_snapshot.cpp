@@ -0,0 +1,271 @@
+#include "common/include/config_snapshot.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+PHOSPHOR_LOG2_USING;
+
+using namespace phosphor::software::config;
+
+// The signatures of the alternatives of 'PropertyValue'
+static constexpr std::array<std::string_view, 11> knownSignatures = {
+    "as", "s", "x", "t", "d", "i", "u", "n", "q", "y", "b",
+};
+
+ConfigSnapshot::PropertyMap ConfigSnapshot::decodeProperties(
+    sdbusplus::message_t& msg)
+{
+    sd_bus_message* m = msg.get();
+    PropertyMap properties;
+
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}");
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "enter property array");
+    }
+
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "sv")) > 0)
+    {
+        std::string name;
+        msg.read(name);
+
+        const char* contents = nullptr;
+        r = sd_bus_message_peek_type(m, nullptr, &contents);
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "peek property type");
+        }
+
+        if (contents != nullptr &&
+            std::ranges::find(knownSignatures, contents) !=
+                knownSignatures.end())
+        {
+            PropertyValue value;
+            msg.read(value);
+            properties.emplace(std::move(name), std::move(value));
+        }
+        else
+        {
+            debug("Skipping property {PROPERTY} of type {TYPE}", "PROPERTY",
+                  name, "TYPE", contents != nullptr ? contents : "");
+
+            r = sd_bus_message_skip(m, "v");
+            if (r < 0)
+            {
+                throw sdbusplus::exception::SdBusError(-r, "skip property");
+            }
+        }
+
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "exit property");
+        }
+    }
+
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "enter property");
+    }
+
+    r = sd_bus_message_exit_container(m);
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "exit property array");
+    }
+
+    return properties;
+}
+
+bool ConfigSnapshot::isConfigInterface(const std::string& interfaceName,
+                                       const std::string& configIface)
+{
+    return interfaceName == configIface ||
+           interfaceName.starts_with(configIface + ".");
+}
+
+ConfigSnapshot::ObjectMap ConfigSnapshot::decodeManagedObjects(
+    sdbusplus::message_t& msg, const std::vector<std::string>& interfaces)
+{
+    sd_bus_message* m = msg.get();
+    ObjectMap objects;
+
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY,
+                                           "{oa{sa{sv}}}");
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "enter object array");
+    }
+
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "oa{sa{sv}}")) > 0)
+    {
+        sdbusplus::message::object_path path;
+        msg.read(path);
+
+        r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}");
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "enter interfaces");
+        }
+
+        InterfaceMap objectInterfaces;
+
+        while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                   "sa{sv}")) > 0)
+        {
+            std::string interface;
+            msg.read(interface);
+
+            const bool wanted =
+                std::ranges::any_of(interfaces, [&](const auto& configIface) {
+                    return isConfigInterface(interface, configIface);
+                });
+
+            if (wanted)
+            {
+                objectInterfaces[interface] = decodeProperties(msg);
+            }
+            else
+            {
+                r = sd_bus_message_skip(m, "a{sv}");
+                if (r < 0)
+                {
+                    throw sdbusplus::exception::SdBusError(-r,
+                                                           "skip interface");
+                }
+            }
+
+            r = sd_bus_message_exit_container(m);
+            if (r < 0)
+            {
+                throw sdbusplus::exception::SdBusError(-r, "exit interface");
+            }
+        }
+
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "enter interface");
+        }
+
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "exit interfaces");
+        }
+
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "exit object");
+        }
+
+        if (!objectInterfaces.empty())
+        {
+            objects.emplace(path.str, std::move(objectInterfaces));
+        }
+    }
+
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "enter object");
+    }
+
+    r = sd_bus_message_exit_container(m);
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "exit object array");
+    }
+
+    return objects;
+}
+
+sdbusplus::async::task<std::optional<ConfigSnapshot::ObjectMap>>
+    ConfigSnapshot::fetchAll(sdbusplus::async::context& ctx,
+                             const std::string& service,
+                             const std::vector<std::string>& interfaces)
+{
+    try
+    {
+        auto msg = ctx.get_bus().new_method_call(
+            service.c_str(), managerPath, "org.freedesktop.DBus.ObjectManager",
+            "GetManagedObjects");
+
+        // the reply is decoded by hand, so that properties of types which
+        // are not used for configuration don't fail the devices
+        auto reply = co_await sdbusplus::async::callback(
+            [&msg](sd_bus_message_handler_t handler, void* data) {
+                return sd_bus_call_async(sd_bus_message_get_bus(msg.get()),
+                                         nullptr, msg.get(), handler, data, 0);
+            });
+
+        co_return decodeManagedObjects(reply, interfaces);
+    }
+    catch (std::exception& e)
+    {
+        error("Failed to get the managed objects of {SERVICE}: {ERROR}",
+              "SERVICE", service, "ERROR", e);
+    }
+
+    co_return std::nullopt;
+}
+
+sdbusplus::async::task<std::optional<ConfigSnapshot>> ConfigSnapshot::fetch(
+    sdbusplus::async::context& ctx, const std::string& service,
+    const std::string& path, const std::vector<std::string>& interfaces)
+{
+    std::optional<ObjectMap> objects =
+        co_await fetchAll(ctx, service, interfaces);
+
+    if (!objects.has_value())
+    {
+        co_return std::nullopt;
+    }
+
+    auto it = objects->find(path);
+    if (it == objects->end())
+    {
+        error("No configuration at {PATH}", "PATH", path);
+        co_return std::nullopt;
+    }
+
+    co_return ConfigSnapshot(std::move(it->second));
+}
+
+bool ConfigSnapshot::hasInterface(const std::string& interface) const
+{
+    return interfaces.contains(interface);
+}
+
+void ConfigSnapshot::getMuxOutputs(const std::string& configIface,
+                                   std::vector<std::string>& names,
+                                   std::vector<bool>& polarities) const
+{
+    const std::string configIfaceMux = configIface + ".MuxOutputs";
+
+    for (size_t i = 0; true; i++)
+    {
+        const std::string iface = configIfaceMux + std::to_string(i);
+
+        std::optional<std::string> name = get<std::string>(iface, "Name");
+        std::optional<std::string> polarity =
+            get<std::string>(iface, "Polarity");
+
+        if (!name.has_value() || !polarity.has_value())
+        {
+            break;
+        }
+
+        names.push_back(name.value());
+        polarities.push_back(polarity.value() == "High");
+    }
+}
@@ -1,9 +1,12 @@
 #include "device.hpp"
 
+#include "common/pldm/package_index.hpp"
 #include "common/pldm/pldm_package_util.hpp"
 #include "software.hpp"
 #include "software_manager.hpp"
 
+#include "common_config.h"
+
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/async/context.hpp>
@@ -12,6 +15,8 @@
 #include <xyz/openbmc_project/Software/ActivationProgress/aserver.hpp>
 #include <xyz/openbmc_project/State/Host/client.hpp>
 
+#include <chrono>
+#include <format>
 #include <utility>
 
 PHOSPHOR_LOG2_USING;
@@ -25,6 +30,22 @@ using SoftwareActivationProgress =
 using SoftwareActivationProgressProperties = sdbusplus::common::xyz::
     openbmc_project::software::ActivationProgress::properties_t;
 
+using SoftwareProgressProperties =
+    sdbusplus::common::xyz::openbmc_project::common::Progress::properties_t;
+
+using OperationStatus =
+    sdbusplus::common::xyz::openbmc_project::common::Progress::OperationStatus;
+
+using phosphor::software::update::UpdatePhase;
+
+// @returns     milliseconds since the epoch, as used by the Progress interface
+static uint64_t getEpochMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
 const auto applyTimeImmediate = sdbusplus::common::xyz::openbmc_project::
     software::ApplyTime::RequestedApplyTimes::Immediate;
 
@@ -42,16 +63,14 @@ Device::Device(sdbusplus::async::context& ctx, const SoftwareConfig& config,
 
 sdbusplus::async::task<bool> Device::getImageInfo(
     const sdbusplus::object_path& objectPath,
-    std::unique_ptr<void, std::function<void(void*)>>& pldmPackage,
-    size_t pldmPackageSize, uint8_t** matchingComponentImage,
-    size_t* componentImageSize, std::string& componentVersion)
+    const pldm_package_util::MappedPackage& package,
+    const uint8_t** matchingComponentImage, size_t* componentImageSize,
+    std::string& componentVersion)
 
 {
-    std::unique_ptr<pldm::fw_update::Package> package =
-        pldm_package_util::parsePLDMPackage(
-            static_cast<uint8_t*>(pldmPackage.get()), pldmPackageSize);
+    const pldm_package_util::PackageIndex* packageIndex = package.index();
 
-    if (package == nullptr)
+    if (packageIndex == nullptr)
     {
         error("could not parse PLDM package");
         co_await events.generateVerificationFailed(objectPath, componentVersion,
@@ -62,22 +81,23 @@ sdbusplus::async::task<bool> Device::getImageInfo(
     co_await events.generateVerificationFailed(objectPath, componentVersion,
                                                false);
 
-    uint32_t componentOffset = 0;
-    const int status = pldm_package_util::extractMatchingComponentImage(
-        static_cast<uint8_t*>(pldmPackage.get()), package,
-        config.compatibleHardware, config.vendorIANA, &componentOffset,
-        componentImageSize, componentVersion);
+    const pldm_package_util::ComponentImageLocation* component =
+        packageIndex->find(config.vendorIANA, config.compatibleHardware);
 
-    if (status != 0)
+    if (component == nullptr)
     {
-        error("could not extract matching component image");
+        error(
+            "did not find a matching component image for {IANA}, {COMPATIBLE}",
+            "IANA", lg2::hex, config.vendorIANA, "COMPATIBLE",
+            config.compatibleHardware);
         co_await events.generateUpdateNotApplicable(objectPath,
                                                     componentVersion, true);
         co_return false;
     }
 
-    *matchingComponentImage =
-        static_cast<uint8_t*>(pldmPackage.get()) + componentOffset;
+    *matchingComponentImage = package.data() + component->offset;
+    *componentImageSize = component->size;
+    componentVersion = component->version;
 
     co_await events.generateUpdateNotApplicable(objectPath, componentVersion,
                                                 false);
@@ -91,27 +111,50 @@ sdbusplus::async::task<bool> Device::startUpdateAsync(
 {
     debug("starting the async update with memfd {FD}", "FD", image.fd);
 
-    size_t pldm_pkg_size = 0;
-    auto pldm_pkg = pldm_package_util::mmapImagePackage(image, &pldm_pkg_size);
+    // the package is parsed only once for all devices which are updated
+    // from it, the index is released once this update is done
+    std::shared_ptr<const pldm_package_util::MappedPackage> package =
+        pldm_package_util::MappedPackage::map(image);
 
-    if (pldm_pkg == nullptr)
+    co_return co_await startUpdateAsync(std::move(package), applyTime,
+                                        std::move(softwarePendingIn));
+}
+
+sdbusplus::async::task<bool> Device::startUpdateAsync(
+    std::shared_ptr<const pldm_package_util::MappedPackage> package,
+    RequestedApplyTimes applyTime, std::unique_ptr<Software> softwarePendingIn)
+{
+    updateTimer.emplace();
+
+    if (package == nullptr)
     {
         softwarePendingIn->setActivation(ActivationInvalid);
+        finishUpdateTiming("", false);
         co_return false;
     }
 
-    uint8_t* componentImage;
+    // the package may have been parsed for several devices at once
+    updateTimer->addPhaseDuration(UpdatePhase::Parse,
+                                  package->getParseDuration());
+
+    updateTimer->beginPhase(UpdatePhase::Match);
+
+    const uint8_t* componentImage = nullptr;
     size_t componentImageSize = 0;
     std::string componentVersion;
 
-    if (!co_await getImageInfo(softwarePendingIn->objectPath, pldm_pkg,
-                               pldm_pkg_size, &componentImage,
-                               &componentImageSize, componentVersion))
+    if (!co_await getImageInfo(softwarePendingIn->objectPath, *package,
+                               &componentImage, &componentImageSize,
+                               componentVersion))
     {
         softwarePendingIn->setActivation(ActivationInvalid);
+        finishUpdateTiming(componentVersion, false);
         co_return false;
     }
 
+    updateTimer->endPhase();
+    updateTimer->setImageSize(componentImageSize);
+
     std::unique_ptr<Software> softwarePendingOld = std::move(softwarePending);
 
     softwarePending = std::move(softwarePendingIn);
@@ -123,6 +166,8 @@ sdbusplus::async::task<bool> Device::startUpdateAsync(
     const bool success = co_await continueUpdateWithMappedPackage(
         componentImage, componentImageSize, componentVersion, applyTime);
 
+    finishUpdateTiming(componentVersion, success);
+
     if (!success)
     {
         softwarePending->setActivation(ActivationFailed);
@@ -154,6 +199,18 @@ std::string Device::getEMConfigType() const
     return config.configType;
 }
 
+bool Device::isApplicable(
+    const pldm_package_util::PackageIndex& packageIndex) const
+{
+    return packageIndex.find(config.vendorIANA, config.compatibleHardware) !=
+           nullptr;
+}
+
+std::optional<std::string> Device::getUpdateBus() const
+{
+    return std::nullopt;
+}
+
 sdbusplus::async::task<bool> Device::resetDevice()
 {
     debug("Default implementation for device reset");
@@ -170,9 +227,70 @@ bool Device::setUpdateProgress(uint8_t progress) const
 
     softwarePending->softwareActivationProgress->progress(progress);
 
+    // The estimate is only logged, CompletedTime is set once the update
+    // has actually completed.
+    if (updateTimer.has_value())
+    {
+        const auto remaining = updateTimer->getRemaining(progress);
+
+        debug("{SWID}: {PROGRESS}%, {BPS} bytes/s, {ETA} ms remaining",
+              "SWID", softwarePending->swid, "PROGRESS", progress, "BPS",
+              updateTimer->getThroughput(progress), "ETA",
+              remaining.value_or(std::chrono::milliseconds(0)).count());
+    }
+
+    if (updateProgressListener)
+    {
+        updateProgressListener(progress);
+    }
+
     return true;
 }
 
+void Device::beginUpdatePhase(UpdatePhase phase)
+{
+    if (!updateTimer.has_value())
+    {
+        return;
+    }
+
+    updateTimer->beginPhase(phase);
+}
+
+void Device::finishUpdateTiming(const std::string& version, bool success)
+{
+    if (!updateTimer.has_value())
+    {
+        return;
+    }
+
+    updateTimer->endPhase();
+
+    const std::string entry = std::format(
+        "{} {} {} {} size={} total={} {} bps={}",
+        getEpochMs() / 1000, config.configName,
+        version.empty() ? "-" : version, success ? "success" : "failed",
+        updateTimer->getImageSize(), updateTimer->getElapsed().count(),
+        updateTimer->getSummary(), updateTimer->getAverageThroughput());
+
+    info("update timing (ms): {ENTRY}", "ENTRY", entry);
+
+    updateTimer = std::nullopt;
+
+    if (parent == nullptr)
+    {
+        return;
+    }
+
+    const update::UpdateTimingLog log(
+        std::filesystem::path(UPDATE_TIMING_LOG_DIR) /
+            (parent->serviceName + ".log"),
+        UPDATE_TIMING_LOG_ENTRIES);
+
+    // the log is rewritten as a whole, not on the event loop
+    log.appendAsync(entry);
+}
+
 sdbusplus::async::task<bool> Device::continueUpdateWithMappedPackage(
     const uint8_t* matchingComponentImage, size_t componentImageSize,
     const std::string& componentVersion, RequestedApplyTimes applyTime)
@@ -191,14 +309,35 @@ sdbusplus::async::task<bool> Device::continueUpdateWithMappedPackage(
 
     softwarePending->softwareActivationProgress->emit_added();
 
+    softwarePending->softwareProgress = std::make_unique<SoftwareProgress>(
+        ctx, objPath.c_str(),
+        SoftwareProgressProperties{OperationStatus::InProgress, getEpochMs(),
+                                   0});
+
+    softwarePending->softwareProgress->emit_added();
+
     softwarePending->setActivationBlocksTransition(true);
 
     softwarePending->setActivation(
         ActivationInterface::Activations::Activating);
 
+    if (updateTimer.has_value())
+    {
+        updateTimer->beginPhase(UpdatePhase::Program);
+    }
+
     bool success =
         co_await updateDevice(matchingComponentImage, componentImageSize);
 
+    if (updateTimer.has_value())
+    {
+        updateTimer->endPhase();
+    }
+
+    softwarePending->softwareProgress->status(
+        success ? OperationStatus::Completed : OperationStatus::Failed);
+    softwarePending->softwareProgress->completed_time(getEpochMs());
+
     if (success)
     {
         softwarePending->setActivation(
@@ -227,8 +366,15 @@ sdbusplus::async::task<bool> Device::continueUpdateWithMappedPackage(
 
     if (applyTime == applyTimeImmediate)
     {
+        beginUpdatePhase(UpdatePhase::Reset);
+
         co_await resetDevice();
 
+        if (updateTimer.has_value())
+        {
+            updateTimer->endPhase();
+        }
+
         co_await softwarePending->createInventoryAssociations(true);
 
         softwarePending->enableUpdate(allowedApplyTimes);
@@ -0,0 +1,303 @@
+#include "group_update.hpp"
+
+#include "common/pldm/package_index.hpp"
+#include "device.hpp"
+#include "software.hpp"
+#include "software_manager.hpp"
+
+#include <phosphor-logging/elog-errors.hpp>
+#include <phosphor-logging/elog.hpp>
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async/context.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <numeric>
+
+PHOSPHOR_LOG2_USING;
+
+using Unavailable = sdbusplus::xyz::openbmc_project::Common::Error::Unavailable;
+
+using namespace phosphor::logging;
+using namespace phosphor::software::update;
+using namespace phosphor::software::device;
+using namespace phosphor::software;
+
+using ActivationState = GroupUpdateActivation::Activations;
+
+GroupUpdateJob::GroupUpdateJob(sdbusplus::async::context& ctx,
+                               const sdbusplus::object_path& objectPath,
+                               const std::vector<Device*>& devices) :
+    GroupUpdateActivation(
+        ctx, objectPath,
+        GroupUpdateActivation::properties_t{
+            ActivationState::Activating,
+            GroupUpdateActivation::RequestedActivations::None}),
+    objectPath(objectPath), ctx(ctx)
+{
+    for (const Device* device : devices)
+    {
+        deviceProgress[device] = 0;
+    }
+
+    emit_added();
+
+    activationProgress = std::make_unique<GroupUpdateActivationProgress>(
+        ctx, objectPath.str.c_str(),
+        GroupUpdateActivationProgress::properties_t{0});
+    activationProgress->emit_added();
+}
+
+void GroupUpdateJob::addSoftware(const sdbusplus::object_path& softwarePath)
+{
+    debug("group update {PATH}: device software {SWPATH}", "PATH", objectPath,
+          "SWPATH", softwarePath);
+
+    assocs.emplace_back("software", "group_update", softwarePath.str);
+
+    updateAssociations();
+}
+
+void GroupUpdateJob::updateAssociations()
+{
+    if (associationDefinitions)
+    {
+        associationDefinitions->associations(assocs);
+        return;
+    }
+
+    associationDefinitions =
+        std::make_unique<GroupUpdateAssociationDefinitions>(
+            ctx, objectPath,
+            GroupUpdateAssociationDefinitions::properties_t{assocs});
+    associationDefinitions->emit_added();
+}
+
+void GroupUpdateJob::setDeviceProgress(const Device* device, uint8_t progress)
+{
+    deviceProgress[device] = progress;
+
+    if (!activationProgress)
+    {
+        return;
+    }
+
+    const size_t sum = std::accumulate(
+        deviceProgress.begin(), deviceProgress.end(), size_t(0),
+        [](size_t acc, const auto& entry) { return acc + entry.second; });
+
+    activationProgress->progress(
+        static_cast<uint8_t>(sum / deviceProgress.size()));
+}
+
+void GroupUpdateJob::setDeviceResult(const Device* device, bool success)
+{
+    deviceResults[device] = success;
+
+    setDeviceProgress(device, 100);
+
+    if (!isDone())
+    {
+        return;
+    }
+
+    size_t failed = 0;
+    for (const auto& [_, result] : deviceResults)
+    {
+        if (!result)
+        {
+            failed++;
+        }
+    }
+
+    info("group update {PATH} done, {COUNT} devices, {FAILED} failed", "PATH",
+         objectPath, "COUNT", deviceResults.size(), "FAILED", failed);
+
+    activation(failed == 0 ? ActivationState::Active
+                           : ActivationState::Failed);
+
+    activationProgress = nullptr;
+}
+
+bool GroupUpdateJob::isDone() const
+{
+    return deviceResults.size() == deviceProgress.size();
+}
+
+GroupUpdate::GroupUpdate(
+    sdbusplus::async::context& ctx, const sdbusplus::object_path& path,
+    manager::SoftwareManager& manager,
+    const std::set<RequestedApplyTimes>& allowedApplyTimes) :
+    sdbusplus::aserver::xyz::openbmc_project::software::Update<GroupUpdate>(
+        ctx, path),
+    ctx(ctx), objectPath(path), manager(manager),
+    allowedApplyTimes(allowedApplyTimes)
+{
+    emit_added();
+}
+
+GroupUpdate::~GroupUpdate()
+{
+    emit_removed();
+}
+
+auto GroupUpdate::method_call(start_update_t /*unused*/, auto image,
+                              auto applyTime)
+    -> sdbusplus::async::task<start_update_t::return_type>
+{
+    debug("Requesting group update with {FD}", "FD", image.fd);
+
+    if (!allowedApplyTimes.contains(applyTime))
+    {
+        error("apply time {APPLYTIME} is not allowed for group updates",
+              "APPLYTIME", applyTime);
+        using Argument =
+            phosphor::logging::xyz::openbmc_project::common::InvalidArgument;
+        elog<sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument>(
+            Argument::ARGUMENT_NAME("ApplyTime"),
+            Argument::ARGUMENT_VALUE(
+                sdbusplus::message::convert_to_string(applyTime).c_str()));
+    }
+
+    // mapped and parsed once, shared by all devices of the group
+    std::shared_ptr<const pldm_package_util::MappedPackage> package =
+        pldm_package_util::MappedPackage::map(image);
+
+    if (package == nullptr)
+    {
+        using Argument =
+            phosphor::logging::xyz::openbmc_project::common::InvalidArgument;
+        elog<sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument>(
+            Argument::ARGUMENT_NAME("Image"),
+            Argument::ARGUMENT_VALUE("could not map the image"));
+    }
+
+    const pldm_package_util::PackageIndex* packageIndex = package->index();
+
+    if (packageIndex == nullptr)
+    {
+        using Argument =
+            phosphor::logging::xyz::openbmc_project::common::InvalidArgument;
+        elog<sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument>(
+            Argument::ARGUMENT_NAME("Image"),
+            Argument::ARGUMENT_VALUE("could not parse the PLDM package"));
+    }
+
+    // devices sharing a bus are updated one after the other
+    std::map<std::string, std::vector<Device*>> buses;
+    std::vector<Device*> matching;
+
+    for (auto& [path, device] : manager.devices)
+    {
+        if (!device->isApplicable(*packageIndex))
+        {
+            continue;
+        }
+
+        if (device->updateInProgress)
+        {
+            error("skipping {PATH}, an update is already in progress", "PATH",
+                  path);
+            continue;
+        }
+
+        if (!device->allowedApplyTimes.contains(applyTime))
+        {
+            error("skipping {PATH}, apply time not allowed", "PATH", path);
+            continue;
+        }
+
+        // reserve the device right away, this also prevents removal
+        device->updateInProgress = true;
+
+        matching.push_back(device.get());
+        buses[device->getUpdateBus().value_or(path.str)].push_back(
+            device.get());
+    }
+
+    if (matching.empty())
+    {
+        error("no device matches the package");
+        elog<Unavailable>();
+    }
+
+    info("group update of {COUNT} devices on {BUSES} buses", "COUNT",
+         matching.size(), "BUSES", buses.size());
+
+    const sdbusplus::object_path jobPath =
+        objectPath / std::to_string(Software::getRandomId());
+
+    pruneJobs();
+
+    auto job = std::make_unique<GroupUpdateJob>(ctx, jobPath, matching);
+    GroupUpdateJob& jobRef = *job;
+
+    jobs[jobPath] = std::move(job);
+    jobOrder.push_back(jobPath);
+
+    for (auto& [bus, devices] : buses)
+    {
+        ctx.spawn(updateBus(jobRef, devices, package, applyTime));
+    }
+
+    co_return jobPath;
+}
+
+sdbusplus::async::task<> GroupUpdate::updateBus(
+    GroupUpdateJob& job, std::vector<Device*> devices,
+    std::shared_ptr<const pldm_package_util::MappedPackage> package,
+    RequestedApplyTimes applyTime)
+{
+    for (Device* device : devices)
+    {
+        std::unique_ptr<Software> softwareInstance =
+            std::make_unique<Software>(ctx, *device);
+
+        softwareInstance->setActivation(
+            ActivationInterface::Activations::NotReady);
+
+        job.addSoftware(softwareInstance->objectPath);
+
+        device->updateProgressListener = [&job, device](uint8_t progress) {
+            job.setDeviceProgress(device, progress);
+        };
+
+        const bool success = co_await device->startUpdateAsync(
+            package, applyTime, std::move(softwareInstance));
+
+        device->updateProgressListener = nullptr;
+        device->updateInProgress = false;
+
+        job.setDeviceResult(device, success);
+    }
+
+    co_return;
+}
+
+void GroupUpdate::pruneJobs()
+{
+    // running jobs are referenced by their update tasks, skip them and
+    // drop the oldest finished ones instead
+    auto it = jobOrder.begin();
+
+    while (jobOrder.size() >= maxRetainedJobs && it != jobOrder.end())
+    {
+        auto job = jobs.find(*it);
+
+        if (job != jobs.end() && !job->second->isDone())
+        {
+            it++;
+            continue;
+        }
+
+        if (job != jobs.end())
+        {
+            jobs.erase(job);
+        }
+        it = jobOrder.erase(it);
+    }
+}
+
+auto GroupUpdate::get_property(allowed_apply_times_t /*unused*/) const
+{
+    return allowedApplyTimes;
+}
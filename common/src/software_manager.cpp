@@ -1,5 +1,7 @@
 #include "software_manager.hpp"
 
+#include "common_config.h"
+
 #include <boost/container/flat_map.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/asio/object_server.hpp>
@@ -8,10 +10,10 @@
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
-#include <xyz/openbmc_project/ObjectMapper/client.hpp>
 #include <xyz/openbmc_project/Software/Version/client.hpp>
 #include <xyz/openbmc_project/State/Host/client.hpp>
 
+#include <algorithm>
 #include <cstdint>
 
 PHOSPHOR_LOG2_USING;
@@ -19,83 +21,81 @@ PHOSPHOR_LOG2_USING;
 using namespace phosphor::software::manager;
 
 using AsyncMatch = sdbusplus::async::match;
+using ConfigMap = ConfigSnapshot::InterfaceMap;
 
 namespace RulesIntf = sdbusplus::match_rules;
 static constexpr auto serviceNameEM = "xyz.openbmc_project.EntityManager";
 
+using ServiceReadyState = SoftwareManagerServiceReady::States;
+
+const size_t SoftwareManager::defaultMaxConcurrentInits =
+    MAX_CONCURRENT_DEVICE_INITS;
+
 const auto matchRuleSender = RulesIntf::sender(serviceNameEM);
 const auto matchRulePath = RulesIntf::path("/xyz/openbmc_project/inventory");
 
 SoftwareManager::SoftwareManager(sdbusplus::async::context& ctx,
-                                 const std::string& serviceNameSuffix) :
+                                 const std::string& serviceNameSuffix,
+                                 size_t maxConcurrentInits) :
     ctx(ctx),
     configIntfAddedMatch(ctx, RulesIntf::interfacesAdded() + matchRuleSender),
     configIntfRemovedMatch(ctx, RulesIntf::interfacesRemoved() + matchRulePath),
     serviceName("xyz.openbmc_project.Software." + serviceNameSuffix),
     manager(ctx, sdbusplus::client::xyz::openbmc_project::software::Version<>::
-                     namespace_path)
+                     namespace_path),
+    maxConcurrentInits(std::max<size_t>(maxConcurrentInits, 1))
 {
     debug("requesting dbus name {BUSNAME}", "BUSNAME", serviceName);
 
     ctx.request_name(serviceName.c_str());
 
+    const std::string suffix = serviceName.substr(serviceName.rfind('.') + 1);
+
+    const sdbusplus::object_path path =
+        sdbusplus::object_path(sdbusplus::client::xyz::openbmc_project::
+                                   software::Version<>::namespace_path) /
+        "service" / suffix;
+
+    serviceReady = std::make_unique<SoftwareManagerServiceReady>(ctx, path);
+    serviceReady->state(ServiceReadyState::Starting);
+    serviceReady->emit_added();
+
     debug("Initialized SoftwareManager");
 }
 
-static sdbusplus::async::task<std::optional<SoftwareConfig>> getConfig(
-    sdbusplus::async::context& ctx, const std::string& service,
-    const std::string& objectPath, const std::string& interfacePrefix)
+static std::optional<SoftwareConfig> getConfig(
+    const ConfigSnapshot& snapshot, const std::string& objectPath,
+    const std::string& interfacePrefix)
 {
-    auto client = sdbusplus::async::proxy()
-                      .service(service)
-                      .path(objectPath)
-                      .interface("org.freedesktop.DBus.Properties");
-
-    uint64_t vendorIANA = 0;
-    std::string compatible{};
-    std::string configType{};
-    std::string configName{};
-
     const std::string interfaceName = interfacePrefix + ".FirmwareInfo";
 
-    try
+    auto vendorIANA =
+        snapshot.getRequired<uint64_t>(interfaceName, "VendorIANA");
+    auto compatible =
+        snapshot.getRequired<std::string>(interfaceName, "CompatibleHardware");
+    auto configType =
+        snapshot.getRequired<std::string>(interfacePrefix, "Type");
+    auto configName =
+        snapshot.getRequired<std::string>(interfacePrefix, "Name");
+
+    if (!vendorIANA.has_value() || !compatible.has_value() ||
+        !configType.has_value() || !configName.has_value())
     {
-        {
-            auto propVendorIANA = co_await client.call<std::variant<uint64_t>>(
-                ctx, "Get", interfaceName, "VendorIANA");
-
-            vendorIANA = std::get<uint64_t>(propVendorIANA);
-        }
-        {
-            auto propCompatible =
-                co_await client.call<std::variant<std::string>>(
-                    ctx, "Get", interfaceName, "CompatibleHardware");
-
-            compatible = std::get<std::string>(propCompatible);
-        }
-        {
-            auto propConfigType =
-                co_await client.call<std::variant<std::string>>(
-                    ctx, "Get", interfacePrefix, "Type");
-
-            configType = std::get<std::string>(propConfigType);
-        }
-        {
-            auto propConfigName =
-                co_await client.call<std::variant<std::string>>(
-                    ctx, "Get", interfacePrefix, "Name");
+        error("Incomplete configuration at {PATH}", "PATH", objectPath);
+        return std::nullopt;
+    }
 
-            configName = std::get<std::string>(propConfigName);
-        }
+    try
+    {
+        return SoftwareConfig(objectPath, vendorIANA.value(),
+                              compatible.value(), configType.value(),
+                              configName.value());
     }
     catch (std::exception& e)
     {
         error("Failed to get config with {ERROR}", "ERROR", e);
-        co_return std::nullopt;
+        return std::nullopt;
     }
-
-    co_return SoftwareConfig(objectPath, vendorIANA, compatible, configType,
-                             configName);
 }
 
 sdbusplus::async::task<> SoftwareManager::initDevices(
@@ -104,45 +104,137 @@ sdbusplus::async::task<> SoftwareManager::initDevices(
     ctx.spawn(interfaceAddedMatch(configurationInterfaces));
     ctx.spawn(interfaceRemovedMatch(configurationInterfaces));
 
-    auto client = sdbusplus::client::xyz::openbmc_project::ObjectMapper<>(ctx)
-                      .service("xyz.openbmc_project.ObjectMapper")
-                      .path("/xyz/openbmc_project/object_mapper");
-
-    auto res = co_await client.get_sub_tree("/xyz/openbmc_project/inventory", 0,
-                                            configurationInterfaces);
-
     for (auto& iface : configurationInterfaces)
     {
         debug("[config] looking for dbus interface {INTF}", "INTF", iface);
     }
 
-    for (auto& [path, v] : res)
+    // one call for the configuration of all devices, instead of a mapper
+    // lookup and a GetAll per interface and device
+    std::optional<ConfigSnapshot::ObjectMap> objects =
+        co_await ConfigSnapshot::fetchAll(ctx, serviceNameEM,
+                                          configurationInterfaces);
+
+    if (!objects.has_value())
     {
-        for (auto& [service, interfaceNames] : v)
-        {
-            std::string interfaceFound;
+        error("Failed to get the initial configuration");
+        objects.emplace();
+    }
+
+    for (auto& [path, interfacesMap] : *objects)
+    {
+        std::string interfaceFound;
 
-            for (std::string& interfaceName : interfaceNames)
+        for (auto& iface : configurationInterfaces)
+        {
+            if (interfacesMap.contains(iface))
             {
-                for (auto& iface : configurationInterfaces)
-                {
-                    if (interfaceName == iface)
-                    {
-                        interfaceFound = interfaceName;
-                    }
-                }
+                interfaceFound = iface;
             }
+        }
 
-            if (interfaceFound.empty())
+        if (interfaceFound.empty())
+        {
+            continue;
+        }
+
+        ConfigMap configMap;
+
+        for (auto& [interfaceName, properties] : interfacesMap)
+        {
+            if (ConfigSnapshot::isConfigInterface(interfaceName,
+                                                  interfaceFound))
             {
-                continue;
+                configMap.emplace(interfaceName, std::move(properties));
             }
-
-            co_await handleInterfaceAdded(service, path, interfaceFound);
         }
+
+        queueInterfaceAdded({serviceNameEM, path, interfaceFound,
+                             ConfigSnapshot(std::move(configMap))});
+    }
+
+    finishInitialScan();
+}
+
+void SoftwareManager::finishInitialScan()
+{
+    initialScanQueued = true;
+
+    checkDiscoveryComplete();
+}
+
+bool SoftwareManager::isDiscoveryComplete() const
+{
+    return discoveryComplete;
+}
+
+void SoftwareManager::queueInterfaceAdded(PendingInit pending)
+{
+    pendingInits.push_back(std::move(pending));
+
+    if (activeInitWorkers >= maxConcurrentInits)
+    {
+        debug("Queued init of {PATH}, {COUNT} devices pending", "PATH",
+              pendingInits.back().path, "COUNT", pendingInits.size());
+        return;
+    }
+
+    activeInitWorkers++;
+    ctx.spawn(initWorker());
+}
+
+sdbusplus::async::task<void> SoftwareManager::initWorker()
+{
+    while (!pendingInits.empty() && !ctx.stop_requested())
+    {
+        PendingInit next = std::move(pendingInits.front());
+        pendingInits.pop_front();
+
+        co_await handleInterfaceAdded(std::move(next));
+    }
+
+    activeInitWorkers--;
+
+    checkDiscoveryComplete();
+}
+
+void SoftwareManager::checkDiscoveryComplete()
+{
+    if (discoveryComplete || !initialScanQueued || activeInitWorkers != 0 ||
+        !pendingInits.empty())
+    {
+        return;
+    }
+
+    discoveryComplete = true;
+
+    info("Done with initial configuration, {COUNT} devices initialized",
+         "COUNT", devices.size());
+
+    serviceReady->state(ServiceReadyState::Enabled);
+}
+
+void SoftwareManager::enableGroupUpdate(
+    const std::set<RequestedApplyTimes>& allowedApplyTimes)
+{
+    if (groupUpdate != nullptr)
+    {
+        error("group update of {BUSNAME} has already been enabled", "BUSNAME",
+              serviceName);
+        return;
     }
 
-    debug("Done with initial configuration");
+    const std::string suffix = serviceName.substr(serviceName.rfind('.') + 1);
+
+    const sdbusplus::object_path path =
+        sdbusplus::object_path(sdbusplus::client::xyz::openbmc_project::
+                                   software::Version<>::namespace_path) /
+        "group" / suffix;
+
+    debug("enabling group update on {PATH}", "PATH", path);
+
+    groupUpdate = std::make_unique<update::GroupUpdate>(ctx, path, *this,
+                                                        allowedApplyTimes);
 }
 
 std::string SoftwareManager::getBusName()
@@ -151,9 +243,10 @@ std::string SoftwareManager::getBusName()
 }
 
 sdbusplus::async::task<void> SoftwareManager::handleInterfaceAdded(
-    const std::string& service, const sdbusplus::object_path& path,
-    const std::string& interface)
+    PendingInit pending)
 {
+    const sdbusplus::object_path path = pending.path;
+
     if (devices.contains(path) || initializingPaths.contains(path))
     {
         debug("Skipping duplicate init for {PATH}", "PATH", path);
@@ -161,18 +254,44 @@ sdbusplus::async::task<void> SoftwareManager::handleInterfaceAdded(
     }
 
     initializingPaths.insert(path);
-    co_await handleInterfaceAddedGuarded(service, path, interface);
+
+    try
+    {
+        co_await handleInterfaceAddedGuarded(pending);
+    }
+    catch (std::exception& e)
+    {
+        error("Failed to initialize device at {PATH}: {ERROR}", "PATH", path,
+              "ERROR", e);
+    }
+
     initializingPaths.erase(path);
 }
 
 sdbusplus::async::task<void> SoftwareManager::handleInterfaceAddedGuarded(
-    const std::string& service, const std::string& path,
-    const std::string& interface)
+    PendingInit& pending)
 {
+    const std::string& service = pending.service;
+    const sdbusplus::object_path& path = pending.path;
+
     debug("Found configuration interface at {SERVICE}, {PATH}", "SERVICE",
           service, "PATH", path);
 
-    auto optConfig = co_await getConfig(ctx, service, path, interface);
+    if (!pending.snapshot.has_value())
+    {
+        pending.snapshot = co_await ConfigSnapshot::fetch(
+            ctx, service, path, {pending.interface});
+    }
+
+    if (!pending.snapshot.has_value())
+    {
+        error("Failed to get configuration from {PATH}", "PATH", path);
+        co_return;
+    }
+
+    const ConfigSnapshot& snapshot = pending.snapshot.value();
+
+    auto optConfig = getConfig(snapshot, path, pending.interface);
 
     if (!optConfig.has_value())
     {
@@ -189,7 +308,8 @@ sdbusplus::async::task<void> SoftwareManager::handleInterfaceAddedGuarded(
         co_return;
     }
 
-    const bool accepted = co_await initDevice(service, path, config);
+    const bool accepted =
+        co_await initDevice(service, path, config, snapshot);
 
     if (accepted && devices.contains(config.objectPath))
     {
@@ -207,12 +327,6 @@ sdbusplus::async::task<void> SoftwareManager::handleInterfaceAddedGuarded(
     co_return;
 }
 
-using BasicVariantType =
-    std::variant<std::vector<std::string>, std::string, int64_t, uint64_t,
-                 double, int32_t, uint32_t, int16_t, uint16_t, uint8_t, bool>;
-using InterfacesMap = boost::container::flat_map<std::string, BasicVariantType>;
-using ConfigMap = boost::container::flat_map<std::string, InterfacesMap>;
-
 sdbusplus::async::task<void> SoftwareManager::interfaceAddedMatch(
     std::vector<std::string> interfaces)
 {
@@ -231,8 +345,29 @@ sdbusplus::async::task<void> SoftwareManager::interfaceAddedMatch(
                 debug("detected interface {INTF} added on {PATH}", "INTF",
                       interface, "PATH", objPath);
 
-                co_await handleInterfaceAdded(serviceNameEM, objPath,
-                                              interface);
+                // entity-manager may emit one signal per interface, so
+                // the payload is only used if it carries the sub-interfaces
+                if (!interfacesMap.contains(interface + ".FirmwareInfo"))
+                {
+                    queueInterfaceAdded(
+                        {serviceNameEM, objPath, interface, std::nullopt});
+                    continue;
+                }
+
+                // the signal already carries all properties of the new
+                // object, no need to fetch them again
+                ConfigMap configMap;
+
+                for (auto& [interfaceName, properties] : interfacesMap)
+                {
+                    if (ConfigSnapshot::isConfigInterface(interfaceName, interface))
+                    {
+                        configMap.emplace(interfaceName, properties);
+                    }
+                }
+
+                queueInterfaceAdded({serviceNameEM, objPath, interface,
+                                     ConfigSnapshot(std::move(configMap))});
             }
         }
     }
@@ -0,0 +1,260 @@
+#include "update_timing.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+PHOSPHOR_LOG2_USING;
+
+using namespace phosphor::software::update;
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+// the logs of all devices of a daemon share one directory, and may be
+// written by several threads
+static std::mutex logLock;
+
+std::string_view phosphor::software::update::getPhaseName(UpdatePhase phase)
+{
+    switch (phase)
+    {
+        case UpdatePhase::Parse:
+            return "parse";
+        case UpdatePhase::Match:
+            return "match";
+        case UpdatePhase::Verify:
+            return "verify";
+        case UpdatePhase::Program:
+            return "program";
+        case UpdatePhase::Reset:
+            return "reset";
+    }
+    return "unknown";
+}
+
+UpdateTimer::UpdateTimer(Clock::time_point now) : start(now), phaseStart(now)
+{}
+
+void UpdateTimer::beginPhase(UpdatePhase next, Clock::time_point now)
+{
+    endPhase(now);
+
+    phase = next;
+    phaseStart = now;
+
+    // parsing and matching happen before the device is touched
+    if (!deviceStart.has_value() && next != UpdatePhase::Parse &&
+        next != UpdatePhase::Match)
+    {
+        deviceStart = now;
+    }
+}
+
+void UpdateTimer::endPhase(Clock::time_point now)
+{
+    if (!phase.has_value())
+    {
+        return;
+    }
+
+    durations[static_cast<size_t>(*phase)] += now - phaseStart;
+    phase = std::nullopt;
+}
+
+void UpdateTimer::addPhaseDuration(UpdatePhase p, Clock::duration duration)
+{
+    durations[static_cast<size_t>(p)] += duration;
+}
+
+std::optional<UpdatePhase> UpdateTimer::getPhase() const
+{
+    return phase;
+}
+
+void UpdateTimer::setImageSize(size_t size)
+{
+    imageSize = size;
+}
+
+size_t UpdateTimer::getImageSize() const
+{
+    return imageSize;
+}
+
+milliseconds UpdateTimer::getPhaseDuration(UpdatePhase p) const
+{
+    return duration_cast<milliseconds>(durations[static_cast<size_t>(p)]);
+}
+
+milliseconds UpdateTimer::getElapsed(Clock::time_point now) const
+{
+    return duration_cast<milliseconds>(now - start);
+}
+
+uint64_t UpdateTimer::getThroughput(uint8_t progress,
+                                    Clock::time_point now) const
+{
+    if (!deviceStart.has_value() || progress == 0 || imageSize == 0)
+    {
+        return 0;
+    }
+
+    const auto elapsed = duration_cast<milliseconds>(now - *deviceStart);
+
+    if (elapsed.count() <= 0)
+    {
+        return 0;
+    }
+
+    const uint64_t bytesDone =
+        static_cast<uint64_t>(imageSize) * std::min<uint8_t>(progress, 100) /
+        100;
+
+    return bytesDone * 1000 / elapsed.count();
+}
+
+std::optional<milliseconds> UpdateTimer::getRemaining(
+    uint8_t progress, Clock::time_point now) const
+{
+    if (!deviceStart.has_value() || progress == 0)
+    {
+        return std::nullopt;
+    }
+
+    if (progress >= 100)
+    {
+        return milliseconds(0);
+    }
+
+    const auto elapsed = duration_cast<milliseconds>(now - *deviceStart);
+
+    return elapsed * (100 - progress) / progress;
+}
+
+uint64_t UpdateTimer::getAverageThroughput() const
+{
+    Clock::duration devicePhases{};
+
+    for (UpdatePhase p : {UpdatePhase::Verify, UpdatePhase::Program})
+    {
+        devicePhases += durations[static_cast<size_t>(p)];
+    }
+
+    const auto elapsed = duration_cast<milliseconds>(devicePhases);
+
+    if (elapsed.count() <= 0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(imageSize) * 1000 / elapsed.count();
+}
+
+std::string UpdateTimer::getSummary() const
+{
+    std::string summary;
+
+    for (size_t i = 0; i < phaseCount; i++)
+    {
+        const auto p = static_cast<UpdatePhase>(i);
+
+        summary += std::format("{}{}={}", summary.empty() ? "" : " ",
+                               getPhaseName(p), getPhaseDuration(p).count());
+    }
+
+    return summary;
+}
+
+UpdateTimingLog::UpdateTimingLog(std::filesystem::path path,
+                                 size_t maxEntries) :
+    path(std::move(path)), maxEntries(maxEntries)
+{}
+
+std::vector<std::string> UpdateTimingLog::read() const
+{
+    std::vector<std::string> entries;
+    std::ifstream file(path);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (!line.empty())
+        {
+            entries.push_back(line);
+        }
+    }
+
+    return entries;
+}
+
+bool UpdateTimingLog::append(const std::string& entry) const
+{
+    if (maxEntries == 0 || entry.find('\n') != std::string::npos)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(logLock);
+
+    std::vector<std::string> entries = read();
+
+    // keep space for the new entry
+    if (entries.size() >= maxEntries)
+    {
+        entries.erase(entries.begin(),
+                      entries.begin() + (entries.size() - maxEntries + 1));
+    }
+
+    entries.push_back(entry);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // write the whole log first, so it is never left half written
+    const std::filesystem::path tmpPath = path.string() + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+
+        for (const std::string& e : entries)
+        {
+            file << e << '\n';
+        }
+
+        if (!file.good())
+        {
+            error("Failed to write update timing log {PATH}", "PATH",
+                  tmpPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+
+    if (ec)
+    {
+        error("Failed to write update timing log {PATH}: {ERROR}", "PATH",
+              path.string(), "ERROR", ec.message());
+        return false;
+    }
+
+    return true;
+}
+
+std::future<bool> UpdateTimingLog::appendAsync(std::string entry) const
+{
+    std::promise<bool> written;
+    std::future<bool> result = written.get_future();
+
+    std::thread([log = *this, entry = std::move(entry),
+                 written = std::move(written)]() mutable {
+        written.set_value(log.append(entry));
+    }).detach();
+
+    return result;
+}
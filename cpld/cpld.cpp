@@ -1,5 +1,6 @@
 #include "cpld.hpp"
 
+#include "common/include/i2c/bus_scheduler.hpp"
 #include "common/include/utils.hpp"
 
 namespace phosphor::software::cpld
@@ -39,6 +40,9 @@ sdbusplus::async::task<bool> CPLDDevice::updateDevice(const uint8_t* image,
         co_return false;
     }
 
+    // how much the update had to wait for the other devices on the bus
+    phosphor::i2c::BusStatsSummary busStats(bus);
+
     setUpdateProgress(1);
     if (!(co_await cpldInterface->updateFirmware(
             false, image, image_size, [this](int percent) -> bool {
@@ -8,6 +8,8 @@
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/async/context.hpp>
 
+#include <format>
+
 PHOSPHOR_LOG2_USING;
 
 namespace ManagerInf = phosphor::software::manager;
@@ -28,7 +30,7 @@ class CPLDDevice : public Device
                {RequestedApplyTimes::Immediate, RequestedApplyTimes::OnReset}),
         cpldInterface(CPLDFactory::instance().create(chiptype, ctx, chipname,
                                                      bus, address)),
-        muxGPIOs(gpioLinesIn, gpioValuesIn)
+        muxGPIOs(gpioLinesIn, gpioValuesIn), bus(bus)
     {}
 
     using Device::softwareCurrent;
@@ -36,10 +38,16 @@ class CPLDDevice : public Device
                                               size_t image_size) final;
     sdbusplus::async::task<bool> getVersion(std::string& version);
 
+    std::optional<std::string> getUpdateBus() const final
+    {
+        return std::format("i2c-{}", bus);
+    }
+
   private:
     std::optional<ScopedBmcMux> setupMux();
     std::unique_ptr<CPLDInterface> cpldInterface;
     GPIOGroup muxGPIOs;
+    const uint16_t bus;
 };
 
 } // namespace phosphor::software::cpld
@@ -1,6 +1,5 @@
 #include "cpld_software_manager.hpp"
 
-#include "common/include/dbus_helper.hpp"
 #include "cpld.hpp"
 
 #include <phosphor-logging/lg2.hpp>
@@ -11,20 +10,16 @@ PHOSPHOR_LOG2_USING;
 using namespace phosphor::software::cpld;
 
 sdbusplus::async::task<bool> CPLDSoftwareManager::initDevice(
-    const std::string& service, const sdbusplus::object_path& path,
-    SoftwareConfig& config)
+    const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
+    SoftwareConfig& config, const ConfigSnapshot& snapshot)
 {
     std::string configIface =
         "xyz.openbmc_project.Configuration." + config.configType;
 
-    auto busNo = co_await dbusGetRequiredProperty<uint64_t>(
-        ctx, service, path, configIface, "Bus");
-    auto address = co_await dbusGetRequiredProperty<uint64_t>(
-        ctx, service, path, configIface, "Address");
-    auto chipType = co_await dbusGetRequiredProperty<std::string>(
-        ctx, service, path, configIface, "Type");
-    auto chipName = co_await dbusGetRequiredProperty<std::string>(
-        ctx, service, path, configIface, "Name");
+    auto busNo = snapshot.getRequired<uint64_t>(configIface, "Bus");
+    auto address = snapshot.getRequired<uint64_t>(configIface, "Address");
+    auto chipType = snapshot.getRequired<std::string>(configIface, "Type");
+    auto chipName = snapshot.getRequired<std::string>(configIface, "Name");
 
     if (!busNo.has_value() || !address.has_value() || !chipType.has_value() ||
         !chipName.has_value())
@@ -38,34 +33,16 @@ sdbusplus::async::task<bool> CPLDSoftwareManager::initDevice(
         "TYPE", chipType.value(), "NAME", chipName.value(), "BUS",
         busNo.value(), "ADDR", address.value());
 
-    const std::string configIfaceMux = configIface + ".MuxOutputs";
-
     std::vector<std::string> names;
     std::vector<bool> values;
 
-    for (size_t i = 0; true; i++)
-    {
-        const std::string iface = configIfaceMux + std::to_string(i);
-
-        std::optional<std::string> name =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Name");
-
-        std::optional<std::string> polarity =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Polarity");
-
-        if (!name.has_value() || !polarity.has_value())
-        {
-            break;
-        }
+    snapshot.getMuxOutputs(configIface, names, values);
 
+    for (size_t i = 0; i < names.size(); i++)
+    {
         lg2::debug(
             "Found CPLD MuxOutput[{INDEX}]: Name={NAME}, Polarity={POLARITY}",
-            "INDEX", i, "NAME", name.value(), "POLARITY", polarity.value());
-
-        names.push_back(name.value());
-        values.push_back((polarity == "High") ? 1 : 0);
+            "INDEX", i, "NAME", names[i], "POLARITY", values[i]);
     }
 
     lg2::debug("Total CPLD MuxOutputs found: {COUNT}", "COUNT", names.size());
@@ -108,6 +85,10 @@ void CPLDSoftwareManager::start()
     }
 
     ctx.spawn(initDevices(configIntfs));
+
+    enableGroupUpdate(
+        {RequestedApplyTimes::Immediate, RequestedApplyTimes::OnReset});
+
     ctx.run();
 }
 
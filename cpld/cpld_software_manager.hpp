@@ -12,9 +12,9 @@ class CPLDSoftwareManager : public phosphor::software::manager::SoftwareManager
         SoftwareManager(ctx, "CPLD")
     {}
 
-    sdbusplus::async::task<bool> initDevice(const std::string& service,
-                                            const sdbusplus::object_path& path,
-                                            SoftwareConfig& config) final;
+    sdbusplus::async::task<bool> initDevice(
+        const std::string& service, const sdbusplus::object_path& path,
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) final;
 
     void start();
 };
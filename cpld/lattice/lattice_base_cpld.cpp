@@ -305,7 +305,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::enableProgramMode()
     std::vector<uint8_t> request = {commandEnableConfigMode, 0x08, 0x0, 0x0};
     std::vector<uint8_t> response;
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send enable program mode request.");
         co_return false;
@@ -369,7 +369,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::resetConfigFlash()
         request = {commandResetConfigFlash, 0x0, 0x0, 0x0};
     }
 
-    co_return i2cInterface.sendReceive(request, response);
+    co_return co_await i2cInterface.sendReceive(request, response);
 }
 
 sdbusplus::async::task<bool> LatticeBaseCPLD::programDone()
@@ -377,7 +377,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::programDone()
     std::vector<uint8_t> request = {commandProgramDone, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response;
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send program done request.");
         co_return false;
@@ -396,7 +396,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::disableConfigInterface()
 {
     std::vector<uint8_t> request = {commandDisableConfigInterface, 0x0, 0x0};
     std::vector<uint8_t> response;
-    co_return i2cInterface.sendReceive(request, response);
+    co_return co_await i2cInterface.sendReceive(request, response);
 }
 
 sdbusplus::async::task<bool> LatticeBaseCPLD::waitBusyAndVerify()
@@ -457,7 +457,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::readBusyFlag(uint8_t& busyFlag)
     std::vector<uint8_t> request = {commandReadBusyFlag, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response(resSize, 0);
 
-    auto success = i2cInterface.sendReceive(request, response);
+    auto success = co_await i2cInterface.sendReceive(request, response);
     if (!success && response.size() != resSize)
     {
         co_return false;
@@ -471,7 +471,7 @@ sdbusplus::async::task<bool> LatticeBaseCPLD::readStatusReg(uint8_t& statusReg)
     std::vector<uint8_t> request = {commandReadStatusReg, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response(4, 0);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send read status register request.");
         co_return false;
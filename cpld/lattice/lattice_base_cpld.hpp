@@ -158,7 +158,7 @@ class LatticeBaseCPLD
                     const uint8_t address, const std::string& chip,
                     const std::string& target, const bool debugMode) :
         ctx(ctx), chip(chip), target(target), debugMode(debugMode),
-        i2cInterface(phosphor::i2c::I2C(bus, address))
+        i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
     {}
     virtual ~LatticeBaseCPLD() = default;
     LatticeBaseCPLD(const LatticeBaseCPLD&) = delete;
@@ -2,6 +2,7 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <array>
 #include <fstream>
 #include <vector>
 
@@ -13,7 +14,7 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::readDeviceId()
     std::vector<uint8_t> request = {commandReadDeviceId, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response = {0, 0, 0, 0};
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error(
             "Fail to read device Id. Please check the I2C bus and address.");
@@ -96,7 +97,7 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::eraseFlash()
         request = {commandEraseFlash, 0xC, 0x0, 0x0};
     }
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send erase flash request.");
         co_return false;
@@ -177,7 +178,7 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::readUserCode(uint32_t& userCode)
     std::vector<uint8_t> request = {commandReadFwVersion, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response(resSize, 0);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send read user code request.");
         co_return false;
@@ -199,7 +200,7 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::programUserCode()
         request.push_back((fwInfo.version >> (i * 8)) & 0xFF);
     }
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send program user code request.");
         co_return false;
@@ -306,31 +307,34 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::programSinglePage(
     uint16_t pageOffset, std::span<const uint8_t> pageData)
 {
     // Set Page Offset
-    std::vector<uint8_t> emptyResp(0);
     std::vector<uint8_t> setPageAddrCmd = {
         commandSetPageAddress, 0x0, 0x0, 0x0, 0x00, 0x00, 0x00, 0x00};
     setPageAddrCmd[6] = static_cast<uint8_t>(pageOffset >> 8); // high byte
     setPageAddrCmd[7] = static_cast<uint8_t>(pageOffset);      // low byte
 
-    // NOLINTNEXTLINE(clang-analyzer-core.uninitialized.Branch)
-    bool success = co_await i2cInterface.sendReceive(
-        setPageAddrCmd.data(), setPageAddrCmd.size(), nullptr, 0);
-    if (!success)
-    {
-        lg2::error("Write page address failed");
-        co_return false;
-    }
-
     // Write Page Data
     constexpr uint8_t pageCount = 1;
     std::vector<uint8_t> writeCmd = {commandProgramPage, 0x0, 0x0, pageCount};
     writeCmd.insert(writeCmd.end(), pageData.begin(), pageData.end());
 
-    success = co_await i2cInterface.sendReceive(writeCmd.data(),
-                                                writeCmd.size(), nullptr, 0);
-    if (!success)
+    // both commands in one transfer, if the adapter can send the STOP
+    // in between
+    std::array<phosphor::i2c::I2CMessage, 2> messages = {{
+        {.read = false,
+         .stop = true,
+         .data = setPageAddrCmd.data(),
+         .size = static_cast<uint16_t>(setPageAddrCmd.size())},
+        {.read = false,
+         .stop = true,
+         .data = writeCmd.data(),
+         .size = static_cast<uint16_t>(writeCmd.size())},
+    }};
+
+    // NOLINTNEXTLINE(clang-analyzer-core.uninitialized.Branch)
+    const int ret = co_await i2cInterface.sendReceiveBatch(messages);
+    if (ret < 0)
     {
-        lg2::error("Write page data failed");
+        lg2::error("Write page failed: {ERRNO}", "ERRNO", -ret);
         co_return false;
     }
 
@@ -349,26 +353,38 @@ sdbusplus::async::task<bool> LatticeXO3CPLD::verifySinglePage(
     uint16_t pageOffset, std::span<const uint8_t> pageData)
 {
     // Set Page Offset
-    std::vector<uint8_t> emptyResp(0);
     std::vector<uint8_t> setPageAddrCmd = {
         commandSetPageAddress, 0x0, 0x0, 0x0, 0x00, 0x00, 0x00, 0x00};
     setPageAddrCmd[6] = static_cast<uint8_t>(pageOffset >> 8); // high byte
     setPageAddrCmd[7] = static_cast<uint8_t>(pageOffset);      // low byte
 
-    if (!i2cInterface.sendReceive(setPageAddrCmd, emptyResp))
-    {
-        lg2::error("Write page address failed");
-        co_return false;
-    }
-
     // Read Page Data
     constexpr uint8_t pageCount = 1;
     std::vector<uint8_t> readData(pageData.size());
     std::vector<uint8_t> readCmd = {commandReadPage, 0x0, 0x0, pageCount};
 
-    if (!i2cInterface.sendReceive(readCmd, readData))
+    // set the page and read it back in one transfer, or in two if the
+    // adapter cannot send the STOP after setting the page
+    std::array<phosphor::i2c::I2CMessage, 3> messages = {{
+        {.read = false,
+         .stop = true,
+         .data = setPageAddrCmd.data(),
+         .size = static_cast<uint16_t>(setPageAddrCmd.size())},
+        {.read = false,
+         .stop = false,
+         .data = readCmd.data(),
+         .size = static_cast<uint16_t>(readCmd.size())},
+        {.read = true,
+         .stop = false,
+         .data = readData.data(),
+         .size = static_cast<uint16_t>(readData.size())},
+    }};
+
+    // NOLINTNEXTLINE(clang-analyzer-core.uninitialized.Branch)
+    const int ret = co_await i2cInterface.sendReceiveBatch(messages);
+    if (ret < 0)
     {
-        lg2::error("Read page data failed");
+        lg2::error("Read page failed: {ERRNO}", "ERRNO", -ret);
         co_return false;
     }
 
@@ -79,7 +79,7 @@ sdbusplus::async::task<bool> LatticeXO5DSeriesCPLD::esfbWrite(
     request.insert(request.end(), data.begin(), data.end());
     request.push_back(checkSum(request));
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("ESFB write failed for CMD: {CMD_ID}", "CMD_ID", lg2::hex,
                    cmdId);
@@ -102,7 +102,7 @@ sdbusplus::async::task<bool> LatticeXO5DSeriesCPLD::esfbReadStatus(
 
     request.push_back(cmdId);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("ESFB read status failed for CMD: {CMD}", "CMD", lg2::hex,
                    cmdId);
@@ -169,7 +169,7 @@ sdbusplus::async::task<bool> LatticeXO5DSeriesCPLD::esfbReadData(
 
     request.push_back(cmdId);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("ESFB read data failed.");
         co_return false;
@@ -63,7 +63,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::eraseCfg(
         request.push_back(block);
         request.push_back(0x0);
         request.push_back(0x0);
-        if (!i2cInterface.sendReceive(request, response))
+        if (!(co_await i2cInterface.sendReceive(request, response)))
         {
             lg2::error("Failed to erase block");
             co_return false;
@@ -99,7 +99,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::programPage(
     request.push_back(0x0);
     request.insert(request.end(), data.begin(), data.end());
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         co_return false;
     }
@@ -174,7 +174,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::readPage(
     request.push_back(page);
     request.push_back(0x0);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         co_return false;
     }
@@ -189,7 +189,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::readPage(
         co_return false;
     }
 
-    if (!i2cInterface.sendReceive(request, data))
+    if (!(co_await i2cInterface.sendReceive(request, data)))
     {
         co_return false;
     }
@@ -273,7 +273,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::readUserCode(
     std::vector<uint8_t> request = {commandReadFwVersion, 0x0, 0x0, 0x0};
     std::vector<uint8_t> response(resSize, 0);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send read user code request.");
         co_return false;
@@ -293,7 +293,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::programDone()
     request.push_back(0x0);
     request.push_back(0x0);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send program done request.");
         co_return false;
@@ -366,7 +366,7 @@ sdbusplus::async::task<bool> LatticeXO5StandardCPLD::checkDeviceReady()
     std::vector<uint8_t> request = {};
     std::vector<uint8_t> response = {0xff};
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         co_return false;
     }
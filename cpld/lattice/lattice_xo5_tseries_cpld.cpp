@@ -86,7 +86,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::lockI2C()
     }
     std::vector<uint8_t> request = {static_cast<uint8_t>(xo5Cmd::lock), 0x01};
     std::vector<uint8_t> response = {0x00};
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to send lock command.");
         co_return false;
@@ -113,7 +113,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::toggleCrc16(bool enable)
                                     0x00, 0x00};
     std::vector<uint8_t> response = {};
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to toggle CRC16.");
         co_return false;
@@ -128,7 +128,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::readCrcStatus(bool& crc_ok)
         static_cast<uint8_t>(xo5Cmd::checkBusyStatus), 0x00, 0x00, 0x00};
     std::vector<uint8_t> response(1, 0xFF);
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         lg2::error("Failed to read CRC status.");
         co_return false;
@@ -193,7 +193,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::sendReceive(
 
     if (!isCrcRequired(opcode))
     {
-        co_return i2cInterface.sendReceive(request, response);
+        co_return co_await i2cInterface.sendReceive(request, response);
     }
 
     std::vector<uint8_t> request_crc = request;
@@ -208,7 +208,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::sendReceive(
     std::size_t j = 0;
     for (; j < xo5Cfg::retryMax; ++j)
     {
-        if (!i2cInterface.sendReceive(request_crc, responseCrc))
+        if (!(co_await i2cInterface.sendReceive(request_crc, responseCrc)))
         {
             lg2::error("Failed to sendReceive with CRC16.");
             co_return false;
@@ -730,7 +730,7 @@ sdbusplus::async::task<bool> LatticeXO5TSeriesCPLD::checkDeviceReady()
         static_cast<uint8_t>(xo5Cmd::checkBusyStatus), 0x00, 0x00, 0x00};
     std::vector<uint8_t> response = {0xff};
 
-    if (!i2cInterface.sendReceive(request, response))
+    if (!(co_await i2cInterface.sendReceive(request, response)))
     {
         co_return false;
     }
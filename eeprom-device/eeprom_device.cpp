@@ -9,6 +9,7 @@
 #include <sdbusplus/message.hpp>
 
 #include <filesystem>
+#include <format>
 #include <fstream>
 
 PHOSPHOR_LOG2_USING;
@@ -73,6 +74,11 @@ EEPROMDevice::EEPROMDevice(
     debug("Initialized EEPROM device instance on dbus");
 }
 
+std::optional<std::string> EEPROMDevice::getUpdateBus() const
+{
+    return std::format("i2c-{}", bus);
+}
+
 sdbusplus::async::task<bool> EEPROMDevice::updateDevice(const uint8_t* image,
                                                         size_t image_size)
 {
@@ -30,6 +30,8 @@ class EEPROMDevice : public Device
     sdbusplus::async::task<bool> updateDevice(const uint8_t* image,
                                               size_t image_size) final;
 
+    std::optional<std::string> getUpdateBus() const final;
+
   private:
     uint16_t bus;
     uint8_t address;
@@ -1,6 +1,5 @@
 #include "eeprom_device_software_manager.hpp"
 
-#include "common/include/dbus_helper.hpp"
 #include "eeprom_device.hpp"
 
 #include <phosphor-logging/lg2.hpp>
@@ -30,30 +29,31 @@ void EEPROMDeviceSoftwareManager::start()
                    });
 
     ctx.spawn(initDevices(configIntfs));
+
+    enableGroupUpdate(
+        {RequestedApplyTimes::Immediate, RequestedApplyTimes::OnReset});
+
     ctx.run();
 }
 
 sdbusplus::async::task<bool> EEPROMDeviceSoftwareManager::initDevice(
-    const std::string& service, const sdbusplus::object_path& path,
-    SoftwareConfig& config)
+    const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
+    SoftwareConfig& config, const ConfigSnapshot& snapshot)
 {
     const std::string configIface =
         "xyz.openbmc_project.Configuration." + config.configType;
 
-    std::optional<uint64_t> bus = co_await dbusGetRequiredProperty<uint64_t>(
-        ctx, service, path, configIface, "Bus");
+    std::optional<uint64_t> bus =
+        snapshot.getRequired<uint64_t>(configIface, "Bus");
 
     std::optional<uint64_t> address =
-        co_await dbusGetRequiredProperty<uint64_t>(ctx, service, path,
-                                                   configIface, "Address");
+        snapshot.getRequired<uint64_t>(configIface, "Address");
 
     std::optional<std::string> type =
-        co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                      configIface, "Type");
+        snapshot.getRequired<std::string>(configIface, "Type");
 
     std::optional<std::string> fwDevice =
-        co_await dbusGetRequiredProperty<std::string>(
-            ctx, service, path, configIface, "FirmwareDevice");
+        snapshot.getRequired<std::string>(configIface, "FirmwareDevice");
 
     if (!bus.has_value() || !address.has_value() || !type.has_value() ||
         !fwDevice.has_value())
@@ -106,14 +106,19 @@ sdbusplus::async::task<bool> EEPROMDeviceSoftwareManager::initDevice(
             {
                 if (iface.starts_with("xyz.openbmc_project.Configuration."))
                 {
-                    bus = co_await dbusGetRequiredProperty<uint64_t>(
-                        ctx, s, p, iface, "Bus");
-
-                    address = co_await dbusGetRequiredProperty<uint64_t>(
-                        ctx, s, p, iface, "Address");
-
-                    type = co_await dbusGetRequiredProperty<std::string>(
-                        ctx, s, p, iface, "Type");
+                    // one GetAll instead of a Get per property
+                    std::optional<ConfigSnapshot> fwDeviceSnapshot =
+                        co_await ConfigSnapshot::fetch(ctx, s, p, {iface});
+
+                    if (fwDeviceSnapshot.has_value())
+                    {
+                        bus = fwDeviceSnapshot->getRequired<uint64_t>(iface,
+                                                                      "Bus");
+                        address = fwDeviceSnapshot->getRequired<uint64_t>(
+                            iface, "Address");
+                        type = fwDeviceSnapshot->getRequired<std::string>(
+                            iface, "Type");
+                    }
                     break;
                 }
             }
@@ -134,30 +139,10 @@ sdbusplus::async::task<bool> EEPROMDeviceSoftwareManager::initDevice(
     debug("EEPROM: Bus={BUS}, Address={ADDR}, Type={TYPE}", "BUS", bus.value(),
           "ADDR", address.value(), "TYPE", type.value());
 
-    const std::string configIfaceMux = configIface + ".MuxOutputs";
     std::vector<std::string> gpioLines;
     std::vector<bool> gpioPolarities;
 
-    for (size_t i = 0; true; i++)
-    {
-        const std::string iface = configIfaceMux + std::to_string(i);
-
-        std::optional<std::string> name =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Name");
-
-        std::optional<std::string> polarity =
-            co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                          iface, "Polarity");
-
-        if (!name.has_value() || !polarity.has_value())
-        {
-            break;
-        }
-
-        gpioLines.push_back(name.value());
-        gpioPolarities.push_back(polarity.value() == "High");
-    }
+    snapshot.getMuxOutputs(configIface, gpioLines, gpioPolarities);
 
     for (size_t i = 0; i < gpioLines.size(); i++)
     {
@@ -15,9 +15,9 @@ class EEPROMDeviceSoftwareManager : public ManagerInf::SoftwareManager
 
     void start();
 
-    sdbusplus::async::task<bool> initDevice(const std::string& service,
-                                            const sdbusplus::object_path& path,
-                                            SoftwareConfig& config) final;
+    sdbusplus::async::task<bool> initDevice(
+        const std::string& service, const sdbusplus::object_path& path,
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) final;
 
   private:
     sdbusplus::async::task<bool> getDeviceProperties(
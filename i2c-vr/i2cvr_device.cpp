@@ -1,5 +1,6 @@
 #include "i2cvr_device.hpp"
 
+#include "common/include/i2c/bus_scheduler.hpp"
 #include "common/include/utils.hpp"
 
 #include <phosphor-logging/lg2.hpp>
@@ -12,8 +13,13 @@ namespace phosphor::software::i2c_vr::device
 sdbusplus::async::task<bool> I2CVRDevice::updateDevice(const uint8_t* image,
                                                        size_t imageSize)
 {
+    // how much the update had to wait for the other devices on the bus
+    phosphor::i2c::BusStatsSummary busStats(bus);
+
     setUpdateProgress(20);
 
+    beginUpdatePhase(update::UpdatePhase::Verify);
+
     // NOLINTBEGIN(clang-analyzer-core.uninitialized.Branch)
     if (!(co_await vrInterface->verifyImage(image, imageSize)))
     //  NOLINTEND(clang-analyzer-core.uninitialized.Branch)
@@ -23,6 +29,8 @@ sdbusplus::async::task<bool> I2CVRDevice::updateDevice(const uint8_t* image,
 
     setUpdateProgress(50);
 
+    beginUpdatePhase(update::UpdatePhase::Program);
+
     // NOLINTBEGIN(clang-analyzer-core.uninitialized.Branch)
     if (!(co_await vrInterface->updateFirmware(false)))
     //  NOLINTEND(clang-analyzer-core.uninitialized.Branch)
@@ -5,6 +5,8 @@
 #include "common/include/software_manager.hpp"
 #include "vr.hpp"
 
+#include <format>
+
 namespace SoftwareInf = phosphor::software;
 namespace ManagerInf = SoftwareInf::manager;
 namespace DeviceInf = SoftwareInf::device;
@@ -28,7 +30,7 @@ class I2CVRDevice : public DeviceInf::Device
         DeviceInf::Device(
             ctx, config, parent,
             {SDBusPlusSoftware::ApplyTime::RequestedApplyTimes::OnReset}),
-        vrInterface(VRInf::create(ctx, vrType, bus, address))
+        vrInterface(VRInf::create(ctx, vrType, bus, address)), bus(bus)
     {}
 
     std::unique_ptr<VRInf::VoltageRegulator> vrInterface;
@@ -37,6 +39,14 @@ class I2CVRDevice : public DeviceInf::Device
                                               size_t image_size) final;
 
     sdbusplus::async::task<bool> getVersion(uint32_t* sum) const;
+
+    std::optional<std::string> getUpdateBus() const final
+    {
+        return std::format("i2c-{}", bus);
+    }
+
+  private:
+    const uint16_t bus;
 };
 
 } // namespace phosphor::software::i2c_vr::device
@@ -1,6 +1,5 @@
 #include "i2cvr_software_manager.hpp"
 
-#include "common/include/dbus_helper.hpp"
 #include "common/include/software_manager.hpp"
 #include "i2cvr_device.hpp"
 #include "vr.hpp"
@@ -41,24 +40,25 @@ void I2CVRSoftwareManager::start()
     }
 
     ctx.spawn(initDevices(configIntfs));
+
+    enableGroupUpdate({RequestedApplyTimes::OnReset});
+
     ctx.run();
 }
 
 sdbusplus::async::task<bool> I2CVRSoftwareManager::initDevice(
-    const std::string& service, const sdbusplus::object_path& path,
-    SoftwareConfig& config)
+    const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
+    SoftwareConfig& config, const ConfigSnapshot& snapshot)
 {
     std::string configIface =
         "xyz.openbmc_project.Configuration." + config.configType;
 
-    std::optional<uint64_t> busNum = co_await dbusGetRequiredProperty<uint64_t>(
-        ctx, service, path, configIface, "Bus");
+    std::optional<uint64_t> busNum =
+        snapshot.getRequired<uint64_t>(configIface, "Bus");
     std::optional<uint64_t> address =
-        co_await dbusGetRequiredProperty<uint64_t>(ctx, service, path,
-                                                   configIface, "Address");
+        snapshot.getRequired<uint64_t>(configIface, "Address");
     std::optional<std::string> vrChipType =
-        co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                      configIface, "Type");
+        snapshot.getRequired<std::string>(configIface, "Type");
 
     if (!busNum.has_value() || !address.has_value() || !vrChipType.has_value())
     {
@@ -14,7 +14,8 @@ class I2CVRSoftwareManager : public ManagerInf::SoftwareManager
 
     SDBusAsync::task<bool> initDevice(const std::string& service,
                                       const sdbusplus::object_path& path,
-                                      SoftwareConfig& config) final;
+                                      SoftwareConfig& config,
+                                      const ConfigSnapshot& snapshot) final;
 
     void start();
 };
@@ -74,7 +74,7 @@ constexpr uint16_t gen3p5CRC = 336 - gen3p5FileHead;
 
 ISL69269::ISL69269(sdbusplus::async::context& ctx, uint16_t bus,
                    uint16_t address, Gen gen) :
-    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address)),
+    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(ctx, bus, address)),
     generation(gen)
 {}
 
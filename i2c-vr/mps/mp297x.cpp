@@ -105,7 +105,7 @@ sdbusplus::async::task<bool> MP297X::checkId(PMBusCmd idCmd, uint32_t expected)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for ID check");
         co_return false;
@@ -113,7 +113,7 @@ sdbusplus::async::task<bool> MP297X::checkId(PMBusCmd idCmd, uint32_t expected)
 
     tbuf = buildByteVector(idCmd);
     rbuf.resize(statusByteLength + idLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read ID, cmd={CMD}", "CMD", lg2::hex,
               static_cast<uint8_t>(idCmd));
@@ -142,7 +142,7 @@ sdbusplus::async::task<bool> MP297X::isPasswordUnlock()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for password unlock check");
         co_return false;
@@ -151,7 +151,7 @@ sdbusplus::async::task<bool> MP297X::isPasswordUnlock()
     tbuf = buildByteVector(PMBusCmd::statusCML);
     rbuf.resize(statusByteLength);
 
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to check password unlock status");
         co_return false;
@@ -176,14 +176,14 @@ sdbusplus::async::task<bool> MP297X::unlockWriteProtect()
 
     // Get write protection mode
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 1 to check write protection mode");
         co_return false;
     }
 
     tbuf = buildByteVector(MP297XCmd::writeProtectMode);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to get write protect mode");
         co_return false;
@@ -194,14 +194,14 @@ sdbusplus::async::task<bool> MP297X::unlockWriteProtect()
 
     // Unlock write protection
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 to unlock write protection");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::writeProtect, unlockData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock write protection");
         co_return false;
@@ -237,7 +237,7 @@ sdbusplus::async::task<bool> MP297X::programPageRegisters(
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, page);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page {PAGE} to program registers", "PAGE",
               pageNum);
@@ -252,7 +252,7 @@ sdbusplus::async::task<bool> MP297X::programPageRegisters(
 
         for (size_t i = 1; i <= maxRetries; ++i)
         {
-            if (i2cInterface.sendReceive(tbuf, rbuf))
+            if (co_await i2cInterface.sendReceive(tbuf, rbuf))
             {
                 co_return true;
             }
@@ -297,14 +297,14 @@ sdbusplus::async::task<bool> MP297X::storeDataIntoMTP()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for storing data into MTP");
         co_return false;
     }
 
     tbuf = buildByteVector(MP297XCmd::storeDataIntoMTP);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to store data into MTP");
         co_return false;
@@ -326,7 +326,7 @@ sdbusplus::async::task<bool> MP297X::enableMTPPageWriteRead()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 1 to enable MTP page write/read");
         co_return false;
@@ -334,7 +334,7 @@ sdbusplus::async::task<bool> MP297X::enableMTPPageWriteRead()
 
     tbuf = buildByteVector(MP297XCmd::enableMTPPageWR);
     rbuf.resize(statusByteLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read MTP page write/read status");
         co_return false;
@@ -343,7 +343,7 @@ sdbusplus::async::task<bool> MP297X::enableMTPPageWriteRead()
     uint8_t enableMTPPageWRData = rbuf[0] | mtpByteRWEnable;
     tbuf = buildByteVector(MP297XCmd::enableMTPPageWR, enableMTPPageWRData);
     rbuf.resize(0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to enable MTP page write/read");
         co_return false;
@@ -359,14 +359,14 @@ sdbusplus::async::task<bool> MP297X::enableMultiConfigCRC()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2 to enable multi-config CRC");
         co_return false;
     }
 
     tbuf = buildByteVector(MP297XCmd::enableMultiConfigCRC);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to enable multi-config CRC");
         co_return false;
@@ -395,7 +395,7 @@ sdbusplus::async::task<bool> MP297X::getCRC(uint32_t* checksum)
     // Read User Code CRC
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page29);
     rbuf.resize(0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 29 for User Code CRC read");
         co_return false;
@@ -403,7 +403,7 @@ sdbusplus::async::task<bool> MP297X::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MP297XCmd::readUserCodeCRC);
     rbuf.resize(crcLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read User Code CRC from device");
         co_return false;
@@ -414,7 +414,7 @@ sdbusplus::async::task<bool> MP297X::getCRC(uint32_t* checksum)
     // Read Multi Config CRC
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2A);
     rbuf.resize(0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2A for Multi Config CRC read");
         co_return false;
@@ -422,7 +422,7 @@ sdbusplus::async::task<bool> MP297X::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MP297XCmd::readMultiConfigCRC);
     rbuf.resize(crcLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read Multi Config CRC from device");
         co_return false;
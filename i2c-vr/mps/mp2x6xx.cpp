@@ -126,7 +126,7 @@ sdbusplus::async::task<bool> MP2X6XX::checkId(PMBusCmd pmBusCmd,
     std::vector<uint8_t> tbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for ID check");
         co_return false;
@@ -135,7 +135,7 @@ sdbusplus::async::task<bool> MP2X6XX::checkId(PMBusCmd pmBusCmd,
     tbuf = {cmd};
     rbuf.resize(idLen + (blockRead ? statusByteLength : 0));
 
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("I2C failure during ID check, cmd {CMD}", "CMD", lg2::hex, cmd);
         co_return false;
@@ -160,14 +160,14 @@ sdbusplus::async::task<bool> MP2X6XX::unlockWriteProtect()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for unlocking write protect");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::writeProtect, disableWriteProtect);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to disable write protect");
         co_return false;
@@ -175,7 +175,7 @@ sdbusplus::async::task<bool> MP2X6XX::unlockWriteProtect()
 
     // unlock page 2 write protect
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 1 for unlocking write protect for page 2");
         co_return false;
@@ -183,7 +183,7 @@ sdbusplus::async::task<bool> MP2X6XX::unlockWriteProtect()
 
     tbuf =
         buildByteVector(MP2X6XXCmd::mfrMTPMemoryCtrl, disablePage2WriteProtect);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock page 2 write protect");
         co_return false;
@@ -191,7 +191,7 @@ sdbusplus::async::task<bool> MP2X6XX::unlockWriteProtect()
 
     // unlock page 3 write protect
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page3);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 3 for unlocking write protect for page 3");
         co_return false;
@@ -199,7 +199,7 @@ sdbusplus::async::task<bool> MP2X6XX::unlockWriteProtect()
 
     tbuf = buildByteVector(MP2X6XXCmd::mfrMTPMemoryCtrlPage3,
                            disablePage3WriteProtect);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock page 3 write protect");
         co_return false;
@@ -220,7 +220,7 @@ sdbusplus::async::task<bool> MP2X6XX::selectConfig(uint8_t config)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2 for configuration switch");
         co_return false;
@@ -232,7 +232,7 @@ sdbusplus::async::task<bool> MP2X6XX::selectConfig(uint8_t config)
 
     tbuf = buildByteVector(MP2X6XXCmd::selectConfigCtrl, command);
 
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to write config select command {CMD} for config {CONFIG}",
               "CMD", lg2::hex, command, "CONFIG", config);
@@ -254,7 +254,7 @@ sdbusplus::async::task<bool> MP2X6XX::programConfigData(
         uint8_t page = data.page & pageMask;
 
         tbuf = buildByteVector(PMBusCmd::page, page);
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("Failed to set page {PAGE} for register {REG}", "PAGE", page,
                   "REG", lg2::hex, data.addr);
@@ -265,7 +265,7 @@ sdbusplus::async::task<bool> MP2X6XX::programConfigData(
         tbuf.insert(tbuf.end(), data.data.begin(),
                     data.data.begin() + data.length);
 
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error(
                 "Failed to write data {DATA} to register {REG} on page {PAGE}",
@@ -315,14 +315,14 @@ sdbusplus::async::task<bool> MP2X6XX::storeUserCode()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for storing user code");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::storeUserCode);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to store user code");
         co_return false;
@@ -348,7 +348,7 @@ sdbusplus::async::task<bool> MP2X6XX::getCRC(uint32_t* checksum)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for CRC read");
         co_return false;
@@ -356,7 +356,7 @@ sdbusplus::async::task<bool> MP2X6XX::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MP2X6XXCmd::readCRCReg);
     rbuf.resize(crcLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read CRC from device");
         co_return false;
@@ -87,7 +87,7 @@ sdbusplus::async::task<bool> MP5998::checkId(PMBusCmd idCmd, uint32_t expected)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("MP5998: Failed to set page 0 for ID check");
         co_return false;
@@ -113,7 +113,7 @@ sdbusplus::async::task<bool> MP5998::checkId(PMBusCmd idCmd, uint32_t expected)
     tbuf = buildByteVector(idCmd);
     rbuf.resize(bufferSize);
 
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("MP5998: I2C sendReceive failed for command 0x{CMD}", "CMD",
               lg2::hex, static_cast<uint8_t>(idCmd));
@@ -148,14 +148,14 @@ sdbusplus::async::task<bool> MP5998::unlockPasswordProtection()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for password unlock");
         co_return false;
     }
 
     tbuf = buildByteVector(MP5998Cmd::passwordReg, passwordData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to write password");
         co_return false;
@@ -163,7 +163,7 @@ sdbusplus::async::task<bool> MP5998::unlockPasswordProtection()
 
     tbuf = buildByteVector(PMBusCmd::statusCML);
     rbuf.resize(statusByteLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read STATUS_CML");
         co_return false;
@@ -180,14 +180,14 @@ sdbusplus::async::task<bool> MP5998::unlockWriteProtection()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for write protection unlock");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::writeProtect, unlockData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock write protection");
         co_return false;
@@ -208,7 +208,7 @@ sdbusplus::async::task<bool> MP5998::programAllRegisters()
             std::vector<uint8_t> tbuf =
                 buildByteVector(PMBusCmd::page, regData.page);
             std::vector<uint8_t> rbuf;
-            if (!i2cInterface.sendReceive(tbuf, rbuf))
+            if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
             {
                 error("Failed to set page {PAGE}", "PAGE", regData.page);
                 co_return false;
@@ -226,7 +226,7 @@ sdbusplus::async::task<bool> MP5998::programAllRegisters()
             tbuf.push_back(regData.data[i]);
         }
 
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("Failed to write register 0x{REG} on page {PAGE}", "REG",
                   lg2::hex, regData.addr, "PAGE", regData.page);
@@ -244,14 +244,14 @@ sdbusplus::async::task<bool> MP5998::storeMTP()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for MTP store");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::storeUserCode);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to send STORE_USER_ALL command");
         co_return false;
@@ -269,7 +269,7 @@ sdbusplus::async::task<bool> MP5998::waitForMTPComplete()
     std::vector<uint8_t> rbuf;
     rbuf.resize(statusByteLength);
 
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read STATUS_CML after MTP store");
         co_return false;
@@ -311,7 +311,7 @@ sdbusplus::async::task<bool> MP5998::getCRC(uint32_t* checksum)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for CRC read");
         co_return false;
@@ -319,7 +319,7 @@ sdbusplus::async::task<bool> MP5998::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MP5998Cmd::crcUser);
     rbuf.resize(crcLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read CRC_USER register");
         co_return false;
@@ -336,14 +336,14 @@ sdbusplus::async::task<bool> MP5998::sendRestoreMTPCommand()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for MTP restore");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::restoreUserAll);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to send RESTORE_ALL command");
         co_return false;
@@ -358,7 +358,7 @@ sdbusplus::async::task<bool> MP5998::checkEEPROMFaultAfterRestore()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for EEPROM fault check");
         co_return false;
@@ -366,7 +366,7 @@ sdbusplus::async::task<bool> MP5998::checkEEPROMFaultAfterRestore()
 
     tbuf = buildByteVector(PMBusCmd::statusCML);
     rbuf.resize(1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read STATUS_CML register");
         co_return false;
@@ -28,7 +28,7 @@ sdbusplus::async::task<bool> MPQ87XX::checkId()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for ID check");
         co_return false;
@@ -36,7 +36,7 @@ sdbusplus::async::task<bool> MPQ87XX::checkId()
 
     tbuf = buildByteVector(PMBusCmd::mfrId);
     rbuf.resize(mfrIdLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read ID, cmd={CMD}", "CMD", lg2::hex,
               static_cast<uint8_t>(PMBusCmd::mfrId));
@@ -57,7 +57,7 @@ sdbusplus::async::task<bool> MPQ87XX::checkId()
     tbuf = buildByteVector(MPQ87XXCmd::mfrConfigId);
     rbuf.clear();
     rbuf.resize(mfrConfigIdLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read ID, cmd={CMD}", "CMD", lg2::hex,
               static_cast<uint8_t>(MPQ87XXCmd::mfrConfigId));
@@ -93,7 +93,7 @@ sdbusplus::async::task<bool> MPQ87XX::programPageRegisters(
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, page);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page {PAGE} to program registers", "PAGE",
               pageNum);
@@ -106,7 +106,7 @@ sdbusplus::async::task<bool> MPQ87XX::programPageRegisters(
         tbuf.insert(tbuf.end(), regData.data.begin(),
                     regData.data.begin() + regData.length);
 
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("Failed to program VR registers");
             co_return false;
@@ -122,14 +122,14 @@ sdbusplus::async::task<bool> MPQ87XX::storeMTP()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for MTP store");
         co_return false;
     }
 
     tbuf = buildByteVector(MPQ87XXCmd::storeAll);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to send STORE_USER_ALL command");
         co_return false;
@@ -232,7 +232,7 @@ sdbusplus::async::task<bool> MPQ87XX::getCRC(uint32_t* checksum)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for CRC read");
         co_return false;
@@ -240,7 +240,7 @@ sdbusplus::async::task<bool> MPQ87XX::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MPQ87XXCmd::checksumFunc);
     rbuf.resize(crcLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read CRC register");
         co_return false;
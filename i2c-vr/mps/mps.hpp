@@ -281,7 +281,8 @@ class MPSVoltageRegulator : public VoltageRegulator
   public:
     MPSVoltageRegulator(sdbusplus::async::context& ctx, uint16_t bus,
                         uint16_t address) :
-        VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address))
+        VoltageRegulator(ctx),
+        i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
     {}
 
     /**
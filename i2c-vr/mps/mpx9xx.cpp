@@ -146,7 +146,7 @@ sdbusplus::async::task<bool> MPX9XX::checkId(MPX9XXCmd idCmd, uint32_t expected)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, page);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page for ID check");
         co_return false;
@@ -154,7 +154,7 @@ sdbusplus::async::task<bool> MPX9XX::checkId(MPX9XXCmd idCmd, uint32_t expected)
 
     tbuf = buildByteVector(idCmd);
     rbuf.resize(idLen);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read ID, cmd={CMD}", "CMD", lg2::hex, cmd);
         co_return false;
@@ -180,14 +180,14 @@ sdbusplus::async::task<bool> MPX9XX::unlockWriteProtect()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 to unlock write protection mode");
         co_return false;
     }
 
     tbuf = buildByteVector(PMBusCmd::writeProtect, unlockWriteProtectData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock write protect mode");
         co_return false;
@@ -208,7 +208,7 @@ sdbusplus::async::task<bool> MPX9XX::disableStoreFaultTriggering()
 
     // enable entering page 7
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2 to enable entering page 7");
         co_return false;
@@ -216,7 +216,7 @@ sdbusplus::async::task<bool> MPX9XX::disableStoreFaultTriggering()
 
     tbuf = buildByteVector(MPX9XXCmd::mfrDebug);
     rbuf.resize(mfrDebugDataLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read MFR Debug register to enable entering 7");
         co_return false;
@@ -225,7 +225,7 @@ sdbusplus::async::task<bool> MPX9XX::disableStoreFaultTriggering()
     uint16_t data = (rbuf[1] << 8) | rbuf[0] | enableEnteringPage7Mask;
     tbuf = buildByteVector(MPX9XXCmd::mfrDebug, data);
     rbuf.clear();
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to enable entering page 7");
         co_return false;
@@ -233,7 +233,7 @@ sdbusplus::async::task<bool> MPX9XX::disableStoreFaultTriggering()
 
     // disable store fault triggering
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page7);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 7 to disable store fault triggering");
         co_return false;
@@ -242,7 +242,7 @@ sdbusplus::async::task<bool> MPX9XX::disableStoreFaultTriggering()
     tbuf = buildByteVector(MPX9XXCmd::storeFaultTrigger,
                            disableStoreFaultTriggeringData);
     rbuf.clear();
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to disable store fault triggering");
         co_return false;
@@ -275,7 +275,7 @@ sdbusplus::async::task<bool> MPX9XX::setMultiConfigAddress(uint8_t config)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2 to set multi config address");
         co_return false;
@@ -283,7 +283,7 @@ sdbusplus::async::task<bool> MPX9XX::setMultiConfigAddress(uint8_t config)
 
     uint8_t selectAddrData = enableMultiConfigAddrSel + addr;
     tbuf = buildByteVector(MPX9XXCmd::mfrMulconfigSel, selectAddrData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to write {DATA} to multi config select register {REG}",
               "DATA", lg2::hex, selectAddrData, "REG", lg2::hex,
@@ -306,7 +306,7 @@ sdbusplus::async::task<bool> MPX9XX::programConfigData(
         uint8_t page = data.page & pageMask;
 
         tbuf = buildByteVector(PMBusCmd::page, page);
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("Failed to set page {PAGE} for register {REG}", "PAGE", page,
                   "REG", lg2::hex, data.addr);
@@ -317,7 +317,7 @@ sdbusplus::async::task<bool> MPX9XX::programConfigData(
         tbuf.insert(tbuf.end(), data.data.begin(),
                     data.data.begin() + data.length);
 
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error(
                 "Failed to write data {DATA} to register {REG} on page {PAGE}",
@@ -373,14 +373,14 @@ sdbusplus::async::task<bool> MPX9XX::storeDataIntoMTP()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 to store data into MTP");
         co_return false;
     }
 
     tbuf = buildByteVector(MPX9XXCmd::storeUserAll);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to store data into MTP");
         co_return false;
@@ -402,7 +402,7 @@ sdbusplus::async::task<bool> MPX9XX::getCRC(uint32_t* checksum)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for get user data");
         co_return false;
@@ -410,7 +410,7 @@ sdbusplus::async::task<bool> MPX9XX::getCRC(uint32_t* checksum)
 
     tbuf = buildByteVector(MPX9XXCmd::userData08);
     rbuf.resize(crcUserMultiDataLength + statusByteLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to get user data on page 0");
         co_return false;
@@ -433,7 +433,7 @@ sdbusplus::async::task<bool> MPX9XX::restoreDataFromNVM()
 
     // enable restore data from MTP
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 2 to enable restore data from MTP");
         co_return false;
@@ -441,7 +441,7 @@ sdbusplus::async::task<bool> MPX9XX::restoreDataFromNVM()
 
     tbuf = buildByteVector(MPX9XXCmd::mfrNVMPmbusCtrl);
     rbuf.resize(nvmPmbusCtrlDataLength);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to read NVM PMBUS Ctrl register");
         co_return false;
@@ -450,7 +450,7 @@ sdbusplus::async::task<bool> MPX9XX::restoreDataFromNVM()
     uint16_t data = ((rbuf[1] << 8) | rbuf[0]) | enableRestoreDataFromMTPMask;
     tbuf = buildByteVector(MPX9XXCmd::mfrNVMPmbusCtrl, data);
     rbuf.clear();
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to enable restore data from MTP");
         co_return false;
@@ -458,13 +458,13 @@ sdbusplus::async::task<bool> MPX9XX::restoreDataFromNVM()
 
     // restore data from NVM
     tbuf = buildByteVector(PMBusCmd::page, MPSPage::page0);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to set page 0 for restore MTP and verify");
     }
 
     tbuf = buildByteVector(PMBusCmd::restoreUserAll);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to restore data from NVM");
         co_return false;
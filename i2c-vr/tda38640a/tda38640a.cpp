@@ -54,7 +54,7 @@ const std::unordered_set<uint16_t> user_section_otp_register{
 
 TDA38640A::TDA38640A(sdbusplus::async::context& ctx, uint16_t bus,
                      uint16_t address) :
-    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address))
+    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
 {}
 
 sdbusplus::async::task<bool> TDA38640A::getUserRemainingWrites(uint8_t* remain)
@@ -71,7 +71,7 @@ sdbusplus::async::task<bool> TDA38640A::getUserRemainingWrites(uint8_t* remain)
 
     tbuf = buildByteVector(TDA38640ACmd::userWrRemain);
     rbuf.resize(2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getUserRemainingWrites failed with sendreceive");
         co_return false;
@@ -89,7 +89,7 @@ sdbusplus::async::task<bool> TDA38640A::setPage(uint8_t page)
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(TDA38640ACmd::pageReg, page);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("setPage failed with sendreceive");
         co_return false;
@@ -110,7 +110,7 @@ sdbusplus::async::task<bool> TDA38640A::getDeviceRevision(uint8_t* revision)
 
     tbuf = buildByteVector(TDA38640ACmd::revisionReg);
     rbuf.resize(1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getDeviceRevision failed with sendreceive");
         co_return false;
@@ -136,7 +136,7 @@ sdbusplus::async::task<bool> TDA38640A::getCRC(uint32_t* sum)
 
     tbuf = buildByteVector(TDA38640ACmd::crcLowReg);
     rbuf.resize(2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getCRC failed with sendreceive");
         co_return false;
@@ -145,7 +145,7 @@ sdbusplus::async::task<bool> TDA38640A::getCRC(uint32_t* sum)
     checksum = rbuf[0] | (rbuf[1] << 8);
 
     tbuf = buildByteVector(TDA38640ACmd::crcHighReg);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getCRC failed with sendreceive");
         co_return false;
@@ -239,7 +239,7 @@ sdbusplus::async::task<bool> TDA38640A::unlockDevice()
 
     tbuf = buildByteVector(TDA38640ACmd::unlockRegsReg,
                            TDA38640ACmd::unlockRegsVal);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("unlockDevice failed with sendreceive");
         co_return false;
@@ -260,7 +260,7 @@ sdbusplus::async::task<bool> TDA38640A::programmingCmd()
 
     tbuf = buildByteVector(TDA38640ACmd::progCmdHighReg,
                            TDA38640ACmd::progCmdHighVal);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("programmingCmd high bit failed with sendreceive.");
         co_return false;
@@ -268,7 +268,7 @@ sdbusplus::async::task<bool> TDA38640A::programmingCmd()
 
     tbuf = buildByteVector(TDA38640ACmd::progCmdLowReg,
                            TDA38640ACmd::progCmdLowVal);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("programmingCmd low bit failed with sendreceive.");
         co_return false;
@@ -283,7 +283,7 @@ sdbusplus::async::task<bool> TDA38640A::getProgStatus(uint8_t* status)
 
     tbuf = buildByteVector(TDA38640ACmd::progCmdHighReg);
     rbuf.resize(1);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getProgStatus failed with sendreceive");
         co_return false;
@@ -296,8 +296,6 @@ sdbusplus::async::task<bool> TDA38640A::getProgStatus(uint8_t* status)
 
 sdbusplus::async::task<bool> TDA38640A::program()
 {
-    std::vector<uint8_t> tbuf;
-    std::vector<uint8_t> rbuf;
     uint8_t status;
     uint8_t retry = 3;
 
@@ -312,11 +310,13 @@ sdbusplus::async::task<bool> TDA38640A::program()
     for (size_t i = 0; i < configuration.offsets.size(); i++)
     {
         page = configuration.offsets[i] >> 8;
-        if (!(co_await setPage(page)))
-        {
-            error("program failed at setPage");
-            co_return false;
-        }
+
+        // set the page and write all registers of this offset in a single
+        // transfer, instead of one syscall per register. Every write needs
+        // its STOP, so adapters without protocol mangling still get one
+        // transfer per write.
+        std::vector<std::vector<uint8_t>> writes;
+        writes.push_back(buildByteVector(TDA38640ACmd::pageReg, page));
 
         for (uint8_t bias = 0; bias < 16; bias++)
         {
@@ -333,16 +333,29 @@ sdbusplus::async::task<bool> TDA38640A::program()
 
             address = (configuration.offsets[i] & 0xFF) + bias;
 
-            tbuf = buildByteVector(address, configuration.data[i][bias]);
-            if (!i2cInterface.sendReceive(tbuf, rbuf))
-            {
-                error("program failed with sendreceive");
-                co_return false;
-            }
+            writes.push_back(
+                buildByteVector(address, configuration.data[i][bias]));
             debug("programming : at {PAGE} {ADDR} with {DATA}", "PAGE",
                   lg2::hex, page, "ADDR", lg2::hex, address, "DATA", lg2::hex,
                   configuration.data[i][bias]);
         }
+
+        std::vector<phosphor::i2c::I2CMessage> messages;
+        for (auto& write : writes)
+        {
+            messages.push_back({.read = false,
+                                .stop = true,
+                                .data = write.data(),
+                                .size = static_cast<uint16_t>(write.size())});
+        }
+
+        const int ret = co_await i2cInterface.sendReceiveBatch(messages);
+        if (ret < 0)
+        {
+            error("program failed at page {PAGE}: {ERRNO}", "PAGE", page,
+                  "ERRNO", -ret);
+            co_return false;
+        }
     }
 
     if (!(co_await programmingCmd()))
@@ -34,7 +34,7 @@ sdbusplus::async::task<bool> RS31390::getCheckSum(uint32_t* sum)
 
     tbuf = buildByteVector(regCheckSum);
     rbuf.resize(checkSumLen);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to get checksum");
         co_return false;
@@ -129,7 +129,7 @@ sdbusplus::async::task<bool> TPS25990::unlockWriteProtect()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(regWriteProtect, unlockWriteProtectData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to unlock write protection");
         co_return false;
@@ -145,7 +145,7 @@ sdbusplus::async::task<bool> TPS25990::lockWriteProtect()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(regWriteProtect, lockWriteProtectData);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to lock write protection");
         co_return false;
@@ -165,7 +165,7 @@ sdbusplus::async::task<bool> TPS25990::importUserConfig()
         tbuf = buildByteVector(configuration.offsets[i]);
         tbuf.insert(tbuf.end(), configuration.data[i].begin(),
                     configuration.data[i].end());
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("importUserConfig failed with sendreceive");
             co_return false;
@@ -182,7 +182,7 @@ sdbusplus::async::task<bool> TPS25990::checkNVMavailable()
 
     tbuf = buildByteVector(regStatusMfrSpecific2);
     rbuf.resize(statusMfrSpecific2Len);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to check NVM status");
         co_return false;
@@ -206,7 +206,7 @@ sdbusplus::async::task<bool> TPS25990::program()
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(regStoreUserAll);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to program the NVM with the revised configuration");
         co_return false;
@@ -249,7 +249,7 @@ sdbusplus::async::task<bool> TPS25990::checkProgram()
 
     tbuf = buildByteVector(regStatusCml);
     rbuf.resize(statusCmlLen);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("Failed to check image programming result");
         co_return false;
@@ -312,7 +312,7 @@ sdbusplus::async::task<bool> TPS25990::getCheckSum(uint32_t* sum)
     {
         std::vector<uint8_t> tbuf{data};
         std::vector<uint8_t> rbuf(1);
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("Failed to get checksum");
             co_return false;
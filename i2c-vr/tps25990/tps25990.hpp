@@ -15,7 +15,8 @@ class TPS25990 : public VoltageRegulator
 {
   public:
     TPS25990(sdbusplus::async::context& ctx, uint16_t bus, uint16_t address) :
-        VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address))
+        VoltageRegulator(ctx),
+        i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
     {}
 
     virtual sdbusplus::async::task<bool> getCheckSum(uint32_t* sum);
@@ -38,7 +38,7 @@ const std::vector<RegData> pmbusCfgRegs = {
     {0xE5, 2}, {0xE6, 2}, {0xE7, 2}, {0xE8, 2}, {0xE9, 2}, {0xFA, 1}};
 
 XDP71X::XDP71X(sdbusplus::async::context& ctx, uint16_t bus, uint16_t address) :
-    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address))
+    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
 {}
 
 uint16_t XDP71X::crc16_ccitt(const std::vector<uint8_t>& hex_numbers)
@@ -63,22 +63,22 @@ uint16_t XDP71X::crc16_ccitt(const std::vector<uint8_t>& hex_numbers)
     return crc;
 }
 
-bool XDP71X::getRevision(uint8_t* revision)
+sdbusplus::async::task<bool> XDP71X::getRevision(uint8_t* revision)
 {
     std::vector<uint8_t> tbuf;
     std::vector<uint8_t> rbuf;
 
     tbuf = buildByteVector(XDP71XCmd::mfrRevisionReg);
     rbuf.resize(2);
-    if (!i2cInterface.sendReceive(tbuf, rbuf))
+    if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
     {
         error("getRevision failed with sendreceive");
-        return false;
+        co_return false;
     }
 
     *revision = rbuf[0];
 
-    return true;
+    co_return true;
 }
 
 sdbusplus::async::task<bool> XDP71X::getCRC(uint32_t* sum)
@@ -89,7 +89,7 @@ sdbusplus::async::task<bool> XDP71X::getCRC(uint32_t* sum)
     bool isXDP710 = false;
     uint8_t revision;
 
-    if (!getRevision(&revision))
+    if (!(co_await getRevision(&revision)))
     {
         error("getCRC failed with getRevision");
         co_return false;
@@ -120,7 +120,7 @@ sdbusplus::async::task<bool> XDP71X::getCRC(uint32_t* sum)
             continue;
         }
 
-        if (!i2cInterface.sendReceive(tbuf, rbuf))
+        if (!(co_await i2cInterface.sendReceive(tbuf, rbuf)))
         {
             error("getCRC failed with sendreceive pmbusCfgReg: {REG}", "REG",
                   lg2::dec, cfgReg.reg);
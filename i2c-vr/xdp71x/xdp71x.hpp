@@ -28,6 +28,6 @@ class XDP71X : public VoltageRegulator
     phosphor::i2c::I2C i2cInterface;
 
     static uint16_t crc16_ccitt(const std::vector<uint8_t>& hex_numbers);
-    bool getRevision(uint8_t* revision);
+    sdbusplus::async::task<bool> getRevision(uint8_t* revision);
 };
 } // namespace phosphor::software::VR
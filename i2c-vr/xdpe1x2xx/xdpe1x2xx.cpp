@@ -76,7 +76,7 @@ const char* const DataXV = "XV";
 
 XDPE1X2XX::XDPE1X2XX(sdbusplus::async::context& ctx, uint16_t bus,
                      uint16_t address) :
-    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(bus, address))
+    VoltageRegulator(ctx), i2cInterface(phosphor::i2c::I2C(ctx, bus, address))
 {}
 
 sdbusplus::async::task<bool> XDPE1X2XX::getDeviceId(uint8_t* deviceID)
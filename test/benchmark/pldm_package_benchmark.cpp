@@ -0,0 +1,240 @@
+#include "common/pldm/package_index.hpp"
+#include "common/pldm/pldm_package_util.hpp"
+#include "test/create_package/create_pldm_fw_package.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <format>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+using namespace pldm_package_util;
+
+static constexpr uint32_t benchmarkIANA = 0x0000a015;
+static constexpr const char* benchmarkCompatible = "com.example.Benchmark";
+
+static constexpr size_t pageSize = 4096;
+
+// The synthesized packages, by component image size and record count.
+// Large packages are expensive to create, so each is only built once.
+struct BenchmarkPackage
+{
+    std::unique_ptr<uint8_t[]> buf;
+    size_t size = 0;
+    int fd = -1;
+};
+
+static const BenchmarkPackage& getPackage(size_t imageSize,
+                                          size_t recordCount)
+{
+    static std::map<std::pair<size_t, size_t>, BenchmarkPackage> packages;
+
+    auto it = packages.find({imageSize, recordCount});
+    if (it != packages.end())
+    {
+        return it->second;
+    }
+
+    auto image = std::make_unique<uint8_t[]>(imageSize);
+    memset(image.get(), 0xa5, imageSize);
+
+    BenchmarkPackage package;
+    package.buf =
+        create_pldm_package_buffer(image.get(), imageSize, benchmarkIANA,
+                                   benchmarkCompatible, recordCount,
+                                   package.size);
+
+    package.fd = memfd_create("pldm-package-benchmark", MFD_CLOEXEC);
+    if (package.fd >= 0)
+    {
+        size_t written = 0;
+        while (written < package.size)
+        {
+            const ssize_t n = write(package.fd, package.buf.get() + written,
+                                    package.size - written);
+            if (n <= 0)
+            {
+                break;
+            }
+            written += n;
+        }
+    }
+
+    return packages.emplace(std::make_pair(imageSize, recordCount),
+                            std::move(package))
+        .first->second;
+}
+
+// the compatible string of the last record, the worst case for a lookup
+static std::string lastCompatible(size_t recordCount)
+{
+    return std::format("{}.{}", benchmarkCompatible, recordCount - 1);
+}
+
+static constexpr int64_t imageSizes[] = {1 << 10, 64 << 10, 1 << 20, 16 << 20,
+                                         256 << 20};
+
+// Varies the component image size with a single record, then the record
+// count with a small image. Every package is kept in memory, so not all
+// combinations are built.
+static void packageArgs(benchmark::internal::Benchmark* b)
+{
+    for (int64_t imageSize : imageSizes)
+    {
+        b->Args({imageSize, 1});
+    }
+    for (int64_t recordCount : {8, 32, 128, 255})
+    {
+        b->Args({64 << 10, recordCount});
+    }
+    b->ArgNames({"image_size", "records"});
+}
+
+static void BM_ParsePLDMPackage(benchmark::State& state)
+{
+    const BenchmarkPackage& package =
+        getPackage(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        auto parsed = parsePLDMPackage(package.buf.get(), package.size);
+        if (parsed == nullptr)
+        {
+            state.SkipWithError("failed to parse the package");
+            break;
+        }
+        benchmark::DoNotOptimize(parsed);
+    }
+}
+BENCHMARK(BM_ParsePLDMPackage)->Apply(packageArgs);
+
+static void BM_ExtractMatchingComponentImage(benchmark::State& state)
+{
+    const BenchmarkPackage& package =
+        getPackage(state.range(0), state.range(1));
+
+    const auto parsed = parsePLDMPackage(package.buf.get(), package.size);
+    const std::string compatible = lastCompatible(state.range(1));
+
+    for (auto _ : state)
+    {
+        uint32_t offset = 0;
+        size_t size = 0;
+        std::string version;
+
+        if (parsed == nullptr ||
+            extractMatchingComponentImage(package.buf.get(), parsed,
+                                          compatible, benchmarkIANA, &offset,
+                                          &size, version) != 0)
+        {
+            state.SkipWithError("no matching component image");
+            break;
+        }
+        benchmark::DoNotOptimize(offset);
+        benchmark::DoNotOptimize(size);
+    }
+}
+BENCHMARK(BM_ExtractMatchingComponentImage)->Apply(packageArgs);
+
+static void BM_PackageIndexCreate(benchmark::State& state)
+{
+    const BenchmarkPackage& package =
+        getPackage(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        auto index = PackageIndex::create(package.buf.get(), package.size);
+        if (index == nullptr)
+        {
+            state.SkipWithError("failed to index the package");
+            break;
+        }
+        benchmark::DoNotOptimize(index);
+    }
+}
+BENCHMARK(BM_PackageIndexCreate)->Apply(packageArgs);
+
+static void BM_PackageIndexFind(benchmark::State& state)
+{
+    const BenchmarkPackage& package =
+        getPackage(state.range(0), state.range(1));
+
+    const auto index = PackageIndex::create(package.buf.get(), package.size);
+    const std::string compatible = lastCompatible(state.range(1));
+
+    for (auto _ : state)
+    {
+        if (index == nullptr ||
+            index->find(benchmarkIANA, compatible) == nullptr)
+        {
+            state.SkipWithError("no matching component image");
+            break;
+        }
+        benchmark::DoNotOptimize(index->find(benchmarkIANA, compatible));
+    }
+}
+BENCHMARK(BM_PackageIndexFind)->Apply(packageArgs);
+
+static void BM_MmapImagePackage(benchmark::State& state)
+{
+    const BenchmarkPackage& package = getPackage(state.range(0), 1);
+
+    for (auto _ : state)
+    {
+        size_t size = 0;
+        auto data = mmapImagePackage(package.fd, &size);
+        if (data == nullptr)
+        {
+            state.SkipWithError("failed to mmap the package");
+            break;
+        }
+        benchmark::DoNotOptimize(data.get());
+    }
+}
+
+// As above, but also faults in every page, like copying the component
+// image to the device would.
+static void BM_MmapImagePackageTouch(benchmark::State& state)
+{
+    const BenchmarkPackage& package = getPackage(state.range(0), 1);
+
+    for (auto _ : state)
+    {
+        size_t size = 0;
+        auto data = mmapImagePackage(package.fd, &size);
+        if (data == nullptr)
+        {
+            state.SkipWithError("failed to mmap the package");
+            break;
+        }
+
+        const auto* bytes = static_cast<const volatile uint8_t*>(data.get());
+        uint8_t sum = 0;
+        for (size_t i = 0; i < size; i += pageSize)
+        {
+            sum += bytes[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * package.size);
+}
+
+static void mmapArgs(benchmark::internal::Benchmark* b)
+{
+    for (int64_t imageSize : imageSizes)
+    {
+        b->Arg(imageSize);
+    }
+    b->ArgName("image_size");
+}
+
+BENCHMARK(BM_MmapImagePackage)->Apply(mmapArgs);
+BENCHMARK(BM_MmapImagePackageTouch)->Apply(mmapArgs);
+
+BENCHMARK_MAIN();
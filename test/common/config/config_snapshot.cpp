@@ -0,0 +1,200 @@
+#include "common/include/config_snapshot.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::software::config;
+
+const std::string configIface =
+    "xyz.openbmc_project.Configuration.XDPE1X2XXFirmware";
+
+static ConfigSnapshot createSnapshot()
+{
+    ConfigSnapshot::InterfaceMap interfaces;
+
+    interfaces[configIface] = {
+        {"Bus", uint64_t(4)},
+        {"Address", uint64_t(0x60)},
+        {"Type", std::string("XDPE1X2XXFirmware")},
+    };
+    interfaces[configIface + ".FirmwareInfo"] = {
+        {"VendorIANA", uint64_t(0x0000A015)},
+        {"CompatibleHardware", std::string("com.example.VR")},
+    };
+    interfaces[configIface + ".MuxOutputs0"] = {
+        {"Name", std::string("MUX_SEL_0")},
+        {"Polarity", std::string("High")},
+    };
+    interfaces[configIface + ".MuxOutputs1"] = {
+        {"Name", std::string("MUX_SEL_1")},
+        {"Polarity", std::string("Low")},
+    };
+    // not contiguous, must be ignored
+    interfaces[configIface + ".MuxOutputs3"] = {
+        {"Name", std::string("MUX_SEL_3")},
+        {"Polarity", std::string("High")},
+    };
+
+    return ConfigSnapshot(std::move(interfaces));
+}
+
+TEST(ConfigSnapshotTest, TestGetProperty)
+{
+    ConfigSnapshot snapshot = createSnapshot();
+
+    EXPECT_TRUE(snapshot.hasInterface(configIface));
+    EXPECT_FALSE(snapshot.hasInterface(configIface + ".Unknown"));
+
+    EXPECT_EQ(snapshot.get<uint64_t>(configIface, "Bus"), 4);
+    EXPECT_EQ(snapshot.get<uint64_t>(configIface, "Address"), 0x60);
+    EXPECT_EQ(snapshot.get<std::string>(configIface, "Type"),
+              "XDPE1X2XXFirmware");
+    EXPECT_EQ(snapshot.getRequired<uint64_t>(configIface + ".FirmwareInfo",
+                                             "VendorIANA"),
+              0x0000A015);
+}
+
+TEST(ConfigSnapshotTest, TestGetMissingProperty)
+{
+    ConfigSnapshot snapshot = createSnapshot();
+
+    EXPECT_FALSE(snapshot.get<uint64_t>(configIface, "Missing").has_value());
+    EXPECT_FALSE(
+        snapshot.getRequired<uint64_t>(configIface + ".Unknown", "Bus")
+            .has_value());
+}
+
+TEST(ConfigSnapshotTest, TestGetPropertyWrongType)
+{
+    ConfigSnapshot snapshot = createSnapshot();
+
+    EXPECT_FALSE(snapshot.get<std::string>(configIface, "Bus").has_value());
+    EXPECT_FALSE(snapshot.get<uint8_t>(configIface, "Bus").has_value());
+}
+
+TEST(ConfigSnapshotTest, TestGetMuxOutputs)
+{
+    ConfigSnapshot snapshot = createSnapshot();
+
+    std::vector<std::string> names;
+    std::vector<bool> polarities;
+
+    snapshot.getMuxOutputs(configIface, names, polarities);
+
+    ASSERT_EQ(names.size(), 2);
+    ASSERT_EQ(polarities.size(), 2);
+
+    EXPECT_EQ(names[0], "MUX_SEL_0");
+    EXPECT_TRUE(polarities[0]);
+    EXPECT_EQ(names[1], "MUX_SEL_1");
+    EXPECT_FALSE(polarities[1]);
+}
+
+TEST(ConfigSnapshotTest, TestEmptySnapshot)
+{
+    ConfigSnapshot snapshot;
+
+    std::vector<std::string> names;
+    std::vector<bool> polarities;
+
+    snapshot.getMuxOutputs(configIface, names, polarities);
+
+    EXPECT_TRUE(names.empty());
+    EXPECT_FALSE(snapshot.get<uint64_t>(configIface, "Bus").has_value());
+}
+
+TEST(ConfigSnapshotTest, TestDecodeSkipsUnsupportedTypes)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto msg = bus.new_method_call("xyz.openbmc_project.EntityManager", "/",
+                                   "org.freedesktop.DBus.Properties", "GetAll");
+
+    // 'at' and 'ad' are not a ConfigSnapshot::PropertyValue
+    using Value = std::variant<std::string, uint64_t, std::vector<uint64_t>,
+                               std::vector<double>>;
+    const std::map<std::string, Value> properties = {
+        {"Type", std::string("XDPE1X2XXFirmware")},
+        {"Bus", uint64_t(4)},
+        {"Addresses", std::vector<uint64_t>{0x60, 0x62}},
+        {"Scales", std::vector<double>{0.5}},
+    };
+    msg.append(properties);
+
+    // read the message back as if it was received
+    ASSERT_GE(sd_bus_message_seal(msg.get(), 1, 0), 0);
+    ASSERT_GE(sd_bus_message_rewind(msg.get(), 1), 0);
+
+    ConfigSnapshot::InterfaceMap interfaces;
+    interfaces[configIface] = ConfigSnapshot::decodeProperties(msg);
+
+    EXPECT_EQ(interfaces[configIface].size(), 2);
+
+    ConfigSnapshot snapshot(std::move(interfaces));
+
+    EXPECT_EQ(snapshot.get<std::string>(configIface, "Type"),
+              "XDPE1X2XXFirmware");
+    EXPECT_EQ(snapshot.get<uint64_t>(configIface, "Bus"), 4);
+    EXPECT_FALSE(snapshot.get<std::vector<std::string>>(configIface,
+                                                        "Addresses")
+                     .has_value());
+    EXPECT_FALSE(snapshot.get<std::vector<std::string>>(configIface, "Scales")
+                     .has_value());
+}
+
+TEST(ConfigSnapshotTest, TestDecodeManagedObjects)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto msg = bus.new_method_call("xyz.openbmc_project.EntityManager",
+                                   "/xyz/openbmc_project/inventory",
+                                   "org.freedesktop.DBus.ObjectManager",
+                                   "GetManagedObjects");
+
+    using Value = std::variant<std::string, uint64_t, std::vector<double>>;
+    using Properties = std::map<std::string, Value>;
+    const std::string vrPath = "/xyz/openbmc_project/inventory/system/vr";
+    const std::string otherPath = "/xyz/openbmc_project/inventory/system/fan";
+    const std::map<sdbusplus::message::object_path,
+                   std::map<std::string, Properties>>
+        objects = {
+            {vrPath,
+             {
+                 {configIface,
+                  {{"Bus", uint64_t(4)},
+                   {"Scales", std::vector<double>{0.5}}}},
+                 {configIface + ".FirmwareInfo",
+                  {{"CompatibleHardware", std::string("com.example.VR")}}},
+                 {"xyz.openbmc_project.Inventory.Item", {}},
+             }},
+            {otherPath,
+             {{"xyz.openbmc_project.Configuration.Fan",
+               {{"Bus", uint64_t(1)}}}}},
+        };
+    msg.append(objects);
+
+    ASSERT_GE(sd_bus_message_seal(msg.get(), 1, 0), 0);
+    ASSERT_GE(sd_bus_message_rewind(msg.get(), 1), 0);
+
+    // only the objects with a configuration interface, and only those
+    // interfaces, are kept
+    auto result = ConfigSnapshot::decodeManagedObjects(msg, {configIface});
+
+    ASSERT_EQ(result.size(), 1);
+    ASSERT_TRUE(result.contains(vrPath));
+    EXPECT_EQ(result[vrPath].size(), 2);
+
+    ConfigSnapshot snapshot(std::move(result[vrPath]));
+
+    EXPECT_EQ(snapshot.get<uint64_t>(configIface, "Bus"), 4);
+    EXPECT_FALSE(
+        snapshot.get<std::vector<std::string>>(configIface, "Scales")
+            .has_value());
+    EXPECT_EQ(snapshot.get<std::string>(configIface + ".FirmwareInfo",
+                                        "CompatibleHardware"),
+              "com.example.VR");
+    EXPECT_FALSE(snapshot.hasInterface("xyz.openbmc_project.Inventory.Item"));
+}
@@ -12,6 +12,7 @@
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
 #include <xyz/openbmc_project/Software/Update/server.hpp>
 
+#include <algorithm>
 #include <memory>
 
 PHOSPHOR_LOG2_USING;
@@ -37,8 +38,10 @@ long ExampleCodeUpdater::getRandomId()
 
 // nop code updater needs unique suffix on dbus for parallel unit testing
 ExampleCodeUpdater::ExampleCodeUpdater(sdbusplus::async::context& ctx,
-                                       long uniqueSuffix) :
-    SoftwareManager(ctx, "ExampleUpdater" + std::to_string(uniqueSuffix))
+                                       long uniqueSuffix,
+                                       size_t maxConcurrentInits) :
+    SoftwareManager(ctx, "ExampleUpdater" + std::to_string(uniqueSuffix),
+                    maxConcurrentInits)
 {}
 
 ExampleCodeUpdater::ExampleCodeUpdater(
@@ -79,9 +82,19 @@ std::unique_ptr<ExampleDevice>& ExampleCodeUpdater::getDevice()
 
 sdbusplus::async::task<bool> ExampleCodeUpdater::initDevice(
     const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
-    SoftwareConfig& /*unused*/)
+    SoftwareConfig& config, const ConfigSnapshot& /*unused*/)
 {
-    auto device = std::make_unique<ExampleDevice>(ctx, this);
+    initsInProgress++;
+    maxInitsInProgress = std::max(maxInitsInProgress, initsInProgress);
+
+    if (initDelay.count() > 0)
+    {
+        co_await sdbusplus::async::sleep_for(ctx, initDelay);
+    }
+
+    initsInProgress--;
+
+    auto device = std::make_unique<ExampleDevice>(ctx, this, config);
 
     device->softwareCurrent = std::make_unique<ExampleSoftware>(ctx, *device);
 
@@ -93,7 +106,7 @@ sdbusplus::async::task<bool> ExampleCodeUpdater::initDevice(
     auto applyTimes = {RequestedApplyTimes::OnReset};
     device->softwareCurrent->enableUpdate(applyTimes);
 
-    devices.insert({exampleInvObjPath, std::move(device)});
+    devices.insert({config.objectPath, std::move(device)});
 
     co_return true;
 }
@@ -9,6 +9,8 @@
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
 #include <xyz/openbmc_project/Software/Update/server.hpp>
 
+#include <chrono>
+
 namespace phosphor::software::example_device
 {
 
@@ -17,8 +19,9 @@ class ExampleDevice;
 class ExampleCodeUpdater : public phosphor::software::manager::SoftwareManager
 {
   public:
-    ExampleCodeUpdater(sdbusplus::async::context& ctx,
-                       long uniqueSuffix = getRandomId());
+    ExampleCodeUpdater(
+        sdbusplus::async::context& ctx, long uniqueSuffix = getRandomId(),
+        size_t maxConcurrentInits = defaultMaxConcurrentInits);
 
     // @param createDevice  create an ExampleDevice. Prerequisite for param
     // 'swVersion'.
@@ -29,14 +32,20 @@ class ExampleCodeUpdater : public phosphor::software::manager::SoftwareManager
 
     std::unique_ptr<ExampleDevice>& getDevice();
 
-    sdbusplus::async::task<bool> initDevice(const std::string& service,
-                                            const sdbusplus::object_path& path,
-                                            SoftwareConfig& config) final;
+    sdbusplus::async::task<bool> initDevice(
+        const std::string& service, const sdbusplus::object_path& path,
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) final;
 
     using SoftwareManager::getBusName;
 
-  private:
     static long getRandomId();
+
+    // how long each device takes to initialize
+    std::chrono::milliseconds initDelay{0};
+
+    // the number of devices being initialized, and the most at once
+    size_t initsInProgress = 0;
+    size_t maxInitsInProgress = 0;
 };
 
 const std::string exampleName = "ExampleSoftware";
@@ -16,7 +16,8 @@ sdbusplus::async::task<void> init(ExampleCodeUpdater& updater)
      */
 
     co_await updater.initDevice("", sdbusplus::object_path("/"),
-                                ExampleDevice::defaultConfig);
+                                ExampleDevice::defaultConfig,
+                                ConfigSnapshot());
 
     co_return;
 }
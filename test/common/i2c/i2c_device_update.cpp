@@ -0,0 +1,327 @@
+#include "common/include/i2c/bus_scheduler.hpp"
+#include "cpld/lattice/lattice_xo3_cpld.hpp"
+#include "i2c-vr/tda38640a/tda38640a.hpp"
+#include "simulated_bus.hpp"
+#include "simulated_devices.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::i2c;
+using namespace phosphor::i2c::simulated;
+using namespace std::chrono_literals;
+
+static constexpr uint16_t testBus = 3;
+static constexpr uint16_t cpldAddress = 0x40;
+static constexpr uint16_t vrAddress = 0x42;
+
+// 400 kHz, and the overhead of a transaction on an AST2600
+static constexpr SimulatedBusConfig busConfig = {
+    .transactionLatency = 50us, .byteLatency = 23us};
+
+// Runs firmware updates of the drivers against simulated devices. The
+// durations are recorded as test properties, to compare them across changes.
+class DeviceUpdateTest : public testing::Test
+{
+  protected:
+    DeviceUpdateTest()
+    {
+        BusScheduler::instance().setTransportFactory(
+            SimulatedBus::factory({{testBus, bus}}));
+    }
+
+    ~DeviceUpdateTest() override
+    {
+        BusScheduler::instance().setTransportFactory(nullptr);
+    }
+
+  public:
+    DeviceUpdateTest(const DeviceUpdateTest&) = delete;
+    DeviceUpdateTest(DeviceUpdateTest&&) = delete;
+    DeviceUpdateTest& operator=(const DeviceUpdateTest&) = delete;
+    DeviceUpdateTest& operator=(DeviceUpdateTest&&) = delete;
+
+    // @param name      the name of the property
+    // @param start     when the timed operation started
+    void recordDuration(const std::string& name,
+                        std::chrono::steady_clock::time_point start)
+    {
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        RecordProperty(name + "_ms", std::to_string(elapsed.count()));
+        RecordProperty(name + "_bus_ms",
+                       std::to_string(bus->getStats().busTime.count() / 1000));
+    }
+
+    std::shared_ptr<SimulatedBus> bus =
+        std::make_shared<SimulatedBus>(busConfig);
+
+    sdbusplus::async::context ctx;
+};
+
+static uint8_t reverseBits(uint8_t b)
+{
+    uint8_t reversed = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        reversed |= ((b >> i) & 1) << (7 - i);
+    }
+    return reversed;
+}
+
+// @returns     a JED file of the configuration data for an LCMXO3LF-4300C
+static std::string createJedFile(const std::vector<uint8_t>& cfg,
+                                 uint32_t userCode)
+{
+    std::string jed = "NOTE DEVICE NAME:\tLCMXO3LF-4300C-6BG256*\n";
+    jed += std::format("QF{}*\n", cfg.size() * 8);
+    jed += "L000000\n";
+
+    uint32_t checksum = 0;
+
+    for (size_t i = 0; i < cfg.size(); i++)
+    {
+        jed += std::bitset<8>(cfg[i]).to_string();
+        if (i % SimulatedLatticeXO3::pageSize ==
+            SimulatedLatticeXO3::pageSize - 1)
+        {
+            jed += "\n";
+        }
+        checksum += reverseBits(cfg[i]);
+    }
+
+    jed += "*\nNOTE END CONFIG DATA*\n";
+    jed += std::format("C{:04X}*\n", checksum & 0xffff);
+    jed += "NOTE User Electronic Signature Data*\n";
+    jed += std::format("UH{:08X}*\n", userCode);
+
+    return jed;
+}
+
+sdbusplus::async::task<> testLatticeXO3Update(
+    DeviceUpdateTest& test, std::shared_ptr<SimulatedLatticeXO3> device,
+    const std::vector<uint8_t>& cfg, uint32_t userCode)
+{
+    const std::string jed = createJedFile(cfg, userCode);
+
+    phosphor::software::cpld::LatticeXO3CPLD cpld(
+        test.ctx, testBus, cpldAddress, "LCMXO3LF-4300C", "", false);
+
+    int progress = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    EXPECT_TRUE(co_await cpld.updateFirmware(
+        reinterpret_cast<const uint8_t*>(jed.data()), jed.size(),
+        [&progress](int p) {
+            progress = p;
+            return true;
+        }));
+
+    test.recordDuration("update", start);
+
+    EXPECT_EQ(progress, 100);
+    EXPECT_TRUE(std::ranges::equal(device->getFlash(), cfg));
+    EXPECT_EQ(device->getPagesProgrammed(), cfg.size() / 16);
+    EXPECT_EQ(device->getUserCode(), userCode);
+    EXPECT_TRUE(device->isDone());
+    EXPECT_FALSE(device->isConfigMode());
+
+    std::string version;
+    EXPECT_TRUE(co_await cpld.getVersion(version));
+    EXPECT_EQ(version, std::format("{:08X}", userCode));
+
+    test.ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(DeviceUpdateTest, LatticeXO3)
+{
+    constexpr size_t pages = 64;
+
+    auto device = std::make_shared<SimulatedLatticeXO3>(
+        std::array<uint8_t, 4>{0x61, 0x2b, 0xc0, 0x43}, pages,
+        SimulatedLatticeXO3::Timing{.erase = 100ms});
+    bus->attach(cpldAddress, device);
+
+    std::vector<uint8_t> cfg(pages * SimulatedLatticeXO3::pageSize);
+    for (size_t i = 0; i < cfg.size(); i++)
+    {
+        cfg[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    ctx.spawn(testLatticeXO3Update(*this, device, cfg, 0x00c0ffee));
+    ctx.run();
+}
+
+sdbusplus::async::task<> testLatticeXO3WrongDevice(
+    DeviceUpdateTest& test, std::shared_ptr<SimulatedLatticeXO3> device)
+{
+    const std::string jed = createJedFile(std::vector<uint8_t>(16), 1);
+
+    phosphor::software::cpld::LatticeXO3CPLD cpld(
+        test.ctx, testBus, cpldAddress, "LCMXO3LF-4300C", "", false);
+
+    EXPECT_FALSE(co_await cpld.updateFirmware(
+        reinterpret_cast<const uint8_t*>(jed.data()), jed.size(),
+        [](int) { return true; }));
+
+    EXPECT_EQ(device->getPagesProgrammed(), 0);
+
+    test.ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(DeviceUpdateTest, LatticeXO3WrongDevice)
+{
+    // an LCMXO3LF-2100C
+    auto device = std::make_shared<SimulatedLatticeXO3>(
+        std::array<uint8_t, 4>{0x61, 0x2b, 0xb0, 0x43}, 1,
+        SimulatedLatticeXO3::Timing{});
+    bus->attach(cpldAddress, device);
+
+    ctx.spawn(testLatticeXO3WrongDevice(*this, device));
+    ctx.run();
+}
+
+// @returns     a configuration file with 16 registers at each offset
+static std::string createTDAConfig(uint8_t revision, uint32_t checksum,
+                                   const std::vector<uint16_t>& offsets)
+{
+    std::string config = std::format("Part Number : TDA38640A{:X}\n", revision);
+    config += std::format("Configuration Checksum : 0x{:08X}\n", checksum);
+    config += "[Configuration Data]\n";
+
+    for (uint16_t offset : offsets)
+    {
+        config += std::format("{:04X}", offset);
+        for (int i = 0; i < 16; i++)
+        {
+            config += std::format(" {:02X}", (offset + i) & 0xff);
+        }
+        config += "\n";
+    }
+
+    config += "[End Configuration Data]\n";
+
+    return config;
+}
+
+static constexpr uint8_t tdaRevision = 2;
+
+sdbusplus::async::task<> testTDA38640AUpdate(
+    DeviceUpdateTest& test, std::shared_ptr<SimulatedTDA38640A> device)
+{
+    const uint32_t oldCrc = device->getCRC();
+    const size_t remainingWrites = device->getRemainingWrites();
+
+    const std::string config =
+        createTDAConfig(tdaRevision, 0x55667788, {0x0040, 0x0240, 0x0280});
+
+    phosphor::software::VR::TDA38640A vr(test.ctx, testBus, vrAddress);
+
+    EXPECT_TRUE(co_await vr.verifyImage(
+        reinterpret_cast<const uint8_t*>(config.data()), config.size()));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    EXPECT_TRUE(co_await vr.updateFirmware(false));
+
+    test.recordDuration("update", start);
+
+    EXPECT_EQ(device->getRemainingWrites(), remainingWrites - 1);
+    EXPECT_EQ(device->getProgrammedRegister(0x0040), 0x40);
+    EXPECT_EQ(device->getProgrammedRegister(0x024f), 0x4f);
+
+    // not a user register, so it is skipped
+    EXPECT_EQ(device->getProgrammedRegister(0x0241), 0x00);
+
+    uint32_t crc = 0;
+    EXPECT_TRUE(co_await vr.getCRC(&crc));
+    EXPECT_EQ(crc, device->getCRC());
+    EXPECT_NE(crc, oldCrc);
+
+    test.ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(DeviceUpdateTest, TDA38640A)
+{
+    auto device =
+        std::make_shared<SimulatedTDA38640A>(tdaRevision, 0x11223344, 100ms);
+    device->setUsedImages(3);
+    bus->attach(vrAddress, device);
+
+    ctx.spawn(testTDA38640AUpdate(*this, device));
+    ctx.run();
+}
+
+sdbusplus::async::task<> testTDA38640ANoRemainingWrites(DeviceUpdateTest& test)
+{
+    const std::string config = createTDAConfig(tdaRevision, 1, {0x0040});
+
+    phosphor::software::VR::TDA38640A vr(test.ctx, testBus, vrAddress);
+
+    EXPECT_FALSE(co_await vr.verifyImage(
+        reinterpret_cast<const uint8_t*>(config.data()), config.size()));
+
+    test.ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(DeviceUpdateTest, TDA38640ANoRemainingWrites)
+{
+    auto device = std::make_shared<SimulatedTDA38640A>(tdaRevision, 0, 0ms);
+    device->setUsedImages(SimulatedTDA38640A::userImages);
+    bus->attach(vrAddress, device);
+
+    ctx.spawn(testTDA38640ANoRemainingWrites(*this));
+    ctx.run();
+}
+
+sdbusplus::async::task<> testTDA38640ABusErrors(
+    DeviceUpdateTest& test, std::shared_ptr<SimulatedTDA38640A> device)
+{
+    const std::string config = createTDAConfig(tdaRevision, 1, {0x0040});
+
+    phosphor::software::VR::TDA38640A vr(test.ctx, testBus, vrAddress);
+
+    EXPECT_TRUE(co_await vr.verifyImage(
+        reinterpret_cast<const uint8_t*>(config.data()), config.size()));
+
+    // the driver does not retry, a single failed transfer fails the update
+    SimulatedBusConfig failing = busConfig;
+    failing.failEvery = 2;
+    test.bus->setConfig(failing);
+
+    EXPECT_FALSE(co_await vr.updateFirmware(false));
+    EXPECT_EQ(device->getRemainingWrites(), SimulatedTDA38640A::userImages);
+
+    test.ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(DeviceUpdateTest, TDA38640ABusErrors)
+{
+    auto device = std::make_shared<SimulatedTDA38640A>(tdaRevision, 0, 0ms);
+    bus->attach(vrAddress, device);
+
+    ctx.spawn(testTDA38640ABusErrors(*this, device));
+    ctx.run();
+}
@@ -0,0 +1,328 @@
+#include "common/include/i2c/bus_scheduler.hpp"
+#include "common/include/i2c/i2c.hpp"
+#include "common/include/pmbus.hpp"
+#include "simulated_bus.hpp"
+#include "simulated_devices.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::i2c;
+using namespace phosphor::i2c::simulated;
+using namespace std::chrono_literals;
+
+static constexpr uint16_t testBus = 7;
+static constexpr uint16_t eepromAddress = 0x50;
+static constexpr uint16_t vrAddress = 0x60;
+
+class SimulatedBusTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        BusScheduler::instance().setTransportFactory(
+            SimulatedBus::factory({{testBus, bus}}));
+    }
+
+    void TearDown() override
+    {
+        BusScheduler::instance().setTransportFactory(nullptr);
+    }
+
+    std::shared_ptr<SimulatedBus> bus = std::make_shared<SimulatedBus>();
+};
+
+static sdbusplus::async::task<> runBatch(sdbusplus::async::context& ctx,
+                                         const I2C& i2c,
+                                         std::span<I2CMessage> messages,
+                                         int& result)
+{
+    result = co_await i2c.sendReceiveBatch(messages);
+
+    ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(SimulatedBusTest, OnlyConfiguredBusExists)
+{
+    I2C present(testBus, eepromAddress);
+    I2C missing(testBus + 1, eepromAddress);
+
+    EXPECT_TRUE(present.isOpen());
+    EXPECT_FALSE(missing.isOpen());
+}
+
+TEST_F(SimulatedBusTest, MissingDeviceDoesNotAcknowledge)
+{
+    I2C i2c(testBus, eepromAddress);
+
+    std::vector<uint8_t> request = {0x00, 0x00};
+    std::vector<uint8_t> response(1);
+
+    EXPECT_FALSE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(bus->getStats().failed, 1);
+}
+
+TEST_F(SimulatedBusTest, EepromPageWrite)
+{
+    auto eeprom = std::make_shared<SimulatedAT24>(4096, 32, 2ms);
+    bus->attach(eepromAddress, eeprom);
+
+    I2C i2c(testBus, eepromAddress);
+    std::vector<uint8_t> response;
+
+    // wraps around to the start of the page
+    std::vector<uint8_t> request = {0x00, 0x1e, 1, 2, 3, 4};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(eeprom->getWriteCycles(), 1);
+
+    // busy with the write cycle
+    request = {0x00, 0x00};
+    response.resize(2);
+    EXPECT_FALSE(i2c.sendReceiveBlocking(request, response));
+
+    std::this_thread::sleep_for(2ms);
+
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(response, (std::vector<uint8_t>{3, 4}));
+
+    request = {0x00, 0x1e};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(response, (std::vector<uint8_t>{1, 2}));
+
+    // setting the address does not start a write cycle
+    EXPECT_EQ(eeprom->getWriteCycles(), 1);
+}
+
+TEST_F(SimulatedBusTest, Latency)
+{
+    bus->attach(eepromAddress, std::make_shared<SimulatedAT24>(256, 8, 0ms));
+    bus->setConfig({.transactionLatency = 1ms, .byteLatency = 100us});
+
+    I2C i2c(testBus, eepromAddress);
+
+    std::vector<uint8_t> request = {0x00, 0x00};
+    std::vector<uint8_t> response(7);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+
+    // 1ms, and 11 bytes including both address bytes
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 2100us);
+    EXPECT_EQ(bus->getStats().busTime, 2100us);
+    EXPECT_EQ(bus->getStats().bytes, 9);
+}
+
+TEST_F(SimulatedBusTest, FailEvery)
+{
+    bus->attach(eepromAddress, std::make_shared<SimulatedAT24>(256, 8, 0ms));
+    bus->setConfig({.failEvery = 3, .failError = -ETIMEDOUT});
+
+    I2C i2c(testBus, eepromAddress);
+
+    std::vector<uint8_t> request = {0x00, 0x00};
+    std::vector<uint8_t> response(1);
+
+    std::vector<bool> results;
+    for (int i = 0; i < 6; i++)
+    {
+        results.push_back(i2c.sendReceiveBlocking(request, response));
+    }
+
+    EXPECT_EQ(results,
+              (std::vector<bool>{true, true, false, true, true, false}));
+    EXPECT_EQ(bus->getStats().injected, 2);
+}
+
+TEST_F(SimulatedBusTest, RandomFailuresAreReproducible)
+{
+    bus->attach(eepromAddress, std::make_shared<SimulatedAT24>(256, 8, 0ms));
+
+    I2C i2c(testBus, eepromAddress);
+
+    std::vector<uint8_t> request = {0x00, 0x00};
+    std::vector<uint8_t> response(1);
+
+    auto run = [&]() {
+        bus->setConfig({.failProbability = 0.5, .seed = 42});
+
+        std::vector<bool> results;
+        for (int i = 0; i < 32; i++)
+        {
+            results.push_back(i2c.sendReceiveBlocking(request, response));
+        }
+        return results;
+    };
+
+    const std::vector<bool> first = run();
+
+    EXPECT_EQ(run(), first);
+    EXPECT_NE(std::ranges::count(first, false), 0);
+    EXPECT_NE(std::ranges::count(first, true), 0);
+}
+
+TEST_F(SimulatedBusTest, BusyPeriod)
+{
+    // the busy periods start when the bus is created
+    auto busy = std::make_shared<SimulatedBus>(
+        SimulatedBusConfig{.busyPeriod = 1000ms, .busyDuration = 500ms});
+    busy->attach(eepromAddress, std::make_shared<SimulatedAT24>(256, 8, 0ms));
+
+    BusScheduler::instance().setTransportFactory(
+        SimulatedBus::factory({{testBus, busy}}));
+
+    I2C i2c(testBus, eepromAddress);
+
+    std::vector<uint8_t> request = {0x00, 0x00};
+    std::vector<uint8_t> response(1);
+
+    EXPECT_FALSE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(busy->getStats().injected, 1);
+}
+
+TEST_F(SimulatedBusTest, MPSWriteProtectAndStore)
+{
+    auto vr = std::make_shared<SimulatedMPS>(5ms);
+    bus->attach(vrAddress, vr);
+
+    const auto writeProtect = static_cast<uint8_t>(PMBusCmd::writeProtect);
+    const auto page = static_cast<uint8_t>(PMBusCmd::page);
+    const auto mfrId = static_cast<uint8_t>(PMBusCmd::mfrId);
+
+    vr->setRegister(0, writeProtect, {0x80});
+    vr->setBlockRegister(0, mfrId, {'M', 'P', 'S'});
+
+    I2C i2c(testBus, vrAddress);
+
+    std::vector<uint8_t> request = {mfrId};
+    std::vector<uint8_t> response(4);
+
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+    EXPECT_EQ(response, (std::vector<uint8_t>{3, 'M', 'P', 'S'}));
+
+    response.clear();
+
+    request = {page, 1};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+
+    request = {0x21, 0x34, 0x12};
+    EXPECT_FALSE(i2c.sendReceiveBlocking(request, response));
+
+    request = {writeProtect, 0x00};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+
+    request = {0x21, 0x34, 0x12};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+
+    request = {static_cast<uint8_t>(PMBusCmd::storeUserCode)};
+    ASSERT_TRUE(i2c.sendReceiveBlocking(request, response));
+
+    // does not acknowledge while storing
+    request = {page, 0};
+    EXPECT_FALSE(i2c.sendReceiveBlocking(request, response));
+
+    EXPECT_EQ(vr->getStoreCount(), 1);
+    EXPECT_EQ(vr->getStoredRegister(1, 0x21),
+              (std::vector<uint8_t>{0x34, 0x12}));
+    EXPECT_FALSE(vr->getStoredRegister(0, 0x21).has_value());
+}
+
+class SimulatedBusBatchTest : public SimulatedBusTest
+{
+  protected:
+    // two page writes, each of which must end with a STOP
+    int writePages()
+    {
+        I2C i2c(ctx, testBus, eepromAddress);
+
+        messages = {{
+            {.stop = true,
+             .data = first.data(),
+             .size = static_cast<uint16_t>(first.size())},
+            {.stop = true,
+             .data = second.data(),
+             .size = static_cast<uint16_t>(second.size())},
+        }};
+
+        int result = 1;
+
+        ctx.spawn(runBatch(ctx, i2c, messages, result));
+        ctx.run();
+
+        return result;
+    }
+
+    sdbusplus::async::context ctx;
+
+    std::vector<uint8_t> first = {0x00, 0x00, 1, 2};
+    std::vector<uint8_t> second = {0x00, 0x08, 3, 4};
+
+    std::array<I2CMessage, 2> messages;
+};
+
+TEST_F(SimulatedBusBatchTest, WithoutProtocolMangling)
+{
+    auto eeprom = std::make_shared<SimulatedAT24>(256, 8, 0ms);
+    bus->attach(eepromAddress, eeprom);
+
+    EXPECT_EQ(writePages(), 0);
+
+    // the adapter would ignore I2C_M_STOP, so every write is a transfer
+    EXPECT_EQ(bus->getStats().transactions, 2);
+    EXPECT_TRUE(messages[0].transferred);
+    EXPECT_TRUE(messages[1].transferred);
+    EXPECT_EQ(eeprom->getWriteCycles(), 2);
+    EXPECT_EQ(eeprom->getContents()[1], 2);
+    EXPECT_EQ(eeprom->getContents()[9], 4);
+}
+
+TEST_F(SimulatedBusBatchTest, WithProtocolMangling)
+{
+    auto eeprom = std::make_shared<SimulatedAT24>(256, 8, 0ms);
+    bus->attach(eepromAddress, eeprom);
+    bus->setConfig({.protocolMangling = true});
+
+    EXPECT_EQ(writePages(), 0);
+
+    EXPECT_EQ(bus->getStats().transactions, 1);
+    EXPECT_TRUE(messages[0].transferred);
+    EXPECT_TRUE(messages[1].transferred);
+    EXPECT_EQ(eeprom->getWriteCycles(), 2);
+    EXPECT_EQ(eeprom->getContents()[1], 2);
+    EXPECT_EQ(eeprom->getContents()[9], 4);
+}
+
+TEST_F(SimulatedBusBatchTest, ReportsErrno)
+{
+    // nobody acknowledges the first write
+    EXPECT_EQ(writePages(), -ENXIO);
+
+    // the second write is not attempted after the first one failed
+    EXPECT_EQ(bus->getStats().transactions, 1);
+    EXPECT_FALSE(messages[0].transferred);
+    EXPECT_FALSE(messages[1].transferred);
+}
+
+TEST_F(SimulatedBusBatchTest, ReportsTransferredMessages)
+{
+    // still busy with the first write when the second one comes in
+    auto eeprom = std::make_shared<SimulatedAT24>(256, 8, 50ms);
+    bus->attach(eepromAddress, eeprom);
+
+    EXPECT_EQ(writePages(), -ENXIO);
+
+    EXPECT_TRUE(messages[0].transferred);
+    EXPECT_FALSE(messages[1].transferred);
+    EXPECT_EQ(eeprom->getWriteCycles(), 1);
+}
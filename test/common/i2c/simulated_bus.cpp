@@ -0,0 +1,194 @@
+#include "simulated_bus.hpp"
+
+#include <thread>
+#include <utility>
+
+extern "C"
+{
+#include <linux/i2c.h>
+}
+
+namespace phosphor::i2c::simulated
+{
+
+namespace
+{
+
+// The transport of one bus, owned by the BusScheduler. The simulated bus
+// itself stays with the test, which inspects it.
+class SimulatedTransport : public Transport
+{
+  public:
+    explicit SimulatedTransport(std::shared_ptr<SimulatedBus> bus) :
+        bus(std::move(bus))
+    {}
+
+    int transfer(struct i2c_msg* msgs, size_t count) override
+    {
+        return bus->transfer(msgs, count);
+    }
+
+    bool supportsProtocolMangling() const override
+    {
+        return bus->supportsProtocolMangling();
+    }
+
+  private:
+    const std::shared_ptr<SimulatedBus> bus;
+};
+
+} // namespace
+
+SimulatedBus::SimulatedBus(SimulatedBusConfig config) :
+    created(std::chrono::steady_clock::now()), config(config),
+    random(config.seed)
+{}
+
+void SimulatedBus::attach(uint16_t address,
+                          std::shared_ptr<SimulatedDevice> device)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    devices[address] = std::move(device);
+}
+
+void SimulatedBus::detach(uint16_t address)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    devices.erase(address);
+}
+
+void SimulatedBus::setConfig(const SimulatedBusConfig& newConfig)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    config = newConfig;
+    random.seed(config.seed);
+}
+
+SimulatedBusStats SimulatedBus::getStats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
+
+bool SimulatedBus::supportsProtocolMangling() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return config.protocolMangling;
+}
+
+int SimulatedBus::nextInjectedError()
+{
+    if (config.busyPeriod.count() > 0)
+    {
+        const auto sinceCreated = std::chrono::steady_clock::now() - created;
+
+        if (sinceCreated % config.busyPeriod < config.busyDuration)
+        {
+            return -EAGAIN;
+        }
+    }
+
+    if (config.failEvery > 0 && stats.transactions % config.failEvery == 0)
+    {
+        return config.failError;
+    }
+
+    if (config.failProbability > 0 &&
+        std::uniform_real_distribution<double>(0, 1)(random) <
+            config.failProbability)
+    {
+        return config.failError;
+    }
+
+    return 0;
+}
+
+int SimulatedBus::transfer(struct i2c_msg* msgs, size_t count)
+{
+    std::chrono::nanoseconds latency{0};
+    int result = static_cast<int>(count);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        stats.transactions++;
+        latency = config.transactionLatency;
+
+        const int injected = nextInjectedError();
+
+        for (size_t i = 0; i < count && injected == 0; i++)
+        {
+            stats.messages++;
+            stats.bytes += msgs[i].len;
+
+            // the address byte is on the wire even if nobody acknowledges
+            latency += config.byteLatency * (msgs[i].len + 1);
+
+            auto it = devices.find(msgs[i].addr);
+            if (it == devices.end())
+            {
+                result = -ENXIO;
+                break;
+            }
+
+            SimulatedDevice& device = *it->second;
+            const bool read = (msgs[i].flags & I2C_M_RD) != 0;
+
+            const int ret =
+                read ? device.read(std::span<uint8_t>(msgs[i].buf, msgs[i].len))
+                     : device.write(
+                           std::span<const uint8_t>(msgs[i].buf, msgs[i].len));
+
+            // the controller sends a STOP after a failed message, after the
+            // last one, and wherever it was asked to if it can
+            if (ret < 0 || i + 1 == count ||
+                (config.protocolMangling && (msgs[i].flags & I2C_M_STOP) != 0))
+            {
+                device.stop();
+            }
+
+            if (ret < 0)
+            {
+                result = ret;
+                break;
+            }
+        }
+
+        if (injected != 0)
+        {
+            // only the address of the first message went out
+            latency += config.byteLatency;
+            result = injected;
+            stats.injected++;
+        }
+
+        if (result < 0)
+        {
+            stats.failed++;
+        }
+
+        stats.busTime +=
+            std::chrono::duration_cast<std::chrono::microseconds>(latency);
+    }
+
+    std::this_thread::sleep_for(latency);
+
+    return result;
+}
+
+TransportFactory SimulatedBus::factory(
+    std::map<uint16_t, std::shared_ptr<SimulatedBus>> buses)
+{
+    return [buses = std::move(buses)](
+               uint16_t bus) -> std::unique_ptr<Transport> {
+        auto it = buses.find(bus);
+        if (it == buses.end())
+        {
+            return nullptr;
+        }
+        return std::make_unique<SimulatedTransport>(it->second);
+    };
+}
+
+} // namespace phosphor::i2c::simulated
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "common/include/i2c/i2c_transport.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+
+namespace phosphor::i2c::simulated
+{
+
+// A device on a simulated bus. Its methods are only called from the thread
+// of the bus, so a device must only be inspected while no transfer to it is
+// running.
+class SimulatedDevice
+{
+  public:
+    SimulatedDevice() = default;
+    virtual ~SimulatedDevice() = default;
+
+    SimulatedDevice(const SimulatedDevice&) = delete;
+    SimulatedDevice& operator=(const SimulatedDevice&) = delete;
+    SimulatedDevice(SimulatedDevice&&) = delete;
+    SimulatedDevice& operator=(SimulatedDevice&&) = delete;
+
+    // A write message addressed to this device.
+    // @param data      the bytes written by the controller
+    // @returns         0 if the device acknowledged the message,
+    //                  negative errno otherwise, e.g. -ENXIO for a NACK
+    virtual int write(std::span<const uint8_t> data) = 0;
+
+    // A read message addressed to this device.
+    // @param data      the bytes to fill
+    // @returns         as for 'write'
+    virtual int read(std::span<uint8_t> data) = 0;
+
+    // The controller sent a STOP after a message to this device, not a
+    // repeated START.
+    virtual void stop() {}
+};
+
+struct SimulatedBusConfig
+{
+    // added to every transaction, for the adapter and the kernel
+    std::chrono::microseconds transactionLatency{0};
+
+    // per byte on the wire, including the address byte of every message.
+    // At 100 kHz this is about 90us, at 400 kHz about 23us.
+    std::chrono::nanoseconds byteLatency{0};
+
+    // The bus is held by another controller for 'busyDuration' at the start
+    // of every 'busyPeriod'. Transactions in that time fail with -EAGAIN,
+    // like a lost arbitration. A period of 0 disables this.
+    std::chrono::milliseconds busyPeriod{0};
+    std::chrono::milliseconds busyDuration{0};
+
+    // fail every n-th transaction, 0 to disable
+    size_t failEvery = 0;
+
+    // fail transactions at random with this probability
+    double failProbability = 0;
+
+    // seed for the random failures, so runs are reproducible
+    uint32_t seed = 0;
+
+    // the error of the injected failures
+    int failError = -EIO;
+
+    // the adapter honors I2C_M_STOP. Most BMC adapters, e.g. Aspeed and
+    // Nuvoton, ignore it and send a repeated START instead. This is read
+    // when an I2C instance is opened.
+    bool protocolMangling = false;
+};
+
+struct SimulatedBusStats
+{
+    uint64_t transactions = 0;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+
+    // transactions which failed, injected or not
+    uint64_t failed = 0;
+
+    // failures caused by the configuration, not by a device
+    uint64_t injected = 0;
+
+    // the latency added to the transactions
+    std::chrono::microseconds busTime{0};
+};
+
+// An in-process i2c bus with simulated devices, which can replace the kernel
+// bus device via BusScheduler::setTransportFactory. The bus adds the
+// configured latency to every transaction, so update durations measured
+// against it are close to the ones on hardware.
+class SimulatedBus
+{
+  public:
+    explicit SimulatedBus(SimulatedBusConfig config = {});
+
+    // @param address   the 7-bit address of the device
+    // @param device    the device, replacing one with the same address
+    void attach(uint16_t address, std::shared_ptr<SimulatedDevice> device);
+
+    void detach(uint16_t address);
+
+    // Applies to the transactions which are submitted from now on, and
+    // restarts the random failures from the seed.
+    void setConfig(const SimulatedBusConfig& config);
+
+    SimulatedBusStats getStats() const;
+
+    bool supportsProtocolMangling() const;
+
+    // Executes a transaction, as the kernel bus device would.
+    // @returns         the number of messages, negative errno on failure
+    int transfer(struct i2c_msg* msgs, size_t count);
+
+    // @param buses     the simulated buses by bus number
+    // @returns         a factory for BusScheduler::setTransportFactory.
+    //                  Buses which are not in 'buses' do not exist.
+    static TransportFactory factory(
+        std::map<uint16_t, std::shared_ptr<SimulatedBus>> buses);
+
+  private:
+    // @returns         the error to inject into the next transaction, or 0
+    int nextInjectedError();
+
+    const std::chrono::steady_clock::time_point created;
+
+    mutable std::mutex lock;
+
+    SimulatedBusConfig config;
+
+    SimulatedBusStats stats;
+
+    std::mt19937 random;
+
+    std::map<uint16_t, std::shared_ptr<SimulatedDevice>> devices;
+};
+
+} // namespace phosphor::i2c::simulated
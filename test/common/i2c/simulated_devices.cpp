@@ -0,0 +1,639 @@
+#include "simulated_devices.hpp"
+
+#include "common/include/pmbus.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+namespace phosphor::i2c::simulated
+{
+
+// Copies 'value' to the start of 'data' and fills the rest like an idle bus
+static void fillRead(std::span<uint8_t> data, std::span<const uint8_t> value)
+{
+    const size_t n = std::min(data.size(), value.size());
+
+    std::copy_n(value.begin(), n, data.begin());
+    std::fill(data.begin() + n, data.end(), 0xff);
+}
+
+SimulatedAT24::SimulatedAT24(size_t size, size_t pageSize,
+                             std::chrono::microseconds writeCycle) :
+    pageSize(pageSize), writeCycle(writeCycle), contents(size, 0xff)
+{}
+
+bool SimulatedAT24::busy() const
+{
+    return Clock::now() < busyUntil;
+}
+
+int SimulatedAT24::write(std::span<const uint8_t> data)
+{
+    if (busy())
+    {
+        return -ENXIO;
+    }
+
+    // the 16-bit word address comes first, the data follows
+    if (data.size() < 2)
+    {
+        return 0;
+    }
+
+    address = ((data[0] << 8) | data[1]) % contents.size();
+
+    const size_t pageStart = address - (address % pageSize);
+
+    for (uint8_t value : data.subspan(2))
+    {
+        pending[address] = value;
+        address = pageStart + ((address + 1 - pageStart) % pageSize);
+    }
+
+    return 0;
+}
+
+int SimulatedAT24::read(std::span<uint8_t> data)
+{
+    if (busy())
+    {
+        return -ENXIO;
+    }
+
+    for (uint8_t& value : data)
+    {
+        value = contents[address];
+        address = (address + 1) % contents.size();
+    }
+
+    return 0;
+}
+
+void SimulatedAT24::stop()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    for (const auto& [addr, value] : pending)
+    {
+        contents[addr] = value;
+    }
+    pending.clear();
+
+    writeCycles++;
+    busyUntil = Clock::now() + writeCycle;
+}
+
+std::span<const uint8_t> SimulatedAT24::getContents() const
+{
+    return contents;
+}
+
+size_t SimulatedAT24::getWriteCycles() const
+{
+    return writeCycles;
+}
+
+// The commands of the configuration port, see LatticeBaseCPLD
+enum class LatticeCmd : uint8_t
+{
+    eraseFlash = 0x0E,
+    disableConfigInterface = 0x26,
+    readStatusReg = 0x3C,
+    resetConfigFlash = 0x46,
+    programDone = 0x5E,
+    programPage = 0x70,
+    readPage = 0x73,
+    enableConfigMode = 0x74,
+    setPageAddress = 0xB4,
+    readFwVersion = 0xC0,
+    programUserCode = 0xC2,
+    readDeviceId = 0xE0,
+    readBusyFlag = 0xF0,
+};
+
+static constexpr uint8_t latticeBusyFlag = 0x80;
+static constexpr uint8_t latticeStatusBusy = 0x10;
+static constexpr uint8_t latticeStatusFail = 0x20;
+
+// the commands are followed by 3 operand bytes
+static constexpr size_t latticeCmdSize = 4;
+
+SimulatedLatticeXO3::SimulatedLatticeXO3(std::array<uint8_t, 4> deviceId,
+                                         size_t pages, Timing timing) :
+    deviceId(deviceId), timing(timing), flash(pages * pageSize, 0)
+{}
+
+bool SimulatedLatticeXO3::busy() const
+{
+    return Clock::now() < busyUntil;
+}
+
+void SimulatedLatticeXO3::startBusy(std::chrono::microseconds duration)
+{
+    busyUntil = Clock::now() + duration;
+}
+
+int SimulatedLatticeXO3::write(std::span<const uint8_t> data)
+{
+    if (data.empty())
+    {
+        return 0;
+    }
+
+    const auto cmd = static_cast<LatticeCmd>(data[0]);
+
+    // only the busy flag and the status can be read while busy
+    if (busy() && cmd != LatticeCmd::readBusyFlag &&
+        cmd != LatticeCmd::readStatusReg)
+    {
+        failed = true;
+        return 0;
+    }
+
+    switch (cmd)
+    {
+        case LatticeCmd::readDeviceId:
+        case LatticeCmd::readFwVersion:
+        case LatticeCmd::readBusyFlag:
+        case LatticeCmd::readStatusReg:
+            readCommand = data[0];
+            break;
+        case LatticeCmd::readPage:
+            failed = failed || !configMode;
+            readCommand = data[0];
+            break;
+        case LatticeCmd::enableConfigMode:
+            configMode = true;
+            failed = false;
+            break;
+        case LatticeCmd::eraseFlash:
+            if (!configMode)
+            {
+                failed = true;
+                break;
+            }
+            std::ranges::fill(flash, 0);
+            userCode = 0;
+            done = false;
+            startBusy(timing.erase);
+            break;
+        case LatticeCmd::resetConfigFlash:
+            page = 0;
+            break;
+        case LatticeCmd::setPageAddress:
+            if (data.size() < latticeCmdSize + 4)
+            {
+                failed = true;
+                break;
+            }
+            page = (data[6] << 8) | data[7];
+            break;
+        case LatticeCmd::programPage:
+        {
+            const auto pageData = data.subspan(
+                std::min(data.size(), latticeCmdSize));
+
+            if (!configMode || pageData.size() > pageSize ||
+                (page + 1) * pageSize > flash.size())
+            {
+                failed = true;
+                break;
+            }
+            std::ranges::copy(pageData, flash.begin() + page * pageSize);
+            page++;
+            pagesProgrammed++;
+            startBusy(timing.programPage);
+            break;
+        }
+        case LatticeCmd::programUserCode:
+            if (!configMode || data.size() < latticeCmdSize + 4)
+            {
+                failed = true;
+                break;
+            }
+            userCode = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) |
+                       data[7];
+            startBusy(timing.programPage);
+            break;
+        case LatticeCmd::programDone:
+            if (!configMode)
+            {
+                failed = true;
+                break;
+            }
+            done = true;
+            startBusy(timing.programDone);
+            break;
+        case LatticeCmd::disableConfigInterface:
+            configMode = false;
+            break;
+        default:
+            failed = true;
+            break;
+    }
+
+    return 0;
+}
+
+int SimulatedLatticeXO3::read(std::span<uint8_t> data)
+{
+    switch (static_cast<LatticeCmd>(readCommand))
+    {
+        case LatticeCmd::readDeviceId:
+            fillRead(data, deviceId);
+            break;
+        case LatticeCmd::readFwVersion:
+        {
+            const std::array<uint8_t, 4> value = {
+                static_cast<uint8_t>(userCode >> 24),
+                static_cast<uint8_t>(userCode >> 16),
+                static_cast<uint8_t>(userCode >> 8),
+                static_cast<uint8_t>(userCode)};
+            fillRead(data, value);
+            break;
+        }
+        case LatticeCmd::readBusyFlag:
+        {
+            const std::array<uint8_t, 1> value = {
+                busy() ? latticeBusyFlag : uint8_t(0)};
+            fillRead(data, value);
+            break;
+        }
+        case LatticeCmd::readStatusReg:
+        {
+            // bit 12 is busy and bit 13 is fail, MSB first
+            const std::array<uint8_t, 4> value = {
+                0, 0,
+                static_cast<uint8_t>((busy() ? latticeStatusBusy : 0) |
+                                     (failed ? latticeStatusFail : 0)),
+                0};
+            fillRead(data, value);
+            break;
+        }
+        case LatticeCmd::readPage:
+            if (page * pageSize >= flash.size())
+            {
+                fillRead(data, {});
+                break;
+            }
+            fillRead(data, std::span<const uint8_t>(flash).subspan(
+                               page * pageSize, pageSize));
+            page++;
+            break;
+        default:
+            fillRead(data, {});
+            break;
+    }
+
+    return 0;
+}
+
+std::span<const uint8_t> SimulatedLatticeXO3::getFlash() const
+{
+    return flash;
+}
+
+uint32_t SimulatedLatticeXO3::getUserCode() const
+{
+    return userCode;
+}
+
+void SimulatedLatticeXO3::setUserCode(uint32_t code)
+{
+    userCode = code;
+}
+
+bool SimulatedLatticeXO3::isConfigMode() const
+{
+    return configMode;
+}
+
+bool SimulatedLatticeXO3::isDone() const
+{
+    return done;
+}
+
+size_t SimulatedLatticeXO3::getPagesProgrammed() const
+{
+    return pagesProgrammed;
+}
+
+static constexpr uint8_t writeProtectMask = 0xe0;
+
+SimulatedMPS::SimulatedMPS(std::chrono::microseconds storeTime) :
+    storeTime(storeTime)
+{}
+
+int SimulatedMPS::write(std::span<const uint8_t> data)
+{
+    if (Clock::now() < busyUntil)
+    {
+        return -ENXIO;
+    }
+
+    if (data.empty())
+    {
+        return 0;
+    }
+
+    const uint8_t cmd = data[0];
+
+    if (data.size() == 1)
+    {
+        if (cmd == static_cast<uint8_t>(PMBusCmd::storeUserCode))
+        {
+            stored = registers;
+            storeCount++;
+            busyUntil = Clock::now() + storeTime;
+            return 0;
+        }
+
+        // the command of the next read
+        readCommand = cmd;
+        return 0;
+    }
+
+    if (cmd == static_cast<uint8_t>(PMBusCmd::page))
+    {
+        page = data[1];
+        return 0;
+    }
+
+    // WRITE_PROTECT is not paged
+    const bool isWriteProtect =
+        cmd == static_cast<uint8_t>(PMBusCmd::writeProtect);
+    const auto writeProtect = registers.find(
+        {0, static_cast<uint8_t>(PMBusCmd::writeProtect)});
+
+    if (!isWriteProtect && writeProtect != registers.end() &&
+        !writeProtect->second.empty() &&
+        (writeProtect->second[0] & writeProtectMask) != 0)
+    {
+        return -EIO;
+    }
+
+    registers[{isWriteProtect ? uint8_t(0) : page, cmd}] =
+        std::vector<uint8_t>(data.begin() + 1, data.end());
+
+    return 0;
+}
+
+int SimulatedMPS::read(std::span<uint8_t> data)
+{
+    if (Clock::now() < busyUntil)
+    {
+        return -ENXIO;
+    }
+
+    const bool isWriteProtect =
+        readCommand == static_cast<uint8_t>(PMBusCmd::writeProtect);
+
+    auto it = registers.find({isWriteProtect ? uint8_t(0) : page, readCommand});
+
+    if (it == registers.end())
+    {
+        fillRead(data, {});
+    }
+    else
+    {
+        fillRead(data, it->second);
+    }
+
+    return 0;
+}
+
+void SimulatedMPS::setRegister(uint8_t page, uint8_t command,
+                               std::vector<uint8_t> value)
+{
+    registers[{page, command}] = std::move(value);
+}
+
+void SimulatedMPS::setBlockRegister(uint8_t page, uint8_t command,
+                                    const std::vector<uint8_t>& value)
+{
+    std::vector<uint8_t> block = {static_cast<uint8_t>(value.size())};
+    block.insert(block.end(), value.begin(), value.end());
+
+    setRegister(page, command, std::move(block));
+}
+
+std::optional<std::vector<uint8_t>> SimulatedMPS::getRegister(
+    uint8_t page, uint8_t command) const
+{
+    auto it = registers.find({page, command});
+    if (it == registers.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<std::vector<uint8_t>> SimulatedMPS::getStoredRegister(
+    uint8_t page, uint8_t command) const
+{
+    auto it = stored.find({page, command});
+    if (it == stored.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t SimulatedMPS::getStoreCount() const
+{
+    return storeCount;
+}
+
+// The registers of page 0 used for programming, see TDA38640A
+static constexpr uint8_t tdaCrcHighReg = 0xae;
+static constexpr uint8_t tdaCrcLowReg = 0xb0;
+static constexpr uint8_t tdaUserWrRemainReg = 0xb8;
+static constexpr uint8_t tdaProgCmdLowReg = 0xd6;
+static constexpr uint8_t tdaProgCmdHighReg = 0xd7;
+static constexpr uint8_t tdaRevisionReg = 0xfd;
+static constexpr uint8_t tdaPageReg = 0xff;
+
+static constexpr uint8_t tdaProgCmdLowVal = 0x42;
+static constexpr uint8_t tdaProgCmdHighVal = 0x3f;
+
+static constexpr uint8_t tdaNVMDone = 0x80;
+static constexpr uint8_t tdaNVMError = 0x40;
+
+// the user section, whose CRC is reported
+static constexpr std::pair<uint16_t, uint16_t> tdaUserRanges[] = {
+    {0x0040, 0x0080}, {0x0200, 0x0400}};
+
+// Not the CRC of the real device, which is not needed to tell whether the
+// configuration changed.
+static uint32_t crc32(std::span<const uint8_t> data, uint32_t crc)
+{
+    crc = ~crc;
+    for (uint8_t value : data)
+    {
+        crc ^= value;
+        for (int i = 0; i < 8; i++)
+        {
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+SimulatedTDA38640A::SimulatedTDA38640A(uint8_t revision, uint32_t crc,
+                                       std::chrono::microseconds programTime) :
+    programTime(programTime)
+{
+    registers[tdaRevisionReg] = revision;
+    setCRC(crc);
+    setUsedImagesRegister();
+}
+
+void SimulatedTDA38640A::setCRC(uint32_t crc)
+{
+    registers[tdaCrcLowReg] = crc & 0xff;
+    registers[tdaCrcLowReg + 1] = (crc >> 8) & 0xff;
+    registers[tdaCrcHighReg] = (crc >> 16) & 0xff;
+    registers[tdaCrcHighReg + 1] = (crc >> 24) & 0xff;
+}
+
+void SimulatedTDA38640A::setUsedImagesRegister()
+{
+    // one bit per used user image
+    const uint16_t used = (1U << usedImages) - 1;
+
+    registers[tdaUserWrRemainReg] = used & 0xff;
+    registers[tdaUserWrRemainReg + 1] = used >> 8;
+}
+
+void SimulatedTDA38640A::update()
+{
+    if (!programming.has_value() || Clock::now() < *programming + programTime)
+    {
+        return;
+    }
+
+    programming.reset();
+    programmed = registers;
+    usedImages++;
+
+    uint32_t crc = 0;
+    for (const auto& [begin, end] : tdaUserRanges)
+    {
+        crc = crc32(std::span<const uint8_t>(registers).subspan(begin,
+                                                                end - begin),
+                    crc);
+    }
+
+    setCRC(crc);
+    setUsedImagesRegister();
+    registers[tdaProgCmdHighReg] = tdaNVMDone;
+}
+
+void SimulatedTDA38640A::writeRegister(uint8_t reg, uint8_t value)
+{
+    const uint16_t address = (page << 8) | reg;
+
+    // the status is read only while programming
+    if (programming.has_value() && address == tdaProgCmdHighReg)
+    {
+        return;
+    }
+
+    registers[address] = value;
+
+    if (address != tdaProgCmdLowReg || value != tdaProgCmdLowVal ||
+        registers[tdaProgCmdHighReg] != tdaProgCmdHighVal)
+    {
+        return;
+    }
+
+    if (usedImages >= userImages)
+    {
+        registers[tdaProgCmdHighReg] = tdaNVMDone | tdaNVMError;
+        return;
+    }
+
+    // the done bit is clear until the programming finished
+    programming = Clock::now();
+}
+
+int SimulatedTDA38640A::write(std::span<const uint8_t> data)
+{
+    update();
+
+    if (data.empty())
+    {
+        return 0;
+    }
+
+    // the page register is at the same address on every page
+    if (data[0] == tdaPageReg)
+    {
+        if (data.size() > 1)
+        {
+            page = data[1];
+        }
+        return 0;
+    }
+
+    pointer = data[0];
+
+    for (uint8_t value : data.subspan(1))
+    {
+        writeRegister(pointer++, value);
+    }
+
+    return 0;
+}
+
+int SimulatedTDA38640A::read(std::span<uint8_t> data)
+{
+    update();
+
+    for (uint8_t& value : data)
+    {
+        value = (pointer == tdaPageReg) ? page
+                                        : registers[(page << 8) | pointer];
+        pointer++;
+    }
+
+    return 0;
+}
+
+uint8_t SimulatedTDA38640A::getRegister(uint16_t address) const
+{
+    return registers[address];
+}
+
+std::optional<uint8_t> SimulatedTDA38640A::getProgrammedRegister(
+    uint16_t address) const
+{
+    if (!programmed.has_value())
+    {
+        return std::nullopt;
+    }
+    return (*programmed)[address];
+}
+
+uint32_t SimulatedTDA38640A::getCRC() const
+{
+    return registers[tdaCrcLowReg] | (registers[tdaCrcLowReg + 1] << 8) |
+           (registers[tdaCrcHighReg] << 16) |
+           (static_cast<uint32_t>(registers[tdaCrcHighReg + 1]) << 24);
+}
+
+size_t SimulatedTDA38640A::getRemainingWrites() const
+{
+    return userImages - usedImages;
+}
+
+void SimulatedTDA38640A::setUsedImages(size_t used)
+{
+    usedImages = std::min(used, userImages);
+    setUsedImagesRegister();
+}
+
+} // namespace phosphor::i2c::simulated
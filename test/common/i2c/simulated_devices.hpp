@@ -0,0 +1,234 @@
+#pragma once
+
+#include "simulated_bus.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Register level models of the devices updated by the cpld and i2c-vr
+// daemons, and of an eeprom. They implement what the update code of this
+// repository uses, with the timing of the slow operations configurable.
+
+namespace phosphor::i2c::simulated
+{
+
+using Clock = std::chrono::steady_clock;
+
+// AT24 compatible eeprom with 16-bit word addresses, e.g. AT24C256.
+// A write is buffered until the STOP, then the device is busy for the write
+// cycle and does not acknowledge its address, like the real part.
+class SimulatedAT24 : public SimulatedDevice
+{
+  public:
+    // @param size          the size of the eeprom, in bytes
+    // @param pageSize      writes wrap around within a page of this size
+    // @param writeCycle    how long the device is busy after a write
+    SimulatedAT24(size_t size, size_t pageSize,
+                  std::chrono::microseconds writeCycle);
+
+    int write(std::span<const uint8_t> data) override;
+    int read(std::span<uint8_t> data) override;
+    void stop() override;
+
+    std::span<const uint8_t> getContents() const;
+
+    // @returns     how many write cycles were started
+    size_t getWriteCycles() const;
+
+  private:
+    bool busy() const;
+
+    const size_t pageSize;
+    const std::chrono::microseconds writeCycle;
+
+    std::vector<uint8_t> contents;
+
+    // the address counter
+    size_t address = 0;
+
+    // the data of the write in progress, by address
+    std::map<size_t, uint8_t> pending;
+
+    Clock::time_point busyUntil;
+
+    size_t writeCycles = 0;
+};
+
+// Lattice MachXO3 CPLD, programmed via the i2c configuration port with
+// the commands of LatticeBaseCPLD. The configuration flash is organized in
+// pages of 16 bytes.
+class SimulatedLatticeXO3 : public SimulatedDevice
+{
+  public:
+    static constexpr size_t pageSize = 16;
+
+    struct Timing
+    {
+        std::chrono::microseconds erase{0};
+        std::chrono::microseconds programPage{0};
+        std::chrono::microseconds programDone{0};
+    };
+
+    // @param deviceId      the 4 byte device id, e.g. of LCMXO3LF-4300C
+    // @param pages         size of the configuration flash, in pages
+    // @param timing        how long the device is busy after a command
+    SimulatedLatticeXO3(std::array<uint8_t, 4> deviceId, size_t pages,
+                        Timing timing);
+
+    int write(std::span<const uint8_t> data) override;
+    int read(std::span<uint8_t> data) override;
+
+    std::span<const uint8_t> getFlash() const;
+
+    uint32_t getUserCode() const;
+
+    void setUserCode(uint32_t code);
+
+    bool isConfigMode() const;
+
+    // @returns     true if programming was finished with 'program done'
+    bool isDone() const;
+
+    // @returns     how many pages were programmed
+    size_t getPagesProgrammed() const;
+
+  private:
+    bool busy() const;
+    void startBusy(std::chrono::microseconds duration);
+
+    const std::array<uint8_t, 4> deviceId;
+    const Timing timing;
+
+    std::vector<uint8_t> flash;
+    uint32_t userCode = 0;
+
+    bool configMode = false;
+    bool done = true;
+    bool failed = false;
+
+    size_t page = 0;
+
+    // the command which determines what the next read returns
+    uint8_t readCommand = 0;
+
+    Clock::time_point busyUntil;
+
+    size_t pagesProgrammed = 0;
+};
+
+// MPS digital multi-phase controller, a PMBus command map with pages.
+// While the user code is stored to MTP, the device does not acknowledge
+// its address. WRITE_PROTECT is simplified: while any of its bits is set,
+// only PAGE and WRITE_PROTECT itself can be written.
+class SimulatedMPS : public SimulatedDevice
+{
+  public:
+    // @param storeTime     how long storing the user code takes
+    explicit SimulatedMPS(std::chrono::microseconds storeTime);
+
+    int write(std::span<const uint8_t> data) override;
+    int read(std::span<uint8_t> data) override;
+
+    // @param page      the page of the command
+    // @param command   the command code
+    // @param value     the bytes returned by a read of the command
+    void setRegister(uint8_t page, uint8_t command,
+                     std::vector<uint8_t> value);
+
+    // As above, for block read commands, which are preceded by their length.
+    void setBlockRegister(uint8_t page, uint8_t command,
+                          const std::vector<uint8_t>& value);
+
+    // @returns     the value last written to the command, if any
+    std::optional<std::vector<uint8_t>> getRegister(uint8_t page,
+                                                    uint8_t command) const;
+
+    // @returns     the value of the command when the user code was last
+    //              stored, if any
+    std::optional<std::vector<uint8_t>> getStoredRegister(
+        uint8_t page, uint8_t command) const;
+
+    size_t getStoreCount() const;
+
+  private:
+    using Registers =
+        std::map<std::pair<uint8_t, uint8_t>, std::vector<uint8_t>>;
+
+    const std::chrono::microseconds storeTime;
+
+    Registers registers;
+    Registers stored;
+
+    uint8_t page = 0;
+    uint8_t readCommand = 0;
+
+    Clock::time_point busyUntil;
+
+    size_t storeCount = 0;
+};
+
+// Infineon TDA38640A voltage regulator. Its registers are accessed by
+// address, in 256 byte pages, and the user registers are programmed to one
+// of 16 user images in NVM.
+class SimulatedTDA38640A : public SimulatedDevice
+{
+  public:
+    static constexpr size_t userImages = 16;
+
+    // @param revision      the silicon revision, register 0x00FD
+    // @param crc           the CRC of the configuration in NVM
+    // @param programTime   how long programming a user image takes
+    SimulatedTDA38640A(uint8_t revision, uint32_t crc,
+                       std::chrono::microseconds programTime);
+
+    int write(std::span<const uint8_t> data) override;
+    int read(std::span<uint8_t> data) override;
+
+    // @param address   page and register, e.g. 0x0240
+    uint8_t getRegister(uint16_t address) const;
+
+    // @param address   page and register, e.g. 0x0240
+    // @returns         the value of the register in the last user image
+    //                  programmed, if any
+    std::optional<uint8_t> getProgrammedRegister(uint16_t address) const;
+
+    uint32_t getCRC() const;
+
+    size_t getRemainingWrites() const;
+
+    // @param used      how many user images are used already
+    void setUsedImages(size_t used);
+
+  private:
+    // completes the NVM programming, once it is done
+    void update();
+
+    void writeRegister(uint8_t reg, uint8_t value);
+
+    void setCRC(uint32_t crc);
+
+    void setUsedImagesRegister();
+
+    std::array<uint8_t, 256 * 256> registers{};
+
+    // the registers when the last user image was programmed
+    std::optional<std::array<uint8_t, 256 * 256>> programmed;
+
+    const std::chrono::microseconds programTime;
+
+    uint8_t page = 0;
+    uint8_t pointer = 0;
+
+    size_t usedImages = 0;
+
+    std::optional<Clock::time_point> programming;
+};
+
+} // namespace phosphor::i2c::simulated
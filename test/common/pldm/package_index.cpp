@@ -0,0 +1,227 @@
+#include "common/pldm/package_index.hpp"
+#include "test/create_package/create_pldm_fw_package.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace pldm_package_util;
+
+constexpr uint32_t testVendorIANA = 0x0000A015;
+const std::string testCompatible = "com.example.Hardware.Test";
+
+class PackageIndexTest : public testing::Test
+{
+  protected:
+    PackageIndexTest()
+    {
+        buf = create_pldm_package_buffer(
+            componentImage, sizeof(componentImage),
+            std::optional<uint32_t>(testVendorIANA),
+            std::optional<std::string>(testCompatible), size);
+    }
+
+    // @returns memfd with the test package
+    int createMemfd() const
+    {
+        const int fd = memfd_create("test_package_index", 0);
+
+        EXPECT_TRUE(fd >= 0);
+        EXPECT_EQ(write(fd, buf.get(), size), static_cast<ssize_t>(size));
+
+        return fd;
+    }
+
+    uint8_t componentImage[4] = {0x12, 0x34, 0x83, 0x21};
+
+    std::unique_ptr<uint8_t[]> buf;
+    size_t size = 0;
+};
+
+TEST_F(PackageIndexTest, TestFindComponent)
+{
+    auto index = PackageIndex::create(buf.get(), size);
+
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->size(), 1);
+
+    const ComponentImageLocation* component =
+        index->find(testVendorIANA, testCompatible);
+
+    ASSERT_NE(component, nullptr);
+    EXPECT_EQ(component->size, sizeof(componentImage));
+    EXPECT_EQ(component->version, exampleVersion);
+    ASSERT_LE(component->offset + component->size, size);
+    EXPECT_EQ(memcmp(buf.get() + component->offset, componentImage,
+                     sizeof(componentImage)),
+              0);
+}
+
+TEST_F(PackageIndexTest, TestFindNoMatch)
+{
+    auto index = PackageIndex::create(buf.get(), size);
+
+    ASSERT_NE(index, nullptr);
+
+    EXPECT_EQ(index->find(testVendorIANA + 1, testCompatible), nullptr);
+    EXPECT_EQ(index->find(testVendorIANA, "com.example.Hardware.Other"),
+              nullptr);
+}
+
+TEST_F(PackageIndexTest, TestInvalidPackage)
+{
+    std::vector<uint8_t> garbage(size, 0xff);
+
+    EXPECT_EQ(PackageIndex::create(garbage.data(), garbage.size()), nullptr);
+}
+
+TEST_F(PackageIndexTest, TestCacheSharedAcrossFiles)
+{
+    PackageIndexCache& cache = PackageIndexCache::instance();
+
+    const int fd1 = createMemfd();
+    const int fd2 = createMemfd();
+
+    {
+        auto index1 = cache.acquire(fd1, buf.get(), size);
+        auto index2 = cache.acquire(fd2, buf.get(), size);
+        auto index3 = cache.acquire(fd1, buf.get(), size);
+
+        ASSERT_NE(index1, nullptr);
+
+        // same contents, parsed only once
+        EXPECT_EQ(index1.get(), index2.get());
+        EXPECT_EQ(index1.get(), index3.get());
+        EXPECT_EQ(cache.size(), 1);
+
+        index1.reset();
+        index2.reset();
+
+        // still referenced by 'index3'
+        EXPECT_EQ(cache.size(), 1);
+    }
+
+    // evicted once the last user is done with it
+    EXPECT_EQ(cache.size(), 0);
+
+    close(fd1);
+    close(fd2);
+}
+
+TEST_F(PackageIndexTest, TestSkipRecordWithoutComponent)
+{
+    size_t packageSize = 0;
+
+    // the first matching record has no applicable component, the index
+    // continues with the next matching record
+    auto package = create_pldm_package_buffer(
+        componentImage, sizeof(componentImage),
+        {{testVendorIANA, testCompatible, false},
+         {testVendorIANA, testCompatible, true}},
+        packageSize);
+
+    auto index = PackageIndex::create(package.get(), packageSize);
+
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->size(), 1);
+
+    const ComponentImageLocation* component =
+        index->find(testVendorIANA, testCompatible);
+
+    ASSERT_NE(component, nullptr);
+    EXPECT_EQ(component->size, sizeof(componentImage));
+}
+
+TEST_F(PackageIndexTest, TestNoRecordWithComponent)
+{
+    size_t packageSize = 0;
+
+    auto package = create_pldm_package_buffer(
+        componentImage, sizeof(componentImage),
+        {{testVendorIANA, testCompatible, false}}, packageSize);
+
+    auto index = PackageIndex::create(package.get(), packageSize);
+
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->size(), 0);
+    EXPECT_EQ(index->find(testVendorIANA, testCompatible), nullptr);
+}
+
+TEST_F(PackageIndexTest, TestCacheRehashesChangedFile)
+{
+    PackageIndexCache& cache = PackageIndexCache::instance();
+
+    const int fd = createMemfd();
+
+    // a package of the same size, for another device
+    const std::string otherCompatible = "com.example.Hardware.Tst2";
+    ASSERT_EQ(otherCompatible.size(), testCompatible.size());
+
+    size_t otherSize = 0;
+    auto other = create_pldm_package_buffer(
+        componentImage, sizeof(componentImage),
+        std::optional<uint32_t>(testVendorIANA),
+        std::optional<std::string>(otherCompatible), otherSize);
+    ASSERT_EQ(otherSize, size);
+
+    {
+        auto index1 = cache.acquire(fd, buf.get(), size);
+
+        // the memfd was written with another package while still in use
+        ASSERT_EQ(pwrite(fd, other.get(), otherSize, 0),
+                  static_cast<ssize_t>(otherSize));
+
+        auto index2 = cache.acquire(fd, other.get(), otherSize);
+
+        ASSERT_NE(index1, nullptr);
+        ASSERT_NE(index2, nullptr);
+
+        EXPECT_NE(index1.get(), index2.get());
+        EXPECT_EQ(cache.size(), 2);
+
+        EXPECT_NE(index1->find(testVendorIANA, testCompatible), nullptr);
+        EXPECT_EQ(index2->find(testVendorIANA, testCompatible), nullptr);
+        EXPECT_NE(index2->find(testVendorIANA, otherCompatible), nullptr);
+    }
+
+    EXPECT_EQ(cache.size(), 0);
+
+    close(fd);
+}
+
+TEST_F(PackageIndexTest, TestCacheKeyedByHeader)
+{
+    PackageIndexCache& cache = PackageIndexCache::instance();
+
+    // the same header, with other component image contents
+    uint8_t otherImage[sizeof(componentImage)] = {0xde, 0xad, 0xbe, 0xef};
+    size_t otherSize = 0;
+    auto other = create_pldm_package_buffer(
+        otherImage, sizeof(otherImage),
+        std::optional<uint32_t>(testVendorIANA),
+        std::optional<std::string>(testCompatible), otherSize);
+    ASSERT_EQ(otherSize, size);
+
+    const int fd = createMemfd();
+
+    {
+        auto index1 = cache.acquire(fd, buf.get(), size);
+        auto index2 = cache.acquire(fd, other.get(), otherSize);
+
+        ASSERT_NE(index1, nullptr);
+
+        // the component images are not part of the key, the locations of
+        // the index are the same for both
+        EXPECT_EQ(index1.get(), index2.get());
+        EXPECT_EQ(cache.size(), 1);
+    }
+
+    EXPECT_EQ(cache.size(), 0);
+
+    close(fd);
+}
@@ -0,0 +1,123 @@
+#include "../exampledevice/example_device.hpp"
+#include "test/create_package/create_pldm_fw_package.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async/context.hpp>
+#include <xyz/openbmc_project/Software/Activation/client.hpp>
+#include <xyz/openbmc_project/Software/Update/client.hpp>
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+PHOSPHOR_LOG2_USING;
+
+using namespace phosphor::software;
+using namespace phosphor::software::example_device;
+
+using ActivationClient =
+    sdbusplus::client::xyz::openbmc_project::software::Activation<>;
+
+constexpr auto pollIntervalMs = std::chrono::milliseconds(50);
+
+const std::string exampleInvObjPath2 =
+    "/xyz/openbmc_project/inventory/system/board/ExampleBoard/ExampleDevice2";
+
+static int makeUpdateFd()
+{
+    uint8_t component_image[] = {0x12, 0x34, 0x83, 0x21};
+
+    size_t size_out = 0;
+    std::unique_ptr<uint8_t[]> buf = create_pldm_package_buffer(
+        component_image, sizeof(component_image),
+        std::optional<uint32_t>(exampleVendorIANA),
+        std::optional<std::string>(exampleCompatibleHardware), size_out);
+
+    const int fd = memfd_create("test_memfd", 0);
+    EXPECT_GE(fd, 0);
+
+    if (fd < 0)
+    {
+        return fd;
+    }
+
+    EXPECT_EQ(write(fd, (void*)buf.get(), size_out),
+              static_cast<ssize_t>(size_out))
+        << "Failed to write to memfd: " << strerror(errno);
+
+    return fd;
+}
+
+sdbusplus::async::task<> testGroupUpdate(sdbusplus::async::context& ctx,
+                                         int fd)
+{
+    ExampleCodeUpdater exampleUpdater(ctx, true, "v12.345");
+
+    auto device2 = std::make_unique<ExampleDevice>(ctx, &exampleUpdater);
+    device2->softwareCurrent =
+        std::make_unique<ExampleSoftware>(ctx, *device2);
+    device2->softwareCurrent->setVersion("v12.345");
+
+    ExampleDevice* device1 = exampleUpdater.getDevice().get();
+    ExampleDevice* device2Ptr = device2.get();
+
+    exampleUpdater.devices.insert({exampleInvObjPath2, std::move(device2)});
+
+    exampleUpdater.enableGroupUpdate({RequestedApplyTimes::Immediate});
+
+    const std::string busName = exampleUpdater.getBusName();
+    const std::string suffix = busName.substr(busName.rfind('.') + 1);
+
+    auto client =
+        sdbusplus::client::xyz::openbmc_project::software::Update<>(ctx)
+            .service(busName)
+            .path("/xyz/openbmc_project/software/group/" + suffix);
+
+    sdbusplus::object_path jobPath =
+        co_await client.start_update(fd, RequestedApplyTimes::Immediate);
+
+    auto jobClient = ActivationClient(ctx).service(busName).path(jobPath.str);
+
+    using Activations = ActivationClient::Activations;
+
+    Activations activation = Activations::Activating;
+
+    ssize_t timeout = 2000;
+    while (timeout > 0 && activation == Activations::Activating)
+    {
+        co_await sdbusplus::async::sleep_for(ctx, pollIntervalMs);
+        timeout -= 50;
+        activation = co_await jobClient.activation();
+    }
+
+    EXPECT_EQ(activation, Activations::Active);
+
+    // both devices were updated from the same package
+    EXPECT_TRUE(device1->deviceSpecificUpdateFunctionCalled);
+    EXPECT_TRUE(device2Ptr->deviceSpecificUpdateFunctionCalled);
+
+    EXPECT_FALSE(device1->updateInProgress);
+    EXPECT_FALSE(device2Ptr->updateInProgress);
+
+    ctx.request_stop();
+
+    co_return;
+}
+
+TEST(SoftwareGroupUpdate, TestGroupUpdateAllDevices)
+{
+    const int fd = makeUpdateFd();
+
+    ASSERT_GE(fd, 0);
+
+    sdbusplus::async::context ctx;
+
+    ctx.spawn(testGroupUpdate(ctx, fd));
+
+    ctx.run();
+
+    close(fd);
+}
@@ -0,0 +1,137 @@
+#include "../exampledevice/example_device.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async/context.hpp>
+
+#include <gtest/gtest.h>
+
+PHOSPHOR_LOG2_USING;
+
+using namespace phosphor::software::manager;
+using namespace phosphor::software::example_device;
+
+constexpr auto pollIntervalMs = std::chrono::milliseconds(10);
+
+const std::string configIface =
+    "xyz.openbmc_project.Configuration.ExampleFirmware";
+
+// Befriended by SoftwareManager, drives its init queue without dbus
+class SoftwareManagerTest : public testing::Test
+{
+  protected:
+    using ServiceReadyState = SoftwareManagerServiceReady::States;
+
+    static void queueInterfaceAdded(SoftwareManager& manager, size_t index)
+    {
+        const std::string path = exampleInvObjPath + std::to_string(index);
+
+        ConfigSnapshot::InterfaceMap interfaces;
+
+        interfaces[configIface] = {
+            {"Type", std::string("ExampleFirmware")},
+            {"Name", exampleName + std::to_string(index)},
+        };
+        interfaces[configIface + ".FirmwareInfo"] = {
+            {"VendorIANA", uint64_t(exampleVendorIANA)},
+            {"CompatibleHardware", exampleCompatibleHardware},
+        };
+
+        manager.queueInterfaceAdded(
+            {"", path, configIface, ConfigSnapshot(std::move(interfaces))});
+    }
+
+    static void finishInitialScan(SoftwareManager& manager)
+    {
+        manager.finishInitialScan();
+    }
+
+    static ServiceReadyState serviceReadyState(const SoftwareManager& manager)
+    {
+        return manager.serviceReady->state();
+    }
+
+    sdbusplus::async::context ctx;
+};
+
+sdbusplus::async::task<> waitForDiscovery(sdbusplus::async::context& ctx,
+                                          ExampleCodeUpdater& updater)
+{
+    ssize_t timeout = 2000;
+    while (timeout > 0 && !updater.isDiscoveryComplete())
+    {
+        co_await sdbusplus::async::sleep_for(ctx, pollIntervalMs);
+        timeout -= pollIntervalMs.count();
+    }
+
+    ctx.request_stop();
+
+    co_return;
+}
+
+sdbusplus::async::task<> stopAfter(sdbusplus::async::context& ctx,
+                                   std::chrono::milliseconds delay)
+{
+    co_await sdbusplus::async::sleep_for(ctx, delay);
+
+    ctx.request_stop();
+
+    co_return;
+}
+
+TEST_F(SoftwareManagerTest, TestConcurrentInitBound)
+{
+    constexpr size_t maxConcurrentInits = 2;
+    constexpr size_t numDevices = 5;
+
+    ExampleCodeUpdater updater(ctx, ExampleCodeUpdater::getRandomId(),
+                               maxConcurrentInits);
+    updater.initDelay = std::chrono::milliseconds(20);
+
+    for (size_t i = 0; i < numDevices; i++)
+    {
+        queueInterfaceAdded(updater, i);
+    }
+    finishInitialScan(updater);
+
+    ctx.spawn(waitForDiscovery(ctx, updater));
+
+    ctx.run();
+
+    EXPECT_TRUE(updater.isDiscoveryComplete());
+    EXPECT_EQ(serviceReadyState(updater), ServiceReadyState::Enabled);
+    EXPECT_EQ(updater.devices.size(), numDevices);
+
+    // devices were initialized concurrently, but never more than the bound
+    EXPECT_EQ(updater.maxInitsInProgress, maxConcurrentInits);
+    EXPECT_EQ(updater.initsInProgress, 0);
+}
+
+TEST_F(SoftwareManagerTest, TestDiscoveryWaitsForInitialScan)
+{
+    ExampleCodeUpdater updater(ctx);
+
+    queueInterfaceAdded(updater, 0);
+
+    // devices added before the initial scan is done don't complete discovery
+    ctx.spawn(stopAfter(ctx, std::chrono::milliseconds(50)));
+
+    ctx.run();
+
+    EXPECT_EQ(updater.devices.size(), 1);
+    EXPECT_FALSE(updater.isDiscoveryComplete());
+    EXPECT_EQ(serviceReadyState(updater), ServiceReadyState::Starting);
+}
+
+TEST_F(SoftwareManagerTest, TestDiscoveryCompleteWithoutDevices)
+{
+    ExampleCodeUpdater updater(ctx);
+
+    EXPECT_FALSE(updater.isDiscoveryComplete());
+    EXPECT_EQ(serviceReadyState(updater), ServiceReadyState::Starting);
+
+    finishInitialScan(updater);
+
+    EXPECT_TRUE(updater.isDiscoveryComplete());
+    EXPECT_EQ(serviceReadyState(updater), ServiceReadyState::Enabled);
+    EXPECT_TRUE(updater.devices.empty());
+}
@@ -0,0 +1,162 @@
+#include "update_timing.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <future>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::software::update;
+using namespace std::chrono_literals;
+
+TEST(UpdateTimingTest, PhaseDurations)
+{
+    const auto t0 = UpdateTimer::Clock::now();
+    UpdateTimer timer(t0);
+
+    timer.beginPhase(UpdatePhase::Parse, t0);
+    timer.beginPhase(UpdatePhase::Match, t0 + 10ms);
+    timer.beginPhase(UpdatePhase::Verify, t0 + 15ms);
+    timer.beginPhase(UpdatePhase::Program, t0 + 115ms);
+    timer.beginPhase(UpdatePhase::Verify, t0 + 315ms);
+    timer.endPhase(t0 + 365ms);
+
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Parse), 10ms);
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Match), 5ms);
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Verify), 150ms);
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Program), 200ms);
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Reset), 0ms);
+    EXPECT_EQ(timer.getElapsed(t0 + 400ms), 400ms);
+    EXPECT_FALSE(timer.getPhase().has_value());
+
+    EXPECT_EQ(timer.getSummary(),
+              "parse=10 match=5 verify=150 program=200 reset=0");
+}
+
+TEST(UpdateTimingTest, AddPhaseDuration)
+{
+    const auto t0 = UpdateTimer::Clock::now();
+    UpdateTimer timer(t0);
+
+    // e.g. the package was parsed once for a group update
+    timer.addPhaseDuration(UpdatePhase::Parse, 20ms);
+
+    timer.beginPhase(UpdatePhase::Match, t0);
+    timer.beginPhase(UpdatePhase::Program, t0 + 5ms);
+
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Parse), 20ms);
+    EXPECT_EQ(timer.getPhaseDuration(UpdatePhase::Match), 5ms);
+    EXPECT_EQ(timer.getPhase(), UpdatePhase::Program);
+}
+
+TEST(UpdateTimingTest, ThroughputAndRemaining)
+{
+    const auto t0 = UpdateTimer::Clock::now();
+    UpdateTimer timer(t0);
+
+    timer.setImageSize(10000);
+
+    // nothing to estimate before the device update started
+    timer.beginPhase(UpdatePhase::Parse, t0);
+    EXPECT_EQ(timer.getThroughput(50, t0 + 1s), 0);
+    EXPECT_FALSE(timer.getRemaining(50, t0 + 1s).has_value());
+
+    timer.beginPhase(UpdatePhase::Program, t0 + 1s);
+
+    EXPECT_FALSE(timer.getRemaining(0, t0 + 2s).has_value());
+
+    // half of the image took 1s
+    EXPECT_EQ(timer.getThroughput(50, t0 + 2s), 5000);
+    EXPECT_EQ(timer.getRemaining(50, t0 + 2s), 1000ms);
+
+    EXPECT_EQ(timer.getThroughput(25, t0 + 2s), 2500);
+    EXPECT_EQ(timer.getRemaining(25, t0 + 2s), 3000ms);
+
+    EXPECT_EQ(timer.getRemaining(100, t0 + 3s), 0ms);
+
+    timer.beginPhase(UpdatePhase::Reset, t0 + 3s);
+    timer.endPhase(t0 + 10s);
+
+    // reset does not count towards the throughput
+    EXPECT_EQ(timer.getAverageThroughput(), 5000);
+}
+
+class UpdateTimingLogTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() /
+              std::format("update-timing-test-{}", getpid());
+        std::filesystem::remove_all(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::filesystem::path dir;
+};
+
+TEST_F(UpdateTimingLogTest, CreatesDirectory)
+{
+    UpdateTimingLog log(dir / "sub" / "test.log", 4);
+
+    EXPECT_TRUE(log.read().empty());
+
+    EXPECT_TRUE(log.append("first"));
+
+    EXPECT_EQ(log.read(), std::vector<std::string>{"first"});
+}
+
+TEST_F(UpdateTimingLogTest, KeepsMostRecentEntries)
+{
+    UpdateTimingLog log(dir / "test.log", 3);
+
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_TRUE(log.append(std::to_string(i)));
+    }
+
+    EXPECT_EQ(log.read(), (std::vector<std::string>{"2", "3", "4"}));
+
+    // a smaller limit also trims older entries
+    UpdateTimingLog smaller(dir / "test.log", 2);
+
+    EXPECT_TRUE(smaller.append("5"));
+
+    EXPECT_EQ(smaller.read(), (std::vector<std::string>{"4", "5"}));
+}
+
+TEST_F(UpdateTimingLogTest, AppendAsync)
+{
+    UpdateTimingLog log(dir / "test.log", 3);
+
+    std::future<bool> first = log.appendAsync("first");
+    std::future<bool> second = log.appendAsync("second");
+
+    EXPECT_TRUE(first.get());
+    EXPECT_TRUE(second.get());
+
+    // both entries are there, in whichever order the threads ran
+    std::vector<std::string> entries = log.read();
+    std::ranges::sort(entries);
+
+    EXPECT_EQ(entries, (std::vector<std::string>{"first", "second"}));
+
+    EXPECT_FALSE(log.appendAsync("a\nb").get());
+}
+
+TEST_F(UpdateTimingLogTest, RejectsMultilineEntry)
+{
+    UpdateTimingLog log(dir / "test.log", 3);
+
+    EXPECT_FALSE(log.append("a\nb"));
+
+    EXPECT_TRUE(log.read().empty());
+}
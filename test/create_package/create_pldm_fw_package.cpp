@@ -1,3 +1,4 @@
+#include "create_pldm_fw_package.hpp"
 
 #include "component_image_info_area.hpp"
 #include "firmware_device_id_area.hpp"
@@ -8,16 +9,22 @@
 #include <libpldm/firmware_update.h>
 
 #include <cstring>
+#include <format>
 #include <fstream>
 #include <limits>
 #include <random>
+#include <vector>
+
+// upper bound for the size of one firmware device id record
+static constexpr size_t maxRecordSize = 256;
 
 std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
     const uint8_t* component_image, size_t component_image_size,
-    const std::optional<uint32_t>& optVendorIANA,
-    const std::optional<std::string>& optCompatible, size_t& size_out)
+    const std::vector<FirmwareDeviceIdRecordDescriptors>& records,
+    size_t& size_out)
 {
-    const size_t size = 512 + component_image_size;
+    const size_t size =
+        512 + (records.size() * maxRecordSize) + component_image_size;
     auto buffer = std::make_unique<uint8_t[]>(size);
     uint8_t* b = buffer.get();
     memset(b, 0, size);
@@ -68,7 +75,7 @@ std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
     // --- Firmware Device Identification Area 1.0.0 ---
 
     i = create_pldm_firmware_device_identification_area_v1_0_0(
-        b, i, optVendorIANA, optCompatible, componentBitmapBitLength);
+        b, i, records, componentBitmapBitLength);
 
     // --- Component Image Information Area 1.0.0 ---
     size_t componentLocationOffsetIndex;
@@ -96,10 +103,8 @@ std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
     // --- end of the package header ---
 
     // write the component image
-    for (size_t j = 0; j < component_image_size; j++)
-    {
-        b[i++] = component_image[j];
-    }
+    memcpy(b + i, component_image, component_image_size);
+    i += component_image_size;
 
     lg2::debug("wrote {NBYTES} bytes for pldm update package", "NBYTES", i);
 
@@ -107,6 +112,32 @@ std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
     return buffer;
 }
 
+std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
+    const uint8_t* component_image, size_t component_image_size,
+    const std::optional<uint32_t>& optVendorIANA,
+    const std::optional<std::string>& optCompatible, size_t& size_out)
+{
+    return create_pldm_package_buffer(component_image, component_image_size,
+                                      {{optVendorIANA, optCompatible}},
+                                      size_out);
+}
+
+std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
+    const uint8_t* component_image, size_t component_image_size,
+    uint32_t vendorIANA, const std::string& compatible, size_t recordCount,
+    size_t& size_out)
+{
+    std::vector<FirmwareDeviceIdRecordDescriptors> records;
+
+    for (size_t j = 0; j < recordCount; j++)
+    {
+        records.push_back({vendorIANA, std::format("{}.{}", compatible, j)});
+    }
+
+    return create_pldm_package_buffer(component_image, component_image_size,
+                                      records, size_out);
+}
+
 static void create_pldm_package_file(std::ofstream& of,
                                      const uint8_t* component_image,
                                      size_t component_image_size)
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "firmware_device_id_area.hpp"
+
 #include <inttypes.h>
 
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 constexpr const char* exampleVersion = "mycompversion";
 
@@ -15,3 +18,18 @@ std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
     const uint8_t* component_image, size_t component_image_size,
     const std::optional<uint32_t>& optVendorIANA,
     const std::optional<std::string>& optCompatible, size_t& size_out);
+
+// Creates a package where 'recordCount' firmware device id records apply to
+// the single component image. Record 'n' has the descriptors 'vendorIANA'
+// and "<compatible>.<n>". At most 255 records fit in a package.
+std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
+    const uint8_t* component_image, size_t component_image_size,
+    uint32_t vendorIANA, const std::string& compatible, size_t recordCount,
+    size_t& size_out);
+
+// Creates a package with the given firmware device id records, which apply
+// to the single component image unless they are marked otherwise.
+std::unique_ptr<uint8_t[]> create_pldm_package_buffer(
+    const uint8_t* component_image, size_t component_image_size,
+    const std::vector<FirmwareDeviceIdRecordDescriptors>& records,
+    size_t& size_out);
@@ -1,9 +1,12 @@
+#include "firmware_device_id_area.hpp"
+
 #include <inttypes.h>
 #include <libpldm/firmware_update.h>
 
 #include <cstring>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 static ssize_t create_pldm_firmware_device_descriptor_v1_0_0(
@@ -101,7 +104,7 @@ static ssize_t create_pldm_firmware_device_descriptors_v1_0_0(
 ssize_t create_pldm_firmware_device_identification_record(
     uint8_t* b, ssize_t i, const std::optional<uint32_t>& optVendorIANA,
     const std::optional<std::string>& optCompatible,
-    uint16_t componentBitmapBitLength)
+    uint16_t componentBitmapBitLength, bool applicable)
 {
     const ssize_t startIndex = i;
     // RecordLength, backfill later
@@ -133,7 +136,7 @@ ssize_t create_pldm_firmware_device_identification_record(
     // ApplicableComponents
     for (int j = 0; j < (componentBitmapBitLength / 8); j++)
     {
-        b[i++] = 0x1;
+        b[i++] = applicable ? 0x1 : 0x0;
         // the first and only component image does apply to this device
     }
 
@@ -172,3 +175,21 @@ ssize_t create_pldm_firmware_device_identification_area_v1_0_0(
     return create_pldm_firmware_device_identification_record(
         b, i, optVendorIANA, optCompatible, componentBitmapBitLength);
 }
+
+ssize_t create_pldm_firmware_device_identification_area_v1_0_0(
+    uint8_t* b, ssize_t i,
+    const std::vector<FirmwareDeviceIdRecordDescriptors>& records,
+    uint16_t componentBitmapBitLength)
+{
+    // Device ID Record Count
+    b[i++] = records.size();
+
+    for (const auto& record : records)
+    {
+        i = create_pldm_firmware_device_identification_record(
+            b, i, record.vendorIANA, record.compatible,
+            componentBitmapBitLength, record.applicable);
+    }
+
+    return i;
+}
@@ -5,13 +5,29 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
+
+// The descriptors of a firmware device id record
+struct FirmwareDeviceIdRecordDescriptors
+{
+    std::optional<uint32_t> vendorIANA;
+    std::optional<std::string> compatible;
+    // false if the component image does not apply to the device
+    bool applicable = true;
+};
 
 ssize_t create_pldm_firmware_device_identification_record(
     uint8_t* b, ssize_t i, const std::optional<uint32_t>& optVendorIANA,
     const std::optional<std::string>& optCompatible,
-    uint16_t componentBitmapBitLength);
+    uint16_t componentBitmapBitLength, bool applicable = true);
 
 ssize_t create_pldm_firmware_device_identification_area_v1_0_0(
     uint8_t* b, ssize_t i, const std::optional<uint32_t>& optVendorIANA,
     const std::optional<std::string>& optCompatible,
     uint16_t componentBitmapBitLength);
+
+// @param records      the descriptors of each record
+ssize_t create_pldm_firmware_device_identification_area_v1_0_0(
+    uint8_t* b, ssize_t i,
+    const std::vector<FirmwareDeviceIdRecordDescriptors>& records,
+    uint16_t componentBitmapBitLength);
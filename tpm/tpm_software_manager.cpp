@@ -1,6 +1,5 @@
 #include "tpm_software_manager.hpp"
 
-#include "common/include/dbus_helper.hpp"
 #include "tpm_device.hpp"
 
 #include <phosphor-logging/lg2.hpp>
@@ -20,14 +19,14 @@ void TPMSoftwareManager::start()
 }
 
 sdbusplus::async::task<bool> TPMSoftwareManager::initDevice(
-    const std::string& service, const sdbusplus::object_path& path,
-    SoftwareConfig& config)
+    const std::string& /*unused*/, const sdbusplus::object_path& /*unused*/,
+    SoftwareConfig& config, const ConfigSnapshot& snapshot)
 {
     const std::string configIface =
         "xyz.openbmc_project.Configuration." + config.configType;
 
-    std::optional<uint8_t> tpmIndex = co_await dbusGetRequiredProperty<uint8_t>(
-        ctx, service, path, configIface, "TPMIndex");
+    std::optional<uint8_t> tpmIndex =
+        snapshot.getRequired<uint8_t>(configIface, "TPMIndex");
 
     if (!tpmIndex.has_value())
     {
@@ -36,8 +35,7 @@ sdbusplus::async::task<bool> TPMSoftwareManager::initDevice(
     }
 
     std::optional<std::string> type =
-        co_await dbusGetRequiredProperty<std::string>(ctx, service, path,
-                                                      configIface, "Type");
+        snapshot.getRequired<std::string>(configIface, "Type");
     if (!type.has_value())
     {
         error("Missing property: Type");
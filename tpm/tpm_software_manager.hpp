@@ -15,7 +15,7 @@ class TPMSoftwareManager : public ManagerInf::SoftwareManager
 
     void start();
 
-    sdbusplus::async::task<bool> initDevice(const std::string& service,
-                                            const sdbusplus::object_path& path,
-                                            SoftwareConfig& config) final;
+    sdbusplus::async::task<bool> initDevice(
+        const std::string& service, const sdbusplus::object_path& path,
+        SoftwareConfig& config, const ConfigSnapshot& snapshot) final;
 };